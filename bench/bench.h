@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Shared microbenchmark scaffolding: each measurement repeats until it
+ * has run for BENCH_SECONDS and done at least MIN_OPS operations.
+ */
+
+#include <time.h>
+
+#define BENCH_SECONDS   0.3
+#define MIN_OPS         50
+
+static inline double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline double now_usec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+#endif /* BENCH_H */
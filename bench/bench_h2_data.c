@@ -0,0 +1,426 @@
+/*
+ * HTTP/2 response DATA: copied frames vs NGHTTP2_DATA_FLAG_NO_COPY.
+ *
+ * copy   - the previous send path: the body copied into a data source
+ *          at submit time, each DATA frame's payload copied into
+ *          nghttp2's frame buffer by the read callback, and the whole
+ *          frame copied again into the output buffer by the send callback.
+ * nocopy - the current one, driven through src/http2.c: the data source
+ *          from h2_body_source_new() references the body (pinning the
+ *          static table, as for a page), the read callback only sizes the
+ *          frame, and h2_send_data_callback() copies the 9-byte frame
+ *          header and adds the payload by reference.
+ *
+ * Both write through the server's own send callbacks into a Connection's
+ * bufferevent output. A client session (its windows opened to the
+ * maximum) issues one GET at a time; the server session answers each
+ * with the body over 16KB DATA frames, and the output is written to
+ * /dev/null as the socket would. Reports bytes copied per response by the
+ * send path, responses/sec and body MB/s at 1KB, 16KB, 128KB (a large
+ * HTML page) and 1MB. Also checks both paths produce the same bytes.
+ *
+ * Usage: make bench  (or ./build/bench_h2_data, from the repository root)
+ */
+
+#include "connection.h"
+#include "http2.h"
+#include "static_files.h"
+#include "log.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <nghttp2/nghttp2.h>
+#include <event2/event.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+
+#define MAX_WINDOW      ((1u << 31) - 1)
+
+/*
+ * The client never reads the responses, so its streams stay open and its
+ * connection window only shrinks: session pairs are replaced after this
+ * many streams or body bytes.
+ */
+#define SESSION_STREAMS 1000
+#define SESSION_BYTES   ((size_t)1 << 30)
+
+static const size_t sizes[] = { 1u << 10, 16u << 10, 128u << 10, 1u << 20 };
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+/* ========== Server ========== */
+
+/* The previous path's data source, kept here as the baseline */
+typedef struct {
+    size_t len;
+    size_t pos;
+    unsigned char copy[];
+} CopySource;
+
+typedef struct {
+    int nocopy;
+    Connection *conn;           /* user_data of the server session */
+    struct evbuffer *output;    /* conn's bufferevent output */
+    StaticFiles *files;         /* Pinned by each nocopy response */
+    const unsigned char *body;
+    size_t body_len;
+    uint64_t copied;            /* Bytes memcpy'd by the send path */
+} Server;
+
+/* The server session's user_data has to be the Connection */
+static Server server;
+
+static ssize_t copy_read_cb(nghttp2_session *session, int32_t stream_id,
+                            uint8_t *buf, size_t length, uint32_t *data_flags,
+                            nghttp2_data_source *source, void *user_data)
+{
+    CopySource *cs = source->ptr;
+    size_t n = cs->len - cs->pos < length ? cs->len - cs->pos : length;
+    (void)session;
+    (void)stream_id;
+    (void)user_data;
+
+    memcpy(buf, cs->copy + cs->pos, n);
+    server.copied += n;
+    cs->pos += n;
+    if (cs->pos == cs->len) {
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+    return (ssize_t)n;
+}
+
+static int server_frame_recv_cb(nghttp2_session *session, const nghttp2_frame *frame,
+                                void *user_data)
+{
+    nghttp2_nv headers[] = {
+        { (uint8_t *)":status", (uint8_t *)"200", 7, 3, NGHTTP2_NV_FLAG_NONE },
+        { (uint8_t *)"content-type", (uint8_t *)"text/html", 12, 9, NGHTTP2_NV_FLAG_NONE },
+    };
+    nghttp2_data_provider prd;
+    void *source;
+    (void)user_data;
+
+    if (frame->hd.type != NGHTTP2_HEADERS || !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM)) {
+        return 0;
+    }
+    if (server.nocopy) {
+        source = h2_body_source_new(server.files, server.body, server.body_len, &prd);
+    } else {
+        CopySource *cs = malloc(sizeof(CopySource) + server.body_len);
+        if (cs) {
+            cs->len = server.body_len;
+            cs->pos = 0;
+            memcpy(cs->copy, server.body, server.body_len);
+            server.copied += server.body_len;
+            prd.source.ptr = cs;
+            prd.read_callback = copy_read_cb;
+        }
+        source = cs;
+    }
+    if (!source) {
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+    if (nghttp2_submit_response(session, frame->hd.stream_id, headers, 2, &prd) != 0 ||
+        nghttp2_session_set_stream_user_data(session, frame->hd.stream_id, source) != 0) {
+        if (server.nocopy) h2_body_source_unref(source);
+        else free(source);
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+    return 0;
+}
+
+static int server_stream_close_cb(nghttp2_session *session, int32_t stream_id,
+                                  uint32_t error_code, void *user_data)
+{
+    void *source = nghttp2_session_get_stream_user_data(session, stream_id);
+    (void)error_code;
+    (void)user_data;
+
+    if (source && server.nocopy) {
+        h2_body_source_unref(source);
+    } else {
+        free(source);
+    }
+    return 0;
+}
+
+static int server_init(int nocopy, struct event_base *base, StaticFiles *files,
+                       const unsigned char *body, size_t len)
+{
+    memset(&server, 0, sizeof(server));
+    server.nocopy = nocopy;
+    server.files = files;
+    server.body = body;
+    server.body_len = len;
+    if (!(server.conn = calloc(1, sizeof(Connection)))) {
+        return -1;
+    }
+    if (!(server.conn->bev = bufferevent_socket_new(base, -1, 0))) {
+        free(server.conn);
+        return -1;
+    }
+    /* No socket: flush_output() stands in for the bufferevent's writes */
+    server.output = bufferevent_get_output(server.conn->bev);
+    evbuffer_unfreeze(server.output, 1);
+    return 0;
+}
+
+static void server_free(void)
+{
+    bufferevent_free(server.conn->bev);
+    free(server.conn);
+}
+
+/* ========== Session pair ========== */
+
+typedef struct {
+    nghttp2_session *client;
+    nghttp2_session *server;
+    size_t streams;
+    size_t sent;                /* Body bytes against the connection window */
+} Pair;
+
+static ssize_t client_send_cb(nghttp2_session *session, const uint8_t *data,
+                              size_t length, int flags, void *user_data)
+{
+    (void)session;
+    (void)data;
+    (void)flags;
+    (void)user_data;
+    return (ssize_t)length;
+}
+
+static void pair_free(Pair *p)
+{
+    nghttp2_session_del(p->client);
+    nghttp2_session_del(p->server);
+    p->client = p->server = NULL;
+}
+
+static int pair_open(Pair *p)
+{
+    nghttp2_session_callbacks *cb;
+    nghttp2_option *option;
+    nghttp2_settings_entry settings[] = {
+        { NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, MAX_WINDOW },
+    };
+    int rv;
+
+    p->client = p->server = NULL;
+    p->streams = 0;
+    p->sent = 0;
+    if (nghttp2_session_callbacks_new(&cb) != 0) return -1;
+    if (nghttp2_option_new(&option) != 0) {
+        nghttp2_session_callbacks_del(cb);
+        return -1;
+    }
+    /* The server's SETTINGS never reach the client, which would otherwise
+     * assume 100 concurrent streams */
+    nghttp2_option_set_peer_max_concurrent_streams(option, SESSION_STREAMS + 1);
+    nghttp2_session_callbacks_set_send_callback(cb, client_send_cb);
+    rv = nghttp2_session_client_new2(&p->client, cb, NULL, option);
+    nghttp2_option_del(option);
+    nghttp2_session_callbacks_del(cb);
+    if (rv != 0) {
+        return -1;
+    }
+
+    if (nghttp2_session_callbacks_new(&cb) != 0) return -1;
+    h2_set_send_callbacks(cb);
+    if (!server.nocopy) {
+        /* Whole frames through h2_send_callback() */
+        nghttp2_session_callbacks_set_send_data_callback(cb, NULL);
+    }
+    nghttp2_session_callbacks_set_on_frame_recv_callback(cb, server_frame_recv_cb);
+    nghttp2_session_callbacks_set_on_stream_close_callback(cb, server_stream_close_cb);
+    rv = nghttp2_session_server_new(&p->server, cb, server.conn);
+    nghttp2_session_callbacks_del(cb);
+    if (rv != 0) {
+        pair_free(p);
+        return -1;
+    }
+
+    if (nghttp2_submit_settings(p->client, NGHTTP2_FLAG_NONE, settings, 1) != 0 ||
+        nghttp2_submit_window_update(p->client, NGHTTP2_FLAG_NONE, 0,
+                                     MAX_WINDOW - NGHTTP2_INITIAL_CONNECTION_WINDOW_SIZE) != 0) {
+        pair_free(p);
+        return -1;
+    }
+    return 0;
+}
+
+/* One GET from the client, fed to the server, and the server's answer */
+static int exchange(Pair *p)
+{
+    static const nghttp2_nv request[] = {
+        { (uint8_t *)":method", (uint8_t *)"GET", 7, 3, NGHTTP2_NV_FLAG_NONE },
+        { (uint8_t *)":scheme", (uint8_t *)"https", 7, 5, NGHTTP2_NV_FLAG_NONE },
+        { (uint8_t *)":authority", (uint8_t *)"relay.example.com", 10, 17, NGHTTP2_NV_FLAG_NONE },
+        { (uint8_t *)":path", (uint8_t *)"/", 5, 1, NGHTTP2_NV_FLAG_NONE },
+    };
+    size_t queued = evbuffer_get_length(server.output);
+    size_t added;
+    const uint8_t *data;
+    ssize_t len;
+
+    if (nghttp2_submit_request(p->client, NULL, request, 4, NULL, NULL) < 0) {
+        return -1;
+    }
+    while ((len = nghttp2_session_mem_send(p->client, &data)) > 0) {
+        if (nghttp2_session_mem_recv(p->server, data, (size_t)len) != len) {
+            return -1;
+        }
+    }
+    if (len < 0 || nghttp2_session_send(p->server) != 0) {
+        return -1;
+    }
+    added = evbuffer_get_length(server.output) - queued;
+    if (added < server.body_len) {
+        return -1;
+    }
+    /* All but referenced DATA payloads was copied into the output */
+    server.copied += server.nocopy ? added - server.body_len : added;
+    p->streams++;
+    p->sent += server.body_len;
+    return 0;
+}
+
+/* ========== Measurement ========== */
+
+static int flush_output(struct evbuffer *output, int fd)
+{
+    while (evbuffer_get_length(output) > 0) {
+        if (evbuffer_write(output, fd) < 0) return -1;
+    }
+    return 0;
+}
+
+typedef struct {
+    double kb_copied;
+    double ops_per_sec;
+} Result;
+
+static int run(int nocopy, struct event_base *base, StaticFiles *files,
+               const unsigned char *body, size_t len, int fd, Result *r)
+{
+    Pair pair;
+    uint64_t ops = 0;
+    double start, elapsed;
+
+    if (server_init(nocopy, base, files, body, len) < 0 || pair_open(&pair) < 0) {
+        return -1;
+    }
+
+    /* The first exchange also carries the preface and SETTINGS */
+    if (exchange(&pair) < 0 || flush_output(server.output, fd) < 0) {
+        return -1;
+    }
+    server.copied = 0;
+
+    start = now_sec();
+    do {
+        if (pair.streams == SESSION_STREAMS || pair.sent + len > SESSION_BYTES) {
+            pair_free(&pair);
+            if (pair_open(&pair) < 0 || exchange(&pair) < 0) return -1;
+        }
+        if (exchange(&pair) < 0 || flush_output(server.output, fd) < 0) {
+            return -1;
+        }
+        ops++;
+        elapsed = now_sec() - start;
+    } while (ops < MIN_OPS || elapsed < BENCH_SECONDS);
+
+    r->kb_copied = server.copied / 1024.0 / ops;
+    r->ops_per_sec = ops / elapsed;
+    pair_free(&pair);
+    server_free();
+    return 0;
+}
+
+/* Both paths must put the same bytes on the wire */
+static int same_output(struct event_base *base, StaticFiles *files,
+                       const unsigned char *body, size_t len)
+{
+    struct evbuffer *out[2];
+    int same;
+
+    for (int nocopy = 0; nocopy < 2; nocopy++) {
+        Pair pair;
+
+        if (!(out[nocopy] = evbuffer_new()) ||
+            server_init(nocopy, base, files, body, len) < 0 || pair_open(&pair) < 0) {
+            return 0;
+        }
+        for (int i = 0; i < 3; i++) {
+            if (exchange(&pair) < 0) return 0;
+        }
+        pair_free(&pair);
+        if (evbuffer_add_buffer(out[nocopy], server.output) != 0) return 0;
+        server_free();
+    }
+    same = evbuffer_get_length(out[0]) == evbuffer_get_length(out[1]) &&
+           memcmp(evbuffer_pullup(out[0], -1), evbuffer_pullup(out[1], -1),
+                  evbuffer_get_length(out[0])) == 0;
+    evbuffer_free(out[0]);
+    evbuffer_free(out[1]);
+    return same;
+}
+
+int main(void)
+{
+    Config *config = config_default();
+    struct event_base *base = event_base_new();
+    int fd = open("/dev/null", O_WRONLY);
+    unsigned char *body = malloc(sizes[NUM_SIZES - 1]);
+    StaticFiles *files;
+
+    if (!config || !base || fd < 0 || !body) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    /* Only pinned by the responses, like the table a page lives in */
+    log_init(LOG_WARN);
+    files = static_files_open("./static", config, NULL);
+    if (!files) {
+        printf("cannot load ./static (run from the repository root)\n");
+        return 1;
+    }
+    for (size_t i = 0; i < sizes[NUM_SIZES - 1]; i++) {
+        body[i] = (unsigned char)("<p>relay</p>\n"[i % 13]);
+    }
+
+    printf("%-7s  %22s  %22s  %22s\n", "", "KB copied/response",
+           "responses/sec", "body MB/s");
+    printf("%-7s  %10s %11s  %10s %11s  %10s %11s\n", "body",
+           "copy", "nocopy", "copy", "nocopy", "copy", "nocopy");
+
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        size_t len = sizes[s];
+        Result copy, nocopy;
+
+        if (!same_output(base, files, body, len)) {
+            fprintf(stderr, "FAIL: copy and nocopy output differ at %zu bytes\n", len);
+            return 1;
+        }
+        if (run(0, base, files, body, len, fd, &copy) < 0 ||
+            run(1, base, files, body, len, fd, &nocopy) < 0) {
+            fprintf(stderr, "FAIL: session error at %zu bytes\n", len);
+            return 1;
+        }
+        printf("%5zuKB  %10.1f %11.1f  %10.0f %11.0f  %10.0f %11.0f\n", len >> 10,
+               copy.kb_copied, nocopy.kb_copied, copy.ops_per_sec, nocopy.ops_per_sec,
+               copy.ops_per_sec * len / 1e6, nocopy.ops_per_sec * len / 1e6);
+    }
+
+    static_files_unref(files);
+    event_base_free(base);
+    config_free(config);
+    free(body);
+    close(fd);
+    return 0;
+}
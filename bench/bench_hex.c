@@ -0,0 +1,136 @@
+/*
+ * Hex validate/decode backend microbenchmark.
+ *
+ * Reports throughput (MB/s of hex input) of hex_scan() and
+ * hex_decode_scan() per backend at 1KB, 64KB, 1MB and 16MB; the scalar
+ * row is the lookup-table version. Also cross-checks decoded bytes and
+ * first-invalid offsets of every backend against scalar.
+ *
+ * Usage: make bench  (or ./build/bench_hex)
+ */
+
+#include "hex.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIZE        (16u << 20)
+
+static const size_t sizes[] = { 1u << 10, 64u << 10, 1u << 20, 16u << 20 };
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static size_t sink;
+
+static double bench_scan(const char *hex, size_t len)
+{
+    uint64_t bytes = 0;
+    double start = now_sec(), elapsed;
+
+    do {
+        sink += hex_scan(hex, len);
+        bytes += len;
+        elapsed = now_sec() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    return bytes / elapsed / 1e6;
+}
+
+static double bench_decode(const char *hex, size_t len, uint8_t *out)
+{
+    uint64_t bytes = 0;
+    double start = now_sec(), elapsed;
+
+    do {
+        sink += hex_decode_scan(hex, len, out);
+        bytes += len;
+        elapsed = now_sec() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    return bytes / elapsed / 1e6;
+}
+
+/*
+ * Check decode output and invalid offsets against scalar for a spread of
+ * lengths and bad-character positions. Returns 0 if all agree.
+ */
+static int cross_check(const char *hex, const uint8_t *expect, uint8_t *out)
+{
+    static const char bad[] = { 'g', 'G', ' ', '/', ':', '@', '`', '\0', '\x80', '\xff' };
+    char buf[512];
+
+    for (size_t len = 0; len <= 256; len += 2) {
+        memset(out, 0, len / 2);
+        if (hex_decode_scan(hex, len, out) != len || memcmp(out, expect, len / 2) != 0 ||
+            hex_scan(hex, len) != len) {
+            return -1;
+        }
+    }
+
+    for (size_t pos = 0; pos < 256; pos++) {
+        memcpy(buf, hex, 256);
+        buf[pos] = bad[pos % sizeof(bad)];
+        if (hex_scan(buf, 256) != pos || hex_decode_scan(buf, 256, out) != pos ||
+            memcmp(out, expect, pos / 2) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const char digits[] = "0123456789abcdefABCDEF";
+    char *hex = malloc(MAX_SIZE);
+    uint8_t *out = malloc(MAX_SIZE / 2);
+    uint8_t expect[128];
+    int failed = 0;
+
+    if (!hex || !out) {
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < MAX_SIZE; i++) {
+        hex[i] = digits[rand() % (sizeof(digits) - 1)];
+    }
+
+    hex_set_backend(HEX_BACKEND_SCALAR);
+    hex_decode_scan(hex, 256, expect);
+
+    printf("%-8s %-6s", "backend", "op");
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        char label[32];
+        snprintf(label, sizeof(label), "%zuKB", sizes[s] >> 10);
+        printf(" %12s", label);
+    }
+    printf("   (MB/s)\n");
+
+    for (int b = 0; b < HEX_BACKEND_COUNT; b++) {
+        const char *name = hex_backend_name((HexBackend)b);
+        if (hex_set_backend((HexBackend)b) < 0) {
+            printf("%-8s %s\n", name, "unsupported");
+            continue;
+        }
+
+        if (cross_check(hex, expect, out) < 0) {
+            printf("%-8s MISMATCH against scalar\n", name);
+            failed = 1;
+            continue;
+        }
+
+        printf("%-8s %-6s", name, "scan");
+        for (size_t s = 0; s < NUM_SIZES; s++) {
+            printf(" %12.0f", bench_scan(hex, sizes[s]));
+        }
+        printf("\n%-8s %-6s", name, "decode");
+        for (size_t s = 0; s < NUM_SIZES; s++) {
+            printf(" %12.0f", bench_decode(hex, sizes[s], out));
+        }
+        printf("\n");
+    }
+
+    free(hex);
+    free(out);
+    return failed;
+}
@@ -0,0 +1,353 @@
+/*
+ * HTTP request head parsing: per-header scans vs one-pass tokenizer.
+ *
+ * legacy - the previous parse_request_headers(): memmem() for the
+ *          request line, then a strncasecmp() scan of the whole block
+ *          per header (Content-Length, Connection, Accept,
+ *          Accept-Encoding, If-None-Match, If-Modified-Since).
+ * scalar/sse4.2/avx2 - http_parse_request() on each backend, then the
+ *          same fields read from the known-header slots.
+ *
+ * Neither copies the method or path (the server does that after both).
+ * Inputs: a curl /tx/{txid} lookup, a browser page load with cookies and
+ * validators, and a raw transaction broadcast (32KB of hex in the path).
+ * Reports requests/sec and MB/s per parser. Also checks every parser
+ * extracts the same fields.
+ *
+ * Usage: make bench  (or ./build/bench_http_parser)
+ */
+
+#include "http_parser.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#define TX_HEX_LEN      32768
+
+typedef struct {
+    char method[16];
+    const char *path;
+    size_t path_len;
+    size_t content_length;
+    bool keep_alive;
+    bool accept_json;
+    const char *accept_encoding;
+    size_t accept_encoding_len;
+    const char *if_none_match;
+    size_t if_none_match_len;
+    const char *if_modified_since;
+    size_t if_modified_since_len;
+} Fields;
+
+/* ========== Parsers ========== */
+
+static const unsigned char *legacy_find_header_value(const unsigned char *headers, size_t len,
+                                                     const char *name, size_t name_len,
+                                                     size_t *value_len)
+{
+    const unsigned char *headers_end = headers + len;
+
+    for (size_t i = 1; i + name_len < len; i++) {
+        if (headers[i - 1] == '\n' &&
+            strncasecmp((const char *)headers + i, name, name_len) == 0) {
+            const unsigned char *value = headers + i + name_len;
+            const unsigned char *eol = memmem(value, headers_end - value, "\r\n", 2);
+            *value_len = eol ? (size_t)(eol - value) : (size_t)(headers_end - value);
+            return value;
+        }
+    }
+    return NULL;
+}
+
+/* Leading whitespace trimmed, as the tokenizer does */
+static const unsigned char *legacy_header(const unsigned char *headers, size_t len,
+                                          const char *name, size_t name_len,
+                                          size_t *value_len)
+{
+    const unsigned char *v = legacy_find_header_value(headers, len, name, name_len, value_len);
+    while (v && *value_len > 0 && (*v == ' ' || *v == '\t')) {
+        v++;
+        (*value_len)--;
+    }
+    return v;
+}
+
+static int parse_legacy(const unsigned char *headers, size_t len, Fields *f)
+{
+    const unsigned char *headers_end = headers + len;
+    const unsigned char *line_end, *space1, *space2, *value;
+    size_t value_len;
+
+    memset(f, 0, sizeof(*f));
+    f->keep_alive = true;
+
+    /* Request line */
+    line_end = memmem(headers, len, "\r\n", 2);
+    if (!line_end) return -1;
+    space1 = memchr(headers, ' ', line_end - headers);
+    if (!space1 || (size_t)(space1 - headers) >= sizeof(f->method)) return -1;
+    memcpy(f->method, headers, space1 - headers);
+    space2 = memchr(space1 + 1, ' ', line_end - space1 - 1);
+    f->path = (const char *)space1 + 1;
+    f->path_len = (space2 ? space2 : line_end) - (space1 + 1);
+
+    /* Content-Length */
+    const unsigned char *found = NULL;
+    for (size_t i = 0; i + 15 < len; i++) {
+        if ((headers[i] == 'C' || headers[i] == 'c') &&
+            strncasecmp((const char *)headers + i, "Content-Length:", 15) == 0) {
+            found = headers + i + 15;
+            break;
+        }
+    }
+    if (found) {
+        while (found < headers_end && (*found == ' ' || *found == '\t')) found++;
+        if (found < headers_end && *found != '-' && *found != '+') {
+            char *endptr = NULL;
+            errno = 0;
+            unsigned long val = strtoul((const char *)found, &endptr, 10);
+            if (errno != ERANGE && endptr != (const char *)found) {
+                f->content_length = (size_t)val;
+            }
+        }
+    }
+
+    /* Connection */
+    const unsigned char *conn_found = NULL;
+    for (size_t i = 0; i + 11 < len; i++) {
+        if ((headers[i] == 'C' || headers[i] == 'c') &&
+            strncasecmp((const char *)headers + i, "Connection:", 11) == 0) {
+            conn_found = headers + i + 11;
+            break;
+        }
+    }
+    if (conn_found) {
+        while (conn_found < headers_end && (*conn_found == ' ' || *conn_found == '\t')) {
+            conn_found++;
+        }
+        if (conn_found + 5 <= headers_end &&
+            strncasecmp((const char *)conn_found, "close", 5) == 0) {
+            f->keep_alive = false;
+        }
+    }
+
+    /* Accept */
+    for (size_t i = 1; i + 7 < len; i++) {
+        if (headers[i - 1] == '\n' &&
+            strncasecmp((const char *)headers + i, "Accept:", 7) == 0) {
+            const unsigned char *v = headers + i + 7;
+            const unsigned char *eol = memmem(v, headers_end - v, "\r\n", 2);
+            size_t vlen = eol ? (size_t)(eol - v) : (size_t)(headers_end - v);
+            f->accept_json = memmem(v, vlen, "application/json", 16) != NULL;
+            break;
+        }
+    }
+
+    value = legacy_header(headers, len, "Accept-Encoding:", 16, &value_len);
+    f->accept_encoding = (const char *)value;
+    f->accept_encoding_len = value ? value_len : 0;
+    value = legacy_header(headers, len, "If-None-Match:", 14, &value_len);
+    f->if_none_match = (const char *)value;
+    f->if_none_match_len = value ? value_len : 0;
+    value = legacy_header(headers, len, "If-Modified-Since:", 18, &value_len);
+    f->if_modified_since = (const char *)value;
+    f->if_modified_since_len = value ? value_len : 0;
+    return 0;
+}
+
+static int parse_tokenized(const unsigned char *headers, size_t len, Fields *f)
+{
+    HttpRequest req;
+    const HttpHeader *h;
+
+    memset(f, 0, sizeof(*f));
+    f->keep_alive = true;
+    if (http_parse_request((const char *)headers, len, &req) < 0 ||
+        req.method_len >= sizeof(f->method)) {
+        return -1;
+    }
+    memcpy(f->method, req.method, req.method_len);
+    f->path = req.target;
+    f->path_len = req.target_len;
+
+    h = http_request_header(&req, HTTP_HEADER_CONTENT_LENGTH);
+    if (h && http_parse_content_length(h->value, h->value_len, &f->content_length) < 0) {
+        return -1;
+    }
+    h = http_request_header(&req, HTTP_HEADER_CONNECTION);
+    if (h && http_header_has_token(h->value, h->value_len, "close")) {
+        f->keep_alive = false;
+    }
+    h = http_request_header(&req, HTTP_HEADER_ACCEPT);
+    f->accept_json = h && memmem(h->value, h->value_len, "application/json", 16);
+    if ((h = http_request_header(&req, HTTP_HEADER_ACCEPT_ENCODING))) {
+        f->accept_encoding = h->value;
+        f->accept_encoding_len = h->value_len;
+    }
+    if ((h = http_request_header(&req, HTTP_HEADER_IF_NONE_MATCH))) {
+        f->if_none_match = h->value;
+        f->if_none_match_len = h->value_len;
+    }
+    if ((h = http_request_header(&req, HTTP_HEADER_IF_MODIFIED_SINCE))) {
+        f->if_modified_since = h->value;
+        f->if_modified_since_len = h->value_len;
+    }
+    return 0;
+}
+
+static bool span_eq(const char *a, size_t alen, const char *b, size_t blen)
+{
+    return alen == blen && (alen == 0 || memcmp(a, b, alen) == 0);
+}
+
+static bool fields_eq(const Fields *a, const Fields *b)
+{
+    return strcmp(a->method, b->method) == 0 &&
+           span_eq(a->path, a->path_len, b->path, b->path_len) &&
+           a->content_length == b->content_length &&
+           a->keep_alive == b->keep_alive &&
+           a->accept_json == b->accept_json &&
+           span_eq(a->accept_encoding, a->accept_encoding_len,
+                   b->accept_encoding, b->accept_encoding_len) &&
+           span_eq(a->if_none_match, a->if_none_match_len,
+                   b->if_none_match, b->if_none_match_len) &&
+           span_eq(a->if_modified_since, a->if_modified_since_len,
+                   b->if_modified_since, b->if_modified_since_len);
+}
+
+/* ========== Inputs ========== */
+
+static const char curl_request[] =
+    "GET /tx/4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b HTTP/1.1\r\n"
+    "Host: relay.example.com\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: application/json\r\n"
+    "\r\n";
+
+static const char browser_request[] =
+    "GET /docs HTTP/1.1\r\n"
+    "Host: relay.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"128\", \"Not;A=Brand\";v=\"24\", \"Google Chrome\";v=\"128\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/128.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,"
+    "image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Referer: https://relay.example.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9,de;q=0.8\r\n"
+    "Cookie: _ga=GA1.1.1234567890.1700000000; _ga_ABCDEF1234=GS1.1.1700000000.5.1."
+    "1700000500.0.0.0; theme=dark; session=5f2b8c9d0e1f2a3b4c5d6e7f8091a2b3c4d5e6f7\r\n"
+    "If-None-Match: \"ce347c4ad48e465a-br\"\r\n"
+    "If-Modified-Since: Fri, 16 Oct 2026 09:06:04 GMT\r\n"
+    "\r\n";
+
+static char *make_broadcast(size_t *len)
+{
+    static const char tail[] =
+        " HTTP/1.1\r\n"
+        "Host: relay.example.com\r\n"
+        "User-Agent: rawrelay-batch/1.0\r\n"
+        "Accept: application/json\r\n"
+        "\r\n";
+    char *buf = malloc(5 + TX_HEX_LEN + sizeof(tail));
+    size_t n = 0;
+
+    if (!buf) return NULL;
+    memcpy(buf, "GET /", 5);
+    n = 5;
+    for (size_t i = 0; i < TX_HEX_LEN; i++) {
+        buf[n++] = "0123456789abcdef"[(i * 7 + (i >> 5)) & 15];
+    }
+    memcpy(buf + n, tail, sizeof(tail) - 1);
+    *len = n + sizeof(tail) - 1;
+    return buf;
+}
+
+/* ========== Measurement ========== */
+
+static volatile size_t sink;
+
+static double bench(int legacy, const unsigned char *buf, size_t len)
+{
+    uint64_t requests = 0;
+    double start = now_sec(), elapsed;
+    Fields f;
+
+    do {
+        for (int i = 0; i < 64; i++) {
+            int rc = legacy ? parse_legacy(buf, len, &f) : parse_tokenized(buf, len, &f);
+            sink += (size_t)rc + f.path_len + f.keep_alive;
+        }
+        requests += 64;
+        elapsed = now_sec() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    return requests / elapsed;
+}
+
+int main(void)
+{
+    size_t broadcast_len = 0;
+    char *broadcast = make_broadcast(&broadcast_len);
+    struct {
+        const char *name;
+        const char *buf;
+        size_t len;
+    } inputs[] = {
+        { "curl", curl_request, sizeof(curl_request) - 1 },
+        { "browser", browser_request, sizeof(browser_request) - 1 },
+        { "broadcast", NULL, 0 },
+    };
+
+    if (!broadcast) return 1;
+    inputs[2].buf = broadcast;
+    inputs[2].len = broadcast_len;
+
+    printf("%-10s %8s %-8s %14s %10s\n", "request", "bytes", "parser", "requests/s", "MB/s");
+    for (size_t n = 0; n < sizeof(inputs) / sizeof(inputs[0]); n++) {
+        const unsigned char *buf = (const unsigned char *)inputs[n].buf;
+        size_t len = inputs[n].len;
+        Fields expect, got;
+        double rps;
+
+        if (parse_legacy(buf, len, &expect) < 0) {
+            printf("%-10s legacy parser failed\n", inputs[n].name);
+            return 1;
+        }
+        rps = bench(1, buf, len);
+        printf("%-10s %8zu %-8s %14.0f %10.1f\n", inputs[n].name, len, "legacy",
+               rps, rps * len / 1e6);
+
+        for (int b = 0; b < HTTP_PARSER_BACKEND_COUNT; b++) {
+            const char *name = http_parser_backend_name((HttpParserBackend)b);
+            if (http_parser_set_backend((HttpParserBackend)b) < 0) {
+                printf("%-10s %8zu %-8s %14s\n", inputs[n].name, len, name, "unsupported");
+                continue;
+            }
+            if (parse_tokenized(buf, len, &got) < 0 || !fields_eq(&expect, &got)) {
+                printf("%-10s MISMATCH: %s tokenizer differs from legacy parser\n",
+                       inputs[n].name, name);
+                return 1;
+            }
+            rps = bench(0, buf, len);
+            printf("%-10s %8zu %-8s %14.0f %10.1f\n", inputs[n].name, len, name,
+                   rps, rps * len / 1e6);
+        }
+    }
+
+    free(broadcast);
+    return 0;
+}
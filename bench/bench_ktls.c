@@ -0,0 +1,271 @@
+/*
+ * Sender CPU per GB: plaintext write() vs userspace TLS vs kernel TLS.
+ *
+ * plain - write() of the page bytes, the floor for any TLS path.
+ * tls   - SSL_write() with OpenSSL encrypting records in userspace (the
+ *         default; what bufferevent_openssl does for every static page).
+ * ktls  - SSL_write() with SSL_OP_ENABLE_KTLS: after the handshake the
+ *         kernel encrypts, and OpenSSL hands it plaintext records.
+ *
+ * A forked client reads and decrypts everything over loopback TCP; only
+ * the sending process's CPU (user + system, so in-kernel encryption is
+ * counted) is reported, as CPU seconds per GB sent and throughput. The
+ * cipher is pinned to TLS 1.3 AES-128-GCM, which kTLS supports on every
+ * kernel that has it. Without an OpenSSL built with kTLS or the kernel
+ * tls module the ktls row says why and is skipped.
+ *
+ * Usage: make bench  (or ./build/bench_ktls [MB per mode])
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#define DEFAULT_MB      256
+#define WRITE_CHUNK     (64 * 1024)     /* SSL_write size; OpenSSL splits into 16KB records */
+#define PAGE_BYTES      (1024 * 1024)   /* The "static page" cycled through */
+
+typedef enum { MODE_PLAIN, MODE_TLS, MODE_KTLS } Mode;
+static const char *mode_names[] = { "plain", "tls", "ktls" };
+
+static unsigned char page[PAGE_BYTES];
+
+/* ========== Self-signed P-256 certificate ========== */
+
+static int make_cert(SSL_CTX *ctx)
+{
+    EVP_PKEY *pkey = EVP_EC_gen("P-256");
+    X509 *x509 = X509_new();
+    int ok = 0;
+
+    if (pkey && x509) {
+        X509_set_version(x509, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+        X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+        X509_gmtime_adj(X509_getm_notAfter(x509), 86400);
+        X509_set_pubkey(x509, pkey);
+        X509_NAME_add_entry_by_txt(X509_get_subject_name(x509), "CN", MBSTRING_ASC,
+                                   (const unsigned char *)"localhost", -1, -1, 0);
+        X509_set_issuer_name(x509, X509_get_subject_name(x509));
+        ok = X509_sign(x509, pkey, EVP_sha256()) > 0 &&
+             SSL_CTX_use_certificate(ctx, x509) == 1 &&
+             SSL_CTX_use_PrivateKey(ctx, pkey) == 1;
+    }
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    return ok ? 0 : -1;
+}
+
+static SSL_CTX *make_ctx(int server, int ktls)
+{
+    SSL_CTX *ctx = SSL_CTX_new(server ? TLS_server_method() : TLS_client_method());
+    if (!ctx) {
+        return NULL;
+    }
+    SSL_CTX_set_min_proto_version(ctx, TLS1_3_VERSION);
+    SSL_CTX_set_ciphersuites(ctx, "TLS_AES_128_GCM_SHA256");
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    if (ktls) {
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+    }
+#else
+    (void)ktls;
+#endif
+    if (server && make_cert(ctx) < 0) {
+        SSL_CTX_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/* ========== Client: read and decrypt everything ========== */
+
+static void run_client(int port, Mode mode, size_t total)
+{
+    static unsigned char buf[256 * 1024];
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    size_t got = 0;
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        _exit(1);
+    }
+
+    if (mode == MODE_PLAIN) {
+        ssize_t n;
+        while (got < total && (n = read(fd, buf, sizeof(buf))) > 0) {
+            got += n;
+        }
+        _exit(got == total ? 0 : 1);
+    }
+
+    SSL_CTX *ctx = make_ctx(0, 0);
+    SSL *ssl = ctx ? SSL_new(ctx) : NULL;
+    if (!ssl || SSL_set_fd(ssl, fd) != 1 || SSL_connect(ssl) != 1) {
+        _exit(1);
+    }
+    int n;
+    while (got < total && (n = SSL_read(ssl, buf, sizeof(buf))) > 0) {
+        got += n;
+    }
+    _exit(got == total ? 0 : 1);
+}
+
+/* ========== Sender ========== */
+
+static double cpu_sec(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+/*
+ * Returns 0 when measured, 1 when the mode is unavailable (reason in
+ * *skip), -1 on error.
+ */
+static int run(Mode mode, size_t total, double *cpu_per_gb, double *gb_per_sec,
+               const char **skip)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    socklen_t addrlen = sizeof(addr);
+    SSL_CTX *ctx = NULL;
+    SSL *ssl = NULL;
+    int lfd, fd = -1, status, ret = -1;
+    pid_t pid;
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(lfd, 1) < 0 || getsockname(lfd, (struct sockaddr *)&addr, &addrlen) < 0) {
+        return -1;
+    }
+
+    if (mode != MODE_PLAIN && !(ctx = make_ctx(1, mode == MODE_KTLS))) {
+        close(lfd);
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        goto out;
+    }
+    if (pid == 0) {
+        close(lfd);
+        run_client(ntohs(addr.sin_port), mode, total);
+    }
+
+    fd = accept(lfd, NULL, NULL);
+    if (fd < 0) {
+        goto out;
+    }
+    if (ctx) {
+        ssl = SSL_new(ctx);
+        if (!ssl || SSL_set_fd(ssl, fd) != 1 || SSL_accept(ssl) != 1) {
+            goto out;
+        }
+    }
+    if (mode == MODE_KTLS) {
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+        if (!BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+            *skip = "not offloaded (no tls kernel module?)";
+            ret = 1;
+            goto out;
+        }
+#else
+        *skip = "OpenSSL built without kTLS";
+        ret = 1;
+        goto out;
+#endif
+    }
+
+    double start = now_sec(), cpu_start = cpu_sec();
+    size_t sent = 0;
+    while (sent < total) {
+        size_t off = sent % PAGE_BYTES;
+        size_t len = WRITE_CHUNK;
+        if (len > PAGE_BYTES - off) len = PAGE_BYTES - off;
+        if (len > total - sent) len = total - sent;
+
+        int n = ssl ? SSL_write(ssl, page + off, (int)len)
+                    : (int)write(fd, page + off, len);
+        if (n <= 0) {
+            goto out;
+        }
+        sent += n;
+    }
+    double cpu = cpu_sec() - cpu_start;
+    double elapsed = now_sec() - start;
+
+    *cpu_per_gb = cpu / (total / 1e9);
+    *gb_per_sec = total / 1e9 / elapsed;
+    ret = 0;
+
+out:
+    if (ssl) {
+        SSL_free(ssl);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    SSL_CTX_free(ctx);
+    close(lfd);
+    if (pid > 0) {
+        if (ret != 0) {
+            kill(pid, SIGKILL);
+        }
+        if (waitpid(pid, &status, 0) == pid && ret == 0 &&
+            !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+            ret = -1;   /* Client did not receive every byte */
+        }
+    }
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MB;
+    size_t total = (mb ? mb : DEFAULT_MB) << 20;
+
+    signal(SIGPIPE, SIG_IGN);
+    for (size_t i = 0; i < sizeof(page); i++) {
+        page[i] = (unsigned char)(i * 131 + (i >> 9));
+    }
+
+    printf("%zu MB per mode, TLS 1.3 AES-128-GCM, %d KB writes\n", total >> 20,
+           WRITE_CHUNK / 1024);
+    printf("%-6s %16s %10s\n", "mode", "CPU sec per GB", "GB/s");
+    for (Mode m = MODE_PLAIN; m <= MODE_KTLS; m++) {
+        double cpu_per_gb = 0, gb_per_sec = 0;
+        const char *skip = NULL;
+        int r = run(m, total, &cpu_per_gb, &gb_per_sec, &skip);
+        if (r < 0) {
+            printf("%-6s failed\n", mode_names[m]);
+            ERR_print_errors_fp(stdout);
+            return 1;
+        }
+        if (r > 0) {
+            printf("%-6s %16s    (%s)\n", mode_names[m], "-", skip);
+            continue;
+        }
+        printf("%-6s %16.3f %10.2f\n", mode_names[m], cpu_per_gb, gb_per_sec);
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Per-request object allocation: calloc/strndup vs slab pools and arena.
+ *
+ * connection - the Connection object: calloc()/free() against
+ *              slab_alloc()/slab_free() on a Connection pool.
+ * h2_stream  - an HTTP/2 stream with its :method, :authority and :scheme
+ *              strings: calloc() plus three strndup()s against a slab
+ *              object whose strings go in its embedded arena.
+ *
+ * Each op frees a random object from a live set and allocates its
+ * replacement, touching it as the server would, so the allocator sees
+ * the interleaved lifetimes of concurrent connections rather than LIFO
+ * reuse. Reports ops/sec at live sets of 64 and 4096 objects.
+ *
+ * Usage: make bench  (or ./build/bench_pool)
+ */
+
+#include "connection.h"
+#include "http2.h"
+#include "buffer.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LIVE        4096
+
+static const char method[] = "GET";
+static const char authority[] = "relay.example.com";
+static const char scheme[] = "https";
+
+/* ========== Allocation paths ========== */
+
+static void *conn_malloc(SlabPool *pool)
+{
+    (void)pool;
+    Connection *conn = calloc(1, sizeof(Connection));
+    if (conn) {
+        conn->keep_alive = true;
+        conn->content_length = 0;
+    }
+    return conn;
+}
+
+static void conn_malloc_free(SlabPool *pool, void *obj)
+{
+    (void)pool;
+    free(obj);
+}
+
+static void *conn_slab(SlabPool *pool)
+{
+    Connection *conn = slab_alloc(pool);
+    if (conn) {
+        conn->keep_alive = true;
+        conn->content_length = 0;
+    }
+    return conn;
+}
+
+static void conn_slab_free(SlabPool *pool, void *obj)
+{
+    slab_free(pool, obj);
+}
+
+static void *stream_malloc(SlabPool *pool)
+{
+    (void)pool;
+    H2Stream *stream = calloc(1, sizeof(H2Stream));
+    if (stream) {
+        stream->method = strndup(method, sizeof(method) - 1);
+        stream->authority = strndup(authority, sizeof(authority) - 1);
+        stream->scheme = strndup(scheme, sizeof(scheme) - 1);
+    }
+    return stream;
+}
+
+static void stream_malloc_free(SlabPool *pool, void *obj)
+{
+    H2Stream *stream = obj;
+    (void)pool;
+    free(stream->method);
+    free(stream->authority);
+    free(stream->scheme);
+    free(stream);
+}
+
+static void *stream_slab(SlabPool *pool)
+{
+    H2Stream *stream = slab_alloc(pool);
+    if (stream) {
+        Arena *arena = &stream->header_arena;
+        arena_init(arena, stream->header_space, sizeof(stream->header_space));
+        stream->method = arena_strndup(arena, method, sizeof(method) - 1);
+        stream->authority = arena_strndup(arena, authority, sizeof(authority) - 1);
+        stream->scheme = arena_strndup(arena, scheme, sizeof(scheme) - 1);
+    }
+    return stream;
+}
+
+static void stream_slab_free(SlabPool *pool, void *obj)
+{
+    H2Stream *stream = obj;
+    arena_reset(&stream->header_arena);
+    slab_free(pool, stream);
+}
+
+typedef struct {
+    const char *name;
+    size_t size;
+    void *(*alloc[2])(SlabPool *pool);
+    void (*release[2])(SlabPool *pool, void *obj);
+} Workload;
+
+/* ========== Measurement ========== */
+
+static uint32_t rng_state = 0x9e3779b9;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double run(const Workload *w, int pooled, size_t live)
+{
+    static void *objs[MAX_LIVE];
+    SlabPool pool;
+    uint64_t ops = 0;
+    double start, elapsed;
+
+    if (slab_pool_init(&pool, w->name, w->size) < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < live; i++) {
+        if (!(objs[i] = w->alloc[pooled](&pool))) return -1;
+    }
+
+    start = now_sec();
+    do {
+        for (int i = 0; i < 256; i++) {
+            size_t victim = rng_next() % live;
+            w->release[pooled](&pool, objs[victim]);
+            if (!(objs[victim] = w->alloc[pooled](&pool))) return -1;
+        }
+        ops += 256;
+        elapsed = now_sec() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    for (size_t i = 0; i < live; i++) {
+        w->release[pooled](&pool, objs[i]);
+    }
+    slab_pool_destroy(&pool);
+    return ops / elapsed;
+}
+
+int main(void)
+{
+    const Workload workloads[] = {
+        { "connection", sizeof(Connection),
+          { conn_malloc, conn_slab }, { conn_malloc_free, conn_slab_free } },
+        { "h2_stream", sizeof(H2Stream),
+          { stream_malloc, stream_slab }, { stream_malloc_free, stream_slab_free } },
+    };
+    const size_t live_sets[] = { 64, MAX_LIVE };
+
+    printf("%-11s %7s %6s %14s %14s %8s\n",
+           "object", "bytes", "live", "malloc ops/s", "slab ops/s", "speedup");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        for (size_t l = 0; l < sizeof(live_sets) / sizeof(live_sets[0]); l++) {
+            double base = run(&workloads[w], 0, live_sets[l]);
+            double slab = run(&workloads[w], 1, live_sets[l]);
+            if (base < 0 || slab < 0) {
+                printf("%-11s allocation failed\n", workloads[w].name);
+                return 1;
+            }
+            printf("%-11s %7zu %6zu %14.0f %14.0f %7.2fx\n", workloads[w].name,
+                   workloads[w].size, live_sets[l], base, slab, slab / base);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Request routing: strncmp chain + linear asset scan vs hashed table.
+ *
+ * legacy - the previous route_request(): a strncmp() per fixed endpoint,
+ *          extended with a linear scan over the asset URLs, the way a
+ *          fixed-field router grows as pages are added.
+ * table  - route_request() on a RouteTable holding the fixed endpoints
+ *          and every asset: one hash and one compare.
+ *
+ * Paths are a mix of asset hits, fixed endpoints, txids, raw tx hex and
+ * misses. Reports lookups/sec at 8, 64, 512 and 1024 assets and whether
+ * the table built as a perfect hash. Also checks both agree on every path.
+ *
+ * Usage: make bench  (or ./build/bench_router)
+ */
+
+#include "router.h"
+#include "hex.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ASSETS      1024
+#define NUM_PATHS       4096
+#define PATH_MAX_LEN    256
+
+static const size_t asset_counts[] = { 8, 64, 512, 1024 };
+#define NUM_COUNTS (sizeof(asset_counts) / sizeof(asset_counts[0]))
+
+static char asset_urls[MAX_ASSETS][48];
+static size_t asset_lens[MAX_ASSETS];
+
+static char paths[NUM_PATHS][PATH_MAX_LEN];
+static size_t path_lens[NUM_PATHS];
+
+/* ========== Routers ========== */
+
+/* Returns the asset index + 1 in *asset for ROUTE_STATIC */
+static RouteType route_legacy(const char *path, size_t path_len, size_t nassets,
+                              size_t *asset)
+{
+    *asset = 0;
+    if (path_len == 0 || path[0] != '/') {
+        return ROUTE_ERROR;
+    }
+
+    const char *content = path + 1;
+    size_t content_len = path_len - 1;
+
+    if (content_len == 6 && strncmp(content, "health", 6) == 0) return ROUTE_HEALTH;
+    if (content_len == 5 && strncmp(content, "ready", 5) == 0) return ROUTE_READY;
+    if (content_len == 7 && strncmp(content, "version", 7) == 0) return ROUTE_VERSION;
+    if (content_len == 5 && strncmp(content, "alive", 5) == 0) return ROUTE_ALIVE;
+    if (content_len == 7 && strncmp(content, "metrics", 7) == 0) return ROUTE_METRICS;
+
+    for (size_t i = 0; i < nassets; i++) {
+        if (asset_lens[i] == path_len && strncmp(asset_urls[i], path, path_len) == 0) {
+            *asset = i + 1;
+            return ROUTE_STATIC;
+        }
+    }
+
+    if (content_len > 27 && strncmp(content, ".well-known/acme-challenge/", 27) == 0) {
+        return ROUTE_ACME_CHALLENGE;
+    }
+    if (content_len > 3 && strncmp(content, "tx/", 3) == 0) {
+        return content_len - 3 == 64 && is_all_hex(content + 3, 64) ? ROUTE_RESULT
+                                                                    : ROUTE_ERROR;
+    }
+    if (content_len == 0 || !is_all_hex(content, content_len) || content_len % 2 != 0) {
+        return ROUTE_ERROR;
+    }
+    if (content_len == 64) return ROUTE_RESULT;
+    if (content_len >= 164) return ROUTE_BROADCAST;
+    return ROUTE_ERROR;
+}
+
+/* Same convention: the asset index + 1, 0 if not an asset */
+static size_t route_table(const RouteTable *table, const char *path, size_t path_len,
+                          RouteType *route)
+{
+    const void *data;
+    *route = route_request(table, path, path_len, &data);
+    return data ? (size_t)((const char (*)[48])data - asset_urls) + 1 : 0;
+}
+
+/* ========== Inputs ========== */
+
+static void make_assets(void)
+{
+    static const char *const dirs[] = { "", "js/", "css/", "img/", "fonts/" };
+    static const char *const exts[] = { ".js", ".css", ".png", ".svg", ".woff2", "" };
+
+    for (size_t i = 0; i < MAX_ASSETS; i++) {
+        int n = snprintf(asset_urls[i], sizeof(asset_urls[i]), "/%sasset-%04zu%s",
+                         dirs[i % 5], i, exts[i % 6]);
+        asset_lens[i] = (size_t)n;
+    }
+    /* The pages the old router knew by name */
+    strcpy(asset_urls[0], "/");
+    strcpy(asset_urls[1], "/docs");
+    strcpy(asset_urls[2], "/status");
+    strcpy(asset_urls[3], "/logos");
+    for (size_t i = 0; i < 4; i++) {
+        asset_lens[i] = strlen(asset_urls[i]);
+    }
+}
+
+/* Half asset hits, the rest endpoints, txids, raw tx and misses */
+static void make_paths(size_t nassets)
+{
+    static const char *const fixed[] = { "/health", "/metrics", "/ready", "/nope.js",
+                                         "/.well-known/acme-challenge/tok" };
+    unsigned seed = 12345;
+
+    for (size_t i = 0; i < NUM_PATHS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned pick = (seed >> 16) % 10;
+        char *p = paths[i];
+
+        if (pick < 5) {
+            size_t a = (seed >> 8) % nassets;
+            memcpy(p, asset_urls[a], asset_lens[a] + 1);
+        } else if (pick < 7) {
+            strcpy(p, fixed[(seed >> 8) % 5]);
+        } else {
+            size_t hex_len = pick == 7 ? 64 : pick == 8 ? 200 : 63;
+            p[0] = '/';
+            for (size_t j = 0; j < hex_len; j++) {
+                p[1 + j] = "0123456789abcdef"[(seed >> (j % 24)) & 15];
+            }
+            p[1 + hex_len] = '\0';
+        }
+        path_lens[i] = strlen(p);
+    }
+}
+
+/* ========== Measurement ========== */
+
+static size_t sink;
+
+static double bench(const RouteTable *table, size_t nassets)
+{
+    uint64_t lookups = 0;
+    double start = now_sec(), elapsed;
+
+    do {
+        for (size_t i = 0; i < NUM_PATHS; i++) {
+            size_t asset;
+            RouteType route;
+            if (table) {
+                asset = route_table(table, paths[i], path_lens[i], &route);
+            } else {
+                route = route_legacy(paths[i], path_lens[i], nassets, &asset);
+            }
+            sink += route + asset;
+        }
+        lookups += NUM_PATHS;
+        elapsed = now_sec() - start;
+    } while (elapsed < BENCH_SECONDS);
+
+    return lookups / elapsed;
+}
+
+int main(void)
+{
+    make_assets();
+
+    printf("%-7s %-7s %14s %8s\n", "assets", "router", "lookups/s", "hash");
+    for (size_t c = 0; c < NUM_COUNTS; c++) {
+        size_t nassets = asset_counts[c];
+        RouteTable table;
+
+        if (route_table_init(&table) < 0) return 1;
+        for (size_t i = 0; i < nassets; i++) {
+            if (route_table_add(&table, asset_urls[i], asset_lens[i], ROUTE_STATIC,
+                                asset_urls[i]) != 0) {
+                return 1;
+            }
+        }
+        if (route_table_build(&table) < 0) return 1;
+        make_paths(nassets);
+
+        for (size_t i = 0; i < NUM_PATHS; i++) {
+            size_t a, b;
+            RouteType ra = route_legacy(paths[i], path_lens[i], nassets, &a), rb;
+            b = route_table(&table, paths[i], path_lens[i], &rb);
+            if (ra != rb || a != b) {
+                printf("MISMATCH on %s: legacy %d, table %d\n", paths[i], ra, rb);
+                return 1;
+            }
+        }
+
+        printf("%-7zu %-7s %14.0f %8s\n", nassets, "legacy", bench(NULL, nassets), "-");
+        printf("%-7zu %-7s %14.0f %8s\n", nassets, "table", bench(&table, nassets),
+               table.max_probe == 0 ? "perfect" : "probed");
+        route_table_free(&table);
+    }
+
+    if (sink == 42) printf("\n");
+    return 0;
+}
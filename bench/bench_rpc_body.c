@@ -0,0 +1,277 @@
+/*
+ * sendrawtransaction request assembly: copy path vs evbuffer chain.
+ *
+ * legacy - the previous construction: hex copied into a params string,
+ *          again into the JSON body, and a third time into the output
+ *          buffer after the headers.
+ * chain  - rpc_build_sendraw_body() + rpc_write_http_request(): headers
+ *          in one reserved segment, the hex added by reference.
+ *
+ * Each op builds the request for one endpoint, writes it to /dev/null
+ * (as the socket would) and frees it. Reports heap allocations and bytes
+ * allocated per op (malloc family interposed below) and p50/p99 latency
+ * at 1KB, 64KB, 1MB and 4MB of hex. Also checks both paths produce the
+ * same bytes.
+ *
+ * Usage: make bench  (or ./build/bench_rpc_body)
+ */
+
+#include "rpc.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <event2/buffer.h>
+
+#define MAX_OPS         200000
+#define MAX_SIZE        (4u << 20)
+
+static const size_t sizes[] = { 1u << 10, 64u << 10, 1u << 20, 4u << 20 };
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+/* ========== Allocation counting ========== */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static int counting;
+static uint64_t alloc_count;
+static uint64_t alloc_bytes;
+
+void *malloc(size_t size)
+{
+    if (counting) {
+        alloc_count++;
+        alloc_bytes += size;
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    if (counting) {
+        alloc_count++;
+        alloc_bytes += n * size;
+    }
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (counting) {
+        alloc_count++;
+        alloc_bytes += size;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+/* ========== Request paths ========== */
+
+static uint64_t legacy_id;
+
+static int build_legacy(struct evbuffer *output, const RPCClient *client, const char *hex)
+{
+    size_t params_len = strlen(hex) + 8;
+    char *params = malloc(params_len);
+    if (!params) return -1;
+    snprintf(params, params_len, "[\"%s\"]", hex);
+
+    size_t buf_size = strlen(params) + strlen("sendrawtransaction") + 128;
+    char *body = malloc(buf_size);
+    if (!body) {
+        free(params);
+        return -1;
+    }
+    snprintf(body, buf_size,
+        "{\"jsonrpc\":\"1.0\",\"id\":%lu,\"method\":\"%s\",\"params\":%s}",
+        (unsigned long)(++legacy_id), "sendrawtransaction", params);
+    free(params);
+
+    size_t body_len = strlen(body);
+    evbuffer_add_printf(output,
+        "POST %s%s HTTP/1.1\r\n"
+        "Host: %s:%d\r\n"
+        "Authorization: %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+        "/", client->wallet, client->host, client->port,
+        client->auth_header, body_len);
+    evbuffer_add(output, body, body_len);
+    free(body);
+    return 0;
+}
+
+/* Returns the body; the caller frees it once output has been written */
+static struct evbuffer *build_chain(struct evbuffer *output, const RPCClient *client,
+                                    const char *hex, size_t len)
+{
+    RPCPayload *payload = rpc_payload_wrap(NULL, hex, len);
+    if (!payload) return NULL;
+
+    struct evbuffer *body = rpc_build_sendraw_body(payload);
+    rpc_payload_unref(payload);
+    if (!body) return NULL;
+
+    if (rpc_write_http_request(output, client, body) < 0) {
+        evbuffer_free(body);
+        return NULL;
+    }
+    return body;
+}
+
+/* ========== Measurement ========== */
+
+static int flush_output(struct evbuffer *output, int fd)
+{
+    while (evbuffer_get_length(output) > 0) {
+        if (evbuffer_write(output, fd) < 0) return -1;
+    }
+    return 0;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    double allocs;
+    double kbytes;
+    double p50;
+    double p99;
+} Result;
+
+static int run(int chain, const RPCClient *client, const char *hex, size_t len,
+               int fd, double *samples, Result *r)
+{
+    struct evbuffer *output = evbuffer_new();
+    double start = now_usec();
+    size_t ops = 0;
+
+    if (!output) return -1;
+
+    alloc_count = 0;
+    alloc_bytes = 0;
+    while (ops < MAX_OPS && (ops < MIN_OPS || now_usec() - start < BENCH_SECONDS * 1e6)) {
+        struct evbuffer *body = NULL;
+        double t0 = now_usec();
+
+        counting = 1;
+        if (chain) {
+            body = build_chain(output, client, hex, len);
+        } else if (build_legacy(output, client, hex) < 0) {
+            counting = 0;
+            evbuffer_free(output);
+            return -1;
+        }
+        int rc = flush_output(output, fd);
+        if (body) {
+            evbuffer_free(body);
+        }
+        counting = 0;
+
+        if (rc < 0 || (chain && !body)) {
+            evbuffer_free(output);
+            return -1;
+        }
+        samples[ops++] = now_usec() - t0;
+    }
+
+    qsort(samples, ops, sizeof(double), cmp_double);
+    r->allocs = (double)alloc_count / ops;
+    r->kbytes = (double)alloc_bytes / ops / 1024;
+    r->p50 = samples[ops / 2];
+    r->p99 = samples[(ops * 99) / 100];
+    evbuffer_free(output);
+    return 0;
+}
+
+/* Both paths must put identical bytes on the wire */
+static int cross_check(const RPCClient *client, const char *hex, size_t len)
+{
+    struct evbuffer *a = evbuffer_new();
+    struct evbuffer *b = evbuffer_new();
+    struct evbuffer *body = NULL;
+    int ok = 0;
+
+    if (a && b && build_legacy(a, client, hex) == 0 &&
+        (body = build_chain(b, client, hex, len)) != NULL) {
+        size_t la = evbuffer_get_length(a);
+        ok = la == evbuffer_get_length(b) &&
+             memcmp(evbuffer_pullup(a, -1), evbuffer_pullup(b, -1), la) == 0;
+    }
+
+    if (body) evbuffer_free(body);
+    if (a) evbuffer_free(a);
+    if (b) evbuffer_free(b);
+    return ok ? 0 : -1;
+}
+
+int main(void)
+{
+    static const char digits[] = "0123456789abcdef";
+    char *hex = malloc(MAX_SIZE + 1);
+    double *samples = malloc(MAX_OPS * sizeof(double));
+    int fd = open("/dev/null", O_WRONLY);
+    RPCClient client;
+
+    if (!hex || !samples || fd < 0) {
+        return 1;
+    }
+    for (size_t i = 0; i < MAX_SIZE; i++) {
+        hex[i] = digits[i * 7 % 16];
+    }
+
+    memset(&client, 0, sizeof(client));
+    snprintf(client.host, sizeof(client.host), "127.0.0.1");
+    client.port = 8332;
+    snprintf(client.auth_header, sizeof(client.auth_header), "Basic cnBjdXNlcjpycGNwYXNzd29yZA==");
+
+    /* Both request id counters start at 1 here */
+    hex[256] = '\0';
+    if (cross_check(&client, hex, 256) < 0) {
+        printf("MISMATCH: chain request differs from legacy request\n");
+        return 1;
+    }
+    hex[256] = digits[256 * 7 % 16];
+
+    printf("%-6s %-7s %10s %12s %10s %10s\n",
+           "size", "path", "allocs/op", "alloc KB/op", "p50 us", "p99 us");
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        size_t len = sizes[s];
+        char saved = hex[len];
+        char label[32];
+
+        snprintf(label, sizeof(label), "%zuKB", len >> 10);
+        hex[len] = '\0';
+        for (int chain = 0; chain <= 1; chain++) {
+            Result r;
+            if (run(chain, &client, hex, len, fd, samples, &r) < 0) {
+                printf("%-6s %-7s failed\n", label, chain ? "chain" : "legacy");
+                return 1;
+            }
+            printf("%-6s %-7s %10.1f %12.1f %10.1f %10.1f\n", label,
+                   chain ? "chain" : "legacy", r.allocs, r.kbytes, r.p50, r.p99);
+        }
+        hex[len] = saved;
+    }
+
+    close(fd);
+    free(samples);
+    free(hex);
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Static page response assembly: printf + copy vs prebuilt headers.
+ *
+ * legacy   - the previous serve_static_file(): evbuffer_add_printf()
+ *            calls for the headers, then the body copied with evbuffer_add().
+ * prebuilt - static_file_write_response(): the file's prebuilt head and
+ *            body added by reference, only the request ID copied.
+ *
+ * Each op queues the keep-alive response for / and writes it to
+ * /dev/null, as the socket would. Reports requests/sec and p50/p99
+ * latency for the identity, gzip and br variants. Also checks both paths
+ * produce the same bytes.
+ *
+ * Usage: make bench  (or ./build/bench_static from the repository root)
+ */
+
+#include "static_files.h"
+#include "log.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <event2/buffer.h>
+
+#define MAX_OPS         2000000
+
+static const char request_id[] = "0123456789abcdef-00000001";
+
+/* ========== Response paths ========== */
+
+static int build_legacy(struct evbuffer *output, const StaticFile *file,
+                        StaticEncoding encoding, int cache_max_age)
+{
+    const char *body = file->content;
+    size_t body_len = file->length;
+
+    if (encoding != STATIC_ENCODING_IDENTITY) {
+        body = file->encoded[encoding];
+        body_len = file->encoded_length[encoding];
+    }
+
+    evbuffer_add_printf(output,
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %zu\r\n"
+        "Vary: Accept-Encoding\r\n",
+        file->status_code, file->status_text, file->content_type, body_len);
+    if (encoding != STATIC_ENCODING_IDENTITY) {
+        evbuffer_add_printf(output, "Content-Encoding: %s\r\n",
+                            static_encoding_name(encoding));
+    }
+    evbuffer_add_printf(output, "ETag: %s\r\nLast-Modified: %s\r\n",
+                        file->etag[encoding], file->last_modified_text);
+    if (cache_max_age > 0) {
+        evbuffer_add_printf(output, "Cache-Control: public, max-age=%d\r\n", cache_max_age);
+    } else {
+        evbuffer_add_printf(output, "Cache-Control: no-store\r\n");
+    }
+    evbuffer_add_printf(output, "Connection: keep-alive\r\n");
+    evbuffer_add_printf(output, "X-Request-ID: %s\r\n", request_id);
+    evbuffer_add_printf(output, "\r\n");
+    return evbuffer_add(output, body, body_len);
+}
+
+static int build_prebuilt(struct evbuffer *output, const StaticFile *file,
+                          StaticEncoding encoding)
+{
+    return static_file_write_response(output, file, encoding, true, false, request_id);
+}
+
+/* ========== Measurement ========== */
+
+static int flush_output(struct evbuffer *output, int fd)
+{
+    while (evbuffer_get_length(output) > 0) {
+        if (evbuffer_write(output, fd) < 0) return -1;
+    }
+    return 0;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    double rps;
+    double p50;
+    double p99;
+} Result;
+
+static int run(int prebuilt, const StaticFile *file, StaticEncoding encoding,
+               int cache_max_age, int fd, double *samples, Result *r)
+{
+    struct evbuffer *output = evbuffer_new();
+    double start = now_usec();
+    size_t ops = 0;
+
+    if (!output) return -1;
+
+    while (ops < MAX_OPS && (ops < MIN_OPS || now_usec() - start < BENCH_SECONDS * 1e6)) {
+        double t0 = now_usec();
+        int rc = prebuilt ? build_prebuilt(output, file, encoding)
+                          : build_legacy(output, file, encoding, cache_max_age);
+        if (rc < 0 || flush_output(output, fd) < 0) {
+            evbuffer_free(output);
+            return -1;
+        }
+        samples[ops++] = now_usec() - t0;
+    }
+
+    r->rps = ops / ((now_usec() - start) / 1e6);
+    qsort(samples, ops, sizeof(double), cmp_double);
+    r->p50 = samples[ops / 2];
+    r->p99 = samples[(ops * 99) / 100];
+    evbuffer_free(output);
+    return 0;
+}
+
+/* Both paths must put identical bytes on the wire */
+static int cross_check(const StaticFile *file, StaticEncoding encoding, int cache_max_age)
+{
+    struct evbuffer *a = evbuffer_new();
+    struct evbuffer *b = evbuffer_new();
+    int ok = 0;
+
+    if (a && b && build_legacy(a, file, encoding, cache_max_age) == 0 &&
+        build_prebuilt(b, file, encoding) == 0) {
+        size_t la = evbuffer_get_length(a);
+        ok = la == evbuffer_get_length(b) &&
+             memcmp(evbuffer_pullup(a, -1), evbuffer_pullup(b, -1), la) == 0;
+    }
+
+    if (a) evbuffer_free(a);
+    if (b) evbuffer_free(b);
+    return ok ? 0 : -1;
+}
+
+int main(void)
+{
+    Config *config = config_default();
+    double *samples = malloc(MAX_OPS * sizeof(double));
+    int fd = open("/dev/null", O_WRONLY);
+    StaticFiles *files;
+
+    if (!config || !samples || fd < 0) {
+        return 1;
+    }
+
+    log_init(LOG_WARN);
+    files = static_files_open("./static", config, NULL);
+    if (!files) {
+        printf("cannot load ./static (run from the repository root)\n");
+        return 1;
+    }
+
+    printf("%-9s %-9s %10s %12s %10s %10s\n",
+           "encoding", "path", "body B", "requests/s", "p50 us", "p99 us");
+    for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+        StaticEncoding encoding = (StaticEncoding)e;
+        const char *name = static_encoding_name(encoding);
+        size_t body_len = e == STATIC_ENCODING_IDENTITY ? files->index->length
+                                                        : files->index->encoded_length[e];
+
+        if (!name) name = "identity";
+        if (e != STATIC_ENCODING_IDENTITY && !files->index->encoded[e]) {
+            printf("%-9s %s\n", name, "unavailable");
+            continue;
+        }
+        if (cross_check(files->index, encoding, config->cache_max_age) < 0) {
+            printf("%-9s MISMATCH: prebuilt response differs from legacy response\n", name);
+            return 1;
+        }
+
+        for (int prebuilt = 0; prebuilt <= 1; prebuilt++) {
+            Result r;
+            if (run(prebuilt, files->index, encoding, config->cache_max_age,
+                    fd, samples, &r) < 0) {
+                printf("%-9s %-9s failed\n", name, prebuilt ? "prebuilt" : "legacy");
+                return 1;
+            }
+            printf("%-9s %-9s %10zu %12.0f %10.2f %10.2f\n", name,
+                   prebuilt ? "prebuilt" : "legacy", body_len, r.rps, r.p50, r.p99);
+        }
+    }
+
+    static_files_unref(files);
+    config_free(config);
+    close(fd);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,170 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include "rpc.h"
+#include "network.h"
+#include "tx.h"
+#include "txcache.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Server-side broadcast pipeline.
+ *
+ * ROUTE_BROADCAST hands the raw tx hex to broadcast_submit(), which
+ * decodes it once, computes the txid and fires one async
+ * sendrawtransaction per configured chain; the request bodies reference
+ * the hex rather than copying it. Huge-tier requests are
+ * decoded while they arrive and come in through broadcast_submit_raw(). The outcome is kept in a
+ * per-worker table keyed by txid so /tx/{txid} JSON requests are answered
+ * from memory. Requests that arrive while the broadcast is still in
+ * flight park a BroadcastWaiter and are answered when it completes,
+ * instead of the page polling repeatedly.
+ *
+ * Completed outcomes are also published to the shared TxCache, so a
+ * resubmission that lands on another worker is answered without an RPC.
+ */
+
+#define BROADCAST_MAX_ENDPOINTS  4              /* One per chain */
+#define BROADCAST_RESULT_TTL_SEC 3600           /* Results expire after 1 hour */
+#define BROADCAST_STORE_MAX      4096           /* Max remembered txids per worker */
+#define BROADCAST_STORE_BUCKETS  4096           /* Hash buckets (power of 2) */
+#define BROADCAST_ERROR_LEN      160
+#define BROADCAST_HEX_CHUNK      32640          /* Raw bytes hex-encoded per 64 KiB chain */
+
+struct BroadcastEntry;
+struct BroadcastStore;
+
+/*
+ * Parked request waiting for an in-flight broadcast.
+ * Embedded in the HTTP/1.1 connection or HTTP/2 stream that owns it.
+ */
+typedef struct BroadcastWaiter {
+    void (*on_done)(struct BroadcastWaiter *waiter,
+                    const struct BroadcastEntry *entry);
+    void *ctx;                          /* Owner (Connection or H2Stream) */
+    struct BroadcastEntry *entry;       /* NULL when not waiting */
+    struct BroadcastWaiter *next;
+    struct BroadcastWaiter *prev;
+} BroadcastWaiter;
+
+/*
+ * Outcome of one sendrawtransaction call.
+ */
+typedef struct {
+    BitcoinChain chain;
+    const char *name;                   /* Chain name (result key) */
+    int done;
+    int status;                         /* RPC_OK or RPC_ERR_* */
+    char error[BROADCAST_ERROR_LEN];
+    uint32_t time_ms;
+    RPCRequest *req;                    /* In-flight request, NULL once done */
+    struct BroadcastEntry *entry;
+} BroadcastEndpoint;
+
+typedef struct BroadcastEntry {
+    char txid[TX_HASH_HEX_LEN + 1];     /* Display order, lowercase */
+    char wtxid[TX_HASH_HEX_LEN + 1];    /* Same as txid for legacy txs */
+    uint8_t raw_txid[TX_HASH_LEN];      /* Internal byte order (TxCache key) */
+    uint8_t raw_wtxid[TX_HASH_LEN];
+    uint32_t hash;
+
+    BroadcastEndpoint endpoints[BROADCAST_MAX_ENDPOINTS];
+    int attempted;
+    int accepted;
+    int pending;                        /* Endpoints still in flight */
+
+    time_t created;                     /* Wall clock, for processed_at/TTL */
+    struct timespec started;            /* Monotonic, for processing time */
+    uint32_t processing_time_ms;
+
+    BroadcastWaiter *waiters;
+    struct BroadcastStore *store;
+
+    struct BroadcastEntry *hash_next;   /* Bucket chain */
+    struct BroadcastEntry *age_next;    /* Oldest -> newest */
+    struct BroadcastEntry *age_prev;
+} BroadcastEntry;
+
+typedef struct BroadcastStore {
+    BroadcastEntry **buckets;
+    BroadcastEntry *oldest;
+    BroadcastEntry *newest;
+    size_t count;
+
+    RPCManager *rpc;
+    BitcoinChain chain;                 /* CHAIN_MIXED = every configured chain */
+    TxCache *shared;                    /* Cross-worker dedup, may be NULL */
+
+    /* Stats */
+    uint64_t submitted;                 /* New broadcasts started */
+    uint64_t duplicates;                /* Submissions already known */
+    uint64_t invalid;                   /* Hex that is not a transaction */
+    uint64_t lookups_hit;               /* /tx JSON answered from memory */
+    uint64_t lookups_miss;              /* /tx JSON for unknown txid */
+    uint64_t lookups_waited;            /* /tx JSON parked until completion */
+    uint64_t expired;                   /* Entries dropped by TTL or capacity */
+    uint64_t shared_hits;               /* Resubmits answered from TxCache */
+    uint64_t shared_misses;             /* TxCache lookups that found nothing */
+    uint64_t shared_evictions;          /* Live TxCache entries overwritten */
+} BroadcastStore;
+
+/*
+ * Initialize store. rpc (and shared, if not NULL) must outlive it.
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int broadcast_store_init(BroadcastStore *store, RPCManager *rpc, BitcoinChain chain,
+                         TxCache *shared);
+
+/*
+ * Free all entries. Call after rpc_manager_cancel_all() so no RPC
+ * callbacks still reference them.
+ */
+void broadcast_store_free(BroadcastStore *store);
+
+/*
+ * Start broadcasting a raw transaction given as hex.
+ * Non-blocking: RPC results arrive on the event loop. In-flight requests
+ * take their own references to hex; the caller keeps its own.
+ * If txid_out is non-NULL it receives the display txid.
+ * Returns 0 if started, 1 if the txid was already known, -1 if invalid
+ * (or hex is NULL).
+ */
+int broadcast_submit(BroadcastStore *store, RPCPayload *hex, char *txid_out);
+
+/*
+ * Same, for a transaction already decoded to bytes (huge-tier requests
+ * are decoded while they arrive). raw may be released once this returns.
+ */
+int broadcast_submit_raw(BroadcastStore *store, const uint8_t *raw, size_t raw_len,
+                         char *txid_out);
+
+/*
+ * Find the entry for a txid (64 hex chars, any case).
+ * Returns NULL if unknown or expired.
+ */
+BroadcastEntry *broadcast_lookup(BroadcastStore *store, const char *txid, size_t len);
+
+/*
+ * Park a waiter until entry completes. entry must be pending.
+ */
+void broadcast_wait(BroadcastEntry *entry, BroadcastWaiter *waiter);
+
+/*
+ * Remove a waiter (owner is going away). Safe if not waiting.
+ */
+void broadcast_wait_cancel(BroadcastWaiter *waiter);
+
+/*
+ * Drop entries older than BROADCAST_RESULT_TTL_SEC.
+ */
+void broadcast_store_expire(BroadcastStore *store);
+
+/*
+ * Render the /tx/{txid} JSON document for a completed entry.
+ * Returns length written (truncated to size - 1 if needed).
+ */
+int broadcast_entry_json(const BroadcastEntry *entry, char *buf, size_t size);
+
+#endif /* BROADCAST_H */
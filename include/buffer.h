@@ -2,6 +2,7 @@
 #define BUFFER_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 /* Global memory tracking */
 extern size_t g_total_allocated;
@@ -52,4 +53,149 @@ size_t buffer_set_max_size(size_t max_size);
  */
 size_t buffer_get_max_size(void);
 
+/* ========== Size-classed pool ========== */
+
+/*
+ * Per-worker pool of Buffers for request data decoded off the wire
+ * (huge-tier transactions, see tx_stream in connection.c). No locking.
+ *
+ * Capacities are powers of two from BUFFER_POOL_MIN_SIZE up; released
+ * buffers are kept per class for reuse, bounded by BUFFER_POOL_MAX_IDLE
+ * bytes in total so a burst of huge requests does not pin memory.
+ */
+#define BUFFER_POOL_MIN_SHIFT 16                    /* 64KB smallest class */
+#define BUFFER_POOL_MIN_SIZE  ((size_t)1 << BUFFER_POOL_MIN_SHIFT)
+#define BUFFER_POOL_CLASSES   10                    /* 64KB .. 32MB */
+#define BUFFER_POOL_KEEP      2                     /* Idle buffers per class */
+#define BUFFER_POOL_MAX_IDLE  (16 * 1024 * 1024)
+
+typedef struct {
+    Buffer *idle[BUFFER_POOL_CLASSES][BUFFER_POOL_KEEP];
+    int idle_count[BUFFER_POOL_CLASSES];
+    size_t idle_bytes;
+
+    /* Stats */
+    uint64_t hits;                  /* Served from an idle buffer */
+    uint64_t misses;                /* Had to allocate */
+    uint64_t grows;                 /* Moved to a larger class */
+    size_t in_use_bytes;            /* Capacity currently handed out */
+} BufferPool;
+
+void buffer_pool_init(BufferPool *pool);
+
+/*
+ * Free all idle buffers. Buffers still handed out are not tracked and
+ * must be returned (or freed) by their owners first.
+ */
+void buffer_pool_destroy(BufferPool *pool);
+
+/*
+ * Get an empty buffer with capacity of at least min_cap.
+ * Returns NULL if min_cap exceeds the largest class or the max buffer
+ * size, or on allocation failure.
+ */
+Buffer *buffer_pool_get(BufferPool *pool, size_t min_cap);
+
+/*
+ * Make *b hold at least min_cap bytes by moving its contents to a buffer
+ * of a larger class. Returns 0 on success, -1 on failure (*b unchanged).
+ */
+int buffer_pool_grow(BufferPool *pool, Buffer **b, size_t min_cap);
+
+/*
+ * Return a buffer to the pool. NULL is ignored.
+ */
+void buffer_pool_put(BufferPool *pool, Buffer *b);
+
+/* ========== Object slabs ========== */
+
+/*
+ * Per-worker slab allocator for fixed-size objects allocated on every
+ * connection or request (Connection, H2Connection, H2Stream). No locking.
+ *
+ * Slabs are SLAB_SIZE bytes, aligned to their size so an object finds its
+ * slab by masking its address. Objects are laid out at a cache-line
+ * stride, so neighbours never share a line. Slabs with free objects are
+ * reused first; a slab that empties is freed unless SLAB_POOL_KEEP_EMPTY
+ * empty slabs are already kept, so a connection burst does not pin memory.
+ */
+#define SLAB_CACHE_LINE         64
+#define SLAB_SIZE               (64 * 1024)
+#define SLAB_POOL_KEEP_EMPTY    1
+
+struct Slab;
+
+typedef struct {
+    const char *name;               /* Metrics label */
+    size_t obj_size;                /* Rounded up to SLAB_CACHE_LINE */
+    size_t per_slab;                /* Objects per slab */
+    struct Slab *partial;           /* Slabs with free objects */
+    struct Slab *all;               /* Every slab, for destroy */
+
+    /* Stats */
+    size_t slabs;                   /* Slabs held */
+    size_t empty_slabs;             /* Slabs held with no objects in use */
+    size_t in_use;                  /* Objects handed out */
+    uint64_t allocs;                /* slab_alloc() calls served */
+    uint64_t slab_allocs;           /* Slabs allocated */
+    uint64_t slab_frees;            /* Slabs given back */
+} SlabPool;
+
+/*
+ * Set up a pool of obj_size objects. Returns -1 if an object does not
+ * fit in a slab.
+ */
+int slab_pool_init(SlabPool *pool, const char *name, size_t obj_size);
+
+/*
+ * Free every slab, including objects still handed out.
+ */
+void slab_pool_destroy(SlabPool *pool);
+
+/*
+ * Get a zeroed object (like calloc). Returns NULL on allocation failure.
+ */
+void *slab_alloc(SlabPool *pool);
+
+/*
+ * Return an object to its pool. NULL is ignored.
+ */
+void slab_free(SlabPool *pool, void *obj);
+
+/* ========== Arena ========== */
+
+/*
+ * Bump allocator for small strings that share an owner's lifetime (an
+ * HTTP/2 stream's pseudo-headers). Strings are carved from a buffer
+ * embedded in the owner; what does not fit goes to malloc'd overflow
+ * chunks. arena_reset() releases everything at once - individual strings
+ * are never freed.
+ */
+#define ARENA_CHUNK_SIZE    1024
+
+struct ArenaChunk;
+
+typedef struct {
+    char *base;                     /* Current block */
+    size_t size;
+    size_t used;
+    char *inline_buf;               /* Owner's embedded block */
+    size_t inline_size;
+    struct ArenaChunk *chunks;      /* Overflow chunks */
+    size_t overflows;               /* Overflow chunks allocated */
+} Arena;
+
+void arena_init(Arena *arena, void *buf, size_t size);
+
+/*
+ * Copy len bytes of s into the arena, NUL-terminated.
+ * Returns NULL on allocation failure.
+ */
+char *arena_strndup(Arena *arena, const char *s, size_t len);
+
+/*
+ * Free the overflow chunks and make the whole embedded block available.
+ */
+void arena_reset(Arena *arena);
+
 #endif /* BUFFER_H */
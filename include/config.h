@@ -25,6 +25,7 @@ typedef struct {
     /* Static files settings */
     char static_dir[256];          /* Default: "./static" */
     int cache_max_age;             /* Default: 3600 (1 hour), 0 = no caching */
+    int static_watch;              /* Default: 1, reload static_dir when it changes */
 
     /* Slot limits (per worker) */
     int slots_normal_max;          /* Default: 100 */
@@ -40,6 +41,10 @@ typedef struct {
     int tls_port;                  /* Default: 8443 */
     char tls_cert_file[256];       /* Path to certificate file */
     char tls_key_file[256];        /* Path to private key file */
+    int tls_ticket_key_rotation;   /* Default: 3600 sec, 0 = per-worker ticket keys */
+    int tls_ktls;                  /* Default: 0, 1 = kernel TLS record encryption */
+    int tls_handshake_threads;     /* Default: 0 (handshakes on the event loop) */
+    int tls_handshake_queue;       /* Default: 256 handshakes in flight per thread */
 
     /* HTTP/2 settings (Phase 3) */
     int http2_enabled;             /* Default: 1 (enabled when TLS is enabled) */
@@ -61,6 +66,10 @@ typedef struct {
     RPCConfig rpc_testnet;         /* Testnet Bitcoin Core RPC */
     RPCConfig rpc_signet;          /* Signet Bitcoin Core RPC */
     RPCConfig rpc_regtest;         /* Regtest Bitcoin Core RPC */
+
+    /* Broadcast coalescing, all chains ([rpc]) */
+    int rpc_batch_window_ms;       /* Default: 0 (disabled) */
+    int rpc_batch_max;             /* Default: 16 broadcasts per batch */
 } Config;
 
 /*
@@ -3,6 +3,8 @@
 
 #include "config.h"
 #include "reader.h"  /* For RequestTier */
+#include "broadcast.h"
+#include "static_files.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <event2/bufferevent.h>
@@ -29,6 +31,28 @@ typedef enum {
     PROTO_HTTP_2   = 1            /* HTTP/2 (via ALPN) */
 } ProtocolType;
 
+/*
+ * Request-line validator state. The validator is resumable: each read
+ * callback feeds it only the bytes it has not seen yet.
+ */
+typedef enum {
+    PATH_SCAN_METHOD,             /* Looking for the space after the method */
+    PATH_SCAN_SLASH,              /* Optional leading '/' */
+    PATH_SCAN_PREFIX,             /* Optional "tx/" prefix */
+    PATH_SCAN_HEX,                /* Path is all hex so far */
+    PATH_SCAN_NON_HEX,            /* Saw a non-hex byte, looking for path end */
+    PATH_SCAN_DONE,               /* Path complete and acceptable */
+    PATH_SCAN_FAILED,             /* Long path with invalid characters */
+    PATH_SCAN_NOMEM               /* Could not grow the tx decode buffer */
+} PathScanState;
+
+/*
+ * Paths shorter than this (routes, static assets, /tx/{txid}) are copied
+ * into the Connection. Longer ones - raw transaction hex - are read in
+ * place from the request head, kept in request_head for the request.
+ */
+#define CONN_PATH_INLINE    128
+
 /*
  * Forward declarations.
  */
@@ -44,6 +68,10 @@ struct H2Connection;
  * Uses tiered slots (normal/large/huge) based on request size.
  */
 typedef struct Connection {
+    /* Everything down to body_received is touched on every read event and
+     * fills the first cache line (connections come from a cache-line
+     * aligned slab, worker->conn_pool) */
+
     /* Libevent */
     struct bufferevent *bev;
     struct WorkerProcess *worker;
@@ -57,10 +85,6 @@ typedef struct Connection {
     /* Slot tier - tracks which slot pool this connection uses */
     RequestTier current_tier;
 
-    /* Client info */
-    char client_ip[64];
-    uint16_t client_port;
-
     /* Request parsing - v6: no more request_buffer/request_len/request_capacity
      * We now use evbuffer_search/pullup/drain directly on bufferevent's input */
     size_t headers_scanned;      /* How much of evbuffer we've scanned for \r\n\r\n */
@@ -70,17 +94,40 @@ typedef struct Connection {
 
     /* Request info (parsed from headers) */
     char method[16];
-    char *path;                  /* Dynamically allocated for large URLs */
+    char *path;                  /* path_inline, or a view into request_head */
     size_t path_len;
-
-    /* Early validation state */
-    bool path_validated;         /* Have we started hex validation? */
-    bool validation_failed;      /* Did early validation fail? */
+    RPCPayload *path_payload;    /* Owns request_head's bytes once shared with broadcast RPCs */
+    struct evbuffer *request_head;  /* Head of a request with a long path, or NULL */
+    char path_inline[CONN_PATH_INLINE];
+    bool accept_json;            /* Accept: application/json (for /tx/{txid}) */
+    unsigned accept_encodings;   /* Accept-Encoding, STATIC_ACCEPT_* bits */
+    bool has_if_none_match;
+    char if_none_match[STATIC_IF_NONE_MATCH_MAX];
+    time_t if_modified_since;    /* -1 if absent or not a valid date */
+
+    /* Parked /tx/{txid} request waiting on an in-flight broadcast */
+    BroadcastWaiter tx_waiter;
+
+    /* Early validation state (resumable, see validate_path_early).
+     * Offsets count request bytes, including any already drained. */
+    PathScanState path_scan;
+    size_t path_scan_offset;     /* Request bytes already examined */
+    size_t path_scan_start;      /* Offset of first path char (after '/') */
+    size_t path_scan_bad;        /* Offset of first non-hex path char */
+    size_t path_scan_end;        /* Offset of the path terminator (DONE) */
+    unsigned char path_bad_char; /* That character, for the log */
+    uint8_t path_prefix_len;     /* Chars of "tx/" matched so far */
+
+    /* Huge-tier broadcast decoded while it arrives (see tx_stream_start) */
+    Buffer *tx_raw;              /* Decoded bytes from worker->tx_buffers, or NULL */
+    int tx_pending_hex;          /* Hex char awaiting its pair, -1 if none */
+    size_t input_consumed;       /* Request bytes already drained from input */
 
     /* Keep-alive support (Phase 4) */
     bool keep_alive;             /* Connection supports keep-alive */
     bool slot_held;              /* Currently holding a request slot */
     int requests_on_connection;  /* Number of requests processed on this connection */
+    int pipeline_depth;          /* Responses queued ahead of this request */
 
     /* TLS support (Phase 2) */
     void *ssl;                   /* SSL* - opaque to avoid header dependency */
@@ -89,6 +136,10 @@ typedef struct Connection {
     /* HTTP/2 support (Phase 3) */
     struct H2Connection *h2;     /* HTTP/2 session state */
 
+    /* Client info */
+    char client_ip[64];
+    uint16_t client_port;
+
     /* Timing */
     struct timespec start_time;
 
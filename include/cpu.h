@@ -0,0 +1,33 @@
+#ifndef CPU_H
+#define CPU_H
+
+/*
+ * Runtime CPU feature detection for the SIMD kernels.
+ *
+ * Kernels are compiled with per-function target attributes, so the
+ * binary runs on any x86-64 CPU; callers check cpu_has() once and pick
+ * the best implementation. On other architectures every query is false
+ * and the portable code is used.
+ */
+
+#define CPU_SSSE3     (1u << 0)
+#define CPU_SSE41     (1u << 1)
+#define CPU_SSE42     (1u << 2)
+#define CPU_AVX2      (1u << 3)
+#define CPU_AVX512BW  (1u << 4)   /* Implies AVX512F */
+#define CPU_SHA       (1u << 5)   /* SHA-NI */
+
+/*
+ * Feature bitmask (CPU_*) for this CPU and OS. Cached after first call.
+ */
+unsigned int cpu_features(void);
+
+/*
+ * 1 if every feature in mask is available.
+ */
+static inline int cpu_has(unsigned int mask)
+{
+    return (cpu_features() & mask) == mask;
+}
+
+#endif /* CPU_H */
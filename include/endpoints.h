@@ -8,6 +8,7 @@
 /* Forward declarations */
 struct WorkerProcess;
 struct Connection;
+struct evbuffer;
 
 /*
  * Generate /health JSON response body.
@@ -18,10 +19,11 @@ int generate_health_body(struct WorkerProcess *worker, char *buf, size_t bufsize
 
 /*
  * Generate /metrics Prometheus response body.
- * Writes into caller-provided buffer.
- * Returns number of bytes written (excluding NUL), or -1 on error.
+ * Appends to out, which grows with the chains and node error codes.
+ * Returns number of bytes appended, or -1 on error (logged; out may hold
+ * a partial body and should be discarded).
  */
-int generate_metrics_body(struct WorkerProcess *worker, char *buf, size_t bufsize);
+int generate_metrics_body(struct WorkerProcess *worker, struct evbuffer *out);
 
 /*
  * Serve ACME HTTP-01 challenge for HTTP/2.
@@ -55,6 +57,16 @@ int validate_hex_path(const char *path, size_t path_len);
  */
 void update_latency_histogram(struct WorkerProcess *worker, double duration_sec);
 
+/*
+ * Record a completed TLS handshake (accept to done, in seconds).
+ */
+void update_tls_handshake_histogram(struct WorkerProcess *worker, double duration_sec);
+
+/*
+ * Record how late the event loop probe timer fired (seconds).
+ */
+void update_loop_lag_histogram(struct WorkerProcess *worker, double lag_sec);
+
 /*
  * Update HTTP status code counters.
  */
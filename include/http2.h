@@ -3,16 +3,22 @@
 
 #include "config.h"
 #include "reader.h"  /* For RequestTier */
+#include "broadcast.h"
+#include "static_files.h"
+#include "buffer.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/time.h>
 #include <event2/bufferevent.h>
+#include <nghttp2/nghttp2.h>
 
 /* Forward declarations */
 struct Connection;
 struct WorkerProcess;
 struct nghttp2_session;
+struct H2Connection;
+struct H2BodySource;
 
 /*
  * HTTP/2 stream state.
@@ -26,24 +32,45 @@ typedef enum {
     H2_STREAM_CLOSED
 } H2StreamState;
 
+/*
+ * Room for a stream's short header strings (:method, :authority, :scheme
+ * and a short :path). Longer values spill to the arena's malloc'd chunks;
+ * a path longer than H2_STREAM_ARENA_PATH_MAX gets its own block, since a
+ * broadcast may share it with RPCs that outlive the stream.
+ */
+#define H2_STREAM_ARENA_SIZE        256
+#define H2_STREAM_ARENA_PATH_MAX    128
+
 /*
  * HTTP/2 stream - one per request within a connection.
  * Tracks per-stream slot allocation for proper resource management.
+ * Allocated from worker->h2_stream_pool.
  */
 typedef struct H2Stream {
     int32_t stream_id;
     H2StreamState state;
+    struct H2Connection *h2;       /* Owning session */
 
     /* Slot tier for this stream */
     RequestTier tier;
     bool slot_acquired;
 
-    /* Request info */
+    /* Request info (strings in header_arena unless noted) */
     char *method;
     char *path;
     size_t path_len;
+    bool path_allocated;           /* path is malloc'd, not in header_arena */
+    RPCPayload *path_payload;      /* Owns path once shared with broadcast RPCs */
     char *authority;
     char *scheme;
+    bool accept_json;              /* accept: application/json (for /tx/{txid}) */
+    unsigned accept_encodings;     /* accept-encoding, STATIC_ACCEPT_* bits */
+    bool has_if_none_match;
+    char if_none_match[STATIC_IF_NONE_MATCH_MAX];
+    time_t if_modified_since;      /* -1 if absent or not a valid date */
+
+    /* Parked /tx/{txid} request waiting on an in-flight broadcast */
+    BroadcastWaiter tx_waiter;
 
     /* Request body */
     size_t content_length;
@@ -61,11 +88,16 @@ typedef struct H2Stream {
     /* Linked list of streams */
     struct H2Stream *next;
     struct H2Stream *prev;
+
+    /* Header strings, released in one go when the stream is freed */
+    Arena header_arena;
+    char header_space[H2_STREAM_ARENA_SIZE];
 } H2Stream;
 
 /*
  * HTTP/2 connection state.
  * Manages nghttp2 session and all streams on this connection.
+ * Allocated from worker->h2_conn_pool.
  */
 typedef struct H2Connection {
     struct nghttp2_session *session;
@@ -93,12 +125,21 @@ int h2_connection_init(struct Connection *conn);
  */
 void h2_connection_free(H2Connection *h2);
 
+/*
+ * Bytes of input fed to nghttp2 per read callback. A client with more
+ * queued (a large upload under the 16MB connection window) gets the rest
+ * on a later pass of the event loop, after other connections have run.
+ */
+#define H2_INPUT_BUDGET             (256 * 1024)
+
 /*
  * Process incoming data from the connection.
- * Feeds data to nghttp2 for parsing.
+ * Feeds input to nghttp2 segment by segment (no pullup), draining what
+ * it consumes, up to H2_INPUT_BUDGET bytes; anything beyond that stays
+ * in input for the caller to reschedule.
  * Returns 0 on success, -1 on error (should close connection).
  */
-int h2_process_input(struct Connection *conn, const unsigned char *data, size_t len);
+int h2_process_input(struct Connection *conn, struct evbuffer *input);
 
 /*
  * Send pending output data.
@@ -129,4 +170,19 @@ int h2_send_response(struct Connection *conn, int32_t stream_id,
                      int status_code, const char *content_type,
                      const unsigned char *body, size_t body_len);
 
+/*
+ * Response DATA path, also driven directly by bench_h2_data.
+ *
+ * h2_set_send_callbacks() installs the send callbacks; the session's
+ * user_data must be a Connection, whose bufferevent output receives the
+ * frames. h2_body_source_new() fills provider for nghttp2_submit_response()
+ * so DATA frames reference body (pinning files) or, when files is NULL, a
+ * copy of it. The returned source holds the stream's reference, dropped
+ * with h2_body_source_unref() when the stream closes.
+ */
+void h2_set_send_callbacks(nghttp2_session_callbacks *callbacks);
+struct H2BodySource *h2_body_source_new(StaticFiles *files, const unsigned char *body,
+                                        size_t body_len, nghttp2_data_provider *provider);
+void h2_body_source_unref(struct H2BodySource *bs);
+
 #endif /* HTTP2_H */
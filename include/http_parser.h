@@ -0,0 +1,127 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * HTTP/1.1 request head tokenizer.
+ *
+ * One pass over a complete, contiguous request head (through the blank
+ * line) yields the request line and an array of header name/value
+ * slices pointing into the buffer; nothing is copied. Headers the server
+ * acts on are resolved to an HttpHeaderId while tokenizing, so callers
+ * index known[] instead of searching the block once per header.
+ *
+ * The long runs - the request target (a raw transaction can be megabytes
+ * of hex) and header values - are scanned for their delimiter with the
+ * widest kernel the CPU has, chosen at runtime like hex.c:
+ *   AVX2   - 32 bytes per step
+ *   SSE42  - 16 bytes per step (PCMPESTRI byte ranges)
+ *   SCALAR - one byte per step
+ * Method and header names are short tokens and use a lookup table.
+ *
+ * Rejected as malformed: control bytes in the target or a value, a name
+ * that is not a token or is followed by whitespace before the colon,
+ * obsolete line folding, a version other than HTTP/1.x, Content-Length
+ * headers that disagree (RFC 9112 section 6.3), and more than
+ * HTTP_MAX_HEADERS headers. A missing version (HTTP/0.9 style request
+ * line) is accepted. Lines may end in CRLF or a bare LF.
+ */
+
+#define HTTP_MAX_HEADERS    64
+
+/* Headers resolved while tokenizing */
+typedef enum {
+    HTTP_HEADER_HOST,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_ACCEPT,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_IF_MODIFIED_SINCE,
+    HTTP_HEADER_COUNT
+} HttpHeaderId;
+
+typedef struct {
+    const char *name;
+    size_t name_len;
+    const char *value;          /* Leading/trailing whitespace trimmed */
+    size_t value_len;
+} HttpHeader;
+
+typedef struct {
+    const char *method;
+    size_t method_len;
+    const char *target;
+    size_t target_len;
+    int minor_version;          /* HTTP/1.x; -1 if the line had no version */
+
+    HttpHeader headers[HTTP_MAX_HEADERS];
+    size_t num_headers;
+    int8_t known[HTTP_HEADER_COUNT];  /* First occurrence in headers[], -1 = absent */
+} HttpRequest;
+
+typedef enum {
+    HTTP_PARSER_BACKEND_SCALAR,
+    HTTP_PARSER_BACKEND_SSE42,
+    HTTP_PARSER_BACKEND_AVX2,
+    HTTP_PARSER_BACKEND_COUNT
+} HttpParserBackend;
+
+/*
+ * Tokenize a request head: request line, headers and the blank line.
+ * Returns 0 on success, -1 if malformed or the blank line is missing.
+ */
+int http_parse_request(const char *buf, size_t len, HttpRequest *req);
+
+/*
+ * Tokenize the rest of a request head whose method and target were
+ * consumed elsewhere: from the byte after the target (SP HTTP-version,
+ * or the line end) through the blank line. Sets minor_version but not
+ * method or target. Returns 0 on success, -1 if malformed.
+ */
+int http_parse_request_tail(const char *buf, size_t len, HttpRequest *req);
+
+/*
+ * The first header with this id, or NULL.
+ */
+static inline const HttpHeader *http_request_header(const HttpRequest *req, HttpHeaderId id)
+{
+    return req->known[id] >= 0 ? &req->headers[req->known[id]] : NULL;
+}
+
+/*
+ * 1 if a comma-separated header value lists token (case-insensitive).
+ */
+int http_header_has_token(const char *value, size_t len, const char *token);
+
+/*
+ * Parse a Content-Length value: digits only, no sign, no overflow.
+ * Returns 0 on success, -1 if invalid.
+ */
+int http_parse_content_length(const char *value, size_t len, size_t *out);
+
+/*
+ * Backend selection. http_parser_set_backend() is for benchmarks and
+ * returns -1 (leaving the current backend) if this CPU lacks the
+ * instructions.
+ */
+HttpParserBackend http_parser_backend(void);
+int http_parser_backend_supported(HttpParserBackend backend);
+int http_parser_set_backend(HttpParserBackend backend);
+const char *http_parser_backend_name(HttpParserBackend backend);
+
+/*
+ * Backend kernels (http_parser_simd.c). Each returns the offset of the
+ * first byte below limit or equal to DEL (0x7F) found in a whole vector,
+ * or the number of bytes in whole vectors if there is none. Bytes from
+ * 0x80 up never stop the scan.
+ */
+#if defined(__x86_64__)
+size_t http_scan_sse42(const char *data, size_t len, unsigned char limit);
+size_t http_scan_avx2(const char *data, size_t len, unsigned char limit);
+#endif
+
+#endif /* HTTP_PARSER_H */
@@ -2,6 +2,10 @@
 #define MASTER_H
 
 #include "config.h"
+#include "txcache.h"
+#include "ticket_keys.h"
+#include "static_watch.h"
+#include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
 
@@ -13,6 +17,9 @@
  * - Monitor workers (restart on crash)
  * - Handle SIGHUP for graceful reload
  * - Handle SIGTERM for graceful shutdown
+ * - Own state shared by all workers (TxCache, TLS ticket keys, static
+ *   image), kept across reloads
+ * - Watch the static directory and hand workers the rebuilt image
  */
 
 typedef struct MasterProcess {
@@ -24,6 +31,24 @@ typedef struct MasterProcess {
     int num_workers;
     pid_t *worker_pids;
 
+    /* Cross-worker broadcast dedup cache (NULL if unavailable) */
+    TxCache *tx_cache;
+
+    /* Shared TLS session ticket keys, rotated here (NULL = per-worker) */
+    TicketKeys *ticket_keys;
+
+    /* Static files, built once and mapped read-only by every worker.
+     * A rebuilt image is sent to each worker slot over its channel. */
+    int static_image_fd;
+    uint32_t static_generation;
+    StaticWatch static_watch;
+    int *worker_channels;       /* Master end per worker slot, -1 = none */
+
+    /* Static rebuild after a directory change, in a forked builder */
+    pid_t static_builder;       /* 0 = none running */
+    int static_builder_channel; /* Image comes back here, -1 = none */
+    bool static_rebuild_pending;/* Changed again while building */
+
     /* Draining workers (old workers during reload) */
     pid_t *draining_pids;
     int num_draining;
@@ -52,11 +77,12 @@ int master_run(MasterProcess *master);
 void master_cleanup(MasterProcess *master);
 
 /*
- * Fork a single worker process.
+ * Fork a single worker process with master's current config, shared
+ * state and a fresh static image channel for the slot.
  * Returns child PID to parent, or -1 on error.
  * In child: calls worker_main() and exits.
  */
-pid_t fork_worker(int worker_id, Config *config);
+pid_t fork_worker(MasterProcess *master, int worker_id);
 
 /*
  * Send graceful shutdown signal to all workers.
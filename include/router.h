@@ -2,23 +2,21 @@
 #define ROUTER_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 /*
  * Route types for request routing.
  *
- * ROUTE_HOME:      / (empty path) → index.html
+ * ROUTE_STATIC:    A file from the static directory (/ is index.html)
  * ROUTE_BROADCAST: Raw transaction hex (>64 chars) → broadcast.html
  * ROUTE_RESULT:    Transaction ID lookup → result.html
  * ROUTE_ERROR:     Invalid request → error.html
  */
 typedef enum {
-    ROUTE_HOME,            /* / → home page */
+    ROUTE_STATIC,          /* Exact path of a static asset */
     ROUTE_BROADCAST,       /* Raw tx hex → broadcast page */
     ROUTE_RESULT,          /* Txid lookup → result page */
     ROUTE_ERROR,           /* Invalid → error page */
-    ROUTE_DOCS,            /* /docs → documentation page */
-    ROUTE_STATUS,          /* /status → status page */
-    ROUTE_LOGOS,           /* /logos → logos page */
     ROUTE_HEALTH,          /* /health → JSON health status */
     ROUTE_READY,           /* /ready → readiness probe */
     ROUTE_ALIVE,           /* /alive → liveness probe */
@@ -27,20 +25,72 @@ typedef enum {
     ROUTE_ACME_CHALLENGE   /* /.well-known/acme-challenge/{token} */
 } RouteType;
 
+/*
+ * Exact-path routes: the fixed endpoints plus one entry per static asset.
+ *
+ * Lookups hash the path once. route_table_build() searches for a seed
+ * and table size that give every path its own slot (a perfect hash), so
+ * a lookup is one hash and one compare; if no seed is found it falls back
+ * to linear probing. Paths longer than the longest route are not hashed.
+ */
+typedef struct RouteEntry {
+    const char *path;           /* Not copied: must outlive the table */
+    size_t path_len;
+    RouteType route;
+    const void *data;           /* ROUTE_STATIC: the StaticFile */
+} RouteEntry;
+
+typedef struct RouteTable {
+    RouteEntry *entries;
+    size_t count;
+    size_t capacity;
+    uint32_t *slots;            /* Entry index + 1, 0 = empty */
+    uint32_t mask;
+    uint32_t seed;
+    size_t max_probe;           /* 0 when the hash is perfect */
+    size_t max_path_len;
+} RouteTable;
+
+/*
+ * Start a table holding the fixed endpoints (/health, /ready, ...).
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int route_table_init(RouteTable *table);
+
+/*
+ * Add an exact path. Call route_table_build() after the last add.
+ * Returns 0 on success, 1 if the path is already routed, -1 on
+ * allocation failure.
+ */
+int route_table_add(RouteTable *table, const char *path, size_t path_len,
+                    RouteType route, const void *data);
+
+/*
+ * Index the added paths for lookup.
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int route_table_build(RouteTable *table);
+
+void route_table_free(RouteTable *table);
+
 /*
  * Determine route for a request path.
  *
  * Routing logic:
- * - / → ROUTE_HOME
+ * - exact path in table → its route (*data set for ROUTE_STATIC)
+ * - /.well-known/acme-challenge/{token} → ROUTE_ACME_CHALLENGE
  * - /tx/{64-hex-chars} → ROUTE_RESULT
  * - /{64-hex-chars} → ROUTE_RESULT (bare txid)
  * - /{>64-hex-chars} → ROUTE_BROADCAST (raw tx)
  * - Everything else → ROUTE_ERROR
  *
+ * @param table    Exact routes (may be NULL: dynamic routes only)
  * @param path     Request path (e.g., "/tx/abc123...")
  * @param path_len Length of path string
+ * @param data     Set to the matched entry's data, NULL otherwise
  * @return RouteType indicating which page to serve
  */
-RouteType route_request(const char *path, size_t path_len);
+RouteType route_request(const RouteTable *table, const char *path, size_t path_len,
+                        const void **data);
 
 #endif /* ROUTER_H */
@@ -2,6 +2,7 @@
 #define RPC_H
 
 #include "network.h"
+#include "rpc_parse.h"
 #include <stddef.h>
 #include <stdint.h>
 #include <time.h>
@@ -11,6 +12,7 @@
 struct event_base;
 struct bufferevent;
 struct event;
+struct evbuffer;
 
 /*
  * Bitcoin Core RPC Client - Phase 13c + async extension
@@ -30,15 +32,32 @@ struct event;
  *
  * Usage (async):
  *   rpc_manager_init_async(&mgr, base, ...);
- *   rpc_manager_broadcast_async(&mgr, chain, hex_tx, my_callback, my_data);
+ *   RPCPayload *hex = rpc_payload_wrap(buf, buf + 1, len);
+ *   rpc_manager_broadcast_async(&mgr, chain, hex, my_callback, my_data);
+ *   rpc_payload_unref(hex);
  */
 
 /* Maximum sizes */
 #define RPC_MAX_HOST_LEN 256
 #define RPC_MAX_AUTH_LEN 512
 #define RPC_MAX_WALLET_LEN 64
-#define RPC_INITIAL_BUFFER_LEN (64 * 1024)      /* 64KB initial buffer */
-#define RPC_MAX_RESPONSE_LEN   (4 * 1024 * 1024) /* 4MB max for large responses */
+#define RPC_RESULT_LEN         4096             /* Async result capture */
+#define RPC_NODE_ERROR_CODES   16               /* Distinct node error codes counted */
+#define RPC_HEADER_RESERVE     1024             /* Fits the request line and headers */
+
+/* Async connection pool defaults (per worker, per chain) */
+#define RPC_POOL_DEFAULT_MIN          1
+#define RPC_POOL_DEFAULT_MAX          8
+#define RPC_POOL_DEFAULT_IDLE_TIMEOUT 20    /* Below bitcoind's -rpcservertimeout (30s) */
+#define RPC_POOL_MAINTENANCE_SEC      5     /* Reaper / health check interval */
+
+/* Broadcast coalescing ([rpc] batch_window_ms / batch_max) */
+#define RPC_BATCH_DEFAULT_WINDOW_MS   0     /* 0 = every broadcast sent on its own */
+#define RPC_BATCH_DEFAULT_MAX         16
+#define RPC_BATCH_MAX_WINDOW_MS       1000
+#define RPC_BATCH_MAX_SIZE            256
+#define RPC_BATCH_SIZE_BUCKETS        8     /* le 1, 2, 4, ... 64, +Inf */
+#define RPC_BATCH_DELAY_BUCKETS       7     /* le 0.5ms ... 50ms, +Inf */
 
 /* RPC error codes */
 #define RPC_OK              0
@@ -55,8 +74,9 @@ struct event;
 typedef void (*RPCResultCallback)(int status, const char *result,
                                    size_t result_len, void *user_data);
 
-/* Forward declaration for RPCRequest */
+/* Forward declarations for async types */
 typedef struct RPCRequest RPCRequest;
+typedef struct RPCPoolConn RPCPoolConn;
 
 /*
  * RPC connection configuration.
@@ -71,8 +91,66 @@ typedef struct {
     char datadir[256];                  /* Bitcoin datadir (for auto cookie path) */
     int timeout_sec;                    /* Request timeout (default: 30) */
     char wallet[RPC_MAX_WALLET_LEN];    /* Wallet name (optional) */
+    int pool_min;                       /* Warm keep-alive connections (default: 1) */
+    int pool_max;                       /* Max concurrent connections (default: 8) */
+    int pool_idle_timeout_sec;          /* Reap idle connections after (default: 20) */
 } RPCConfig;
 
+/*
+ * Keep-alive connection pool for async requests.
+ * One per RPCClient; all connections belong to the owning worker's loop.
+ */
+typedef struct {
+    int min_size;
+    int max_size;
+    int idle_timeout_sec;
+
+    RPCPoolConn *conns;                 /* All connections (idle and busy) */
+    int total;                          /* Connections open or connecting */
+    int busy;                           /* Connections with a request in flight */
+
+    RPCRequest *wait_head;              /* FIFO of requests waiting for a connection */
+    RPCRequest *wait_tail;
+    int waiting;
+
+    /* Stats */
+    uint64_t hits;                      /* Request reused an idle connection */
+    uint64_t misses;                    /* Request opened a new connection */
+    uint64_t waits;                     /* Request queued because pool was full */
+    uint64_t reaped;                    /* Idle connections closed by the reaper */
+    uint64_t health_checks;             /* Health probes sent on idle connections */
+    uint64_t health_failures;           /* Health probes that failed */
+} RPCPool;
+
+/*
+ * Broadcast coalescing for one client: broadcasts collected during the
+ * window go to the node as one JSON-RPC batch (at most max_size each).
+ * Histogram buckets are per-bucket counts; /metrics accumulates them.
+ */
+typedef struct {
+    int window_ms;                      /* 0 = disabled */
+    int max_size;
+
+    RPCRequest *head;                   /* Broadcasts waiting for the window */
+    RPCRequest *tail;
+    int queued;
+    struct event *timer;                /* Window end, or made active when full */
+
+    /* Stats */
+    uint64_t sent;                      /* HTTP requests sent (batches and singles) */
+    uint64_t size_buckets[RPC_BATCH_SIZE_BUCKETS];
+    uint64_t size_sum;
+    uint64_t delay_buckets[RPC_BATCH_DELAY_BUCKETS];
+    uint64_t delay_count;
+    double delay_sum_seconds;           /* Time broadcasts spent in the window */
+} RPCBatcher;
+
+/* Node (JSON-RPC) error code and how often it was returned */
+typedef struct {
+    long code;
+    uint64_t count;
+} RPCErrorCount;
+
 /*
  * RPC client handle.
  */
@@ -89,6 +167,11 @@ typedef struct {
     uint64_t request_count;             /* Total requests made */
     uint64_t error_count;               /* Total errors */
 
+    /* Node errors by JSON-RPC error.code, in order first seen */
+    RPCErrorCount node_errors[RPC_NODE_ERROR_CODES];
+    int node_error_codes;
+    uint64_t node_errors_other;         /* Table full, or no code given */
+
     /* Cookie auth state */
     char cookie_path[256];              /* Path to cookie file */
     time_t cookie_mtime;                /* Last modified time of cookie */
@@ -96,6 +179,12 @@ typedef struct {
     /* Pre-resolved address for async connections */
     struct sockaddr_storage resolved_addr;
     socklen_t resolved_addr_len;
+
+    /* Async keep-alive connection pool */
+    RPCPool pool;
+
+    /* Async broadcast coalescing */
+    RPCBatcher batcher;
 } RPCClient;
 
 /*
@@ -110,6 +199,7 @@ typedef struct {
     /* Async state */
     struct event_base *base;            /* NULL = sync-only mode */
     RPCRequest *active_requests;        /* Head of active doubly-linked list */
+    struct event *pool_timer;           /* Idle reaper / health check timer */
 
     /* Stats */
     uint64_t total_broadcasts;
@@ -238,18 +328,17 @@ void rpc_manager_log_status(RPCManager *mgr);
 struct RPCRequest {
     RPCClient *client;
     RPCManager *mgr;
-    struct bufferevent *bev;
+    RPCPoolConn *conn;              /* Pooled connection, NULL while waiting */
     struct event *timeout_ev;
     struct event_base *base;
 
-    /* Request */
-    char *request_body;
-    size_t request_body_len;
+    /* Request: JSON body as an evbuffer chain, kept for stale retries */
+    struct evbuffer *request_body;
+    uint64_t id;                    /* JSON-RPC id in request_body */
 
-    /* Response accumulation */
-    char *response_buf;
-    size_t response_len;
-    size_t response_cap;
+    /* Response, parsed as it arrives: only the result is kept */
+    RPCResponse response;
+    char result[RPC_RESULT_LEN];
 
     /* Callback */
     RPCResultCallback callback;
@@ -257,10 +346,45 @@ struct RPCRequest {
 
     /* State */
     int auth_retried;               /* Cookie refresh retry flag */
+    int stale_retried;              /* Retried after reused connection died */
+    int is_probe;                   /* Internal pool health check */
+    int queued;                     /* On the pool wait queue */
+
+    /* Coalescing: a member waits in the batcher, then rides in a batch */
+    int batch_queued;               /* Waiting for the coalescing window */
+    struct timespec batch_enqueued;
+    RPCRequest *batch_next;
+    RPCRequest *batch;              /* Batch carrying this request */
+    int batch_answered;             /* Reply found in the batch response */
+    int batch_status;
+    size_t batch_result_len;        /* Reply text is kept in result */
+
+    int is_batch;                   /* Carries members[] as one JSON array */
+    RPCRequest **members;           /* By position; NULL once completed */
+    int member_count;
 
     /* Active list (doubly-linked, intrusive) */
     RPCRequest *next;
     RPCRequest *prev;
+
+    /* Pool wait queue (singly-linked FIFO) */
+    RPCRequest *wait_next;
+};
+
+/*
+ * Persistent HTTP/1.1 connection to a node, owned by an RPCPool.
+ */
+struct RPCPoolConn {
+    RPCClient *client;
+    struct event_base *base;
+    struct bufferevent *bev;
+    RPCRequest *req;                /* In-flight request, NULL when idle */
+    int connected;
+    int reused;                     /* Has served at least one request */
+    time_t last_used;
+
+    RPCPoolConn *next;
+    RPCPoolConn *prev;
 };
 
 /*
@@ -278,15 +402,68 @@ int rpc_manager_init_async(RPCManager *mgr,
                             const RPCConfig *regtest);
 
 /*
- * Broadcast a raw transaction asynchronously.
+ * Transaction hex shared by the sendrawtransaction bodies of every
+ * endpoint. Bodies reference it with evbuffer_add_reference() instead of
+ * copying it, and what holds the hex - block (a malloc'd buffer, e.g. a
+ * request path) or owner (e.g. the request head an HTTP/1.1 path points
+ * into) - is freed when the last reference is dropped. hex is NULL when
+ * the hex is all of owner's data, in as many segments as it takes.
+ */
+typedef struct RPCPayload {
+    const char *hex;
+    size_t len;
+    void *block;
+    struct evbuffer *owner;
+    int refs;
+} RPCPayload;
+
+/*
+ * Wrap hex (inside block) with one reference held by the caller.
+ * Takes ownership of block on success; returns NULL (block untouched) on
+ * allocation failure.
+ */
+RPCPayload *rpc_payload_wrap(void *block, const char *hex, size_t len);
+
+/*
+ * Same, for hex inside an evbuffer's (contiguous) data, or for all of its
+ * data when hex is NULL. Takes ownership of owner on success.
+ */
+RPCPayload *rpc_payload_wrap_evbuffer(struct evbuffer *owner, const char *hex, size_t len);
+RPCPayload *rpc_payload_ref(RPCPayload *payload);
+void rpc_payload_unref(RPCPayload *payload);
+
+/*
+ * Coalesce async broadcasts: collect them per chain for window_ms (or
+ * until max_size are waiting) and send them as one JSON-RPC batch.
+ * window_ms = 0 or max_size < 2 disables it. Call after
+ * rpc_manager_init_async().
+ */
+void rpc_manager_set_batching(RPCManager *mgr, int window_ms, int max_size);
+
+/*
+ * Broadcast a transaction asynchronously. The request holds its own
+ * reference to hex until it completes. With batching on it is sent up to
+ * window_ms later, inside a batch with other broadcasts for the chain.
  * Callback fires when the RPC completes (or fails/times out).
  * Returns the RPCRequest handle (for cancellation), or NULL on error.
  */
 RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
-                                         const char *hex_tx,
+                                         RPCPayload *hex,
                                          RPCResultCallback callback,
                                          void *user_data);
 
+/*
+ * Request assembly, exposed for benchmarks.
+ * rpc_build_sendraw_body() returns a new evbuffer: a small JSON head, hex
+ * by reference, and the closing "]}" (NULL on allocation failure).
+ * rpc_write_http_request() writes the headers into one reserved segment
+ * of output and appends body by reference; body is left intact so it
+ * can be sent again. Returns 0 on success, -1 on failure.
+ */
+struct evbuffer *rpc_build_sendraw_body(RPCPayload *hex);
+int rpc_write_http_request(struct evbuffer *output, const RPCClient *client,
+                           struct evbuffer *body);
+
 /*
  * Cancel an in-flight async request.
  * The callback will NOT be fired after cancellation.
@@ -294,7 +471,7 @@ RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
 void rpc_request_cancel(RPCRequest *req);
 
 /*
- * Cancel all in-flight async requests.
+ * Cancel all in-flight async requests and close pooled connections.
  * Call during shutdown before destroying the event_base.
  */
 void rpc_manager_cancel_all(RPCManager *mgr);
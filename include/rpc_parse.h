@@ -0,0 +1,169 @@
+#ifndef RPC_PARSE_H
+#define RPC_PARSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Incremental JSON-RPC response parser.
+ *
+ * Consumes an HTTP/1.x response in whatever segments it arrives in
+ * (evbuffer chains, recv() reads) and keeps only what the caller needs:
+ * the HTTP status, the framing, and the JSON-RPC "result" value and
+ * "error" {code, message}. Nothing else of the reply is buffered, so
+ * memory use is constant whatever the response size.
+ *
+ * Framing: Content-Length, chunked transfer coding, or read-until-close.
+ * Parsing stops at the end of the message so pipelined bytes are left
+ * with the caller.
+ *
+ * The result is copied into a caller-supplied buffer: string results are
+ * unescaped without their quotes, anything else is kept as raw JSON text.
+ * Results longer than the buffer are truncated (result_truncated).
+ *
+ * Batch replies (a top-level array of reply objects) are accepted once
+ * rpc_json_expect_batch() is called: each reply is reported through the
+ * element callback, with its "id", and the reply fields are then reset
+ * for the next one.
+ */
+
+#define RPC_PARSE_LINE_MAX      256     /* Longer header lines are cut */
+#define RPC_PARSE_MESSAGE_LEN   256     /* error.message capture */
+#define RPC_PARSE_KEY_LEN       8       /* Longest key matched ("message") */
+
+typedef enum {
+    RPC_HTTP_STATUS_LINE,
+    RPC_HTTP_HEADERS,
+    RPC_HTTP_BODY,              /* Content-Length framed */
+    RPC_HTTP_CHUNK_SIZE,
+    RPC_HTTP_CHUNK_DATA,
+    RPC_HTTP_CHUNK_END,         /* CRLF after chunk data */
+    RPC_HTTP_TRAILERS,
+    RPC_HTTP_UNTIL_CLOSE,       /* No framing: body ends at EOF */
+    RPC_HTTP_DONE,
+    RPC_HTTP_ERROR
+} RPCHttpState;
+
+/* Which field the JSON value being scanned belongs to */
+typedef enum {
+    RPC_FIELD_NONE,
+    RPC_FIELD_RESULT,
+    RPC_FIELD_ERROR,            /* Top-level "error" that is not an object */
+    RPC_FIELD_ERROR_CODE,
+    RPC_FIELD_ERROR_MESSAGE,
+    RPC_FIELD_ID
+} RPCJsonField;
+
+typedef struct RPCJsonScanner RPCJsonScanner;
+
+/* One reply of a batch has been scanned; json holds its fields */
+typedef void (*RPCJsonElementCallback)(void *ctx, const RPCJsonScanner *json);
+
+struct RPCJsonScanner {
+    /* Output */
+    char *result;
+    size_t result_cap;
+    size_t result_len;
+    int has_result;
+    int result_truncated;
+    int has_error;              /* "error" present and not null */
+    int has_error_code;
+    long error_code;
+    char error_message[RPC_PARSE_MESSAGE_LEN];
+    size_t error_message_len;
+    int has_id;
+    uint64_t id;
+    int complete;               /* Top-level object (or batch array) closed */
+    int invalid;                /* Not a JSON object (or array of objects) */
+
+    /* Batch replies */
+    int batch;                  /* Accept a top-level array */
+    int array;                  /* Top level was an array */
+    int base;                   /* Depth above a reply object: 0, or 1 in an array */
+    int element_done;           /* Inside the element callback */
+    uint64_t elements;          /* Replies scanned */
+    RPCJsonElementCallback on_element;
+    void *element_ctx;
+
+    /* Scanner state */
+    int depth;
+    int error_depth;            /* Depth of the "error" object, 0 if none */
+    uint8_t is_object[4];       /* Container kind at depths 1 to 3 */
+    int want_key;
+    int in_string;
+    int string_is_key;
+    int escape;
+    int unicode_left;           /* Hex digits of a \u escape still to come */
+    unsigned unicode_value;
+    char key[RPC_PARSE_KEY_LEN];
+    size_t key_len;             /* > RPC_PARSE_KEY_LEN: no match possible */
+    RPCJsonField pending;       /* Field whose value comes next */
+    RPCJsonField field;         /* Field being captured */
+    int field_raw;              /* Capturing raw JSON (not string content) */
+    int field_depth;            /* Depth the captured container opened at */
+    int field_scalar;           /* Capturing a number/true/false/null */
+    char number[24];            /* error.code / id / "null" check */
+    size_t number_len;
+};
+
+typedef struct {
+    RPCHttpState state;
+    int status;                 /* HTTP status code, 0 until parsed */
+    int server_close;           /* HTTP/1.0, "Connection: close" or EOF-framed */
+    int chunked;
+    long content_length;        /* -1 = not given */
+    uint64_t remaining;         /* Body or chunk bytes left */
+    uint64_t bytes;             /* Response bytes consumed so far */
+    char line[RPC_PARSE_LINE_MAX];
+    size_t line_len;
+    RPCJsonScanner json;
+} RPCResponse;
+
+/*
+ * Prepare to parse one response. The result is written into
+ * result/result_cap (NUL-terminated, so result_cap must be > 0).
+ */
+void rpc_response_init(RPCResponse *resp, char *result, size_t result_cap);
+
+/*
+ * Feed the next len bytes. Returns how many were consumed (less than len
+ * only once the response is complete), or -1 if the framing is invalid.
+ */
+ssize_t rpc_response_feed(RPCResponse *resp, const char *data, size_t len);
+
+/*
+ * The connection reached EOF. Completes a read-until-close body.
+ * Returns 0 if the response is complete, -1 if it was cut short.
+ */
+int rpc_response_eof(RPCResponse *resp);
+
+static inline int rpc_response_done(const RPCResponse *resp)
+{
+    return resp->state == RPC_HTTP_DONE;
+}
+
+/*
+ * Standalone JSON scanning (a body already in memory).
+ */
+void rpc_json_init(RPCJsonScanner *json, char *result, size_t result_cap);
+void rpc_json_feed(RPCJsonScanner *json, const char *data, size_t len);
+
+/*
+ * Also accept a batch reply. Call after init, before feeding. A single
+ * reply object is still scanned as usual (e.g. an error for the whole
+ * batch); json->array tells which one arrived.
+ */
+void rpc_json_expect_batch(RPCJsonScanner *json, RPCJsonElementCallback on_element,
+                           void *ctx);
+
+/*
+ * Map the scanned JSON-RPC reply to an RPC_* status and message, the way
+ * callbacks report it: RPC_OK with the result, RPC_ERR_NODE with the
+ * node's message, or RPC_ERR_PARSE. Returns the status; *text points at
+ * the result buffer, the error message or a static string. For batches,
+ * call it from the element callback.
+ */
+int rpc_json_outcome(const RPCJsonScanner *json, const char **text, size_t *text_len);
+
+#endif /* RPC_PARSE_H */
@@ -0,0 +1,73 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * SHA-256 / double-SHA256 with runtime backend dispatch.
+ *
+ * Backends (best available is picked on first use):
+ *   SHANI  - Intel SHA extensions, one message at a time
+ *   AVX2   - 8-way multi-buffer: eight independent messages per pass;
+ *            only sha256d_batch() benefits, single messages use scalar
+ *   SCALAR - portable C
+ *
+ * Used for txid/wtxid computation; no OpenSSL dependency on this path.
+ */
+
+#define SHA256_DIGEST_LEN 32
+#define SHA256_BLOCK_LEN  64
+
+typedef enum {
+    SHA256_BACKEND_SCALAR,
+    SHA256_BACKEND_AVX2,
+    SHA256_BACKEND_SHANI,
+    SHA256_BACKEND_COUNT
+} SHA256Backend;
+
+/* Streaming context for messages split across buffers */
+typedef struct {
+    uint32_t state[8];
+    uint64_t bytes;
+    uint8_t buf[SHA256_BLOCK_LEN];
+    size_t buf_len;
+} SHA256Ctx;
+
+void sha256_init(SHA256Ctx *ctx);
+void sha256_update(SHA256Ctx *ctx, const void *data, size_t len);
+void sha256_final(SHA256Ctx *ctx, uint8_t out[SHA256_DIGEST_LEN]);
+
+/*
+ * out = SHA256(SHA256(data)).
+ */
+void sha256d(const void *data, size_t len, uint8_t out[SHA256_DIGEST_LEN]);
+
+/*
+ * Double-SHA256 of n independent messages: out[i] = sha256d(msgs[i]).
+ * The AVX2 backend hashes up to eight of them per pass.
+ */
+void sha256d_batch(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                   uint8_t (*out)[SHA256_DIGEST_LEN]);
+
+/*
+ * Backend selection. sha256_set_backend() is for benchmarks and returns
+ * -1 (leaving the current backend) if this CPU lacks the instructions.
+ */
+SHA256Backend sha256_backend(void);
+int sha256_backend_supported(SHA256Backend backend);
+int sha256_set_backend(SHA256Backend backend);
+const char *sha256_backend_name(SHA256Backend backend);
+
+/*
+ * Backend kernels (sha256_x86.c). state is a..h; blocks are 64 bytes.
+ * The 8-way kernel keeps state word-major: state[word][lane].
+ */
+extern const uint32_t sha256_k[64];
+
+#if defined(__x86_64__)
+void sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t nblocks);
+void sha256_block_avx2_8way(uint32_t state[8][8], const uint8_t *const blocks[8]);
+#endif
+
+#endif /* SHA256_H */
@@ -2,48 +2,253 @@
 #define STATIC_FILES_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 #include "config.h"
+#include "router.h"
+
+struct evbuffer;
+struct StaticFiles;
+
+/*
+ * Content codings a page can be sent in. Compressed variants are built
+ * once at load time (brotli only when built with HAVE_BROTLI).
+ */
+typedef enum {
+    STATIC_ENCODING_IDENTITY,
+    STATIC_ENCODING_GZIP,
+    STATIC_ENCODING_BROTLI,
+    STATIC_ENCODING_COUNT
+} StaticEncoding;
+
+/* Accept-Encoding bitmask, see static_accept_encodings() */
+#define STATIC_ACCEPT_GZIP      (1u << STATIC_ENCODING_GZIP)
+#define STATIC_ACCEPT_BROTLI    (1u << STATIC_ENCODING_BROTLI)
+
+#define STATIC_ETAG_LEN         32      /* "<16 hex>-gzip" with quotes */
+#define STATIC_IF_NONE_MATCH_MAX 128    /* If-None-Match kept per request */
+
+#define STATIC_MAX_ASSETS       1024
+#define STATIC_MAX_DEPTH        4       /* Subdirectory levels scanned */
 
 /*
- * Static file loaded into memory.
- * Content is heap-allocated and must be freed.
+ * Static file loaded into memory. In a mapped table the strings point
+ * into the read-only shared image; in a table from static_files_open()
+ * they are heap-allocated. Either way the owning table frees or unmaps
+ * them, never the caller.
  */
 typedef struct StaticFile {
     char *content;           /* File contents (null-terminated) */
     size_t length;           /* Content length in bytes */
     const char *content_type; /* MIME type for HTTP header */
+    int status_code;         /* Status the page is served with */
+    const char *status_text;
+    char *url;               /* Route path, NULL for role-only pages */
+    size_t url_len;
+    uint64_t requests;       /* Responses served (200 or 304) */
+    struct StaticFiles *owner; /* Table holding this file */
+
+    /* Precompressed variants; NULL if unavailable or not smaller */
+    char *encoded[STATIC_ENCODING_COUNT];
+    size_t encoded_length[STATIC_ENCODING_COUNT];
+
+    /*
+     * Validators: a strong ETag per variant (content hash plus coding)
+     * and the file's mtime for Last-Modified.
+     */
+    char etag[STATIC_ENCODING_COUNT][STATIC_ETAG_LEN];
+    time_t last_modified;
+    char last_modified_text[32];
+
+    /*
+     * Prebuilt HTTP/1.1 response heads, indexed [keep_alive][encoding],
+     * ending in "X-Request-ID: " so only the request ID is added per
+     * response. NULL for encodings without a variant. not_modified_head
+     * holds the matching 304 heads (200 pages only).
+     */
+    char *head[2][STATIC_ENCODING_COUNT];
+    size_t head_length[2][STATIC_ENCODING_COUNT];
+    char *not_modified_head[2][STATIC_ENCODING_COUNT];
+    size_t not_modified_head_length[2][STATIC_ENCODING_COUNT];
 } StaticFile;
 
 /*
- * Collection of all static files needed by the server.
- * Each worker loads its own copy (no locking needed).
+ * Every file under the static directory, and the route table that finds
+ * them. Normally the master builds the shared image (see below) and each
+ * worker maps it with static_files_map(): the bodies, variants and heads
+ * are shared read-only pages, and only this index, the route table and
+ * the counters are on the worker's heap, so no locking is needed. A worker
+ * that cannot map the image loads a private heap copy with
+ * static_files_open() instead.
+ *
+ * Tables are refcounted (static_files_ref/unref) so a reload can swap in
+ * a new one while responses still reference the old one's buffers: the
+ * worker holds one reference, and each buffer queued by
+ * static_file_write_response() holds another until it is sent. The last
+ * reference frees the table and unmaps its image.
+ *
+ * URLs: index.html is "/", other top-level pages drop ".html" ("/docs"),
+ * anything else keeps its relative path ("/js/app.js"). broadcast.html,
+ * result.html and error.html are served by role only, never by URL.
  */
 typedef struct StaticFiles {
-    StaticFile index;        /* index.html - home/welcome page */
-    StaticFile broadcast;    /* broadcast.html - raw tx submission */
-    StaticFile result;       /* result.html - txid status page */
-    StaticFile error;        /* error.html - error page */
-    StaticFile docs;         /* docs.html - API documentation */
-    StaticFile status;       /* status.html - system status */
-    StaticFile logos;        /* logos.html - logo showcase */
+    StaticFile *assets;
+    size_t count;
+    RouteTable routes;       /* Fixed endpoints plus asset URLs */
+    char cache_control[64];  /* Cache-Control value for assets */
+    unsigned refs;
+    void *image;             /* Shared image the files point into, NULL if heap */
+    size_t image_size;
+
+    /* Pages served by role (point into assets) */
+    StaticFile *index;       /* index.html - home/welcome page */
+    StaticFile *broadcast;   /* broadcast.html - raw tx submission */
+    StaticFile *result;      /* result.html - txid status page */
+    StaticFile *error;       /* error.html - error page */
+
+    /* Responses served, by the encoding chosen */
+    uint64_t responses[STATIC_ENCODING_COUNT];
+    uint64_t bytes_sent[STATIC_ENCODING_COUNT];
+    uint64_t bytes_saved;    /* Raw length minus bytes sent */
+    uint64_t not_modified;   /* 304 responses */
+    uint64_t not_modified_bytes; /* Body bytes the 304s did not send */
 } StaticFiles;
 
 /*
- * Load all static files from a directory.
- * Files are served as-is with no modification.
+ * Load all static files from a directory and its subdirectories (up to
+ * STATIC_MAX_DEPTH, skipping dotfiles) into a new table holding one
+ * reference. The content type comes from the file extension.
+ * broadcast.html, result.html and error.html must exist.
  *
- * @param files  Pointer to StaticFiles struct to populate
- * @param dir    Directory path (e.g., "./static")
- * @param config Config (reserved for future use)
- * @return 0 on success, -1 on error
+ * @param dir      Directory path (e.g., "./static")
+ * @param config   Config (cache_max_age for the prebuilt headers)
+ * @param previous Table being reloaded, or NULL: files whose bytes are
+ *                 unchanged copy its compressed variants instead of
+ *                 compressing again
+ * @return The table, or NULL on error
  */
-int static_files_load(StaticFiles *files, const char *dir, const Config *config);
+StaticFiles *static_files_open(const char *dir, const Config *config,
+                               const StaticFiles *previous);
+
+StaticFiles *static_files_ref(StaticFiles *files);
 
 /*
- * Free all loaded static files.
+ * Drop a reference; the last one frees the table and its files.
+ */
+void static_files_unref(StaticFiles *files);
+
+/*
+ * Shared asset image.
  *
- * @param files Pointer to StaticFiles struct to free
+ * The master loads the directory once and writes it into one read-only
+ * image (a sealed memfd, or an unlinked temporary file where memfd is
+ * unavailable) that every worker maps MAP_SHARED. Workers keep only the
+ * StaticFile index and route table on their heap; the bodies, variants
+ * and prebuilt heads stay in the shared pages, so worker RSS does not
+ * grow with the assets.
+ *
+ * Layout: a header, one fixed-size entry per asset (spans into the data
+ * area), then the data area starting page-aligned with every blob on a
+ * cache line. Strings are stored NUL-terminated.
+ */
+
+/*
+ * Write files into a new image. Returns its descriptor, -1 on error.
+ */
+int static_image_create(const StaticFiles *files);
+
+/*
+ * Map an image and index it. The table holds one reference and unmaps
+ * the image when the last one is dropped; fd may be closed afterwards.
+ * Returns NULL if the image is invalid or cannot be mapped.
+ */
+StaticFiles *static_files_map(int fd);
+
+/*
+ * Tell a worker about a new image over its channel (an AF_UNIX
+ * datagram socket): fd is passed with SCM_RIGHTS, or -1 to report
+ * a reload that failed. Never blocks. Returns 0 on success, -1 on error.
+ */
+int static_image_send(int channel, uint32_t generation, int fd);
+
+/*
+ * Receive one notice. Sets *fd to the image (caller closes it) or -1
+ * for a failed reload. Returns 1 if a notice was read, 0 if none is
+ * pending, -1 if the channel is closed or broken.
+ */
+int static_image_recv(int channel, uint32_t *generation, int *fd);
+
+/*
+ * Carry the response counters of a table being replaced over to its
+ * successor, per asset by URL, so reloads do not reset the metrics.
+ */
+void static_files_inherit_stats(StaticFiles *files, const StaticFiles *old);
+
+/*
+ * Route a request path (see route_request()) and pick the page to answer
+ * with: the asset for ROUTE_STATIC, or the broadcast/result/error page.
+ * Returns NULL for routes that are not served from static files.
+ */
+StaticFile *static_files_route(StaticFiles *files, const char *path, size_t path_len,
+                               RouteType *route);
+
+/*
+ * The page served for a route that did not come from the table (e.g. a
+ * streamed broadcast): broadcast/result/error page, NULL otherwise.
+ */
+StaticFile *static_files_page(StaticFiles *files, RouteType route);
+
+/*
+ * Find an asset by URL, NULL if there is none.
+ */
+StaticFile *static_files_find(StaticFiles *files, const char *url);
+
+/*
+ * Parse an Accept-Encoding value into STATIC_ACCEPT_* bits. Codings
+ * with q=0 are not accepted; "*" accepts any coding not listed.
+ */
+unsigned static_accept_encodings(const char *value, size_t len);
+
+/*
+ * Pick the smallest variant of file the client accepts.
+ * Sets *body and *len to the bytes to send. Returns the encoding; its
+ * Content-Encoding name is static_encoding_name() (NULL for identity).
+ */
+StaticEncoding static_file_select(const StaticFile *file, unsigned accepted,
+                                  const char **body, size_t *len);
+
+/*
+ * Parse an HTTP date (IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT").
+ * Returns -1 if it is not one.
+ */
+time_t static_parse_http_date(const char *value, size_t len);
+
+/*
+ * Conditional GET: true if the client's copy of the variant is current.
+ * if_none_match is the header value (NULL if absent) and takes precedence
+ * over if_modified_since (-1 if absent). Only 200 pages are conditional.
+ */
+bool static_file_not_modified(const StaticFile *file, StaticEncoding encoding,
+                              const char *if_none_match, time_t if_modified_since);
+
+/*
+ * Count a response for the static page metrics.
+ */
+void static_files_count(StaticFiles *files, StaticFile *file,
+                        StaticEncoding encoding, bool not_modified);
+
+const char *static_encoding_name(StaticEncoding encoding);
+
+/*
+ * Append the complete HTTP/1.1 response for file in the given encoding
+ * (a bodiless 304 if not_modified): the prebuilt head and the body are
+ * added by reference, only the request ID is copied. Each reference
+ * holds a reference on the file's table until the output drains it.
+ * Returns 0 on success, -1 on error.
  */
-void static_files_free(StaticFiles *files);
+int static_file_write_response(struct evbuffer *output, const StaticFile *file,
+                               StaticEncoding encoding, bool keep_alive,
+                               bool not_modified, const char *request_id);
 
 #endif /* STATIC_FILES_H */
@@ -0,0 +1,45 @@
+#ifndef STATIC_WATCH_H
+#define STATIC_WATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Static directory watcher (Linux inotify).
+ *
+ * Watches the static directory and its subdirectories (up to
+ * STATIC_MAX_DEPTH) for files being written, created, removed, renamed
+ * or touched. Changes are debounced: static_watch_poll() reports a change
+ * once the directory has been quiet for STATIC_WATCH_SETTLE_MS, so a
+ * deploy that copies many files triggers one reload, not one per file.
+ *
+ * The master polls the watch from its supervision loop; a forked builder
+ * rebuilds the shared static image and the master hands it to the
+ * workers. Subdirectories created
+ * later are picked up on the next settle.
+ */
+
+#define STATIC_WATCH_SETTLE_MS  200
+
+typedef struct StaticWatch {
+    int fd;                     /* inotify descriptor, -1 if not watching */
+    bool pending;               /* Changes seen, not yet settled */
+    uint64_t changed_ms;        /* Monotonic time of the last change */
+    char dir[256];
+} StaticWatch;
+
+/*
+ * Start watching dir.
+ * Returns 0 on success, -1 if inotify is unavailable (watch->fd is -1).
+ */
+int static_watch_open(StaticWatch *watch, const char *dir);
+
+/*
+ * Drain pending events without blocking.
+ * Returns true once a batch of changes has settled.
+ */
+bool static_watch_poll(StaticWatch *watch);
+
+void static_watch_close(StaticWatch *watch);
+
+#endif /* STATIC_WATCH_H */
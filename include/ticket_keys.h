@@ -0,0 +1,75 @@
+#ifndef TICKET_KEYS_H
+#define TICKET_KEYS_H
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * TicketKeys - TLS session ticket keys shared by every worker.
+ *
+ * OpenSSL gives each SSL_CTX its own random ticket keys, so a ticket
+ * issued by one worker is useless on the others, and with SO_REUSEPORT a
+ * returning client rarely lands on the same worker. Instead the master
+ * generates the keys into a MAP_SHARED anonymous mapping created in
+ * master_init(); every worker (including workers forked by
+ * master_reload() or crash restarts) inherits the same mapping, so a
+ * ticket resumes on any worker and across reloads.
+ *
+ * The master rotates on a schedule: the newest key encrypts new tickets,
+ * the TICKET_KEYS_KEPT - 1 before it still decrypt (and the ticket is
+ * renewed under the newest key). Only the master writes; workers copy a
+ * snapshot under a sequence counter (odd while a rotation is written).
+ */
+
+#define TICKET_KEYS_KEPT        3
+#define TICKET_KEY_NAME_LEN     16
+#define TICKET_KEY_SECRET_LEN   32
+
+typedef struct {
+    uint8_t name[TICKET_KEY_NAME_LEN];      /* Sent in the ticket to pick the key */
+    uint8_t aes_key[TICKET_KEY_SECRET_LEN]; /* AES-256-CBC */
+    uint8_t hmac_key[TICKET_KEY_SECRET_LEN];/* HMAC-SHA256 */
+    int64_t created;                        /* Wall clock */
+} TicketKey;
+
+/* Keys newest first; count is below TICKET_KEYS_KEPT until enough rotations */
+typedef struct {
+    TicketKey keys[TICKET_KEYS_KEPT];
+    uint32_t count;
+    uint32_t generation;                    /* Rotations so far */
+} TicketKeySet;
+
+typedef struct TicketKeys TicketKeys;
+
+/*
+ * Create the shared keys with a first key (master, before forking
+ * workers). Returns NULL on failure.
+ */
+TicketKeys *ticket_keys_create(void);
+
+/*
+ * Unmap the master's view only. Workers already forked keep theirs, so
+ * the keys must stay intact (keys turned off on reload).
+ */
+void ticket_keys_unmap(TicketKeys *keys);
+
+/*
+ * Wipe and unmap the keys. Only once no worker maps them any more
+ * (final shutdown): the mapping is shared, so this wipes it for all.
+ */
+void ticket_keys_destroy(TicketKeys *keys);
+
+/*
+ * Master: make a new key current if the current one is at least
+ * interval_sec old (0 = never rotate).
+ * Returns 1 if rotated, 0 if not due, -1 on error.
+ */
+int ticket_keys_rotate_if_due(TicketKeys *keys, int interval_sec, time_t now);
+
+/*
+ * Worker: copy the current keys into out.
+ * Returns 0 on success, -1 if a rotation kept the keys busy.
+ */
+int ticket_keys_snapshot(const TicketKeys *keys, TicketKeySet *out);
+
+#endif /* TICKET_KEYS_H */
@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 /*
@@ -15,6 +16,7 @@ struct ssl_ctx_st;
 typedef struct ssl_ctx_st SSL_CTX;
 struct ssl_st;
 typedef struct ssl_st SSL;
+struct TicketKeys;
 
 /*
  * TLS context - one per worker.
@@ -22,7 +24,10 @@ typedef struct ssl_st SSL;
 typedef struct TLSContext {
     SSL_CTX *ctx;           /* OpenSSL SSL_CTX */
     bool http2_enabled;     /* Enable HTTP/2 via ALPN */
+    bool ktls;              /* Kernel TLS requested and built into OpenSSL */
     time_t cert_expiry;     /* Certificate expiry timestamp */
+    struct TicketKeys *ticket_keys;     /* Shared ticket keys (NULL = per-worker) */
+    uint64_t ticket_unknown_key;        /* Tickets whose key rotated out or was foreign */
 } TLSContext;
 
 /*
@@ -33,10 +38,11 @@ time_t tls_get_cert_expiry(TLSContext *tls);
 
 /*
  * Initialize TLS context with certificate and key files.
- * Sets up ALPN callback for h2/http1.1 negotiation.
+ * Sets up ALPN callback for h2/http1.1 negotiation, and session tickets
+ * under ticket_keys when not NULL (kept across tls_context_reload()).
  * Returns 0 on success, -1 on error.
  */
-int tls_context_init(TLSContext *tls, const Config *config);
+int tls_context_init(TLSContext *tls, const Config *config, struct TicketKeys *ticket_keys);
 
 /*
  * Free TLS context resources.
@@ -60,6 +66,13 @@ const char *tls_get_alpn_protocol(SSL *ssl);
  */
 bool tls_is_http2(SSL *ssl);
 
+/*
+ * Check if the kernel encrypts this connection's outgoing records (kTLS).
+ * Only meaningful once the handshake is done; then SSL_write() hands
+ * plaintext straight to the socket.
+ */
+bool tls_ktls_send_active(SSL *ssl);
+
 /*
  * Reload TLS certificate and key from config paths.
  * Used for ACME certificate renewal (SIGUSR2 trigger).
@@ -0,0 +1,100 @@
+#ifndef TLS_OFFLOAD_H
+#define TLS_OFFLOAD_H
+
+#include "tls.h"
+#include "buffer.h"
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <event2/event.h>
+
+/*
+ * TLSOffload - per-worker TLS handshake threads.
+ *
+ * A handshake costs an ECDHE key exchange and a certificate signature,
+ * about a millisecond of CPU; a burst of new clients done on the event
+ * loop stalls every open connection of the worker behind them. With
+ * [tls] handshake_threads > 0, tls_accept_cb() hands the accepted fd and
+ * its SSL to one of the worker's handshake threads instead. Each thread
+ * drives many handshakes at once (non-blocking SSL_do_handshake() under
+ * poll()), so a slow client costs a slot, not a thread. Finished
+ * handshakes come back to the event loop over a pipe and become
+ * connections in the already-open state.
+ *
+ * Threading: a handshake's SSL and fd belong to one thread at a time,
+ * handed over under the thread's or pool's mutex. Only the event loop
+ * thread touches TLSHandshake allocation, the worker and connections;
+ * handshake threads run OpenSSL and nothing else of ours (the SSL_CTX
+ * callbacks must stay thread-safe).
+ */
+
+#define TLS_OFFLOAD_MAX_THREADS     16
+#define TLS_OFFLOAD_DEFAULT_QUEUE   256     /* Handshakes in flight per thread */
+
+typedef struct TLSHandshake {
+    struct TLSHandshake *next;
+    int fd;
+    SSL *ssl;
+    struct sockaddr_storage addr;
+    int socklen;
+    struct timespec started;            /* Accept time (CLOCK_MONOTONIC) */
+    struct timespec deadline;           /* Give up (handshake timeout) */
+    double duration_sec;                /* Accept to handshake done or failed */
+    short want;                         /* POLLIN/POLLOUT the handshake waits for */
+    bool ok;                            /* Handshake completed */
+    bool tls_error;                     /* Failed on a TLS alert/protocol error */
+} TLSHandshake;
+
+/*
+ * Called on the event loop for each finished handshake. Takes ownership
+ * of hs->fd and hs->ssl (whether or not hs->ok); hs itself is freed by
+ * the pool after the call.
+ */
+typedef void (*TLSOffloadDoneFn)(TLSHandshake *hs, void *arg);
+
+struct TLSOffloadThread;
+
+typedef struct TLSOffload {
+    int num_threads;
+    int queue_max;                      /* Per thread */
+    int timeout_sec;
+    struct TLSOffloadThread *threads;
+    unsigned next_thread;
+
+    /* Finished handshakes, handed back to the event loop */
+    pthread_mutex_t done_lock;
+    TLSHandshake *done_head;
+    TLSHandshake *done_tail;
+    int done_pipe[2];
+    struct event *done_event;
+    TLSOffloadDoneFn done_fn;
+    void *done_arg;
+
+    SlabPool handshakes;                /* Event loop thread only */
+    int in_flight;
+} TLSOffload;
+
+/*
+ * Start num_threads handshake threads for a worker. Handshakes not done
+ * within timeout_sec fail. Returns 0 on success, -1 on error (nothing
+ * left running).
+ */
+int tls_offload_init(TLSOffload *pool, struct event_base *base, int num_threads,
+                     int queue_max, int timeout_sec, TLSOffloadDoneFn done_fn, void *arg);
+
+/*
+ * Hand an accepted connection's handshake to a thread. On success the
+ * pool owns fd and ssl until done_fn. Returns -1 when every thread's
+ * queue is full (the caller handshakes on the event loop as before).
+ */
+int tls_offload_submit(TLSOffload *pool, int fd, SSL *ssl,
+                       const struct sockaddr *addr, int socklen);
+
+/*
+ * Stop and join the threads. Handshakes still in flight are reported
+ * to done_fn as failed, so the caller releases what it holds for them.
+ */
+void tls_offload_shutdown(TLSOffload *pool);
+
+#endif /* TLS_OFFLOAD_H */
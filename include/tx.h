@@ -0,0 +1,49 @@
+#ifndef TX_H
+#define TX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bitcoin transaction helpers.
+ *
+ * Just enough parsing to locate the witness data so the txid can be
+ * computed from the legacy (witness-stripped) serialization:
+ *
+ *   txid  = SHA256d(version || inputs || outputs || locktime)
+ *   wtxid = SHA256d(full serialization including marker/flag/witness)
+ *
+ * Hashing uses the native sha256 engine (SHA-NI / AVX2 / scalar).
+ * Hashes are produced in internal byte order; the familiar display form
+ * is the byte-reversed hex string (see tx_txid_to_hex).
+ */
+
+#define TX_HASH_LEN     32
+#define TX_HASH_HEX_LEN 64
+
+/*
+ * Compute the txid of a serialized transaction.
+ *
+ * @param raw  Serialized transaction bytes
+ * @param len  Length of raw
+ * @param txid Output hash (internal byte order)
+ * @return 0 on success, -1 if raw is not a well-formed transaction
+ */
+int tx_compute_txid(const uint8_t *raw, size_t len, uint8_t txid[TX_HASH_LEN]);
+
+/*
+ * Compute txid and wtxid in one parse. wtxid may be NULL.
+ * For non-segwit transactions both are the same.
+ *
+ * @return 0 on success, -1 if raw is not a well-formed transaction
+ */
+int tx_compute_ids(const uint8_t *raw, size_t len, uint8_t txid[TX_HASH_LEN],
+                   uint8_t wtxid[TX_HASH_LEN]);
+
+/*
+ * Format a hash in display order (byte-reversed, lowercase hex).
+ * out must hold TX_HASH_HEX_LEN + 1 bytes.
+ */
+void tx_txid_to_hex(const uint8_t txid[TX_HASH_LEN], char *out);
+
+#endif /* TX_H */
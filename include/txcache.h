@@ -0,0 +1,77 @@
+#ifndef TXCACHE_H
+#define TXCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * TxCache - cross-worker broadcast dedup cache.
+ *
+ * A fixed-size open-addressing table in a MAP_SHARED anonymous mapping.
+ * The master creates it once in master_init(); every worker (including
+ * workers forked by master_reload() or crash restarts) inherits the same
+ * mapping, so its contents survive reloads.
+ *
+ * Keyed by the 32-byte txid, each slot holds the last broadcast outcome.
+ * Workers consult it before calling the node so a transaction resubmitted
+ * to a different worker is answered without another sendrawtransaction.
+ *
+ * Lock-free: each slot carries a sequence counter (odd while being
+ * written). Writers claim a slot with a CAS and skip slots other writers
+ * hold; readers treat a slot that changed under them as a miss.
+ */
+
+#define TXCACHE_SLOTS           8192    /* Power of 2 */
+#define TXCACHE_PROBE_LIMIT     16      /* Max linear probe distance */
+#define TXCACHE_MAX_ENDPOINTS   4       /* One per chain */
+#define TXCACHE_ERROR_LEN       96
+#define TXCACHE_ACCEPTED_TTL_SEC 3600   /* Accepted: resubmits are pointless */
+#define TXCACHE_REJECTED_TTL_SEC 60     /* Rejected: may become valid later */
+
+typedef struct {
+    uint8_t chain;                      /* BitcoinChain */
+    int8_t status;                      /* RPC_OK or RPC_ERR_* */
+    uint16_t reserved;
+    uint32_t time_ms;
+    char error[TXCACHE_ERROR_LEN];
+} TxCacheEndpoint;
+
+typedef struct {
+    uint8_t txid[32];                   /* Internal byte order */
+    uint8_t wtxid[32];
+    int64_t stored_at;                  /* Wall clock of the broadcast */
+    uint32_t processing_time_ms;
+    uint8_t attempted;
+    uint8_t accepted;
+    uint16_t reserved;
+    TxCacheEndpoint endpoints[TXCACHE_MAX_ENDPOINTS];
+} TxCacheRecord;
+
+typedef struct TxCache TxCache;
+
+/*
+ * Create the shared table (master, before forking workers).
+ * Returns NULL on failure.
+ */
+TxCache *txcache_create(void);
+
+/*
+ * Unmap the table (master cleanup).
+ */
+void txcache_destroy(TxCache *cache);
+
+/*
+ * Look up a txid. Copies the record into out and returns 1 if present
+ * and not expired, 0 otherwise.
+ */
+int txcache_lookup(TxCache *cache, const uint8_t txid[32], TxCacheRecord *out);
+
+/*
+ * Insert or replace the record for rec->txid.
+ * Returns 1 if a live entry for another txid was evicted, 0 if stored
+ * without eviction, -1 if every probed slot was busy (not stored).
+ */
+int txcache_store(TxCache *cache, const TxCacheRecord *rec);
+
+#endif /* TXCACHE_H */
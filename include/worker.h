@@ -7,7 +7,11 @@
 #include "rate_limiter.h"
 #include "ip_acl.h"
 #include "tls.h"
+#include "ticket_keys.h"
+#include "tls_offload.h"
 #include "rpc.h"
+#include "broadcast.h"
+#include "buffer.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <event2/event.h>
@@ -26,6 +30,13 @@
 /* Forward declaration */
 struct Connection;
 
+#define TLS_HANDSHAKE_BUCKETS   9   /* le 1ms, 2.5ms, 5ms, 10ms, 25ms, 50ms, 100ms, 500ms, +Inf */
+#define LOOP_LAG_BUCKETS        8   /* le 1ms, 5ms, 10ms, 25ms, 50ms, 100ms, 500ms, +Inf */
+
+/* Event loop lag probe period: an idle worker wakes 10 times a second for
+ * it, and lateness is measured exactly whatever the period */
+#define LOOP_PROBE_INTERVAL_MS  100
+
 typedef struct WorkerProcess {
     /* Identity */
     int worker_id;
@@ -39,8 +50,15 @@ typedef struct WorkerProcess {
     /* Configuration (read-only after init) */
     Config *config;
 
-    /* Static files (loaded per-worker, no locks needed) */
-    StaticFiles static_files;
+    /* Static files (the master's image, mapped read-only, no locks
+     * needed). Swapped whole when the master sends a new image over
+     * static_channel; responses in flight keep a reference. */
+    StaticFiles *static_files;
+    int static_channel;                 /* -1 if none */
+    struct event *static_channel_event;
+    uint32_t static_generation;
+    uint64_t static_reloads;
+    uint64_t static_reload_failures;
 
     /* Slot manager (per-worker connection limits) */
     SlotManager slots;
@@ -54,9 +72,24 @@ typedef struct WorkerProcess {
     /* TLS context (per-worker, used for TLS connections) */
     TLSContext tls;
 
+    /* Handshake threads (num_threads 0 = handshakes on the event loop) */
+    TLSOffload tls_offload;
+
     /* RPC manager for Bitcoin node connections (Phase 13c) */
     RPCManager rpc;
 
+    /* Broadcast results keyed by txid (per-worker, no locks needed) */
+    BroadcastStore broadcasts;
+
+    /* Decode buffers for huge-tier transactions (per-worker, no locks needed) */
+    BufferPool tx_buffers;
+
+    /* Slab pools for per-connection and per-stream objects (per-worker,
+     * no locks needed) */
+    SlabPool conn_pool;
+    SlabPool h2_conn_pool;
+    SlabPool h2_stream_pool;
+
     /* State flags */
     volatile bool draining;
     bool listener_disabled;
@@ -90,11 +123,13 @@ typedef struct WorkerProcess {
 
     /* Status code counters (Phase 5) */
     uint64_t status_2xx;               /* 200-299 */
+    uint64_t status_3xx;               /* 300-399 */
     uint64_t status_4xx;               /* 400-499 */
     uint64_t status_5xx;               /* 500-599 */
 
     /* Specific status codes for detailed metrics */
     uint64_t status_200;
+    uint64_t status_304;               /* Not modified */
     uint64_t status_400;
     uint64_t status_404;
     uint64_t status_408;               /* Timeout */
@@ -111,12 +146,30 @@ typedef struct WorkerProcess {
     uint64_t tls_handshake_errors;
     uint64_t tls_protocol_tls12;
     uint64_t tls_protocol_tls13;
+    uint64_t tls_resumptions;       /* Handshakes that resumed a session */
+    uint64_t tls_ktls_offloaded;    /* Handshakes whose records the kernel encrypts */
+    uint64_t tls_ktls_fallbacks;    /* kTLS on but refused (cipher, no tls module) */
+    uint64_t tls_handshakes_offloaded;  /* Handshakes done on a handshake thread */
+    uint64_t tls_offload_overflows;     /* Done on the event loop: every thread full */
+    uint64_t tls_handshake_buckets[TLS_HANDSHAKE_BUCKETS];  /* Accept to handshake done */
+    double tls_handshake_sum_seconds;
+    uint64_t tls_handshake_count;
+
+    /* Event loop lag: how late a 100ms timer fires, i.e. how long the
+     * loop was busy in one go (handshakes, large responses...) */
+    struct event *loop_probe_event;
+    struct timespec loop_probe_last;
+    uint64_t loop_lag_buckets[LOOP_LAG_BUCKETS];
+    double loop_lag_sum_seconds;
+    uint64_t loop_lag_count;
 
     /* HTTP/2 metrics (Phase 5) */
     uint64_t h2_streams_total;
     int h2_streams_active;
     uint64_t h2_rst_stream_total;
     uint64_t h2_goaway_sent;
+    uint64_t h2_header_arena_overflows;  /* Streams whose header strings spilled to malloc */
+    uint64_t h2_input_yields;           /* Reads that left input past H2_INPUT_BUDGET */
 
     /* Error type counters (Phase 5) */
     uint64_t errors_timeout;
@@ -129,12 +182,8 @@ typedef struct WorkerProcess {
     uint64_t endpoint_alive;
     uint64_t endpoint_version;
     uint64_t endpoint_metrics;
-    uint64_t endpoint_home;
     uint64_t endpoint_broadcast;
     uint64_t endpoint_result;
-    uint64_t endpoint_docs;
-    uint64_t endpoint_status;
-    uint64_t endpoint_logos;
     uint64_t endpoint_acme;
 
     /* Extended metrics */
@@ -142,6 +191,8 @@ typedef struct WorkerProcess {
     uint64_t slowloris_kills;            /* Slowloris detections */
     uint64_t slot_promotion_failures;    /* Tier promotion failures (no slots) */
     uint64_t keepalive_reuses;           /* Requests served on reused connections */
+    uint64_t requests_pipelined;         /* Requests parsed before the previous response drained */
+    uint64_t tx_streamed;                /* Huge-tier txs decoded while arriving */
 
     /* Active connections list (intrusive linked list) */
     struct Connection *connections;
@@ -157,9 +208,16 @@ typedef struct WorkerProcess {
 /*
  * Worker main entry point.
  * Called after fork() in child process.
+ * tx_cache is the master's shared dedup table (may be NULL).
+ * ticket_keys are the master's shared TLS session ticket keys (NULL:
+ * OpenSSL's per-worker keys).
+ * static_image_fd is the master's static image (mapped, then closed; -1
+ * or unusable: the worker loads static_dir itself). static_channel
+ * delivers rebuilt images (-1: no hot reload).
  * Does not return (calls exit()).
  */
-void worker_main(int worker_id, Config *config);
+void worker_main(int worker_id, Config *config, TxCache *tx_cache,
+                 TicketKeys *ticket_keys, int static_image_fd, int static_channel);
 
 /*
  * Get number of available CPUs.
@@ -0,0 +1,606 @@
+/*
+ * Server-side broadcast pipeline and per-worker result table.
+ *
+ * Each worker owns its table (no locking). Entries are chained in hash
+ * buckets for lookup and in an age list for TTL expiry and eviction.
+ * Entries with RPCs still in flight are never evicted; the RPC timeout
+ * bounds how long that can be.
+ *
+ * Before calling the node, a new txid is checked against the shared
+ * TxCache; completed node answers are published back to it.
+ */
+
+#include "broadcast.h"
+#include "hex.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <event2/buffer.h>
+
+/*
+ * Bucket hash: txids are uniformly distributed, so the leading 32 bits
+ * of the display hex are a good enough hash.
+ */
+static uint32_t broadcast_hash(const char *txid)
+{
+    uint8_t prefix[4];
+    hex_decode(txid, 8, prefix);
+    return ((uint32_t)prefix[0] << 24) | ((uint32_t)prefix[1] << 16) |
+           ((uint32_t)prefix[2] << 8) | prefix[3];
+}
+
+static uint32_t elapsed_ms(const struct timespec *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double ms = (now.tv_sec - since->tv_sec) * 1000.0 +
+                (now.tv_nsec - since->tv_nsec) / 1e6;
+    return ms > 0 ? (uint32_t)ms : 0;
+}
+
+int broadcast_store_init(BroadcastStore *store, RPCManager *rpc, BitcoinChain chain,
+                         TxCache *shared)
+{
+    memset(store, 0, sizeof(BroadcastStore));
+
+    store->buckets = calloc(BROADCAST_STORE_BUCKETS, sizeof(BroadcastEntry *));
+    if (!store->buckets) {
+        log_error("Broadcast: failed to allocate result table");
+        return -1;
+    }
+
+    store->rpc = rpc;
+    store->chain = chain;
+    store->shared = shared;
+    return 0;
+}
+
+/*
+ * Unlink an entry from its bucket and the age list, then free it.
+ * Any remaining waiters are detached (their owners see entry == NULL).
+ */
+static void broadcast_entry_remove(BroadcastStore *store, BroadcastEntry *entry)
+{
+    BroadcastEntry **pp = &store->buckets[entry->hash & (BROADCAST_STORE_BUCKETS - 1)];
+    while (*pp && *pp != entry) {
+        pp = &(*pp)->hash_next;
+    }
+    if (*pp) {
+        *pp = entry->hash_next;
+    }
+
+    if (entry->age_prev) {
+        entry->age_prev->age_next = entry->age_next;
+    } else {
+        store->oldest = entry->age_next;
+    }
+    if (entry->age_next) {
+        entry->age_next->age_prev = entry->age_prev;
+    } else {
+        store->newest = entry->age_prev;
+    }
+
+    while (entry->waiters) {
+        BroadcastWaiter *w = entry->waiters;
+        entry->waiters = w->next;
+        w->entry = NULL;
+        w->next = NULL;
+        w->prev = NULL;
+    }
+
+    store->count--;
+    free(entry);
+}
+
+void broadcast_store_free(BroadcastStore *store)
+{
+    while (store->oldest) {
+        broadcast_entry_remove(store, store->oldest);
+    }
+    free(store->buckets);
+    store->buckets = NULL;
+}
+
+static int broadcast_entry_expired(const BroadcastEntry *entry, time_t now)
+{
+    return entry->pending == 0 && now - entry->created >= BROADCAST_RESULT_TTL_SEC;
+}
+
+void broadcast_store_expire(BroadcastStore *store)
+{
+    time_t now = time(NULL);
+
+    while (store->oldest && broadcast_entry_expired(store->oldest, now)) {
+        broadcast_entry_remove(store, store->oldest);
+        store->expired++;
+    }
+}
+
+BroadcastEntry *broadcast_lookup(BroadcastStore *store, const char *txid, size_t len)
+{
+    char key[TX_HASH_HEX_LEN + 1];
+
+    if (len != TX_HASH_HEX_LEN || !store->buckets) {
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        key[i] = (char)tolower((unsigned char)txid[i]);
+    }
+    key[len] = '\0';
+
+    uint32_t hash = broadcast_hash(key);
+    BroadcastEntry *entry = store->buckets[hash & (BROADCAST_STORE_BUCKETS - 1)];
+    while (entry) {
+        if (entry->hash == hash && memcmp(entry->txid, key, TX_HASH_HEX_LEN) == 0) {
+            if (broadcast_entry_expired(entry, time(NULL))) {
+                broadcast_entry_remove(store, entry);
+                store->expired++;
+                return NULL;
+            }
+            return entry;
+        }
+        entry = entry->hash_next;
+    }
+    return NULL;
+}
+
+void broadcast_wait(BroadcastEntry *entry, BroadcastWaiter *waiter)
+{
+    waiter->entry = entry;
+    waiter->prev = NULL;
+    waiter->next = entry->waiters;
+    if (entry->waiters) {
+        entry->waiters->prev = waiter;
+    }
+    entry->waiters = waiter;
+}
+
+void broadcast_wait_cancel(BroadcastWaiter *waiter)
+{
+    BroadcastEntry *entry = waiter->entry;
+    if (!entry) return;
+
+    if (waiter->prev) {
+        waiter->prev->next = waiter->next;
+    } else {
+        entry->waiters = waiter->next;
+    }
+    if (waiter->next) {
+        waiter->next->prev = waiter->prev;
+    }
+    waiter->entry = NULL;
+    waiter->next = NULL;
+    waiter->prev = NULL;
+}
+
+/*
+ * Publish a completed outcome to the shared cache. Only answers the
+ * node actually gave are shared; transport failures (connect, timeout,
+ * auth) are worth retrying from any worker.
+ */
+static void broadcast_entry_publish(BroadcastEntry *entry)
+{
+    BroadcastStore *store = entry->store;
+    TxCacheRecord rec;
+
+    if (!store->shared || entry->attempted == 0) {
+        return;
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    memcpy(rec.txid, entry->raw_txid, sizeof(rec.txid));
+    memcpy(rec.wtxid, entry->raw_wtxid, sizeof(rec.wtxid));
+    rec.stored_at = entry->created;
+    rec.processing_time_ms = entry->processing_time_ms;
+    rec.attempted = (uint8_t)entry->attempted;
+    rec.accepted = (uint8_t)entry->accepted;
+
+    for (int i = 0; i < entry->attempted; i++) {
+        const BroadcastEndpoint *ep = &entry->endpoints[i];
+        if (ep->status != RPC_OK && ep->status != RPC_ERR_NODE) {
+            return;
+        }
+        rec.endpoints[i].chain = (uint8_t)ep->chain;
+        rec.endpoints[i].status = (int8_t)ep->status;
+        rec.endpoints[i].time_ms = ep->time_ms;
+        snprintf(rec.endpoints[i].error, sizeof(rec.endpoints[i].error), "%s", ep->error);
+    }
+
+    if (txcache_store(store->shared, &rec) == 1) {
+        store->shared_evictions++;
+    }
+}
+
+/*
+ * All endpoints answered: record timing and release parked requests.
+ */
+static void broadcast_entry_finish(BroadcastEntry *entry)
+{
+    entry->processing_time_ms = elapsed_ms(&entry->started);
+
+    log_debug("Broadcast %s: %d/%d accepted in %ums", entry->txid,
+              entry->accepted, entry->attempted, entry->processing_time_ms);
+
+    broadcast_entry_publish(entry);
+
+    while (entry->waiters) {
+        BroadcastWaiter *w = entry->waiters;
+        entry->waiters = w->next;
+        if (entry->waiters) {
+            entry->waiters->prev = NULL;
+        }
+        w->entry = NULL;
+        w->next = NULL;
+        w->prev = NULL;
+        w->on_done(w, entry);
+    }
+}
+
+/*
+ * sendrawtransaction completion for one endpoint.
+ */
+static void broadcast_rpc_cb(int status, const char *result,
+                             size_t result_len, void *user_data)
+{
+    BroadcastEndpoint *ep = user_data;
+    BroadcastEntry *entry = ep->entry;
+
+    ep->done = 1;
+    ep->req = NULL;
+    ep->status = status;
+    ep->time_ms = elapsed_ms(&entry->started);
+
+    if (status == RPC_OK) {
+        entry->accepted++;
+        if (result_len != TX_HASH_HEX_LEN ||
+            strncasecmp(result, entry->txid, TX_HASH_HEX_LEN) != 0) {
+            log_warn("Broadcast %s: node %s returned txid %.*s", entry->txid,
+                     ep->name, (int)(result_len < 64 ? result_len : 64), result);
+        }
+    } else {
+        size_t n = result_len < sizeof(ep->error) - 1 ? result_len : sizeof(ep->error) - 1;
+        memcpy(ep->error, result, n);
+        ep->error[n] = '\0';
+    }
+
+    if (--entry->pending == 0) {
+        broadcast_entry_finish(entry);
+    }
+}
+
+/*
+ * Make room for one more entry by evicting the oldest completed one.
+ */
+static void broadcast_store_make_room(BroadcastStore *store)
+{
+    broadcast_store_expire(store);
+
+    BroadcastEntry *entry = store->oldest;
+    while (store->count >= BROADCAST_STORE_MAX && entry) {
+        BroadcastEntry *next = entry->age_next;
+        if (entry->pending == 0) {
+            broadcast_entry_remove(store, entry);
+            store->expired++;
+        }
+        entry = next;
+    }
+}
+
+/*
+ * A resubmission is broadcast again, rather than answered from memory,
+ * when nothing accepted the transaction and either a node could not be
+ * reached or the rejection is old enough that it may no longer hold.
+ */
+static int broadcast_entry_retryable(const BroadcastEntry *entry)
+{
+    if (entry->pending > 0 || entry->accepted > 0) {
+        return 0;
+    }
+    if (time(NULL) - entry->created >= TXCACHE_REJECTED_TTL_SEC) {
+        return 1;
+    }
+    for (int i = 0; i < entry->attempted; i++) {
+        if (entry->endpoints[i].status != RPC_ERR_NODE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Allocate an entry and link it into the table as the newest.
+ */
+static BroadcastEntry *broadcast_entry_new(BroadcastStore *store,
+                                           const uint8_t raw_txid[TX_HASH_LEN],
+                                           const uint8_t raw_wtxid[TX_HASH_LEN],
+                                           const char *txid)
+{
+    broadcast_store_make_room(store);
+
+    BroadcastEntry *entry = calloc(1, sizeof(BroadcastEntry));
+    if (!entry) {
+        return NULL;
+    }
+
+    memcpy(entry->txid, txid, TX_HASH_HEX_LEN + 1);
+    memcpy(entry->raw_txid, raw_txid, TX_HASH_LEN);
+    memcpy(entry->raw_wtxid, raw_wtxid, TX_HASH_LEN);
+    tx_txid_to_hex(raw_wtxid, entry->wtxid);
+    entry->hash = broadcast_hash(txid);
+    entry->store = store;
+    entry->created = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &entry->started);
+
+    BroadcastEntry **bucket = &store->buckets[entry->hash & (BROADCAST_STORE_BUCKETS - 1)];
+    entry->hash_next = *bucket;
+    *bucket = entry;
+
+    entry->age_prev = store->newest;
+    if (store->newest) {
+        store->newest->age_next = entry;
+    } else {
+        store->oldest = entry;
+    }
+    store->newest = entry;
+    store->count++;
+    return entry;
+}
+
+/*
+ * Materialize a completed local entry from a shared cache record so
+ * /tx/{txid} on this worker answers like the worker that broadcast it.
+ */
+static void broadcast_entry_from_record(BroadcastStore *store, const TxCacheRecord *rec,
+                                        const char *txid)
+{
+    BroadcastEntry *entry = broadcast_entry_new(store, rec->txid, rec->wtxid, txid);
+    if (!entry) {
+        return;
+    }
+
+    entry->created = (time_t)rec->stored_at;
+    entry->processing_time_ms = rec->processing_time_ms;
+    entry->attempted = rec->attempted;
+    entry->accepted = rec->accepted;
+
+    for (int i = 0; i < entry->attempted && i < BROADCAST_MAX_ENDPOINTS; i++) {
+        BroadcastEndpoint *ep = &entry->endpoints[i];
+        ep->chain = (BitcoinChain)rec->endpoints[i].chain;
+        ep->name = network_chain_to_string(ep->chain);
+        ep->done = 1;
+        ep->status = rec->endpoints[i].status;
+        ep->time_ms = rec->endpoints[i].time_ms;
+        ep->entry = entry;
+        snprintf(ep->error, sizeof(ep->error), "%s", rec->endpoints[i].error);
+    }
+}
+
+/*
+ * Shared body of broadcast_submit() and broadcast_submit_raw().
+ * hex is raw's hex form; every endpoint's request references it.
+ */
+static int broadcast_start(BroadcastStore *store, const uint8_t *raw, size_t raw_len,
+                           RPCPayload *hex, char *txid_out)
+{
+    uint8_t hash[TX_HASH_LEN];
+    uint8_t whash[TX_HASH_LEN];
+    char txid[TX_HASH_HEX_LEN + 1];
+
+    if (tx_compute_ids(raw, raw_len, hash, whash) < 0) {
+        store->invalid++;
+        return -1;
+    }
+
+    tx_txid_to_hex(hash, txid);
+    if (txid_out) {
+        memcpy(txid_out, txid, sizeof(txid));
+    }
+
+    BroadcastEntry *known = broadcast_lookup(store, txid, TX_HASH_HEX_LEN);
+    if (known) {
+        if (!broadcast_entry_retryable(known)) {
+            store->duplicates++;
+            return 1;
+        }
+        broadcast_entry_remove(store, known);
+    }
+
+    /* Another worker may already have the answer */
+    if (store->shared) {
+        TxCacheRecord rec;
+        if (txcache_lookup(store->shared, hash, &rec)) {
+            store->shared_hits++;
+            store->duplicates++;
+            broadcast_entry_from_record(store, &rec, txid);
+            return 1;
+        }
+        store->shared_misses++;
+    }
+
+    BroadcastEntry *entry = broadcast_entry_new(store, hash, whash, txid);
+    if (!entry) {
+        return -1;
+    }
+    store->submitted++;
+
+    /* Single-chain mode uses its own node; mixed mode tries every node */
+    BitcoinChain chains[BROADCAST_MAX_ENDPOINTS];
+    int n = 0;
+    if (store->chain == CHAIN_MIXED) {
+        for (int c = CHAIN_MAINNET; c <= CHAIN_REGTEST; c++) {
+            if (rpc_manager_get_client(store->rpc, (BitcoinChain)c)) {
+                chains[n++] = (BitcoinChain)c;
+            }
+        }
+    } else {
+        chains[n++] = store->chain;
+    }
+
+    entry->attempted = n;
+    entry->pending = n;
+    for (int i = 0; i < n; i++) {
+        BroadcastEndpoint *ep = &entry->endpoints[i];
+        ep->chain = chains[i];
+        ep->name = network_chain_to_string(chains[i]);
+        ep->entry = entry;
+    }
+
+    /* Callbacks may fire synchronously on immediate failure */
+    for (int i = 0; i < n; i++) {
+        BroadcastEndpoint *ep = &entry->endpoints[i];
+        RPCRequest *req = rpc_manager_broadcast_async(store->rpc, chains[i], hex,
+                                                      broadcast_rpc_cb, ep);
+        if (!ep->done) {
+            ep->req = req;
+        }
+    }
+
+    if (n == 0) {
+        broadcast_entry_finish(entry);
+    }
+
+    log_debug("Broadcast %s (wtxid %s): submitted to %d endpoint(s)",
+              txid, entry->wtxid, n);
+    return 0;
+}
+
+int broadcast_submit(BroadcastStore *store, RPCPayload *hex, char *txid_out)
+{
+    if (!store->buckets || !hex) {
+        return -1;
+    }
+
+    /* Decode once for the txid; the hex itself is what goes to the node */
+    uint8_t *raw = malloc(hex->len / 2 + 1);
+    if (!raw) {
+        return -1;
+    }
+    if (hex_decode(hex->hex, hex->len, raw) < 0) {
+        free(raw);
+        store->invalid++;
+        return -1;
+    }
+
+    int rc = broadcast_start(store, raw, hex->len / 2, hex, txid_out);
+    free(raw);
+    return rc;
+}
+
+int broadcast_submit_raw(BroadcastStore *store, const uint8_t *raw, size_t raw_len,
+                         char *txid_out)
+{
+    if (!store->buckets) {
+        return -1;
+    }
+
+    /* Encode once, in chunks so a huge-tier transaction never needs one
+     * contiguous block; the requests for every endpoint share it */
+    struct evbuffer *chunks = evbuffer_new();
+    if (!chunks) {
+        return -1;
+    }
+    for (size_t off = 0; off < raw_len; ) {
+        size_t n = raw_len - off < BROADCAST_HEX_CHUNK ? raw_len - off : BROADCAST_HEX_CHUNK;
+        struct evbuffer_iovec vec;
+        if (evbuffer_reserve_space(chunks, n * 2 + 1, &vec, 1) < 1) {
+            evbuffer_free(chunks);
+            return -1;
+        }
+        hex_encode(raw + off, n, vec.iov_base);
+        vec.iov_len = n * 2;
+        if (evbuffer_commit_space(chunks, &vec, 1) < 0) {
+            evbuffer_free(chunks);
+            return -1;
+        }
+        off += n;
+    }
+
+    RPCPayload *hex = rpc_payload_wrap_evbuffer(chunks, NULL, raw_len * 2);
+    if (!hex) {
+        evbuffer_free(chunks);
+        return -1;
+    }
+
+    int rc = broadcast_start(store, raw, raw_len, hex, txid_out);
+    rpc_payload_unref(hex);
+    return rc;
+}
+
+/*
+ * Copy src into dst as a JSON string body (no quotes).
+ */
+static void json_escape(const char *src, char *dst, size_t dst_size)
+{
+    size_t o = 0;
+
+    for (; *src && o + 7 < dst_size; src++) {
+        unsigned char c = (unsigned char)*src;
+        if (c == '"' || c == '\\') {
+            dst[o++] = '\\';
+            dst[o++] = (char)c;
+        } else if (c < 0x20) {
+            o += (size_t)snprintf(dst + o, dst_size - o, "\\u%04x", c);
+        } else {
+            dst[o++] = (char)c;
+        }
+    }
+    dst[o] = '\0';
+}
+
+int broadcast_entry_json(const BroadcastEntry *entry, char *buf, size_t size)
+{
+    size_t offset = 0;
+    size_t remaining = size - 1;
+    int n;
+
+    #define JSON_ADVANCE() do { \
+        if (n > 0 && (size_t)n < remaining) { \
+            offset += (size_t)n; \
+            remaining -= (size_t)n; \
+        } else { \
+            remaining = 0; \
+        } \
+    } while (0)
+
+    n = snprintf(buf + offset, remaining,
+                 "{\"txid\":\"%s\",\"wtxid\":\"%s\",\"success\":%s,\"broadcast_results\":{",
+                 entry->txid, entry->wtxid, entry->accepted > 0 ? "true" : "false");
+    JSON_ADVANCE();
+
+    for (int i = 0; i < entry->attempted; i++) {
+        const BroadcastEndpoint *ep = &entry->endpoints[i];
+        if (ep->status == RPC_OK) {
+            n = snprintf(buf + offset, remaining,
+                         "%s\"%s\":{\"success\":true,\"time_ms\":%u}",
+                         i ? "," : "", ep->name, ep->time_ms);
+        } else {
+            char error[BROADCAST_ERROR_LEN * 6];
+            json_escape(ep->error, error, sizeof(error));
+            n = snprintf(buf + offset, remaining,
+                         "%s\"%s\":{\"success\":false,\"error\":\"%s\",\"time_ms\":%u}",
+                         i ? "," : "", ep->name, error, ep->time_ms);
+        }
+        JSON_ADVANCE();
+    }
+
+    char processed_at[32];
+    struct tm tm;
+    gmtime_r(&entry->created, &tm);
+    strftime(processed_at, sizeof(processed_at), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+    n = snprintf(buf + offset, remaining,
+                 "},\"meta\":{\"processed_at\":\"%s\",\"processing_time_ms\":%u,"
+                 "\"endpoints_attempted\":%d,\"endpoints_accepted\":%d}}",
+                 processed_at, entry->processing_time_ms,
+                 entry->attempted, entry->accepted);
+    JSON_ADVANCE();
+
+    #undef JSON_ADVANCE
+
+    buf[offset] = '\0';
+    return (int)offset;
+}
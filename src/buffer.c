@@ -1,15 +1,13 @@
 /*
- * DEAD CODE — entire file is unused.
+ * Growable byte buffers and a per-worker size-classed pool of them.
  *
- * Replaced by: libevent's evbuffer (v6 rewrite). connection.c notes:
- *   "v6: No more request_buffer allocation - we use evbuffer directly."
- *   "v6: No more request_buffer to free."
+ * Request headers live in libevent's evbuffer (v6 rewrite); Buffer is
+ * used for data the server decodes out of a request, such as huge-tier
+ * transactions decoded from hex while they arrive. The pool keeps those
+ * multi-megabyte allocations from going back to malloc on every request.
  *
- * The only caller was reader.c's read_request_line(), which is also dead code.
- * No production or test code calls any function in this file.
- * Still compiled via Makefile but nothing links to it.
- *
- * Safe to remove this file and include/buffer.h.
+ * Also here: the slab pools behind Connection and HTTP/2 session/stream
+ * objects, and the arena for a stream's header strings.
  */
 
 #include "buffer.h"
@@ -189,3 +187,300 @@ void buffer_reset(Buffer *b)
         b->len = 0;
     }
 }
+
+/* ========== Size-classed pool ========== */
+
+/* Smallest class whose size is >= n, or -1 if none */
+static int buffer_pool_class(size_t n)
+{
+    for (int c = 0; c < BUFFER_POOL_CLASSES; c++) {
+        if ((BUFFER_POOL_MIN_SIZE << c) >= n) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+void buffer_pool_init(BufferPool *pool)
+{
+    memset(pool, 0, sizeof(BufferPool));
+}
+
+void buffer_pool_destroy(BufferPool *pool)
+{
+    for (int c = 0; c < BUFFER_POOL_CLASSES; c++) {
+        for (int i = 0; i < pool->idle_count[c]; i++) {
+            buffer_free(pool->idle[c][i]);
+        }
+        pool->idle_count[c] = 0;
+    }
+    pool->idle_bytes = 0;
+}
+
+Buffer *buffer_pool_get(BufferPool *pool, size_t min_cap)
+{
+    int c = buffer_pool_class(min_cap);
+    if (c < 0) {
+        return NULL;
+    }
+
+    Buffer *b;
+    if (pool->idle_count[c] > 0) {
+        b = pool->idle[c][--pool->idle_count[c]];
+        pool->idle_bytes -= b->cap;
+        pool->hits++;
+    } else {
+        b = buffer_new(BUFFER_POOL_MIN_SIZE << c);
+        if (!b) {
+            return NULL;
+        }
+        pool->misses++;
+    }
+
+    b->len = 0;
+    pool->in_use_bytes += b->cap;
+    return b;
+}
+
+int buffer_pool_grow(BufferPool *pool, Buffer **b, size_t min_cap)
+{
+    if ((*b)->cap >= min_cap) {
+        return 0;
+    }
+
+    Buffer *bigger = buffer_pool_get(pool, min_cap);
+    if (!bigger) {
+        return -1;
+    }
+
+    memcpy(bigger->data, (*b)->data, (*b)->len);
+    bigger->len = (*b)->len;
+    buffer_pool_put(pool, *b);
+    *b = bigger;
+    pool->grows++;
+    return 0;
+}
+
+void buffer_pool_put(BufferPool *pool, Buffer *b)
+{
+    if (!b) {
+        return;
+    }
+
+    pool->in_use_bytes -= b->cap;
+
+    int c = buffer_pool_class(b->cap);
+    if (c >= 0 && (BUFFER_POOL_MIN_SIZE << c) == b->cap &&
+        pool->idle_count[c] < BUFFER_POOL_KEEP &&
+        pool->idle_bytes + b->cap <= BUFFER_POOL_MAX_IDLE) {
+        pool->idle[c][pool->idle_count[c]++] = b;
+        pool->idle_bytes += b->cap;
+        return;
+    }
+
+    buffer_free(b);
+}
+
+/* ========== Object slabs ========== */
+
+struct Slab {
+    struct Slab *next;              /* pool->partial links */
+    struct Slab *prev;
+    struct Slab *all_next;          /* pool->all links */
+    struct Slab *all_prev;
+    void *free_list;                /* Returned objects */
+    size_t carved;                  /* Objects handed out at least once */
+    size_t used;                    /* Objects handed out now */
+};
+
+/* Objects start one cache line in, after the header */
+#define SLAB_HEADER_SIZE \
+    ((sizeof(struct Slab) + SLAB_CACHE_LINE - 1) & ~(size_t)(SLAB_CACHE_LINE - 1))
+
+static void slab_partial_push(SlabPool *pool, struct Slab *slab)
+{
+    slab->prev = NULL;
+    slab->next = pool->partial;
+    if (pool->partial) {
+        pool->partial->prev = slab;
+    }
+    pool->partial = slab;
+}
+
+static void slab_partial_remove(SlabPool *pool, struct Slab *slab)
+{
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        pool->partial = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+}
+
+int slab_pool_init(SlabPool *pool, const char *name, size_t obj_size)
+{
+    memset(pool, 0, sizeof(SlabPool));
+    pool->name = name;
+    pool->obj_size = (obj_size + SLAB_CACHE_LINE - 1) & ~(size_t)(SLAB_CACHE_LINE - 1);
+    if (pool->obj_size == 0 || pool->obj_size > SLAB_SIZE - SLAB_HEADER_SIZE) {
+        return -1;
+    }
+    pool->per_slab = (SLAB_SIZE - SLAB_HEADER_SIZE) / pool->obj_size;
+    return 0;
+}
+
+void slab_pool_destroy(SlabPool *pool)
+{
+    while (pool->all) {
+        struct Slab *next = pool->all->all_next;
+        free(pool->all);
+        pool->all = next;
+    }
+    pool->partial = NULL;
+    pool->slabs = 0;
+    pool->empty_slabs = 0;
+    pool->in_use = 0;
+}
+
+void *slab_alloc(SlabPool *pool)
+{
+    struct Slab *slab = pool->partial;
+    void *obj;
+
+    if (!slab) {
+        /* Aligned to its size, so slab_free() can find it from an object */
+        slab = aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+        if (!slab) {
+            return NULL;
+        }
+        slab->free_list = NULL;
+        slab->carved = 0;
+        slab->used = 0;
+        slab->all_prev = NULL;
+        slab->all_next = pool->all;
+        if (pool->all) {
+            pool->all->all_prev = slab;
+        }
+        pool->all = slab;
+        slab_partial_push(pool, slab);
+        pool->slabs++;
+        pool->empty_slabs++;
+        pool->slab_allocs++;
+    }
+
+    if (slab->free_list) {
+        obj = slab->free_list;
+        slab->free_list = *(void **)obj;
+    } else {
+        obj = (char *)slab + SLAB_HEADER_SIZE + slab->carved++ * pool->obj_size;
+    }
+
+    if (slab->used++ == 0) {
+        pool->empty_slabs--;
+    }
+    if (slab->used == pool->per_slab) {
+        /* Full slabs are on no list until an object comes back */
+        slab_partial_remove(pool, slab);
+    }
+    pool->in_use++;
+    pool->allocs++;
+
+    memset(obj, 0, pool->obj_size);
+    return obj;
+}
+
+void slab_free(SlabPool *pool, void *obj)
+{
+    struct Slab *slab;
+
+    if (!obj) {
+        return;
+    }
+
+    slab = (struct Slab *)((uintptr_t)obj & ~(uintptr_t)(SLAB_SIZE - 1));
+    if (slab->used == pool->per_slab) {
+        slab_partial_push(pool, slab);
+    }
+
+    *(void **)obj = slab->free_list;
+    slab->free_list = obj;
+    slab->used--;
+    pool->in_use--;
+
+    if (slab->used == 0) {
+        if (pool->empty_slabs >= SLAB_POOL_KEEP_EMPTY) {
+            slab_partial_remove(pool, slab);
+            if (slab->all_prev) {
+                slab->all_prev->all_next = slab->all_next;
+            } else {
+                pool->all = slab->all_next;
+            }
+            if (slab->all_next) {
+                slab->all_next->all_prev = slab->all_prev;
+            }
+            free(slab);
+            pool->slabs--;
+            pool->slab_frees++;
+        } else {
+            pool->empty_slabs++;
+        }
+    }
+}
+
+/* ========== Arena ========== */
+
+struct ArenaChunk {
+    struct ArenaChunk *next;
+    char data[];
+};
+
+void arena_init(Arena *arena, void *buf, size_t size)
+{
+    arena->base = buf;
+    arena->size = size;
+    arena->used = 0;
+    arena->inline_buf = buf;
+    arena->inline_size = size;
+    arena->chunks = NULL;
+    arena->overflows = 0;
+}
+
+char *arena_strndup(Arena *arena, const char *s, size_t len)
+{
+    size_t need = len + 1;
+    char *p;
+
+    if (arena->size - arena->used < need) {
+        size_t size = need > ARENA_CHUNK_SIZE ? need : ARENA_CHUNK_SIZE;
+        struct ArenaChunk *chunk = malloc(sizeof(struct ArenaChunk) + size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->base = chunk->data;
+        arena->size = size;
+        arena->used = 0;
+        arena->overflows++;
+    }
+
+    p = arena->base + arena->used;
+    memcpy(p, s, len);
+    p[len] = '\0';
+    arena->used += need;
+    return p;
+}
+
+void arena_reset(Arena *arena)
+{
+    while (arena->chunks) {
+        struct ArenaChunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+    arena->base = arena->inline_buf;
+    arena->size = arena->inline_size;
+    arena->used = 0;
+}
@@ -21,6 +21,7 @@
 #define DEFAULT_READ_TIMEOUT_SEC      30
 #define DEFAULT_STATIC_DIR            "./static"
 #define DEFAULT_CACHE_MAX_AGE         3600                /* 1 hour */
+#define DEFAULT_STATIC_WATCH          1                 /* inotify hot reload */
 #define DEFAULT_SLOTS_NORMAL_MAX      100
 #define DEFAULT_SLOTS_LARGE_MAX       20
 #define DEFAULT_SLOTS_HUGE_MAX        5
@@ -30,6 +31,10 @@
 #define DEFAULT_TLS_PORT              8443
 #define DEFAULT_TLS_CERT_FILE         ""
 #define DEFAULT_TLS_KEY_FILE          ""
+#define DEFAULT_TLS_TICKET_KEY_ROTATION 3600            /* Shared keys, hourly */
+#define DEFAULT_TLS_KTLS              0                 /* Userspace record encryption */
+#define DEFAULT_TLS_HANDSHAKE_THREADS 0                 /* Handshakes on the event loop */
+#define DEFAULT_TLS_HANDSHAKE_QUEUE   256               /* Per handshake thread */
 #define DEFAULT_HTTP2_ENABLED         1                 /* HTTP/2 enabled when TLS enabled */
 #define DEFAULT_JSON_LOGGING          0                 /* Text format by default */
 #define DEFAULT_VERBOSE               0                 /* Minimal logging by default */
@@ -38,6 +43,11 @@
 /* RPC defaults */
 #define DEFAULT_RPC_HOST              "127.0.0.1"
 #define DEFAULT_RPC_TIMEOUT_SEC       30
+#define DEFAULT_RPC_POOL_MIN          RPC_POOL_DEFAULT_MIN
+#define DEFAULT_RPC_POOL_MAX          RPC_POOL_DEFAULT_MAX
+#define DEFAULT_RPC_POOL_IDLE_TIMEOUT RPC_POOL_DEFAULT_IDLE_TIMEOUT
+#define DEFAULT_RPC_BATCH_WINDOW_MS   RPC_BATCH_DEFAULT_WINDOW_MS
+#define DEFAULT_RPC_BATCH_MAX         RPC_BATCH_DEFAULT_MAX
 
 /* Default RPC ports per chain */
 #define DEFAULT_RPC_PORT_MAINNET      8332
@@ -55,6 +65,9 @@ static void rpc_config_default(RPCConfig *rpc, int default_port)
     strncpy(rpc->host, DEFAULT_RPC_HOST, sizeof(rpc->host) - 1);
     rpc->port = default_port;
     rpc->timeout_sec = DEFAULT_RPC_TIMEOUT_SEC;
+    rpc->pool_min = DEFAULT_RPC_POOL_MIN;
+    rpc->pool_max = DEFAULT_RPC_POOL_MAX;
+    rpc->pool_idle_timeout_sec = DEFAULT_RPC_POOL_IDLE_TIMEOUT;
 }
 
 static char *trim(char *str)
@@ -166,6 +179,7 @@ Config *config_default(void)
     strncpy(c->static_dir, DEFAULT_STATIC_DIR, sizeof(c->static_dir) - 1);
     c->static_dir[sizeof(c->static_dir) - 1] = '\0';
     c->cache_max_age = DEFAULT_CACHE_MAX_AGE;
+    c->static_watch = DEFAULT_STATIC_WATCH;
     c->slots_normal_max = DEFAULT_SLOTS_NORMAL_MAX;
     c->slots_large_max = DEFAULT_SLOTS_LARGE_MAX;
     c->slots_huge_max = DEFAULT_SLOTS_HUGE_MAX;
@@ -177,6 +191,10 @@ Config *config_default(void)
     c->tls_port = DEFAULT_TLS_PORT;
     c->tls_cert_file[0] = '\0';
     c->tls_key_file[0] = '\0';
+    c->tls_ticket_key_rotation = DEFAULT_TLS_TICKET_KEY_ROTATION;
+    c->tls_ktls = DEFAULT_TLS_KTLS;
+    c->tls_handshake_threads = DEFAULT_TLS_HANDSHAKE_THREADS;
+    c->tls_handshake_queue = DEFAULT_TLS_HANDSHAKE_QUEUE;
     c->http2_enabled = DEFAULT_HTTP2_ENABLED;
 
     /* Logging settings */
@@ -197,6 +215,8 @@ Config *config_default(void)
     rpc_config_default(&c->rpc_testnet, DEFAULT_RPC_PORT_TESTNET);
     rpc_config_default(&c->rpc_signet, DEFAULT_RPC_PORT_SIGNET);
     rpc_config_default(&c->rpc_regtest, DEFAULT_RPC_PORT_REGTEST);
+    c->rpc_batch_window_ms = DEFAULT_RPC_BATCH_WINDOW_MS;
+    c->rpc_batch_max = DEFAULT_RPC_BATCH_MAX;
 
     return c;
 }
@@ -280,6 +300,8 @@ Config *config_load(const char *path)
                 c->static_dir[sizeof(c->static_dir) - 1] = '\0';
             } else if (strcmp(key, "cache_max_age") == 0) {
                 c->cache_max_age = parse_int(value, DEFAULT_CACHE_MAX_AGE);
+            } else if (strcmp(key, "watch") == 0) {
+                c->static_watch = parse_int(value, DEFAULT_STATIC_WATCH);
             }
         } else if (strcmp(section, "slots") == 0) {
             if (strcmp(key, "normal_max") == 0) {
@@ -306,6 +328,14 @@ Config *config_load(const char *path)
             } else if (strcmp(key, "key_file") == 0) {
                 strncpy(c->tls_key_file, value, sizeof(c->tls_key_file) - 1);
                 c->tls_key_file[sizeof(c->tls_key_file) - 1] = '\0';
+            } else if (strcmp(key, "ticket_key_rotation") == 0) {
+                c->tls_ticket_key_rotation = parse_int(value, DEFAULT_TLS_TICKET_KEY_ROTATION);
+            } else if (strcmp(key, "ktls") == 0) {
+                c->tls_ktls = parse_int(value, DEFAULT_TLS_KTLS);
+            } else if (strcmp(key, "handshake_threads") == 0) {
+                c->tls_handshake_threads = parse_int(value, DEFAULT_TLS_HANDSHAKE_THREADS);
+            } else if (strcmp(key, "handshake_queue") == 0) {
+                c->tls_handshake_queue = parse_int(value, DEFAULT_TLS_HANDSHAKE_QUEUE);
             } else if (strcmp(key, "http2_enabled") == 0) {
                 c->http2_enabled = parse_int(value, DEFAULT_HTTP2_ENABLED);
             }
@@ -339,6 +369,12 @@ Config *config_load(const char *path)
                     c->chain = (BitcoinChain)chain;
                 }
             }
+        } else if (strcmp(section, "rpc") == 0) {
+            if (strcmp(key, "batch_window_ms") == 0) {
+                c->rpc_batch_window_ms = parse_int(value, DEFAULT_RPC_BATCH_WINDOW_MS);
+            } else if (strcmp(key, "batch_max") == 0) {
+                c->rpc_batch_max = parse_int(value, DEFAULT_RPC_BATCH_MAX);
+            }
         } else if (strcmp(section, "rpc.mainnet") == 0) {
             RPCConfig *rpc = &c->rpc_mainnet;
             if (strcmp(key, "enabled") == 0) {
@@ -359,6 +395,12 @@ Config *config_load(const char *path)
                 rpc->timeout_sec = parse_int(value, DEFAULT_RPC_TIMEOUT_SEC);
             } else if (strcmp(key, "wallet") == 0) {
                 strncpy(rpc->wallet, value, sizeof(rpc->wallet) - 1);
+            } else if (strcmp(key, "pool_min") == 0) {
+                rpc->pool_min = parse_int(value, DEFAULT_RPC_POOL_MIN);
+            } else if (strcmp(key, "pool_max") == 0) {
+                rpc->pool_max = parse_int(value, DEFAULT_RPC_POOL_MAX);
+            } else if (strcmp(key, "pool_idle_timeout") == 0) {
+                rpc->pool_idle_timeout_sec = parse_int(value, DEFAULT_RPC_POOL_IDLE_TIMEOUT);
             }
         } else if (strcmp(section, "rpc.testnet") == 0) {
             RPCConfig *rpc = &c->rpc_testnet;
@@ -380,6 +422,12 @@ Config *config_load(const char *path)
                 rpc->timeout_sec = parse_int(value, DEFAULT_RPC_TIMEOUT_SEC);
             } else if (strcmp(key, "wallet") == 0) {
                 strncpy(rpc->wallet, value, sizeof(rpc->wallet) - 1);
+            } else if (strcmp(key, "pool_min") == 0) {
+                rpc->pool_min = parse_int(value, DEFAULT_RPC_POOL_MIN);
+            } else if (strcmp(key, "pool_max") == 0) {
+                rpc->pool_max = parse_int(value, DEFAULT_RPC_POOL_MAX);
+            } else if (strcmp(key, "pool_idle_timeout") == 0) {
+                rpc->pool_idle_timeout_sec = parse_int(value, DEFAULT_RPC_POOL_IDLE_TIMEOUT);
             }
         } else if (strcmp(section, "rpc.signet") == 0) {
             RPCConfig *rpc = &c->rpc_signet;
@@ -401,6 +449,12 @@ Config *config_load(const char *path)
                 rpc->timeout_sec = parse_int(value, DEFAULT_RPC_TIMEOUT_SEC);
             } else if (strcmp(key, "wallet") == 0) {
                 strncpy(rpc->wallet, value, sizeof(rpc->wallet) - 1);
+            } else if (strcmp(key, "pool_min") == 0) {
+                rpc->pool_min = parse_int(value, DEFAULT_RPC_POOL_MIN);
+            } else if (strcmp(key, "pool_max") == 0) {
+                rpc->pool_max = parse_int(value, DEFAULT_RPC_POOL_MAX);
+            } else if (strcmp(key, "pool_idle_timeout") == 0) {
+                rpc->pool_idle_timeout_sec = parse_int(value, DEFAULT_RPC_POOL_IDLE_TIMEOUT);
             }
         } else if (strcmp(section, "rpc.regtest") == 0) {
             RPCConfig *rpc = &c->rpc_regtest;
@@ -422,6 +476,12 @@ Config *config_load(const char *path)
                 rpc->timeout_sec = parse_int(value, DEFAULT_RPC_TIMEOUT_SEC);
             } else if (strcmp(key, "wallet") == 0) {
                 strncpy(rpc->wallet, value, sizeof(rpc->wallet) - 1);
+            } else if (strcmp(key, "pool_min") == 0) {
+                rpc->pool_min = parse_int(value, DEFAULT_RPC_POOL_MIN);
+            } else if (strcmp(key, "pool_max") == 0) {
+                rpc->pool_max = parse_int(value, DEFAULT_RPC_POOL_MAX);
+            } else if (strcmp(key, "pool_idle_timeout") == 0) {
+                rpc->pool_idle_timeout_sec = parse_int(value, DEFAULT_RPC_POOL_IDLE_TIMEOUT);
             }
         }
     }
@@ -531,6 +591,7 @@ void config_print(const Config *c)
     printf("  Static:\n");
     printf("    dir:              %s\n", c->static_dir);
     printf("    cache_max_age:    %d seconds\n", c->cache_max_age);
+    printf("    watch:            %s\n", c->static_watch ? "ENABLED" : "DISABLED");
     printf("  Slots (per worker):\n");
     printf("    normal_max:       %d\n", c->slots_normal_max);
     printf("    large_max:        %d\n", c->slots_large_max);
@@ -548,6 +609,19 @@ void config_print(const Config *c)
         printf("    port:             %d\n", c->tls_port);
         printf("    cert_file:        %s\n", c->tls_cert_file);
         printf("    key_file:         %s\n", c->tls_key_file);
+        if (c->tls_ticket_key_rotation > 0) {
+            printf("    ticket_keys:      shared, rotated every %d sec\n",
+                   c->tls_ticket_key_rotation);
+        } else {
+            printf("    ticket_keys:      per-worker\n");
+        }
+        printf("    ktls:             %s\n", c->tls_ktls ? "ENABLED" : "DISABLED");
+        if (c->tls_handshake_threads > 0) {
+            printf("    handshakes:       %d threads per worker, %d in flight each\n",
+                   c->tls_handshake_threads, c->tls_handshake_queue);
+        } else {
+            printf("    handshakes:       on the event loop\n");
+        }
         printf("    http2:            %s\n", c->http2_enabled ? "ENABLED" : "DISABLED");
     } else {
         printf("    status:           DISABLED\n");
@@ -3,6 +3,7 @@
 #include "tcp_opts.h"
 #include "router.h"
 #include "static_files.h"
+#include "http_parser.h"
 #include "slot_manager.h"
 #include "http2.h"
 #include "tls.h"
@@ -10,8 +11,10 @@
 #include "endpoints.h"
 #include "log.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <ctype.h>
 #include <sys/time.h>
@@ -31,91 +34,458 @@
 #define MIN_BYTES_PER_CHECK 100           /* Minimum bytes expected per check interval */
 #define MAX_REQUEST_TIME_SEC 120          /* Maximum time to complete request */
 
+/* Responses queued ahead of the socket before pipelined requests wait */
+#define PIPELINE_MAX_DEPTH 16
+
 /* Forward declarations */
 static void conn_read_cb(struct bufferevent *bev, void *ctx);
 static void conn_write_cb(struct bufferevent *bev, void *ctx);
 static void conn_event_cb(struct bufferevent *bev, short events, void *ctx);
 static int parse_request_headers(Connection *conn, const unsigned char *headers, size_t len);
 static int try_promote_tier(Connection *conn, size_t new_size);
-static int validate_path_early(Connection *conn, const unsigned char *data, size_t len);
+static int validate_path_early(Connection *conn, struct evbuffer *input, size_t len);
+static bool pipeline_next(Connection *conn, struct evbuffer *input);
+static void connection_reset_for_keepalive(Connection *conn);
+static void log_request_complete(Connection *conn);
+static int tx_stream_decode(Connection *conn, const unsigned char *data, size_t len,
+                            size_t *consumed);
+
+/* Paths shorter than this could be /tx/txid or other routes */
+#define PATH_HEX_MIN_LEN 64
+
+static inline bool is_path_end(unsigned char c)
+{
+    return c == ' ' || c == '\r' || c == '\n';
+}
+
+/*
+ * Feed one contiguous chunk, starting at input offset base, to the
+ * request-line validator. Returns -1 once a long path is known to hold
+ * invalid characters, 0 otherwise.
+ */
+static int path_scan_chunk(Connection *conn, const unsigned char *data,
+                           size_t len, size_t base)
+{
+    size_t i = 0;
+
+    while (i < len) {
+        switch (conn->path_scan) {
+            case PATH_SCAN_METHOD: {
+                /* Format: "GET /path HTTP/1.1\r\n" */
+                const unsigned char *sp = memchr(data + i, ' ', len - i);
+                if (!sp) {
+                    return 0;
+                }
+                i = (size_t)(sp - data) + 1;
+                conn->path_scan = PATH_SCAN_SLASH;
+                break;
+            }
+
+            case PATH_SCAN_SLASH:
+                /* Skip the leading slash */
+                if (data[i] == '/') {
+                    i++;
+                }
+                conn->path_scan_start = base + i;
+                conn->path_scan = PATH_SCAN_PREFIX;
+                break;
+
+            case PATH_SCAN_PREFIX:
+                /* Allow 'tx/' prefix; it may be split across reads */
+                if (data[i] == "tx/"[conn->path_prefix_len]) {
+                    i++;
+                    if (++conn->path_prefix_len == 3) {
+                        conn->path_scan = PATH_SCAN_HEX;
+                    }
+                } else if (conn->path_prefix_len > 0) {
+                    /* Partial prefix: 't' is already not hex */
+                    conn->path_scan_bad = conn->path_scan_start;
+                    conn->path_bad_char = 't';
+                    conn->path_scan = PATH_SCAN_NON_HEX;
+                } else {
+                    conn->path_scan = PATH_SCAN_HEX;
+                }
+                break;
+
+            case PATH_SCAN_HEX:
+                if (conn->tx_raw) {
+                    size_t n;
+                    if (tx_stream_decode(conn, data + i, len - i, &n) < 0) {
+                        conn->path_scan = PATH_SCAN_NOMEM;
+                        return -1;
+                    }
+                    i += n;
+                } else {
+                    i += hex_scan((const char *)data + i, len - i);
+                }
+                if (i == len) {
+                    return 0;
+                }
+                if (is_path_end(data[i])) {
+                    conn->path_scan_end = base + i;
+                    conn->path_scan = PATH_SCAN_DONE;
+                    return 0;
+                }
+                conn->path_scan_bad = base + i;
+                conn->path_bad_char = data[i];
+                conn->path_scan = PATH_SCAN_NON_HEX;
+                break;
+
+            case PATH_SCAN_NON_HEX:
+                while (i < len && !is_path_end(data[i])) {
+                    i++;
+                }
+                if (base + i - conn->path_scan_start >= PATH_HEX_MIN_LEN) {
+                    /* Long paths should be hex transaction data */
+                    log_warn("Invalid character in path from %s: '%c' (0x%02x) at position %zu",
+                             log_format_ip(conn->client_ip), conn->path_bad_char,
+                             conn->path_bad_char, conn->path_scan_bad - conn->path_scan_start);
+                    conn->path_scan = PATH_SCAN_FAILED;
+                    return -1;
+                }
+                if (i < len) {
+                    conn->path_scan_end = base + i;
+                    conn->path_scan = PATH_SCAN_DONE;
+                }
+                return 0;
+
+            case PATH_SCAN_DONE:
+                return 0;
+
+            case PATH_SCAN_FAILED:
+            case PATH_SCAN_NOMEM:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+typedef int (*SegmentFn)(Connection *conn, const unsigned char *data, size_t len);
+
+/*
+ * Call fn on each contiguous segment of input bytes [from, from + len),
+ * read in place with evbuffer_peek() rather than linearizing the buffer.
+ * Stops at, and returns, the first fn error.
+ */
+static int input_for_each_segment(struct evbuffer *input, size_t from, size_t len,
+                                  SegmentFn fn, Connection *conn)
+{
+    struct evbuffer_iovec vecs[16];
+    const int max_vecs = (int)(sizeof(vecs) / sizeof(vecs[0]));
+
+    while (len > 0) {
+        struct evbuffer_ptr ptr;
+        if (evbuffer_ptr_set(input, &ptr, from, EVBUFFER_PTR_SET) < 0) {
+            return 0;
+        }
+
+        int n = evbuffer_peek(input, (ev_ssize_t)len, &ptr, vecs, max_vecs);
+        if (n > max_vecs) {
+            n = max_vecs;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+
+        for (int v = 0; v < n && len > 0; v++) {
+            size_t chunk = vecs[v].iov_len < len ? vecs[v].iov_len : len;
+            if (fn(conn, vecs[v].iov_base, chunk) < 0) {
+                return -1;
+            }
+            from += chunk;
+            len -= chunk;
+        }
+    }
+    return 0;
+}
+
+static int path_scan_segment(Connection *conn, const unsigned char *data, size_t len)
+{
+    int rc = path_scan_chunk(conn, data, len, conn->path_scan_offset);
+    conn->path_scan_offset += len;
+    return rc;
+}
 
 /*
- * Early validation of path data as it arrives.
+ * Early validation of the request line as it arrives.
  * For transaction broadcasts (long paths), validates hex characters.
- * Returns 0 if valid, -1 if invalid.
+ *
+ * Resumable: only input bytes past conn->path_scan_offset are examined,
+ * read in place without linearizing the buffer, so a path trickling in
+ * over many reads costs O(n) in total. len is the input length.
+ * Returns 0 if valid so far, -1 if invalid (or out of decode memory).
  */
-static int validate_path_early(Connection *conn, const unsigned char *data, size_t len)
+static int validate_path_early(Connection *conn, struct evbuffer *input, size_t len)
 {
-    /* Skip if already validated or failed */
-    if (conn->validation_failed) {
+    if (conn->path_scan == PATH_SCAN_FAILED || conn->path_scan == PATH_SCAN_NOMEM) {
         return -1;
     }
 
-    /* Look for the path in the request line */
-    /* Format: "GET /path HTTP/1.1\r\n" */
+    size_t from = conn->path_scan_offset - conn->input_consumed;
+    if (conn->path_scan == PATH_SCAN_DONE || from >= len) {
+        return 0;
+    }
+    return input_for_each_segment(input, from, len - from, path_scan_segment, conn);
+}
 
-    /* Find first space (after method) */
-    const unsigned char *path_start = memchr(data, ' ', len);
-    if (!path_start) {
-        return 0;  /* Not enough data yet */
+/*
+ * Reject a request that failed validate_path_early().
+ */
+static void send_path_error(Connection *conn)
+{
+    if (conn->path_scan == PATH_SCAN_NOMEM) {
+        connection_send_error(conn, 503, "Service Unavailable");
+        return;
     }
-    path_start++;  /* Skip space */
+    conn->worker->errors_parse++;
+    connection_send_error(conn, 400, "Bad Request - Invalid Characters");
+}
+
+/* ========== Request path ownership ========== */
 
-    /* Security: bounds check after increment */
-    const unsigned char *data_end = data + len;
-    if (path_start >= data_end) {
-        return 0;  /* Not enough data yet */
+/*
+ * Take the parsed request head off the input. A short path was copied
+ * into path_inline and the head is simply drained. For a long path the
+ * head's bytes move to conn->request_head - the chain itself when the
+ * pullup built one for exactly the head, as it does for heads spanning
+ * several reads - and conn->path is repointed into it, so the path is
+ * never copied and stays valid until connection_free_path().
+ * Returns -1 on allocation failure.
+ */
+static int connection_take_head(Connection *conn, struct evbuffer *input,
+                                const unsigned char *headers, size_t headers_len)
+{
+    if (!conn->path || conn->path == conn->path_inline) {
+        evbuffer_drain(input, headers_len);
+        return 0;
     }
 
-    /* Skip the leading slash */
-    if (*path_start == '/') {
-        path_start++;
-        /* Security: bounds check after increment */
-        if (path_start >= data_end) {
-            return 0;  /* Not enough data yet */
-        }
+    size_t offset = (size_t)((const unsigned char *)conn->path - headers);
+    conn->path = NULL;
+    if (!conn->request_head && !(conn->request_head = evbuffer_new())) {
+        return -1;
+    }
+    if (evbuffer_remove_buffer(input, conn->request_head, headers_len) != (int)headers_len) {
+        return -1;
+    }
+    unsigned char *head = evbuffer_pullup(conn->request_head, -1);
+    if (!head) {
+        return -1;
     }
 
-    /* Find end of path (space before HTTP version or \r\n) */
-    const unsigned char *path_end = NULL;
-    for (const unsigned char *p = path_start; p < data_end; p++) {
-        if (*p == ' ' || *p == '\r' || *p == '\n') {
-            path_end = p;
-            break;
+    /* The byte after the target is the SP or line end; the head is ours */
+    conn->path = (char *)head + offset;
+    conn->path[conn->path_len] = '\0';
+    return 0;
+}
+
+/*
+ * Hand the path to a refcounted payload so broadcast requests can
+ * reference the hex in place; the payload takes over request_head.
+ * conn->path stays valid (for the access log) until
+ * connection_free_path(). Returns NULL on allocation failure.
+ */
+static RPCPayload *connection_share_path(Connection *conn)
+{
+    if (conn->path_payload) {
+        return conn->path_payload;
+    }
+
+    if (conn->path == conn->path_inline) {
+        /* Shorter than any transaction; RPCs still get their own copy */
+        char *copy = strndup(conn->path, conn->path_len);
+        if (copy && !(conn->path_payload = rpc_payload_wrap(copy, copy + 1, conn->path_len - 1))) {
+            free(copy);
+        }
+    } else {
+        conn->path_payload = rpc_payload_wrap_evbuffer(conn->request_head, conn->path + 1,
+                                                       conn->path_len - 1);
+        if (conn->path_payload) {
+            conn->request_head = NULL;
         }
     }
+    return conn->path_payload;
+}
 
-    if (!path_end) {
-        /* Path not complete yet - validate what we have */
-        path_end = data_end;
+static void connection_free_path(Connection *conn)
+{
+    if (conn->path_payload) {
+        /* In-flight RPCs may still reference it */
+        rpc_payload_unref(conn->path_payload);
+        conn->path_payload = NULL;
     }
+    if (conn->request_head) {
+        /* Kept for the next long path */
+        evbuffer_drain(conn->request_head, evbuffer_get_length(conn->request_head));
+    }
+    conn->path = NULL;
+}
 
-    /* For paths that look like transaction hex (long paths), validate characters */
-    size_t path_len = path_end - path_start;
+/* ========== Streaming decode of huge-tier broadcasts ========== */
 
-    /* Short paths (< 64 chars) could be /tx/txid or other routes - don't validate */
-    if (path_len < 64) {
+/*
+ * Decode a run of hex into conn->tx_raw, carrying an odd trailing
+ * character over to the next segment. *consumed receives the number of
+ * leading hex characters taken: the offset of the first non-hex byte, or
+ * len. Returns -1 if the buffer cannot grow.
+ */
+static int tx_stream_decode(Connection *conn, const unsigned char *data, size_t len,
+                            size_t *consumed)
+{
+    const char *hex = (const char *)data;
+    size_t i = 0;
+
+    *consumed = 0;
+    if (len == 0) {
         return 0;
     }
 
-    /* Long paths should be hex transaction data - validate each character */
-    for (const unsigned char *p = path_start; p < path_end; p++) {
-        /* Allow 'tx/' prefix */
-        if (p == path_start && path_len > 3 &&
-            p[0] == 't' && p[1] == 'x' && p[2] == '/') {
-            p += 2;  /* Skip 'tx/' */
-            continue;
+    /* Room for every byte this run could complete */
+    size_t need = conn->tx_raw->len + (len + 1) / 2;
+    if (buffer_pool_grow(&conn->worker->tx_buffers, &conn->tx_raw, need) < 0) {
+        log_error("Failed to grow tx decode buffer to %zu bytes for %s",
+                  need, log_format_ip(conn->client_ip));
+        return -1;
+    }
+    uint8_t *out = (uint8_t *)conn->tx_raw->data;
+
+    /* Complete a byte split across segments */
+    if (conn->tx_pending_hex >= 0) {
+        char pair[2] = { (char)conn->tx_pending_hex, hex[0] };
+        if (hex_decode(pair, 2, out + conn->tx_raw->len) < 0) {
+            return 0;
         }
+        conn->tx_raw->len++;
+        conn->tx_pending_hex = -1;
+        i = 1;
+    }
 
-        if (!is_hex_char(*p)) {
-            log_warn("Invalid character in path from %s: '%c' (0x%02x) at position %zu",
-                     log_format_ip(conn->client_ip), *p, (unsigned char)*p, (size_t)(p - path_start));
-            conn->validation_failed = true;
-            return -1;
+    size_t even = (len - i) & ~(size_t)1;
+    size_t n = hex_decode_scan(hex + i, even, out + conn->tx_raw->len);
+    conn->tx_raw->len += n / 2;
+    i += n;
+
+    if (n < even) {
+        /* Stopped at a non-hex byte after an unpaired character */
+        if (n % 2) {
+            conn->tx_pending_hex = (unsigned char)hex[i - 1];
         }
+    } else if (i < len && is_hex_char(data[i])) {
+        conn->tx_pending_hex = (unsigned char)hex[i];
+        i++;
     }
 
-    conn->path_validated = true;
+    *consumed = i;
+    return 0;
+}
+
+static int tx_stream_catch_up(Connection *conn, const unsigned char *data, size_t len)
+{
+    size_t consumed;
+    return tx_stream_decode(conn, data, len, &consumed);
+}
+
+static void tx_stream_release(Connection *conn)
+{
+    if (conn->tx_raw) {
+        buffer_pool_put(&conn->worker->tx_buffers, conn->tx_raw);
+        conn->tx_raw = NULL;
+    }
+}
+
+/*
+ * Switch a huge-tier broadcast to streaming: from here on its hex is
+ * decoded into a pooled buffer as it arrives and drained from the input,
+ * so the request never holds the hex and a second copy of it. Peak memory
+ * is about half the hex size instead of twice it.
+ *
+ * Only bare /{hex} paths that are still all hex qualify. If the method
+ * or a buffer is unavailable the request stays on the normal path.
+ */
+static void tx_stream_start(Connection *conn, struct evbuffer *input)
+{
+    WorkerProcess *worker = conn->worker;
+    char line[sizeof(conn->method) + 2];
+
+    if (conn->tx_raw || conn->current_tier != TIER_HUGE ||
+        conn->path_scan != PATH_SCAN_HEX || conn->path_prefix_len != 0) {
+        return;
+    }
+
+    /* The request line so far is "METHOD /" followed by hex */
+    size_t prefix = conn->path_scan_start - conn->input_consumed;
+    if (prefix > sizeof(line) ||
+        evbuffer_copyout(input, line, prefix) != (ev_ssize_t)prefix) {
+        return;
+    }
+    const char *sp = memchr(line, ' ', prefix);
+    if (!sp || (size_t)(sp - line) + 2 != prefix || sp[1] != '/' ||
+        (size_t)(sp - line) >= sizeof(conn->method)) {
+        return;
+    }
+
+    size_t hex_len = conn->path_scan_offset - conn->path_scan_start;
+    conn->tx_raw = buffer_pool_get(&worker->tx_buffers, hex_len);
+    if (!conn->tx_raw) {
+        log_warn("No tx decode buffer for %zu hex chars from %s - buffering instead",
+                 hex_len, log_format_ip(conn->client_ip));
+        return;
+    }
+    conn->tx_pending_hex = -1;
+
+    /* Decode the hex validated so far */
+    if (input_for_each_segment(input, prefix, hex_len, tx_stream_catch_up, conn) < 0) {
+        tx_stream_release(conn);
+        return;
+    }
+
+    memcpy(conn->method, line, (size_t)(sp - line));
+    conn->method[sp - line] = '\0';
+    worker->tx_streamed++;
+    log_debug("Streaming tx decode for %s after %zu hex chars",
+              log_format_ip(conn->client_ip), hex_len);
+}
+
+/*
+ * Drop the already decoded part of the request from the input.
+ * Returns the number of bytes drained.
+ */
+static size_t tx_stream_drain(Connection *conn, struct evbuffer *input)
+{
+    size_t upto;
+
+    if (conn->path_scan == PATH_SCAN_DONE) {
+        upto = conn->path_scan_end;
+    } else if (conn->path_scan == PATH_SCAN_HEX) {
+        upto = conn->path_scan_offset;
+    } else {
+        return 0;
+    }
+
+    size_t n = upto - conn->input_consumed;
+    if (n == 0) {
+        return 0;
+    }
+    evbuffer_drain(input, n);
+    conn->input_consumed += n;
+    conn->headers_scanned = conn->headers_scanned > n ? conn->headers_scanned - n : 0;
+    return n;
+}
+
+/*
+ * Request line of a streamed transaction: the method was kept by
+ * tx_stream_start() and the hex is gone, so keep a short form of the path
+ * for the access log.
+ */
+static int tx_stream_finish(Connection *conn)
+{
+    char head[17];
+    size_t head_bytes = conn->tx_raw->len < 8 ? conn->tx_raw->len : 8;
+
+    hex_encode((const uint8_t *)conn->tx_raw->data, head_bytes, head);
+    conn->path = conn->path_inline;
+    conn->path_len = (size_t)snprintf(conn->path_inline, sizeof(conn->path_inline),
+                                      "/%s...", head);
     return 0;
 }
 
@@ -197,8 +567,12 @@ static int connection_init_common(Connection *conn, struct WorkerProcess *worker
     conn->current_tier = TIER_NORMAL;  /* Start in normal tier */
     conn->path = NULL;
     conn->path_len = 0;
-    conn->path_validated = false;
-    conn->validation_failed = false;
+    conn->path_payload = NULL;
+    conn->request_head = NULL;
+    conn->path_scan = PATH_SCAN_METHOD;
+    conn->path_scan_offset = 0;
+    conn->path_prefix_len = 0;
+    conn->input_consumed = 0;
     conn->headers_scanned = 0;
     conn->keep_alive = true;  /* Default to keep-alive for HTTP/1.1 */
     conn->slot_held = true;   /* Slot acquired in accept callback */
@@ -256,6 +630,10 @@ static int connection_init_common(Connection *conn, struct WorkerProcess *worker
     return 0;
 }
 
+/* The fields every read event touches share the slab's first cache line */
+_Static_assert(offsetof(Connection, body_received) + sizeof(size_t) <= SLAB_CACHE_LINE,
+               "Connection read-path fields span more than one cache line");
+
 /*
  * Create new connection from accepted socket.
  * v6: No more request_buffer allocation - we use evbuffer directly.
@@ -267,7 +645,7 @@ Connection *connection_new(struct WorkerProcess *worker, evutil_socket_t fd,
 
     (void)addrlen;
 
-    conn = calloc(1, sizeof(Connection));
+    conn = slab_alloc(&worker->conn_pool);
     if (!conn) {
         log_error("Failed to allocate connection");
         return NULL;
@@ -278,13 +656,13 @@ Connection *connection_new(struct WorkerProcess *worker, evutil_socket_t fd,
                                         BEV_OPT_CLOSE_ON_FREE);
     if (!conn->bev) {
         log_error("Failed to create bufferevent");
-        free(conn);
+        slab_free(&worker->conn_pool, conn);
         return NULL;
     }
 
     if (connection_init_common(conn, worker, addr) < 0) {
         bufferevent_free(conn->bev);
-        free(conn);
+        slab_free(&worker->conn_pool, conn);
         return NULL;
     }
 
@@ -306,7 +684,7 @@ Connection *connection_new_with_bev(struct WorkerProcess *worker,
 
     (void)addrlen;
 
-    conn = calloc(1, sizeof(Connection));
+    conn = slab_alloc(&worker->conn_pool);
     if (!conn) {
         log_error("Failed to allocate connection");
         return NULL;
@@ -315,7 +693,7 @@ Connection *connection_new_with_bev(struct WorkerProcess *worker,
     conn->bev = bev;
 
     if (connection_init_common(conn, worker, addr) < 0) {
-        free(conn);
+        slab_free(&worker->conn_pool, conn);
         return NULL;
     }
 
@@ -342,6 +720,10 @@ void connection_free(Connection *conn)
         conn->next->prev = conn->prev;
     }
 
+    /* Stop waiting on an in-flight broadcast */
+    broadcast_wait_cancel(&conn->tx_waiter);
+    tx_stream_release(conn);
+
     /* Free HTTP/2 session */
     if (conn->h2) {
         h2_connection_free(conn->h2);
@@ -355,9 +737,11 @@ void connection_free(Connection *conn)
     /* Note: SSL is freed by bufferevent_free when using bufferevent_openssl */
     conn->ssl = NULL;
 
-    /* Free dynamic path */
-    if (conn->path) {
-        free(conn->path);
+    /* Release the path and the head it points into */
+    connection_free_path(conn);
+    if (conn->request_head) {
+        evbuffer_free(conn->request_head);
+        conn->request_head = NULL;
     }
 
     /* Release slot at correct tier (only if held) */
@@ -373,134 +757,111 @@ void connection_free(Connection *conn)
     /* Check if we should exit (draining mode) */
     worker_check_drain(worker);
 
-    free(conn);
+    slab_free(&worker->conn_pool, conn);
 }
 
 /*
- * Parse the request line and headers from a contiguous buffer.
- * Extracts method and path. Path is dynamically allocated for large URLs.
+ * Copy the method and target out of the tokenized request line. A short
+ * target goes into path_inline; a long one is left in place (conn->path
+ * points into the head until connection_take_head() moves it).
  * Returns 0 on success, -1 on error.
  */
-static int parse_request_headers(Connection *conn, const unsigned char *headers, size_t len)
+static int set_request_line(Connection *conn, const HttpRequest *req)
 {
-    const unsigned char *line_end;
-    const unsigned char *space1, *space2;
-    size_t method_len, path_len;
-
-    /* Find end of first line */
-    line_end = memmem(headers, len, "\r\n", 2);
-    if (!line_end) {
+    if (req->method_len >= sizeof(conn->method)) {
+        log_warn("HTTP method too long (%zu bytes) from %s", req->method_len,
+                 log_format_ip(conn->client_ip));
         return -1;
     }
-
-    /* Find method (GET, POST, etc.) */
-    space1 = memchr(headers, ' ', line_end - headers);
-    if (!space1) {
-        return -1;
+    memcpy(conn->method, req->method, req->method_len);
+    conn->method[req->method_len] = '\0';
+
+    conn->path_len = req->target_len;
+    if (req->target_len < sizeof(conn->path_inline)) {
+        memcpy(conn->path_inline, req->target, req->target_len);
+        conn->path_inline[req->target_len] = '\0';
+        conn->path = conn->path_inline;
+    } else {
+        conn->path = (char *)req->target;
     }
+    return 0;
+}
 
-    method_len = space1 - headers;
-    if (method_len >= sizeof(conn->method)) {
-        log_warn("HTTP method too long (%zu bytes) from %s", method_len, log_format_ip(conn->client_ip));
+/*
+ * Parse the request line and the headers this server cares about.
+ * The head is tokenized once (http_parser.c); known headers are then
+ * read from their slots instead of searching the block for each.
+ */
+static int parse_request_headers(Connection *conn, const unsigned char *headers, size_t len)
+{
+    HttpRequest req;
+    const HttpHeader *h;
+
+    /* A streamed transaction's method and path were consumed already;
+     * the head starts right after the target */
+    if (conn->tx_raw) {
+        if (tx_stream_finish(conn) < 0 ||
+            http_parse_request_tail((const char *)headers, len, &req) < 0) {
+            return -1;
+        }
+    } else if (http_parse_request((const char *)headers, len, &req) < 0 ||
+               set_request_line(conn, &req) < 0) {
         return -1;
     }
-    memcpy(conn->method, headers, method_len);
-    conn->method[method_len] = '\0';
 
-    /* Find path */
-    space2 = memchr(space1 + 1, ' ', line_end - space1 - 1);
-    if (!space2) {
-        /* HTTP/0.9 style - no version, path goes to end of line */
-        path_len = line_end - (space1 + 1);
-    } else {
-        path_len = space2 - (space1 + 1);
+    /* Request bodies are only drained, so their length must be exact */
+    if (http_request_header(&req, HTTP_HEADER_TRANSFER_ENCODING)) {
+        log_warn("Transfer-Encoding not supported from %s", log_format_ip(conn->client_ip));
+        return -1;
     }
-
-    /* Dynamically allocate path for large URLs */
-    conn->path = malloc(path_len + 1);
-    if (!conn->path) {
-        log_error("Failed to allocate path buffer");
+    conn->content_length = 0;
+    h = http_request_header(&req, HTTP_HEADER_CONTENT_LENGTH);
+    if (h && http_parse_content_length(h->value, h->value_len, &conn->content_length) < 0) {
+        log_warn("Invalid Content-Length header from %s", log_format_ip(conn->client_ip));
         return -1;
     }
 
-    memcpy(conn->path, space1 + 1, path_len);
-    conn->path[path_len] = '\0';
-    conn->path_len = path_len;
-
-    /* Parse Content-Length header if present */
-    const char *cl = "Content-Length:";
-    const unsigned char *found = NULL;
-    const unsigned char *headers_end = headers + len;
-
-    /* Case-insensitive search for Content-Length */
-    for (size_t i = 0; i + 15 < len; i++) {
-        if ((headers[i] == 'C' || headers[i] == 'c') &&
-            strncasecmp((const char *)headers + i, cl, 15) == 0) {
-            found = headers + i + 15;
-            break;
-        }
+    /* Keep-alive: the HTTP/1.1 default is set in connection_new;
+     * HTTP/1.0 closes unless the client asks otherwise */
+    if (req.minor_version == 0) {
+        conn->keep_alive = false;
     }
-
-    if (found) {
-        /* Skip whitespace - with bounds check to prevent buffer overread */
-        while (found < headers_end && (*found == ' ' || *found == '\t')) {
-            found++;
-        }
-        if (found < headers_end) {
-            /* Security: reject negative numbers - strtoul("-1") silently
-             * converts to ULONG_MAX without setting errno */
-            if (*found == '-' || *found == '+') {
-                log_warn("Invalid Content-Length (sign prefix) from %s",
-                         log_format_ip(conn->client_ip));
-                conn->content_length = 0;
-            } else {
-                /* Security: proper strtoul() with error checking */
-                char *endptr = NULL;
-                errno = 0;
-                unsigned long val = strtoul((const char *)found, &endptr, 10);
-
-                if (errno == ERANGE || endptr == (const char *)found) {
-                    log_warn("Invalid Content-Length header from %s",
-                             log_format_ip(conn->client_ip));
-                    conn->content_length = 0;
-                } else {
-                    conn->content_length = (size_t)val;
-                }
-            }
-        } else {
-            conn->content_length = 0;
+    h = http_request_header(&req, HTTP_HEADER_CONNECTION);
+    if (h) {
+        if (http_header_has_token(h->value, h->value_len, "close")) {
+            conn->keep_alive = false;
+        } else if (http_header_has_token(h->value, h->value_len, "keep-alive")) {
+            conn->keep_alive = true;
         }
-    } else {
-        conn->content_length = 0;
     }
 
-    /* Parse Connection header for keep-alive */
-    const char *conn_header = "Connection:";
-    const unsigned char *conn_found = NULL;
-
-    for (size_t i = 0; i + 11 < len; i++) {
-        if ((headers[i] == 'C' || headers[i] == 'c') &&
-            strncasecmp((const char *)headers + i, conn_header, 11) == 0) {
-            conn_found = headers + i + 11;
-            break;
+    /* Accept: /tx/{txid} answers JSON when asked for it */
+    h = http_request_header(&req, HTTP_HEADER_ACCEPT);
+    conn->accept_json = h && memmem(h->value, h->value_len, "application/json", 16);
+
+    /* Accept-Encoding: picks a precompressed static page variant */
+    h = http_request_header(&req, HTTP_HEADER_ACCEPT_ENCODING);
+    conn->accept_encodings = h ? static_accept_encodings(h->value, h->value_len) : 0;
+
+    /* Conditional GET validators for static pages; an over-long
+     * If-None-Match is cut and then just fails to match */
+    conn->if_none_match[0] = '\0';
+    conn->has_if_none_match = false;
+    h = http_request_header(&req, HTTP_HEADER_IF_NONE_MATCH);
+    if (h) {
+        size_t value_len = h->value_len;
+        if (value_len >= sizeof(conn->if_none_match)) {
+            value_len = sizeof(conn->if_none_match) - 1;
         }
+        memcpy(conn->if_none_match, h->value, value_len);
+        conn->if_none_match[value_len] = '\0';
+        conn->has_if_none_match = true;
     }
-
-    if (conn_found) {
-        /* Skip whitespace - with bounds check to prevent buffer overread */
-        while (conn_found < headers_end && (*conn_found == ' ' || *conn_found == '\t')) {
-            conn_found++;
-        }
-        /* Check for "close" - ensure enough bytes remain */
-        if (conn_found + 5 <= headers_end &&
-            strncasecmp((const char *)conn_found, "close", 5) == 0) {
-            conn->keep_alive = false;
-        } else if (conn_found + 10 <= headers_end &&
-                   strncasecmp((const char *)conn_found, "keep-alive", 10) == 0) {
-            conn->keep_alive = true;
-        }
+    conn->if_modified_since = -1;
+    h = http_request_header(&req, HTTP_HEADER_IF_MODIFIED_SINCE);
+    if (h) {
+        conn->if_modified_since = static_parse_http_date(h->value, h->value_len);
     }
-    /* Default is keep-alive for HTTP/1.1, set in connection_new */
 
     return 0;
 }
@@ -508,61 +869,45 @@ static int parse_request_headers(Connection *conn, const unsigned char *headers,
 /*
  * Serve a static file with TCP_CORK optimization.
  * Cork ensures headers + body go in same TCP segment.
- * Includes Cache-Control header based on config.
+ * Sends the smallest precompressed variant Accept-Encoding allows, with
+ * the file's prebuilt headers; neither headers nor body are copied.
+ * Answers 304 when the client's cached copy is still current.
  * Supports keep-alive connections.
  */
-static void serve_static_file(Connection *conn, StaticFile *file, int status_code,
-                              const char *status_text)
+static void serve_static_file(Connection *conn, StaticFile *file)
 {
     struct evbuffer *output = bufferevent_get_output(conn->bev);
     int fd = bufferevent_getfd(conn->bev);
-    int cache_max_age = conn->worker->config->cache_max_age;
+    const char *body;
+    size_t body_len;
+    StaticEncoding encoding = static_file_select(file, conn->accept_encodings,
+                                                 &body, &body_len);
+    bool not_modified = static_file_not_modified(
+        file, encoding, conn->has_if_none_match ? conn->if_none_match : NULL,
+        conn->if_modified_since);
+
+    static_files_count(conn->worker->static_files, file, encoding, not_modified);
+    if (not_modified) {
+        body_len = 0;
+    }
 
     conn->state = CONN_STATE_WRITING_RESPONSE;
 
     /* Cork - accumulate headers + body */
     tcp_cork_enable(fd);
 
-    /* Write HTTP headers */
-    evbuffer_add_printf(output,
-        "HTTP/1.1 %d %s\r\n"
-        "Content-Type: %s\r\n"
-        "Content-Length: %zu\r\n",
-        status_code, status_text,
-        file->content_type, file->length);
-
-    /* Add Cache-Control header if caching is enabled */
-    if (cache_max_age > 0) {
-        evbuffer_add_printf(output,
-            "Cache-Control: public, max-age=%d\r\n",
-            cache_max_age);
-    } else {
-        evbuffer_add_printf(output,
-            "Cache-Control: no-store\r\n");
-    }
-
-    /* Connection header - support keep-alive */
-    if (conn->keep_alive) {
-        evbuffer_add_printf(output, "Connection: keep-alive\r\n");
-    } else {
-        evbuffer_add_printf(output, "Connection: close\r\n");
+    if (static_file_write_response(output, file, encoding, conn->keep_alive,
+                                   not_modified, conn->request_id) < 0) {
+        log_error("Failed to queue static response");
+        conn->keep_alive = false;
     }
 
-    /* X-Request-ID header for tracing */
-    evbuffer_add_printf(output, "X-Request-ID: %s\r\n", conn->request_id);
-
-    /* End headers */
-    evbuffer_add_printf(output, "\r\n");
-
-    /* Write body */
-    evbuffer_add(output, file->content, file->length);
-
     /* Uncork - flush as optimal TCP segments */
     tcp_cork_disable(fd);
 
     /* Track response for access logging */
-    conn->response_status = status_code;
-    conn->response_bytes = file->length;
+    conn->response_status = not_modified ? 304 : file->status_code;
+    conn->response_bytes = body_len;
 
     /* Update state based on keep-alive */
     if (conn->keep_alive) {
@@ -603,6 +948,80 @@ static void serve_health(Connection *conn)
     bufferevent_enable(conn->bev, EV_WRITE);
 }
 
+/*
+ * Send a JSON response body. Used by the /tx/{txid} lookup.
+ */
+static void serve_json(Connection *conn, int status_code, const char *status_text,
+                       const char *body, int body_len)
+{
+    struct evbuffer *output = bufferevent_get_output(conn->bev);
+
+    conn->state = CONN_STATE_WRITING_RESPONSE;
+
+    evbuffer_add_printf(output,
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %d\r\n"
+        "Cache-Control: no-store\r\n"
+        "X-Request-ID: %s\r\n"
+        "Connection: %s\r\n"
+        "\r\n",
+        status_code, status_text, body_len, conn->request_id,
+        conn->keep_alive ? "keep-alive" : "close");
+    evbuffer_add(output, body, body_len);
+
+    conn->response_status = status_code;
+    conn->response_bytes = body_len;
+    conn->state = conn->keep_alive ? CONN_STATE_WRITING_RESPONSE : CONN_STATE_CLOSING;
+    bufferevent_enable(conn->bev, EV_WRITE);
+}
+
+static void serve_tx_entry(Connection *conn, const BroadcastEntry *entry)
+{
+    char body[2048];
+    int body_len = broadcast_entry_json(entry, body, sizeof(body));
+    serve_json(conn, 200, "OK", body, body_len);
+}
+
+/*
+ * Waiter callback: the broadcast this connection was parked on finished.
+ */
+static void tx_waiter_done(BroadcastWaiter *waiter, const BroadcastEntry *entry)
+{
+    Connection *conn = waiter->ctx;
+
+    serve_tx_entry(conn, entry);
+}
+
+/*
+ * Answer with the broadcast result for txid as JSON.
+ * A broadcast still in flight parks the connection until it completes.
+ */
+static void serve_tx_result(Connection *conn, const char *txid)
+{
+    BroadcastStore *store = &conn->worker->broadcasts;
+    BroadcastEntry *entry = broadcast_lookup(store, txid, TX_HASH_HEX_LEN);
+
+    if (!entry) {
+        static const char not_found[] = "{\"error\":\"unknown txid\"}";
+        store->lookups_miss++;
+        serve_json(conn, 404, "Not Found", not_found, sizeof(not_found) - 1);
+        return;
+    }
+
+    if (entry->pending > 0) {
+        /* Stay in PROCESSING; tx_waiter_done() writes the response */
+        store->lookups_waited++;
+        conn->tx_waiter.on_done = tx_waiter_done;
+        conn->tx_waiter.ctx = conn;
+        broadcast_wait(entry, &conn->tx_waiter);
+        return;
+    }
+
+    store->lookups_hit++;
+    serve_tx_entry(conn, entry);
+}
+
 /*
  * Serve /ready endpoint - readiness probe.
  * Returns 200 if accepting connections, 503 if draining.
@@ -824,11 +1243,18 @@ static void serve_metrics(Connection *conn)
 {
     WorkerProcess *worker = conn->worker;
     struct evbuffer *output = bufferevent_get_output(conn->bev);
-    char body[16384];
+    struct evbuffer *body = evbuffer_new();
+    int body_len = body ? generate_metrics_body(worker, body) : -1;
 
-    conn->state = CONN_STATE_WRITING_RESPONSE;
+    if (body_len < 0) {
+        if (body) {
+            evbuffer_free(body);
+        }
+        connection_send_error(conn, 500, "Internal Server Error");
+        return;
+    }
 
-    int body_len = generate_metrics_body(worker, body, sizeof(body));
+    conn->state = CONN_STATE_WRITING_RESPONSE;
 
     evbuffer_add_printf(output,
         "HTTP/1.1 200 OK\r\n"
@@ -837,8 +1263,10 @@ static void serve_metrics(Connection *conn)
         "Cache-Control: no-store\r\n"
         "X-Request-ID: %s\r\n"
         "Connection: close\r\n"
-        "\r\n%s",
-        body_len, conn->request_id, body);
+        "\r\n",
+        body_len, conn->request_id);
+    evbuffer_add_buffer(output, body);
+    evbuffer_free(body);
 
     conn->response_status = 200;
     conn->response_bytes = body_len;
@@ -853,13 +1281,17 @@ static void process_request(Connection *conn)
 {
     WorkerProcess *worker = conn->worker;
     StaticFile *file;
-    int status_code = 200;
-    const char *status_text = "OK";
+    RouteType route;
 
     conn->state = CONN_STATE_PROCESSING;
 
-    /* Route the request based on path */
-    RouteType route = route_request(conn->path, conn->path_len);
+    /* Route the request based on path; a streamed path was all hex */
+    if (conn->tx_raw) {
+        route = conn->tx_pending_hex < 0 ? ROUTE_BROADCAST : ROUTE_ERROR;
+        file = static_files_page(worker->static_files, route);
+    } else {
+        file = static_files_route(worker->static_files, conn->path, conn->path_len, &route);
+    }
     update_endpoint_counter(worker, route);
 
     /* Handle observability endpoints */
@@ -886,36 +1318,43 @@ static void process_request(Connection *conn)
             break;
     }
 
-    /* Select file based on route */
+    /* Routes that answer with something other than their page */
     switch (route) {
-        case ROUTE_HOME:
-            file = &worker->static_files.index;
-            break;
         case ROUTE_BROADCAST:
-            file = &worker->static_files.broadcast;
+            /* Start the broadcast now; the page polls /tx/{txid} for the outcome */
+            if (strcmp(conn->method, "GET") == 0) {
+                char txid[TX_HASH_HEX_LEN + 1];
+                int rc = conn->tx_raw
+                    ? broadcast_submit_raw(&worker->broadcasts,
+                                           (const uint8_t *)conn->tx_raw->data,
+                                           conn->tx_raw->len, txid)
+                    : broadcast_submit(&worker->broadcasts, connection_share_path(conn),
+                                       txid);
+                tx_stream_release(conn);
+                if (conn->accept_json) {
+                    if (rc < 0) {
+                        static const char invalid[] = "{\"error\":\"invalid transaction\"}";
+                        serve_json(conn, 400, "Bad Request", invalid, sizeof(invalid) - 1);
+                    } else {
+                        serve_tx_result(conn, txid);
+                    }
+                    return;
+                }
+            }
             break;
         case ROUTE_RESULT:
-            file = &worker->static_files.result;
-            break;
-        case ROUTE_DOCS:
-            file = &worker->static_files.docs;
-            break;
-        case ROUTE_STATUS:
-            file = &worker->static_files.status;
-            break;
-        case ROUTE_LOGOS:
-            file = &worker->static_files.logos;
+            /* /tx/{txid} and /{txid} both end in the txid */
+            if (conn->accept_json) {
+                serve_tx_result(conn, conn->path + conn->path_len - TX_HASH_HEX_LEN);
+                return;
+            }
             break;
-        case ROUTE_ERROR:
         default:
-            file = &worker->static_files.error;
-            status_code = 404;
-            status_text = "Not Found";
             break;
     }
 
-    /* Serve the static file */
-    serve_static_file(conn, file, status_code, status_text);
+    /* Serve the static file (404 for the error page) */
+    serve_static_file(conn, file);
 }
 
 /*
@@ -951,6 +1390,17 @@ static void conn_read_cb(struct bufferevent *bev, void *ctx)
             } else if (tls_version == TLS1_2_VERSION) {
                 worker->tls_protocol_tls12++;
             }
+            if (SSL_session_reused(ssl)) {
+                worker->tls_resumptions++;
+            }
+            if (worker->tls.ktls) {
+                if (tls_ktls_send_active(ssl)) {
+                    worker->tls_ktls_offloaded++;
+                } else if (worker->tls_ktls_fallbacks++ == 0) {
+                    log_warn("kTLS not active for cipher %s (tls kernel module loaded?), "
+                             "encrypting in userspace", SSL_get_cipher_name(ssl));
+                }
+            }
 
             /* Check ALPN result */
             if (tls_is_http2(ssl)) {
@@ -992,8 +1442,10 @@ static void conn_read_cb(struct bufferevent *bev, void *ctx)
     double check_elapsed = (now.tv_sec - conn->last_progress_time.tv_sec) +
                            (now.tv_nsec - conn->last_progress_time.tv_nsec) / 1e9;
     if (check_elapsed >= THROUGHPUT_CHECK_INTERVAL_SEC) {
-        size_t bytes_this_period = available - conn->bytes_at_last_check;
-        if (available < conn->bytes_at_last_check ||
+        /* Count bytes a streamed transaction already drained too */
+        size_t received = available + conn->input_consumed;
+        size_t bytes_this_period = received - conn->bytes_at_last_check;
+        if (received < conn->bytes_at_last_check ||
             bytes_this_period < MIN_BYTES_PER_CHECK) {
             log_warn("Slowloris: Throughput too low (%zu bytes in %.1fs) from %s [%s]",
                      bytes_this_period, check_elapsed, log_format_ip(conn->client_ip),
@@ -1004,22 +1456,19 @@ static void conn_read_cb(struct bufferevent *bev, void *ctx)
         }
         /* Reset check window */
         conn->last_progress_time = now;
-        conn->bytes_at_last_check = available;
+        conn->bytes_at_last_check = received;
     }
 
     /* Handle HTTP/2 connections */
     if (conn->protocol == PROTO_HTTP_2 && conn->h2) {
-        /* Re-read available in case it changed during HTTP/2 init */
-        available = evbuffer_get_length(input);
-        if (available > 0) {
-            unsigned char *data = evbuffer_pullup(input, available);
-            if (data) {
-                if (h2_process_input(conn, data, available) < 0) {
-                    connection_free(conn);
-                    return;
-                }
-                evbuffer_drain(input, available);
-            }
+        if (h2_process_input(conn, input) < 0) {
+            connection_free(conn);
+            return;
+        }
+        /* Over budget: come back after the rest of the loop has run */
+        if (evbuffer_get_length(input) > 0) {
+            worker->h2_input_yields++;
+            bufferevent_trigger(bev, EV_READ, BEV_TRIG_DEFER_CALLBACKS);
         }
         return;
     }
@@ -1027,142 +1476,196 @@ static void conn_read_cb(struct bufferevent *bev, void *ctx)
     /* HTTP/1.1 handling continues below */
     /* Note: Slowloris checks already done above for all protocols */
 
-    if (conn->state == CONN_STATE_READING_HEADERS) {
-        /* Check against configured max buffer size */
-        if (available > cfg->max_buffer_size) {
-            log_warn("Request exceeds max buffer size (%zu bytes) from %s",
-                     cfg->max_buffer_size, log_format_ip(conn->client_ip));
-            connection_send_error(conn, 413, "Request Entity Too Large");
-            return;
-        }
+    for (;;) {
+        available = evbuffer_get_length(input);
 
-        /* Try to promote tier if needed BEFORE processing more data */
-        if (try_promote_tier(conn, available) < 0) {
-            /* No slots available in higher tier - reject request */
-            worker->slot_promotion_failures++;
-            connection_send_error(conn, 503, "Service Unavailable");
-            return;
-        }
+        if (conn->state == CONN_STATE_READING_HEADERS) {
+            /* Check against configured max buffer size */
+            if (available + conn->input_consumed > cfg->max_buffer_size) {
+                log_warn("Request exceeds max buffer size (%zu bytes) from %s",
+                         cfg->max_buffer_size, log_format_ip(conn->client_ip));
+                connection_send_error(conn, 413, "Request Entity Too Large");
+                return;
+            }
 
-        /* Search for end of headers (\r\n\r\n) WITHOUT copying
-         * Start search from where we left off (headers_scanned) */
-        struct evbuffer_ptr start_ptr;
-        if (conn->headers_scanned > 0) {
-            evbuffer_ptr_set(input, &start_ptr, conn->headers_scanned, EVBUFFER_PTR_SET);
-        } else {
-            evbuffer_ptr_set(input, &start_ptr, 0, EVBUFFER_PTR_SET);
-        }
+            /* Try to promote tier if needed BEFORE processing more data */
+            if (try_promote_tier(conn, available + conn->input_consumed) < 0) {
+                /* No slots available in higher tier - reject request */
+                worker->slot_promotion_failures++;
+                connection_send_error(conn, 503, "Service Unavailable");
+                return;
+            }
+
+            /* Search for end of headers (\r\n\r\n) WITHOUT copying
+             * Start search from where we left off (headers_scanned) */
+            struct evbuffer_ptr start_ptr;
+            if (conn->headers_scanned > 0) {
+                evbuffer_ptr_set(input, &start_ptr, conn->headers_scanned, EVBUFFER_PTR_SET);
+            } else {
+                evbuffer_ptr_set(input, &start_ptr, 0, EVBUFFER_PTR_SET);
+            }
 
-        struct evbuffer_ptr found = evbuffer_search(input, "\r\n\r\n", 4, &start_ptr);
+            struct evbuffer_ptr found = evbuffer_search(input, "\r\n\r\n", 4, &start_ptr);
 
-        if (found.pos < 0) {
-            /* Not found yet - remember how much we've scanned */
-            conn->headers_scanned = available > 3 ? available - 3 : 0;
+            if (found.pos < 0) {
+                /* Not found yet - remember how much we've scanned */
+                conn->headers_scanned = available > 3 ? available - 3 : 0;
 
-            /* Early validation - pullup first line to validate path */
-            if (available > 0) {
-                unsigned char *data = evbuffer_pullup(input, available);
-                if (data && validate_path_early(conn, data, available) < 0) {
-                    worker->errors_parse++;
-                    connection_send_error(conn, 400, "Bad Request - Invalid Characters");
+                /* Early validation of the bytes that arrived since last time */
+                if (validate_path_early(conn, input, available) < 0) {
+                    send_path_error(conn);
                     return;
                 }
-            }
-            return;  /* Wait for more data */
-        }
-
-        /* Found \r\n\r\n - headers are complete! */
-        size_t headers_len = found.pos + 4;  /* Include the \r\n\r\n */
-        conn->headers_end = headers_len;
 
-        /* Get contiguous view of headers (single pullup, zero-copy if already contiguous) */
-        unsigned char *headers = evbuffer_pullup(input, headers_len);
-        if (!headers) {
-            log_error("Failed to pullup headers");
-            connection_send_error(conn, 500, "Internal Server Error");
-            return;
-        }
+                /* Huge broadcasts: decode the hex as it arrives instead of buffering it */
+                tx_stream_start(conn, input);
+                if (conn->tx_raw) {
+                    tx_stream_drain(conn, input);
+                }
+                return;  /* Wait for more data */
+            }
 
-        /* Final validation of complete headers */
-        if (validate_path_early(conn, headers, headers_len) < 0) {
-            worker->errors_parse++;
-            connection_send_error(conn, 400, "Bad Request - Invalid Characters");
-            return;
-        }
+            /* Found \r\n\r\n - headers are complete! */
+            size_t headers_len = found.pos + 4;  /* Include the \r\n\r\n */
 
-        /* Parse request line and headers */
-        if (parse_request_headers(conn, headers, headers_len) < 0) {
-            worker->errors_parse++;
-            connection_send_error(conn, 400, "Bad Request");
-            return;
-        }
+            /* Final validation: finish whatever the early pass has not seen */
+            if (validate_path_early(conn, input, headers_len) < 0) {
+                send_path_error(conn);
+                return;
+            }
+            if (conn->tx_raw) {
+                headers_len -= tx_stream_drain(conn, input);
+            }
+            conn->headers_end = headers_len;
+
+            /* Get contiguous view of headers (single pullup, zero-copy if already contiguous) */
+            unsigned char *headers = evbuffer_pullup(input, headers_len);
+            if (!headers) {
+                log_error("Failed to pullup headers");
+                connection_send_error(conn, 500, "Internal Server Error");
+                return;
+            }
 
-        /* Security: Check Content-Length against max_buffer_size */
-        if (conn->content_length > cfg->max_buffer_size) {
-            log_warn("Content-Length %zu exceeds max_buffer_size %zu from %s",
-                     conn->content_length, cfg->max_buffer_size,
-                     log_format_ip(conn->client_ip));
-            connection_send_error(conn, 413, "Payload Too Large");
-            return;
-        }
+            /* Parse request line and headers, then take the head off the
+             * input: a long path is read in place and must not move when
+             * more input arrives */
+            int parsed = parse_request_headers(conn, headers, headers_len);
+            if (connection_take_head(conn, input, headers, headers_len) < 0) {
+                log_error("Failed to keep request head");
+                connection_send_error(conn, 500, "Internal Server Error");
+                return;
+            }
+            if (parsed < 0) {
+                worker->errors_parse++;
+                connection_send_error(conn, 400, "Bad Request");
+                return;
+            }
 
-        /* Drain the headers from evbuffer */
-        evbuffer_drain(input, headers_len);
+            /* Security: Check Content-Length against max_buffer_size */
+            if (conn->content_length > cfg->max_buffer_size) {
+                log_warn("Content-Length %zu exceeds max_buffer_size %zu from %s",
+                         conn->content_length, cfg->max_buffer_size,
+                         log_format_ip(conn->client_ip));
+                connection_send_error(conn, 413, "Payload Too Large");
+                return;
+            }
 
-        /* Check for body */
-        size_t remaining = evbuffer_get_length(input);
-        conn->body_received = remaining;
+            /* Check for body */
+            size_t remaining = evbuffer_get_length(input);
+            conn->body_received = remaining;
 
-        if (conn->content_length > 0 && conn->body_received < conn->content_length) {
-            /* Need to read more body */
-            conn->state = CONN_STATE_READING_BODY;
+            if (conn->content_length > 0 && conn->body_received < conn->content_length) {
+                /* Need to read more body */
+                conn->state = CONN_STATE_READING_BODY;
 
-            /* Drain any body data already received */
-            if (remaining > 0) {
-                evbuffer_drain(input, remaining);
+                /* Drain any body data already received */
+                if (remaining > 0) {
+                    evbuffer_drain(input, remaining);
+                }
+            } else {
+                /* Complete request - process it. Bytes past the body are the
+                 * next pipelined request and stay in input. */
+                if (conn->content_length > 0) {
+                    evbuffer_drain(input, conn->content_length);
+                    conn->body_received = conn->content_length;
+                }
+                /* Release large/huge slot ASAP - only needed for receiving */
+                downgrade_tier_to_normal(conn);
+                process_request(conn);
+            }
+        } else if (conn->state == CONN_STATE_READING_BODY) {
+            /* Read body data */
+            size_t remaining = conn->content_length - conn->body_received;
+            size_t to_drain = (available < remaining) ? available : remaining;
+
+            /* For now, just drain the body - we don't process it yet */
+            evbuffer_drain(input, to_drain);
+            conn->body_received += to_drain;
+
+            if (conn->body_received >= conn->content_length) {
+                /* Body complete - process request */
+                /* Release large/huge slot ASAP - only needed for receiving */
+                downgrade_tier_to_normal(conn);
+                process_request(conn);
             }
         } else {
-            /* Complete request - process it */
-            if (remaining > 0) {
-                /* Note: HTTP pipelining not supported - extra data is discarded.
-                 * This could be a pipelined request or trailing garbage. */
-                log_debug("Discarding %zu bytes after request from %s (pipelining unsupported)",
-                          remaining, log_format_ip(conn->client_ip));
-                evbuffer_drain(input, remaining);
+            /* Busy with a response; the next request waits in input.
+             * Stop reading once more than a full request is buffered. */
+            if (available > cfg->max_buffer_size) {
+                bufferevent_disable(bev, EV_READ);
             }
-            /* Release large/huge slot ASAP - only needed for receiving */
-            downgrade_tier_to_normal(conn);
-            process_request(conn);
+            return;
         }
-    } else if (conn->state == CONN_STATE_READING_BODY) {
-        /* Read body data */
-        size_t remaining = conn->content_length - conn->body_received;
-        size_t to_drain = (available < remaining) ? available : remaining;
-
-        /* For now, just drain the body - we don't process it yet */
-        evbuffer_drain(input, to_drain);
-        conn->body_received += to_drain;
-
-        if (conn->body_received >= conn->content_length) {
-            /* Body complete - process request */
-            /* Release large/huge slot ASAP - only needed for receiving */
-            downgrade_tier_to_normal(conn);
-            process_request(conn);
+
+        /* The next pipelined request may already be buffered */
+        if (!pipeline_next(conn, input)) {
+            return;
         }
     }
 }
 
+/*
+ * A response was just queued. With keep-alive and the next request
+ * already buffered (pipelining), reset and parse it now rather than
+ * after the output drains: its response is appended behind this one, so
+ * responses leave in request order. Once PIPELINE_MAX_DEPTH responses
+ * are queued, the rest wait for conn_write_cb().
+ * Returns true if the connection is ready to parse the buffered input.
+ */
+static bool pipeline_next(Connection *conn, struct evbuffer *input)
+{
+    if (conn->state != CONN_STATE_WRITING_RESPONSE || !conn->keep_alive ||
+        evbuffer_get_length(input) == 0 || conn->pipeline_depth >= PIPELINE_MAX_DEPTH) {
+        return false;
+    }
+
+    /* Logged when queued: this response shares the output with the next */
+    log_request_complete(conn);
+    conn->pipeline_depth++;
+    conn->worker->requests_pipelined++;
+
+    connection_reset_for_keepalive(conn);
+    if (!conn->slot_held) {
+        /* No slot for the next request: close once the output drains */
+        conn->state = CONN_STATE_CLOSING;
+        return false;
+    }
+    return true;
+}
+
 /*
  * Reset connection state for next keep-alive request.
  */
 static void connection_reset_for_keepalive(Connection *conn)
 {
     /* Free path from previous request */
-    if (conn->path) {
-        free(conn->path);
-        conn->path = NULL;
-    }
+    connection_free_path(conn);
     conn->path_len = 0;
+    conn->accept_json = false;
+    conn->accept_encodings = 0;
+    conn->has_if_none_match = false;
+    conn->if_modified_since = -1;
+    tx_stream_release(conn);
 
     /* Reset parsing state */
     conn->headers_scanned = 0;
@@ -1170,8 +1673,10 @@ static void connection_reset_for_keepalive(Connection *conn)
     conn->content_length = 0;
     conn->body_received = 0;
     conn->method[0] = '\0';
-    conn->path_validated = false;
-    conn->validation_failed = false;
+    conn->path_scan = PATH_SCAN_METHOD;
+    conn->path_scan_offset = 0;
+    conn->path_prefix_len = 0;
+    conn->input_consumed = 0;
 
     /* Release current tier slot and reset to normal */
     if (conn->slot_held && conn->current_tier != TIER_NORMAL) {
@@ -1267,6 +1772,9 @@ static void conn_write_cb(struct bufferevent *bev, void *ctx)
         return;
     }
 
+    /* Every queued pipelined response is on the wire */
+    conn->pipeline_depth = 0;
+
     if (conn->state == CONN_STATE_WRITING_RESPONSE && conn->keep_alive) {
         /* Keep-alive: reset for next request */
         connection_reset_for_keepalive(conn);
@@ -1276,6 +1784,11 @@ static void conn_write_cb(struct bufferevent *bev, void *ctx)
             return;
         }
         bufferevent_enable(bev, EV_READ);
+
+        /* A pipelined request already buffered gets no read event: parse it now */
+        if (evbuffer_get_length(bufferevent_get_input(bev)) > 0) {
+            conn_read_cb(bev, conn);
+        }
     }
 }
 
@@ -1289,7 +1802,13 @@ static void conn_event_cb(struct bufferevent *bev, short events, void *ctx)
     (void)bev;
 
     if (events & BEV_EVENT_CONNECTED) {
-        /* TLS handshake completed - don't free, continue processing */
+        /* TLS handshake completed on the event loop (start_time is the
+         * accept until the first request) - don't free, continue processing */
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        update_tls_handshake_histogram(worker,
+            (now.tv_sec - conn->start_time.tv_sec) +
+            (now.tv_nsec - conn->start_time.tv_nsec) / 1e9);
         return;
     }
 
@@ -0,0 +1,70 @@
+/*
+ * Runtime CPU feature detection (see cpu.h).
+ */
+
+#include "cpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+/* XCR0 bits the OS must enable before AVX/AVX-512 registers are usable */
+#define XCR0_SSE_AVX   0x06
+#define XCR0_AVX512    0xE0
+
+static unsigned long long cpu_xgetbv(void)
+{
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+}
+
+static unsigned int cpu_detect(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int features = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    if (ecx & bit_SSSE3)  features |= CPU_SSSE3;
+    if (ecx & bit_SSE4_1) features |= CPU_SSE41;
+    if (ecx & bit_SSE4_2) features |= CPU_SSE42;
+
+    int osxsave = (ecx & bit_OSXSAVE) != 0;
+    unsigned long long xcr0 = osxsave ? cpu_xgetbv() : 0;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    if ((xcr0 & XCR0_SSE_AVX) == XCR0_SSE_AVX && (ebx & bit_AVX2)) {
+        features |= CPU_AVX2;
+        if ((xcr0 & XCR0_AVX512) == XCR0_AVX512 &&
+            (ebx & bit_AVX512F) && (ebx & bit_AVX512BW)) {
+            features |= CPU_AVX512BW;
+        }
+    }
+    if (ebx & bit_SHA) features |= CPU_SHA;
+
+    return features;
+}
+
+#else
+
+static unsigned int cpu_detect(void)
+{
+    return 0;
+}
+
+#endif
+
+unsigned int cpu_features(void)
+{
+    static int detected = 0;
+    static unsigned int features = 0;
+
+    if (!detected) {
+        features = cpu_detect();
+        detected = 1;
+    }
+    return features;
+}
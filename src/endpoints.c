@@ -17,6 +17,21 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <event2/buffer.h>
+
+/* Upper bounds of the finite buckets; the last bucket is +Inf */
+static const double tls_handshake_le[TLS_HANDSHAKE_BUCKETS - 1] = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.5
+};
+static const char *tls_handshake_le_str[TLS_HANDSHAKE_BUCKETS] = {
+    "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.5", "+Inf"
+};
+static const double loop_lag_le[LOOP_LAG_BUCKETS - 1] = {
+    0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.5
+};
+static const char *loop_lag_le_str[LOOP_LAG_BUCKETS] = {
+    "0.001", "0.005", "0.01", "0.025", "0.05", "0.1", "0.5", "+Inf"
+};
 
 /*
  * Get number of open file descriptors for this process.
@@ -122,22 +137,28 @@ int generate_health_body(WorkerProcess *worker, char *buf, size_t bufsize)
     return body_len;
 }
 
+/*
+ * Requests served by the static asset at url, 0 if there is none.
+ */
+static uint64_t asset_requests(WorkerProcess *worker, const char *url)
+{
+    const StaticFile *file = static_files_find(worker->static_files, url);
+    return file ? file->requests : 0;
+}
+
 /*
  * Generate /metrics Prometheus response body.
  */
-int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
+int generate_metrics_body(WorkerProcess *worker, struct evbuffer *out)
 {
-    size_t offset = 0;
-    size_t remaining = bufsize - 1;  /* Reserve space for null terminator */
+    size_t start = evbuffer_get_length(out);
     int n;
 
-    /* Helper macro to safely advance buffer position */
-    #define METRICS_ADVANCE() do { \
-        if (n > 0 && (size_t)n < remaining) { \
-            offset += (size_t)n; \
-            remaining -= (size_t)n; \
-        } else { \
-            remaining = 0; \
+    /* The body grows with the chains and node error codes: a failed
+     * append (out of memory) fails the whole response, never a section */
+    #define METRICS_CHECK() do { \
+        if (n < 0) { \
+            goto fail; \
         } \
     } while(0)
 
@@ -152,7 +173,7 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
     int max_fds = get_max_fds();
 
     /* === Basic Counters === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_requests_total Total requests processed\n"
         "# TYPE rawrelay_requests_total counter\n"
         "rawrelay_requests_total{worker=\"%d\"} %lu\n"
@@ -182,10 +203,10 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, (unsigned long)worker->connections_rejected_blocked,
         worker->worker_id, (unsigned long)worker->connections_allowlisted,
         worker->worker_id, worker->active_connections);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === Request Latency Histogram === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_request_duration_seconds Request latency histogram\n"
         "# TYPE rawrelay_request_duration_seconds histogram\n"
         "rawrelay_request_duration_seconds_bucket{worker=\"%d\",le=\"0.001\"} %lu\n"
@@ -211,13 +232,14 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, (unsigned long)worker->latency_bucket_inf,
         worker->worker_id, worker->latency_sum_seconds,
         worker->worker_id, (unsigned long)worker->latency_bucket_inf);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === HTTP Status Code Counters === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_http_requests_total HTTP requests by status code\n"
         "# TYPE rawrelay_http_requests_total counter\n"
         "rawrelay_http_requests_total{worker=\"%d\",status=\"200\"} %lu\n"
+        "rawrelay_http_requests_total{worker=\"%d\",status=\"304\"} %lu\n"
         "rawrelay_http_requests_total{worker=\"%d\",status=\"400\"} %lu\n"
         "rawrelay_http_requests_total{worker=\"%d\",status=\"404\"} %lu\n"
         "rawrelay_http_requests_total{worker=\"%d\",status=\"408\"} %lu\n"
@@ -227,22 +249,25 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         "# HELP rawrelay_http_requests_by_class_total HTTP requests by status class\n"
         "# TYPE rawrelay_http_requests_by_class_total counter\n"
         "rawrelay_http_requests_by_class_total{worker=\"%d\",class=\"2xx\"} %lu\n"
+        "rawrelay_http_requests_by_class_total{worker=\"%d\",class=\"3xx\"} %lu\n"
         "rawrelay_http_requests_by_class_total{worker=\"%d\",class=\"4xx\"} %lu\n"
         "rawrelay_http_requests_by_class_total{worker=\"%d\",class=\"5xx\"} %lu\n"
         "\n",
         worker->worker_id, (unsigned long)worker->status_200,
+        worker->worker_id, (unsigned long)worker->status_304,
         worker->worker_id, (unsigned long)worker->status_400,
         worker->worker_id, (unsigned long)worker->status_404,
         worker->worker_id, (unsigned long)worker->status_408,
         worker->worker_id, (unsigned long)worker->status_429,
         worker->worker_id, (unsigned long)worker->status_503,
         worker->worker_id, (unsigned long)worker->status_2xx,
+        worker->worker_id, (unsigned long)worker->status_3xx,
         worker->worker_id, (unsigned long)worker->status_4xx,
         worker->worker_id, (unsigned long)worker->status_5xx);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === Request Method Counters === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_requests_by_method_total HTTP requests by method\n"
         "# TYPE rawrelay_requests_by_method_total counter\n"
         "rawrelay_requests_by_method_total{worker=\"%d\",method=\"GET\"} %lu\n"
@@ -252,10 +277,10 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, (unsigned long)worker->method_get,
         worker->worker_id, (unsigned long)worker->method_post,
         worker->worker_id, (unsigned long)worker->method_other);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === Process Info === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_process_start_time_seconds Unix timestamp of process start\n"
         "# TYPE rawrelay_process_start_time_seconds gauge\n"
         "rawrelay_process_start_time_seconds{worker=\"%d\"} %ld\n"
@@ -266,11 +291,11 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         "\n",
         worker->worker_id, (long)worker->start_wallclock,
         worker->worker_id, uptime_sec);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === File Descriptor Metrics === */
     if (open_fds >= 0 && max_fds >= 0) {
-        n = snprintf(buf + offset, remaining,
+        n = evbuffer_add_printf(out,
             "# HELP rawrelay_open_fds Current number of open file descriptors\n"
             "# TYPE rawrelay_open_fds gauge\n"
             "rawrelay_open_fds{worker=\"%d\"} %d\n"
@@ -281,39 +306,124 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
             "\n",
             worker->worker_id, open_fds,
             worker->worker_id, max_fds);
-        METRICS_ADVANCE();
+        METRICS_CHECK();
     }
 
     /* === TLS Metrics === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_tls_handshakes_total TLS handshakes by protocol version\n"
         "# TYPE rawrelay_tls_handshakes_total counter\n"
         "rawrelay_tls_handshakes_total{worker=\"%d\",protocol=\"TLSv1.2\"} %lu\n"
         "rawrelay_tls_handshakes_total{worker=\"%d\",protocol=\"TLSv1.3\"} %lu\n"
         "\n"
+        "# HELP rawrelay_tls_resumptions_total TLS handshakes that resumed a session\n"
+        "# TYPE rawrelay_tls_resumptions_total counter\n"
+        "rawrelay_tls_resumptions_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_tls_ticket_unknown_key_total Session tickets whose key was rotated out or unknown\n"
+        "# TYPE rawrelay_tls_ticket_unknown_key_total counter\n"
+        "rawrelay_tls_ticket_unknown_key_total{worker=\"%d\"} %lu\n"
+        "\n"
         "# HELP rawrelay_tls_handshake_errors_total TLS handshake errors\n"
         "# TYPE rawrelay_tls_handshake_errors_total counter\n"
         "rawrelay_tls_handshake_errors_total{worker=\"%d\"} %lu\n"
         "\n",
         worker->worker_id, (unsigned long)worker->tls_protocol_tls12,
         worker->worker_id, (unsigned long)worker->tls_protocol_tls13,
+        worker->worker_id, (unsigned long)worker->tls_resumptions,
+        worker->worker_id, (unsigned long)worker->tls.ticket_unknown_key,
         worker->worker_id, (unsigned long)worker->tls_handshake_errors);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
+
+    /* === Kernel TLS === */
+    if (worker->tls.ktls) {
+        n = evbuffer_add_printf(out,
+            "# HELP rawrelay_tls_ktls_total TLS handshakes by record encryption path with ktls on\n"
+            "# TYPE rawrelay_tls_ktls_total counter\n"
+            "rawrelay_tls_ktls_total{worker=\"%d\",result=\"offloaded\"} %lu\n"
+            "rawrelay_tls_ktls_total{worker=\"%d\",result=\"fallback\"} %lu\n"
+            "\n",
+            worker->worker_id, (unsigned long)worker->tls_ktls_offloaded,
+            worker->worker_id, (unsigned long)worker->tls_ktls_fallbacks);
+        METRICS_CHECK();
+    }
+
+    /* === TLS handshake time and offload === */
+    if (worker->config->tls_enabled) {
+        uint64_t cumulative = 0;
+        n = evbuffer_add_printf(out,
+            "# HELP rawrelay_tls_handshake_duration_seconds Accept to completed TLS handshake\n"
+            "# TYPE rawrelay_tls_handshake_duration_seconds histogram\n");
+        METRICS_CHECK();
+        for (int b = 0; b < TLS_HANDSHAKE_BUCKETS; b++) {
+            cumulative += worker->tls_handshake_buckets[b];
+            n = evbuffer_add_printf(out,
+                "rawrelay_tls_handshake_duration_seconds_bucket{worker=\"%d\",le=\"%s\"} %lu\n",
+                worker->worker_id, tls_handshake_le_str[b], (unsigned long)cumulative);
+            METRICS_CHECK();
+        }
+        n = evbuffer_add_printf(out,
+            "rawrelay_tls_handshake_duration_seconds_sum{worker=\"%d\"} %.6f\n"
+            "rawrelay_tls_handshake_duration_seconds_count{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tls_handshakes_offloaded_total TLS handshakes done on a handshake thread\n"
+            "# TYPE rawrelay_tls_handshakes_offloaded_total counter\n"
+            "rawrelay_tls_handshakes_offloaded_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tls_offload_overflows_total TLS handshakes done on the event loop because every handshake thread was full\n"
+            "# TYPE rawrelay_tls_offload_overflows_total counter\n"
+            "rawrelay_tls_offload_overflows_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tls_handshakes_in_flight TLS handshakes currently on handshake threads\n"
+            "# TYPE rawrelay_tls_handshakes_in_flight gauge\n"
+            "rawrelay_tls_handshakes_in_flight{worker=\"%d\"} %d\n"
+            "\n",
+            worker->worker_id, worker->tls_handshake_sum_seconds,
+            worker->worker_id, (unsigned long)worker->tls_handshake_count,
+            worker->worker_id, (unsigned long)worker->tls_handshakes_offloaded,
+            worker->worker_id, (unsigned long)worker->tls_offload_overflows,
+            worker->worker_id, worker->tls_offload.in_flight);
+        METRICS_CHECK();
+    }
+
+    /* === Event loop lag === */
+    {
+        uint64_t cumulative = 0;
+        n = evbuffer_add_printf(out,
+            "# HELP rawrelay_event_loop_lag_seconds How late a %dms event loop timer fired\n"
+            "# TYPE rawrelay_event_loop_lag_seconds histogram\n",
+            LOOP_PROBE_INTERVAL_MS);
+        METRICS_CHECK();
+        for (int b = 0; b < LOOP_LAG_BUCKETS; b++) {
+            cumulative += worker->loop_lag_buckets[b];
+            n = evbuffer_add_printf(out,
+                "rawrelay_event_loop_lag_seconds_bucket{worker=\"%d\",le=\"%s\"} %lu\n",
+                worker->worker_id, loop_lag_le_str[b], (unsigned long)cumulative);
+            METRICS_CHECK();
+        }
+        n = evbuffer_add_printf(out,
+            "rawrelay_event_loop_lag_seconds_sum{worker=\"%d\"} %.6f\n"
+            "rawrelay_event_loop_lag_seconds_count{worker=\"%d\"} %lu\n"
+            "\n",
+            worker->worker_id, worker->loop_lag_sum_seconds,
+            worker->worker_id, (unsigned long)worker->loop_lag_count);
+        METRICS_CHECK();
+    }
 
     /* === TLS Certificate Expiry === */
     time_t cert_expiry = tls_get_cert_expiry(&worker->tls);
     if (cert_expiry > 0) {
-        n = snprintf(buf + offset, remaining,
+        n = evbuffer_add_printf(out,
             "# HELP rawrelay_tls_cert_expiry_timestamp_seconds Unix timestamp when certificate expires\n"
             "# TYPE rawrelay_tls_cert_expiry_timestamp_seconds gauge\n"
             "rawrelay_tls_cert_expiry_timestamp_seconds{worker=\"%d\"} %ld\n"
             "\n",
             worker->worker_id, (long)cert_expiry);
-        METRICS_ADVANCE();
+        METRICS_CHECK();
     }
 
     /* === HTTP/2 Metrics === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_http2_streams_total Total HTTP/2 streams opened\n"
         "# TYPE rawrelay_http2_streams_total counter\n"
         "rawrelay_http2_streams_total{worker=\"%d\"} %lu\n"
@@ -329,15 +439,25 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         "# HELP rawrelay_http2_goaway_total HTTP/2 GOAWAY frames sent\n"
         "# TYPE rawrelay_http2_goaway_total counter\n"
         "rawrelay_http2_goaway_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_http2_header_arena_overflows_total HTTP/2 streams whose header strings outgrew the stream's arena\n"
+        "# TYPE rawrelay_http2_header_arena_overflows_total counter\n"
+        "rawrelay_http2_header_arena_overflows_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_http2_input_yields_total HTTP/2 reads that deferred input past the per-read budget\n"
+        "# TYPE rawrelay_http2_input_yields_total counter\n"
+        "rawrelay_http2_input_yields_total{worker=\"%d\"} %lu\n"
         "\n",
         worker->worker_id, (unsigned long)worker->h2_streams_total,
         worker->worker_id, worker->h2_streams_active,
         worker->worker_id, (unsigned long)worker->h2_rst_stream_total,
-        worker->worker_id, (unsigned long)worker->h2_goaway_sent);
-    METRICS_ADVANCE();
+        worker->worker_id, (unsigned long)worker->h2_goaway_sent,
+        worker->worker_id, (unsigned long)worker->h2_header_arena_overflows,
+        worker->worker_id, (unsigned long)worker->h2_input_yields);
+    METRICS_CHECK();
 
     /* === Error Type Counters === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_errors_total Errors by type\n"
         "# TYPE rawrelay_errors_total counter\n"
         "rawrelay_errors_total{worker=\"%d\",type=\"timeout\"} %lu\n"
@@ -347,10 +467,10 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, (unsigned long)worker->errors_timeout,
         worker->worker_id, (unsigned long)worker->errors_parse,
         worker->worker_id, (unsigned long)worker->errors_tls);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === Slot Metrics === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "# HELP rawrelay_slots_used Slots currently in use by tier\n"
         "# TYPE rawrelay_slots_used gauge\n"
         "rawrelay_slots_used{worker=\"%d\",tier=\"normal\"} %d\n"
@@ -373,10 +493,10 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, slot_manager_max(&worker->slots, TIER_LARGE),
         worker->worker_id, slot_manager_max(&worker->slots, TIER_HUGE),
         worker->worker_id, rate_limiter_get_entry_count(&worker->rate_limiter));
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === Extended Metrics === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "\n"
         "# HELP rawrelay_response_bytes_total Total response bytes sent\n"
         "# TYPE rawrelay_response_bytes_total counter\n"
@@ -392,15 +512,73 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         "\n"
         "# HELP rawrelay_keepalive_reuses_total Requests served on reused keep-alive connections\n"
         "# TYPE rawrelay_keepalive_reuses_total counter\n"
-        "rawrelay_keepalive_reuses_total{worker=\"%d\"} %lu\n",
+        "rawrelay_keepalive_reuses_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_pipelined_requests_total HTTP/1.1 requests parsed while earlier responses were still queued\n"
+        "# TYPE rawrelay_pipelined_requests_total counter\n"
+        "rawrelay_pipelined_requests_total{worker=\"%d\"} %lu\n",
         worker->worker_id, (unsigned long)worker->response_bytes_total,
         worker->worker_id, (unsigned long)worker->slowloris_kills,
         worker->worker_id, (unsigned long)worker->slot_promotion_failures,
-        worker->worker_id, (unsigned long)worker->keepalive_reuses);
-    METRICS_ADVANCE();
+        worker->worker_id, (unsigned long)worker->keepalive_reuses,
+        worker->worker_id, (unsigned long)worker->requests_pipelined);
+    METRICS_CHECK();
+
+    /* === Static Page Compression === */
+    const StaticFiles *sf = worker->static_files;
+    n = evbuffer_add_printf(out,
+        "\n"
+        "# HELP rawrelay_static_responses_total Static page responses by content encoding\n"
+        "# TYPE rawrelay_static_responses_total counter\n"
+        "rawrelay_static_responses_total{worker=\"%d\",encoding=\"identity\"} %lu\n"
+        "rawrelay_static_responses_total{worker=\"%d\",encoding=\"gzip\"} %lu\n"
+        "rawrelay_static_responses_total{worker=\"%d\",encoding=\"br\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_response_bytes_total Static page body bytes sent by content encoding\n"
+        "# TYPE rawrelay_static_response_bytes_total counter\n"
+        "rawrelay_static_response_bytes_total{worker=\"%d\",encoding=\"identity\"} %lu\n"
+        "rawrelay_static_response_bytes_total{worker=\"%d\",encoding=\"gzip\"} %lu\n"
+        "rawrelay_static_response_bytes_total{worker=\"%d\",encoding=\"br\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_bytes_saved_total Static page body bytes not sent thanks to compression\n"
+        "# TYPE rawrelay_static_bytes_saved_total counter\n"
+        "rawrelay_static_bytes_saved_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_not_modified_total Static page requests answered 304 Not Modified\n"
+        "# TYPE rawrelay_static_not_modified_total counter\n"
+        "rawrelay_static_not_modified_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_not_modified_bytes_total Static page body bytes the 304 responses did not send\n"
+        "# TYPE rawrelay_static_not_modified_bytes_total counter\n"
+        "rawrelay_static_not_modified_bytes_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_assets Files loaded from the static directory\n"
+        "# TYPE rawrelay_static_assets gauge\n"
+        "rawrelay_static_assets{worker=\"%d\"} %zu\n"
+        "\n"
+        "# HELP rawrelay_static_reloads_total Static directory reloads swapped in after a change\n"
+        "# TYPE rawrelay_static_reloads_total counter\n"
+        "rawrelay_static_reloads_total{worker=\"%d\"} %lu\n"
+        "\n"
+        "# HELP rawrelay_static_reload_failures_total Static directory reloads that failed (previous files kept)\n"
+        "# TYPE rawrelay_static_reload_failures_total counter\n"
+        "rawrelay_static_reload_failures_total{worker=\"%d\"} %lu\n",
+        worker->worker_id, (unsigned long)sf->responses[STATIC_ENCODING_IDENTITY],
+        worker->worker_id, (unsigned long)sf->responses[STATIC_ENCODING_GZIP],
+        worker->worker_id, (unsigned long)sf->responses[STATIC_ENCODING_BROTLI],
+        worker->worker_id, (unsigned long)sf->bytes_sent[STATIC_ENCODING_IDENTITY],
+        worker->worker_id, (unsigned long)sf->bytes_sent[STATIC_ENCODING_GZIP],
+        worker->worker_id, (unsigned long)sf->bytes_sent[STATIC_ENCODING_BROTLI],
+        worker->worker_id, (unsigned long)sf->bytes_saved,
+        worker->worker_id, (unsigned long)sf->not_modified,
+        worker->worker_id, (unsigned long)sf->not_modified_bytes,
+        worker->worker_id, sf->count,
+        worker->worker_id, (unsigned long)worker->static_reloads,
+        worker->worker_id, (unsigned long)worker->static_reload_failures);
+    METRICS_CHECK();
 
     /* === Per-Endpoint Counters === */
-    n = snprintf(buf + offset, remaining,
+    n = evbuffer_add_printf(out,
         "\n"
         "# HELP rawrelay_endpoint_requests_total Requests by endpoint\n"
         "# TYPE rawrelay_endpoint_requests_total counter\n"
@@ -421,19 +599,19 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         worker->worker_id, (unsigned long)worker->endpoint_alive,
         worker->worker_id, (unsigned long)worker->endpoint_version,
         worker->worker_id, (unsigned long)worker->endpoint_metrics,
-        worker->worker_id, (unsigned long)worker->endpoint_home,
+        worker->worker_id, (unsigned long)asset_requests(worker, "/"),
         worker->worker_id, (unsigned long)worker->endpoint_broadcast,
         worker->worker_id, (unsigned long)worker->endpoint_result,
-        worker->worker_id, (unsigned long)worker->endpoint_docs,
-        worker->worker_id, (unsigned long)worker->endpoint_status,
-        worker->worker_id, (unsigned long)worker->endpoint_logos,
+        worker->worker_id, (unsigned long)asset_requests(worker, "/docs"),
+        worker->worker_id, (unsigned long)asset_requests(worker, "/status"),
+        worker->worker_id, (unsigned long)asset_requests(worker, "/logos"),
         worker->worker_id, (unsigned long)worker->endpoint_acme);
-    METRICS_ADVANCE();
+    METRICS_CHECK();
 
     /* === RPC / Bitcoin Node Metrics === */
     {
         RPCManager *rpc = &worker->rpc;
-        n = snprintf(buf + offset, remaining,
+        n = evbuffer_add_printf(out,
             "\n"
             "# HELP rawrelay_rpc_broadcasts_total Total transaction broadcast attempts\n"
             "# TYPE rawrelay_rpc_broadcasts_total counter\n"
@@ -449,7 +627,7 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
             worker->worker_id, (unsigned long)rpc->total_broadcasts,
             worker->worker_id, (unsigned long)rpc->successful_broadcasts,
             worker->worker_id, (unsigned long)rpc->failed_broadcasts);
-        METRICS_ADVANCE();
+        METRICS_CHECK();
 
         /* Per-chain RPC client stats */
         struct { const char *name; RPCClient *client; } chains[] = {
@@ -463,63 +641,331 @@ int generate_metrics_body(WorkerProcess *worker, char *buf, size_t bufsize)
         for (int i = 0; i < 4; i++) {
             if (chains[i].client->host[0] == '\0') continue;
             if (first_client) {
-                n = snprintf(buf + offset, remaining,
+                n = evbuffer_add_printf(out,
                     "\n"
                     "# HELP rawrelay_rpc_requests_total Total RPC requests to Bitcoin node\n"
                     "# TYPE rawrelay_rpc_requests_total counter\n");
-                METRICS_ADVANCE();
+                METRICS_CHECK();
                 first_client = 0;
             }
-            n = snprintf(buf + offset, remaining,
+            n = evbuffer_add_printf(out,
                 "rawrelay_rpc_requests_total{worker=\"%d\",chain=\"%s\"} %lu\n",
                 worker->worker_id, chains[i].name,
                 (unsigned long)chains[i].client->request_count);
-            METRICS_ADVANCE();
+            METRICS_CHECK();
         }
 
         first_client = 1;
         for (int i = 0; i < 4; i++) {
             if (chains[i].client->host[0] == '\0') continue;
             if (first_client) {
-                n = snprintf(buf + offset, remaining,
+                n = evbuffer_add_printf(out,
                     "\n"
                     "# HELP rawrelay_rpc_errors_total Total RPC errors by chain\n"
                     "# TYPE rawrelay_rpc_errors_total counter\n");
-                METRICS_ADVANCE();
+                METRICS_CHECK();
                 first_client = 0;
             }
-            n = snprintf(buf + offset, remaining,
+            n = evbuffer_add_printf(out,
                 "rawrelay_rpc_errors_total{worker=\"%d\",chain=\"%s\"} %lu\n",
                 worker->worker_id, chains[i].name,
                 (unsigned long)chains[i].client->error_count);
-            METRICS_ADVANCE();
+            METRICS_CHECK();
         }
 
         first_client = 1;
         for (int i = 0; i < 4; i++) {
             if (chains[i].client->host[0] == '\0') continue;
             if (first_client) {
-                n = snprintf(buf + offset, remaining,
+                n = evbuffer_add_printf(out,
                     "\n"
                     "# HELP rawrelay_rpc_node_up Bitcoin node availability (1=up, 0=down)\n"
                     "# TYPE rawrelay_rpc_node_up gauge\n");
-                METRICS_ADVANCE();
+                METRICS_CHECK();
                 first_client = 0;
             }
-            n = snprintf(buf + offset, remaining,
+            n = evbuffer_add_printf(out,
                 "rawrelay_rpc_node_up{worker=\"%d\",chain=\"%s\"} %d\n",
                 worker->worker_id, chains[i].name,
                 chains[i].client->available);
-            METRICS_ADVANCE();
+            METRICS_CHECK();
+        }
+
+        /* Node errors by JSON-RPC error code */
+        first_client = 1;
+        for (int i = 0; i < 4; i++) {
+            const RPCClient *client = chains[i].client;
+            if (client->host[0] == '\0') continue;
+            if (first_client) {
+                n = evbuffer_add_printf(out,
+                    "\n"
+                    "# HELP rawrelay_rpc_node_errors_total Errors returned by the Bitcoin node, by JSON-RPC error code\n"
+                    "# TYPE rawrelay_rpc_node_errors_total counter\n");
+                METRICS_CHECK();
+                first_client = 0;
+            }
+            for (int c = 0; c < client->node_error_codes; c++) {
+                n = evbuffer_add_printf(out,
+                    "rawrelay_rpc_node_errors_total{worker=\"%d\",chain=\"%s\",code=\"%ld\"} %lu\n",
+                    worker->worker_id, chains[i].name, client->node_errors[c].code,
+                    (unsigned long)client->node_errors[c].count);
+                METRICS_CHECK();
+            }
+            n = evbuffer_add_printf(out,
+                "rawrelay_rpc_node_errors_total{worker=\"%d\",chain=\"%s\",code=\"other\"} %lu\n",
+                worker->worker_id, chains[i].name, (unsigned long)client->node_errors_other);
+            METRICS_CHECK();
+        }
+
+        /* Per-chain keep-alive connection pool stats */
+        struct { const char *name; const char *help; const char *type; int field; } pool_metrics[] = {
+            { "rawrelay_rpc_pool_hits_total",
+              "RPC requests that reused an idle pooled connection", "counter", 0 },
+            { "rawrelay_rpc_pool_misses_total",
+              "RPC requests that opened a new node connection", "counter", 1 },
+            { "rawrelay_rpc_pool_waits_total",
+              "RPC requests queued because the pool was at pool_max", "counter", 2 },
+            { "rawrelay_rpc_pool_reaped_total",
+              "Idle pooled connections closed after pool_idle_timeout", "counter", 3 },
+            { "rawrelay_rpc_pool_health_failures_total",
+              "Failed health probes on idle pooled connections", "counter", 4 },
+            { "rawrelay_rpc_pool_connections",
+              "Open pooled connections to the node", "gauge", 5 },
+            { "rawrelay_rpc_pool_busy",
+              "Pooled connections with a request in flight", "gauge", 6 },
+            { "rawrelay_rpc_pool_waiting",
+              "RPC requests currently waiting for a pooled connection", "gauge", 7 },
+        };
+
+        for (size_t m = 0; m < sizeof(pool_metrics) / sizeof(pool_metrics[0]); m++) {
+            first_client = 1;
+            for (int i = 0; i < 4; i++) {
+                if (chains[i].client->host[0] == '\0') continue;
+                if (first_client) {
+                    n = evbuffer_add_printf(out,
+                        "\n"
+                        "# HELP %s %s\n"
+                        "# TYPE %s %s\n",
+                        pool_metrics[m].name, pool_metrics[m].help,
+                        pool_metrics[m].name, pool_metrics[m].type);
+                    METRICS_CHECK();
+                    first_client = 0;
+                }
+                const RPCPool *pool = &chains[i].client->pool;
+                unsigned long value = 0;
+                switch (pool_metrics[m].field) {
+                    case 0: value = (unsigned long)pool->hits; break;
+                    case 1: value = (unsigned long)pool->misses; break;
+                    case 2: value = (unsigned long)pool->waits; break;
+                    case 3: value = (unsigned long)pool->reaped; break;
+                    case 4: value = (unsigned long)pool->health_failures; break;
+                    case 5: value = (unsigned long)pool->total; break;
+                    case 6: value = (unsigned long)pool->busy; break;
+                    case 7: value = (unsigned long)pool->waiting; break;
+                }
+                n = evbuffer_add_printf(out,
+                    "%s{worker=\"%d\",chain=\"%s\"} %lu\n",
+                    pool_metrics[m].name, worker->worker_id, chains[i].name, value);
+                METRICS_CHECK();
+            }
+        }
+
+        /* Broadcast coalescing: batch sizes and time spent in the window */
+        first_client = 1;
+        for (int i = 0; i < 4; i++) {
+            const RPCBatcher *batcher = &chains[i].client->batcher;
+            if (chains[i].client->host[0] == '\0' || batcher->window_ms == 0) continue;
+            if (first_client) {
+                n = evbuffer_add_printf(out,
+                    "\n"
+                    "# HELP rawrelay_rpc_batch_size Broadcasts per request sent to the node while coalescing\n"
+                    "# TYPE rawrelay_rpc_batch_size histogram\n");
+                METRICS_CHECK();
+                first_client = 0;
+            }
+            static const char *size_le[RPC_BATCH_SIZE_BUCKETS] = {
+                "1", "2", "4", "8", "16", "32", "64", "+Inf"
+            };
+            uint64_t cumulative = 0;
+            for (int b = 0; b < RPC_BATCH_SIZE_BUCKETS; b++) {
+                cumulative += batcher->size_buckets[b];
+                n = evbuffer_add_printf(out,
+                    "rawrelay_rpc_batch_size_bucket{worker=\"%d\",chain=\"%s\",le=\"%s\"} %lu\n",
+                    worker->worker_id, chains[i].name, size_le[b], (unsigned long)cumulative);
+                METRICS_CHECK();
+            }
+            n = evbuffer_add_printf(out,
+                "rawrelay_rpc_batch_size_sum{worker=\"%d\",chain=\"%s\"} %lu\n"
+                "rawrelay_rpc_batch_size_count{worker=\"%d\",chain=\"%s\"} %lu\n",
+                worker->worker_id, chains[i].name, (unsigned long)batcher->size_sum,
+                worker->worker_id, chains[i].name, (unsigned long)batcher->sent);
+            METRICS_CHECK();
+        }
+
+        first_client = 1;
+        for (int i = 0; i < 4; i++) {
+            const RPCBatcher *batcher = &chains[i].client->batcher;
+            if (chains[i].client->host[0] == '\0' || batcher->window_ms == 0) continue;
+            if (first_client) {
+                n = evbuffer_add_printf(out,
+                    "\n"
+                    "# HELP rawrelay_rpc_batch_delay_seconds Time broadcasts waited in the coalescing window\n"
+                    "# TYPE rawrelay_rpc_batch_delay_seconds histogram\n");
+                METRICS_CHECK();
+                first_client = 0;
+            }
+            static const char *delay_le[RPC_BATCH_DELAY_BUCKETS] = {
+                "0.0005", "0.001", "0.002", "0.005", "0.01", "0.05", "+Inf"
+            };
+            uint64_t cumulative = 0;
+            for (int b = 0; b < RPC_BATCH_DELAY_BUCKETS; b++) {
+                cumulative += batcher->delay_buckets[b];
+                n = evbuffer_add_printf(out,
+                    "rawrelay_rpc_batch_delay_seconds_bucket{worker=\"%d\",chain=\"%s\",le=\"%s\"} %lu\n",
+                    worker->worker_id, chains[i].name, delay_le[b], (unsigned long)cumulative);
+                METRICS_CHECK();
+            }
+            n = evbuffer_add_printf(out,
+                "rawrelay_rpc_batch_delay_seconds_sum{worker=\"%d\",chain=\"%s\"} %.6f\n"
+                "rawrelay_rpc_batch_delay_seconds_count{worker=\"%d\",chain=\"%s\"} %lu\n",
+                worker->worker_id, chains[i].name, batcher->delay_sum_seconds,
+                worker->worker_id, chains[i].name, (unsigned long)batcher->delay_count);
+            METRICS_CHECK();
+        }
+    }
+
+    /* === Broadcast Pipeline Metrics === */
+    {
+        const BroadcastStore *bs = &worker->broadcasts;
+        n = evbuffer_add_printf(out,
+            "\n"
+            "# HELP rawrelay_broadcast_submitted_total Transactions broadcast by the server\n"
+            "# TYPE rawrelay_broadcast_submitted_total counter\n"
+            "rawrelay_broadcast_submitted_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_broadcast_duplicates_total Submissions of an already known txid\n"
+            "# TYPE rawrelay_broadcast_duplicates_total counter\n"
+            "rawrelay_broadcast_duplicates_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_broadcast_invalid_total Submissions that did not decode as a transaction\n"
+            "# TYPE rawrelay_broadcast_invalid_total counter\n"
+            "rawrelay_broadcast_invalid_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_broadcast_expired_total Results dropped by TTL or capacity\n"
+            "# TYPE rawrelay_broadcast_expired_total counter\n"
+            "rawrelay_broadcast_expired_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_broadcast_results Broadcast results currently held\n"
+            "# TYPE rawrelay_broadcast_results gauge\n"
+            "rawrelay_broadcast_results{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tx_lookups_total /tx/{txid} JSON lookups by outcome\n"
+            "# TYPE rawrelay_tx_lookups_total counter\n"
+            "rawrelay_tx_lookups_total{worker=\"%d\",result=\"hit\"} %lu\n"
+            "rawrelay_tx_lookups_total{worker=\"%d\",result=\"miss\"} %lu\n"
+            "rawrelay_tx_lookups_total{worker=\"%d\",result=\"waited\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_dedup_lookups_total Shared cross-worker dedup cache lookups by outcome\n"
+            "# TYPE rawrelay_dedup_lookups_total counter\n"
+            "rawrelay_dedup_lookups_total{worker=\"%d\",result=\"hit\"} %lu\n"
+            "rawrelay_dedup_lookups_total{worker=\"%d\",result=\"miss\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_dedup_evictions_total Live dedup cache entries overwritten by newer ones\n"
+            "# TYPE rawrelay_dedup_evictions_total counter\n"
+            "rawrelay_dedup_evictions_total{worker=\"%d\"} %lu\n",
+            worker->worker_id, (unsigned long)bs->submitted,
+            worker->worker_id, (unsigned long)bs->duplicates,
+            worker->worker_id, (unsigned long)bs->invalid,
+            worker->worker_id, (unsigned long)bs->expired,
+            worker->worker_id, (unsigned long)bs->count,
+            worker->worker_id, (unsigned long)bs->lookups_hit,
+            worker->worker_id, (unsigned long)bs->lookups_miss,
+            worker->worker_id, (unsigned long)bs->lookups_waited,
+            worker->worker_id, (unsigned long)bs->shared_hits,
+            worker->worker_id, (unsigned long)bs->shared_misses,
+            worker->worker_id, (unsigned long)bs->shared_evictions);
+        METRICS_CHECK();
+    }
+
+    /* === Streamed Transaction Decode Metrics === */
+    {
+        const BufferPool *bp = &worker->tx_buffers;
+        n = evbuffer_add_printf(out,
+            "\n"
+            "# HELP rawrelay_tx_streamed_total Huge-tier transactions decoded from hex while arriving\n"
+            "# TYPE rawrelay_tx_streamed_total counter\n"
+            "rawrelay_tx_streamed_total{worker=\"%d\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tx_buffer_requests_total Decode buffer requests by outcome\n"
+            "# TYPE rawrelay_tx_buffer_requests_total counter\n"
+            "rawrelay_tx_buffer_requests_total{worker=\"%d\",result=\"reused\"} %lu\n"
+            "rawrelay_tx_buffer_requests_total{worker=\"%d\",result=\"allocated\"} %lu\n"
+            "rawrelay_tx_buffer_requests_total{worker=\"%d\",result=\"grown\"} %lu\n"
+            "\n"
+            "# HELP rawrelay_tx_buffer_bytes Decode buffer capacity by state\n"
+            "# TYPE rawrelay_tx_buffer_bytes gauge\n"
+            "rawrelay_tx_buffer_bytes{worker=\"%d\",state=\"in_use\"} %zu\n"
+            "rawrelay_tx_buffer_bytes{worker=\"%d\",state=\"idle\"} %zu\n",
+            worker->worker_id, (unsigned long)worker->tx_streamed,
+            worker->worker_id, (unsigned long)bp->hits,
+            worker->worker_id, (unsigned long)bp->misses,
+            worker->worker_id, (unsigned long)bp->grows,
+            worker->worker_id, bp->in_use_bytes,
+            worker->worker_id, bp->idle_bytes);
+        METRICS_CHECK();
+    }
+
+    /* === Object Pool Metrics === */
+    {
+        const SlabPool *pools[] = {
+            &worker->conn_pool, &worker->h2_conn_pool, &worker->h2_stream_pool
+        };
+        struct { const char *name; const char *help; const char *type; int field; } slab_metrics[] = {
+            { "rawrelay_pool_objects_in_use",
+              "Pooled objects currently handed out", "gauge", 0 },
+            { "rawrelay_pool_objects_free",
+              "Free objects in slabs held by the pool", "gauge", 1 },
+            { "rawrelay_pool_slab_bytes",
+              "Memory held in slabs", "gauge", 2 },
+            { "rawrelay_pool_allocations_total",
+              "Objects allocated from the pool", "counter", 3 },
+            { "rawrelay_pool_slab_allocations_total",
+              "Slabs allocated (the only calls to malloc)", "counter", 4 },
+        };
+
+        for (size_t m = 0; m < sizeof(slab_metrics) / sizeof(slab_metrics[0]); m++) {
+            n = evbuffer_add_printf(out,
+                "\n"
+                "# HELP %s %s\n"
+                "# TYPE %s %s\n",
+                slab_metrics[m].name, slab_metrics[m].help,
+                slab_metrics[m].name, slab_metrics[m].type);
+            METRICS_CHECK();
+            for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+                const SlabPool *pool = pools[i];
+                unsigned long value = 0;
+                switch (slab_metrics[m].field) {
+                    case 0: value = (unsigned long)pool->in_use; break;
+                    case 1: value = (unsigned long)(pool->slabs * pool->per_slab - pool->in_use); break;
+                    case 2: value = (unsigned long)(pool->slabs * SLAB_SIZE); break;
+                    case 3: value = (unsigned long)pool->allocs; break;
+                    case 4: value = (unsigned long)pool->slab_allocs; break;
+                }
+                n = evbuffer_add_printf(out,
+                    "%s{worker=\"%d\",pool=\"%s\"} %lu\n",
+                    slab_metrics[m].name, worker->worker_id, pool->name, value);
+                METRICS_CHECK();
+            }
         }
     }
 
-    /* Ensure null termination */
-    buf[offset] = '\0';
+    #undef METRICS_CHECK
 
-    #undef METRICS_ADVANCE
+    return (int)(evbuffer_get_length(out) - start);
 
-    return (int)offset;
+fail:
+    log_error("Worker %d: out of memory building the /metrics body", worker->worker_id);
+    return -1;
 }
 
 /*
@@ -640,13 +1086,7 @@ int validate_hex_path(const char *path, size_t path_len)
     }
 
     /* Validate remaining characters as hex */
-    for (; p < end; p++) {
-        if (!is_hex_char((unsigned char)*p)) {
-            return -1;
-        }
-    }
-
-    return 0;
+    return is_all_hex(p, (size_t)(end - p)) ? 0 : -1;
 }
 
 /*
@@ -668,6 +1108,34 @@ void update_latency_histogram(WorkerProcess *worker, double duration_sec)
     worker->latency_sum_seconds += duration_sec;
 }
 
+/*
+ * Index of the first bucket whose bound holds value (last = +Inf).
+ */
+static int histogram_bucket(const double *le, int finite, double value)
+{
+    int b = 0;
+    while (b < finite && value > le[b]) {
+        b++;
+    }
+    return b;
+}
+
+void update_tls_handshake_histogram(WorkerProcess *worker, double duration_sec)
+{
+    worker->tls_handshake_buckets[histogram_bucket(tls_handshake_le,
+                                                   TLS_HANDSHAKE_BUCKETS - 1,
+                                                   duration_sec)]++;
+    worker->tls_handshake_sum_seconds += duration_sec;
+    worker->tls_handshake_count++;
+}
+
+void update_loop_lag_histogram(WorkerProcess *worker, double lag_sec)
+{
+    worker->loop_lag_buckets[histogram_bucket(loop_lag_le, LOOP_LAG_BUCKETS - 1, lag_sec)]++;
+    worker->loop_lag_sum_seconds += lag_sec;
+    worker->loop_lag_count++;
+}
+
 /*
  * Update status code counters.
  */
@@ -676,6 +1144,8 @@ void update_status_counters(WorkerProcess *worker, int status)
     /* Category counters */
     if (status >= 200 && status < 300) {
         worker->status_2xx++;
+    } else if (status >= 300 && status < 400) {
+        worker->status_3xx++;
     } else if (status >= 400 && status < 500) {
         worker->status_4xx++;
     } else if (status >= 500 && status < 600) {
@@ -685,6 +1155,7 @@ void update_status_counters(WorkerProcess *worker, int status)
     /* Specific status counters */
     switch (status) {
         case 200: worker->status_200++; break;
+        case 304: worker->status_304++; break;
         case 400: worker->status_400++; break;
         case 404: worker->status_404++; break;
         case 408: worker->status_408++; break;
@@ -724,12 +1195,9 @@ void update_endpoint_counter(WorkerProcess *worker, RouteType route)
         case ROUTE_ALIVE:     worker->endpoint_alive++; break;
         case ROUTE_VERSION:   worker->endpoint_version++; break;
         case ROUTE_METRICS:   worker->endpoint_metrics++; break;
-        case ROUTE_HOME:      worker->endpoint_home++; break;
+        case ROUTE_STATIC:    break;  /* tracked per asset (StaticFile.requests) */
         case ROUTE_BROADCAST: worker->endpoint_broadcast++; break;
         case ROUTE_RESULT:    worker->endpoint_result++; break;
-        case ROUTE_DOCS:      worker->endpoint_docs++; break;
-        case ROUTE_STATUS:    worker->endpoint_status++; break;
-        case ROUTE_LOGOS:     worker->endpoint_logos++; break;
         case ROUTE_ACME_CHALLENGE: worker->endpoint_acme++; break;
         case ROUTE_ERROR:     break;  /* tracked via 404 status counter */
     }
@@ -1,12 +1,14 @@
 /*
- * Optimized hex character validation using lookup table.
+ * Hex validation and decoding.
  *
- * This provides O(1) per-character validation instead of
- * multiple comparisons, improving performance for large
- * Bitcoin transaction hex strings.
+ * The lookup table gives O(1) per-character checks for single
+ * characters and short strings. Bulk validate/decode dispatches at
+ * runtime to SSE4.2, AVX2 or AVX-512 kernels (hex_simd.c), which
+ * process 16/32/64 characters per step.
  */
 
 #include "hex.h"
+#include "cpu.h"
 
 /*
  * Lookup table for hex character validation.
@@ -45,12 +47,177 @@ const uint8_t hex_char_valid[256] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-int is_all_hex(const char *data, size_t len)
+/*
+ * Nibble value per character. Only meaningful where hex_char_valid[] is 1.
+ */
+static const uint8_t hex_nibble[256] = {
+    ['0'] = 0,  ['1'] = 1,  ['2'] = 2,  ['3'] = 3,  ['4'] = 4,
+    ['5'] = 5,  ['6'] = 6,  ['7'] = 7,  ['8'] = 8,  ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
+
+/* ========== Scalar (table) implementation ========== */
+
+static size_t hex_scan_scalar(const char *data, size_t len)
 {
     for (size_t i = 0; i < len; i++) {
         if (!hex_char_valid[(unsigned char)data[i]]) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t hex_decode_scalar(const char *hex, size_t hex_len, uint8_t *out)
+{
+    for (size_t i = 0; i + 1 < hex_len; i += 2) {
+        unsigned char hi = (unsigned char)hex[i];
+        unsigned char lo = (unsigned char)hex[i + 1];
+        if (!hex_char_valid[hi]) {
+            return i;
+        }
+        if (!hex_char_valid[lo]) {
+            return i + 1;
+        }
+        out[i / 2] = (uint8_t)((hex_nibble[hi] << 4) | hex_nibble[lo]);
+    }
+    return hex_len;
+}
+
+/* ========== Dispatch ========== */
+
+/*
+ * SIMD kernels handle whole vectors and stop before the first vector
+ * holding an invalid character; the scalar code finishes the tail and
+ * pins down the exact offset.
+ */
+static HexBackend active_backend = HEX_BACKEND_COUNT;  /* Not chosen yet */
+static size_t (*scan_kernel)(const char *data, size_t len);
+static size_t (*decode_kernel)(const char *hex, size_t hex_len, uint8_t *out);
+
+static size_t hex_kernel_none(const char *data, size_t len)
+{
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+static size_t hex_decode_kernel_none(const char *hex, size_t hex_len, uint8_t *out)
+{
+    (void)hex;
+    (void)hex_len;
+    (void)out;
+    return 0;
+}
+
+int hex_backend_supported(HexBackend backend)
+{
+    switch (backend) {
+        case HEX_BACKEND_SCALAR:
+            return 1;
+#if defined(__x86_64__)
+        case HEX_BACKEND_SSE42:
+            return cpu_has(CPU_SSE42 | CPU_SSSE3);
+        case HEX_BACKEND_AVX2:
+            return cpu_has(CPU_AVX2);
+        case HEX_BACKEND_AVX512:
+            return cpu_has(CPU_AVX512BW);
+#endif
+        default:
             return 0;
+    }
+}
+
+int hex_set_backend(HexBackend backend)
+{
+    if (!hex_backend_supported(backend)) {
+        return -1;
+    }
+
+    active_backend = backend;
+    scan_kernel = hex_kernel_none;
+    decode_kernel = hex_decode_kernel_none;
+#if defined(__x86_64__)
+    switch (backend) {
+        case HEX_BACKEND_SSE42:
+            scan_kernel = hex_scan_sse42;
+            decode_kernel = hex_decode_sse42;
+            break;
+        case HEX_BACKEND_AVX2:
+            scan_kernel = hex_scan_avx2;
+            decode_kernel = hex_decode_avx2;
+            break;
+        case HEX_BACKEND_AVX512:
+            scan_kernel = hex_scan_avx512;
+            decode_kernel = hex_decode_avx512;
+            break;
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+HexBackend hex_backend(void)
+{
+    if (active_backend == HEX_BACKEND_COUNT) {
+        if (hex_set_backend(HEX_BACKEND_AVX512) < 0 &&
+            hex_set_backend(HEX_BACKEND_AVX2) < 0 &&
+            hex_set_backend(HEX_BACKEND_SSE42) < 0) {
+            hex_set_backend(HEX_BACKEND_SCALAR);
         }
     }
-    return 1;
+    return active_backend;
+}
+
+const char *hex_backend_name(HexBackend backend)
+{
+    switch (backend) {
+        case HEX_BACKEND_SCALAR: return "scalar";
+        case HEX_BACKEND_SSE42:  return "sse4.2";
+        case HEX_BACKEND_AVX2:   return "avx2";
+        case HEX_BACKEND_AVX512: return "avx512";
+        default:                 return "unknown";
+    }
+}
+
+/* ========== Public API ========== */
+
+size_t hex_scan(const char *data, size_t len)
+{
+    hex_backend();
+    size_t done = scan_kernel(data, len);
+    return done + hex_scan_scalar(data + done, len - done);
+}
+
+int is_all_hex(const char *data, size_t len)
+{
+    return hex_scan(data, len) == len;
+}
+
+size_t hex_decode_scan(const char *hex, size_t hex_len, uint8_t *out)
+{
+    hex_backend();
+    size_t done = decode_kernel(hex, hex_len, out);
+    return done + hex_decode_scalar(hex + done, hex_len - done, out + done / 2);
+}
+
+int hex_decode(const char *hex, size_t hex_len, uint8_t *out)
+{
+    if (hex_len % 2 != 0) {
+        return -1;
+    }
+    return hex_decode_scan(hex, hex_len, out) == hex_len ? 0 : -1;
+}
+
+void hex_encode(const uint8_t *data, size_t len, char *out)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < len; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0x0F];
+    }
+    out[len * 2] = '\0';
 }
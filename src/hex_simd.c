@@ -0,0 +1,170 @@
+/*
+ * x86 hex kernels: SSE4.2 (16 chars), AVX2 (32 chars), AVX-512BW (64 chars).
+ *
+ * Compiled with per-function target attributes so the rest of the
+ * binary stays baseline x86-64; hex.c only calls these after cpu_has()
+ * confirms the instructions exist.
+ *
+ * Per vector of characters v (signed compares, so bytes >= 0x80 fail):
+ *   digit  = '0' <= v <= '9'
+ *   alpha  = 'a' <= (v | 0x20) <= 'f'
+ *   nibble = (v & 0x0F) + (alpha ? 9 : 0)
+ * Adjacent nibbles are then combined with maddubs (hi * 16 + lo) and
+ * narrowed back to bytes.
+ */
+
+#include "hex.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/* ========== SSE4.2 ========== */
+
+#define SSE42_TARGET __attribute__((target("sse4.2,ssse3")))
+
+SSE42_TARGET
+static inline __m128i classify_sse42(__m128i v, __m128i *alpha)
+{
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    *alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                           _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    return _mm_or_si128(digit, *alpha);
+}
+
+SSE42_TARGET
+size_t hex_scan_sse42(const char *data, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i alpha;
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        if (_mm_movemask_epi8(classify_sse42(v, &alpha)) != 0xFFFF) {
+            break;
+        }
+    }
+    return i;
+}
+
+SSE42_TARGET
+size_t hex_decode_sse42(const char *hex, size_t hex_len, uint8_t *out)
+{
+    const __m128i weights = _mm_set1_epi16(0x0110);  /* hi * 16 + lo */
+    size_t i = 0;
+    for (; i + 16 <= hex_len; i += 16) {
+        __m128i alpha;
+        __m128i v = _mm_loadu_si128((const __m128i *)(hex + i));
+        if (_mm_movemask_epi8(classify_sse42(v, &alpha)) != 0xFFFF) {
+            break;
+        }
+        __m128i nib = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x0F)),
+                                   _mm_and_si128(alpha, _mm_set1_epi8(9)));
+        __m128i words = _mm_maddubs_epi16(nib, weights);
+        _mm_storel_epi64((__m128i *)(out + i / 2), _mm_packus_epi16(words, words));
+    }
+    return i;
+}
+
+/* ========== AVX2 ========== */
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET
+static inline __m256i classify_avx2(__m256i v, __m256i *alpha)
+{
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i digit = _mm256_andnot_si256(
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8('9')),
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)));
+    *alpha = _mm256_andnot_si256(
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('f')),
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)));
+    return _mm256_or_si256(digit, *alpha);
+}
+
+AVX2_TARGET
+size_t hex_scan_avx2(const char *data, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i alpha;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        if ((uint32_t)_mm256_movemask_epi8(classify_avx2(v, &alpha)) != 0xFFFFFFFFu) {
+            break;
+        }
+    }
+    return i;
+}
+
+AVX2_TARGET
+size_t hex_decode_avx2(const char *hex, size_t hex_len, uint8_t *out)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 32 <= hex_len; i += 32) {
+        __m256i alpha;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(hex + i));
+        if ((uint32_t)_mm256_movemask_epi8(classify_avx2(v, &alpha)) != 0xFFFFFFFFu) {
+            break;
+        }
+        __m256i nib = _mm256_add_epi8(_mm256_and_si256(v, _mm256_set1_epi8(0x0F)),
+                                      _mm256_and_si256(alpha, _mm256_set1_epi8(9)));
+        __m256i words = _mm256_maddubs_epi16(nib, weights);
+        /* packus works per 128-bit lane: gather the two low quadwords */
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x08);
+        _mm_storeu_si128((__m128i *)(out + i / 2), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+/* ========== AVX-512BW ========== */
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+
+AVX512_TARGET
+static inline __mmask64 classify_avx512(__m512i v, __mmask64 *alpha)
+{
+    __m512i lower = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+    __mmask64 digit = _mm512_cmpgt_epi8_mask(v, _mm512_set1_epi8('0' - 1)) &
+                      _mm512_cmplt_epi8_mask(v, _mm512_set1_epi8('9' + 1));
+    *alpha = _mm512_cmpgt_epi8_mask(lower, _mm512_set1_epi8('a' - 1)) &
+             _mm512_cmplt_epi8_mask(lower, _mm512_set1_epi8('f' + 1));
+    return digit | *alpha;
+}
+
+AVX512_TARGET
+size_t hex_scan_avx512(const char *data, size_t len)
+{
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __mmask64 alpha;
+        __m512i v = _mm512_loadu_si512((const void *)(data + i));
+        if (classify_avx512(v, &alpha) != ~(__mmask64)0) {
+            break;
+        }
+    }
+    return i;
+}
+
+AVX512_TARGET
+size_t hex_decode_avx512(const char *hex, size_t hex_len, uint8_t *out)
+{
+    const __m512i weights = _mm512_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 64 <= hex_len; i += 64) {
+        __mmask64 alpha;
+        __m512i v = _mm512_loadu_si512((const void *)(hex + i));
+        if (classify_avx512(v, &alpha) != ~(__mmask64)0) {
+            break;
+        }
+        __m512i low = _mm512_and_si512(v, _mm512_set1_epi8(0x0F));
+        __m512i nib = _mm512_mask_add_epi8(low, alpha, low, _mm512_set1_epi8(9));
+        __m512i words = _mm512_maddubs_epi16(nib, weights);
+        _mm256_storeu_si256((__m256i *)(out + i / 2), _mm512_cvtepi16_epi8(words));
+    }
+    return i;
+}
+
+#endif /* __x86_64__ */
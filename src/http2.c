@@ -21,20 +21,53 @@
 /* Connection-level flow control window (16MB) */
 #define H2_CONNECTION_WINDOW_SIZE (16 * 1024 * 1024)
 
-/* Body source for response data provider */
-typedef struct {
-    unsigned char *data;  /* Owned copy of the body data */
+/* Headers every response carries, and room for route-specific ones */
+#define H2_RESPONSE_BASE_HEADERS    5
+#define H2_RESPONSE_EXTRA_HEADERS   4
+
+/*
+ * Body source for response data provider. DATA frames reference the
+ * body in the output buffer (NGHTTP2_DATA_FLAG_NO_COPY) instead of being
+ * copied into nghttp2's frame buffer and again into the output, so the
+ * source lives until the stream and every queued slice have let go.
+ */
+typedef struct H2BodySource {
+    unsigned refs;              /* The stream, plus each queued DATA slice */
+    const unsigned char *data;
     size_t len;
-    size_t pos;
+    size_t pos;                 /* Bytes handed to the output so far */
+    StaticFiles *files;         /* Table holding data for a static page, else NULL */
+    unsigned char copy[];       /* data for any other body */
 } H2BodySource;
 
 /* Per-stream request ID counter (per-process) */
 static uint32_t h2_request_counter = 0;
 
+void h2_body_source_unref(H2BodySource *bs)
+{
+    if (!bs || --bs->refs > 0) {
+        return;
+    }
+    static_files_unref(bs->files);
+    free(bs);
+}
+
+/* evbuffer_add_reference() cleanup: a DATA slice has been written */
+static void h2_body_slice_release(const void *data, size_t len, void *arg)
+{
+    (void)data;
+    (void)len;
+    h2_body_source_unref((H2BodySource *)arg);
+}
+
 /* Forward declarations of nghttp2 callbacks */
 static ssize_t h2_send_callback(nghttp2_session *session,
                                 const uint8_t *data, size_t length,
                                 int flags, void *user_data);
+static int h2_send_data_callback(nghttp2_session *session,
+                                 nghttp2_frame *frame, const uint8_t *framehd,
+                                 size_t length, nghttp2_data_source *source,
+                                 void *user_data);
 static int h2_on_frame_recv_callback(nghttp2_session *session,
                                      const nghttp2_frame *frame,
                                      void *user_data);
@@ -54,21 +87,30 @@ static int h2_on_data_chunk_recv_callback(nghttp2_session *session,
                                           uint8_t flags, int32_t stream_id,
                                           const uint8_t *data, size_t len,
                                           void *user_data);
+static int h2_submit_response(Connection *conn, int32_t stream_id,
+                              int status_code, const char *content_type,
+                              const char *cache_control,
+                              const nghttp2_nv *extra, size_t nextra,
+                              StaticFiles *files,
+                              const unsigned char *body, size_t body_len);
 
 /*
  * Create a new HTTP/2 stream.
  */
 H2Stream *h2_stream_new(H2Connection *h2, int32_t stream_id)
 {
-    H2Stream *stream = calloc(1, sizeof(H2Stream));
+    H2Stream *stream = slab_alloc(&h2->worker->h2_stream_pool);
     if (!stream) {
         return NULL;
     }
 
     stream->stream_id = stream_id;
+    arena_init(&stream->header_arena, stream->header_space, sizeof(stream->header_space));
     stream->state = H2_STREAM_OPEN;
+    stream->h2 = h2;
     stream->tier = TIER_NORMAL;
     stream->slot_acquired = false;
+    stream->if_modified_since = -1;
 
     /* Per-stream request tracking */
     clock_gettime(CLOCK_MONOTONIC, &stream->start_time);
@@ -113,6 +155,9 @@ void h2_stream_free(H2Connection *h2, H2Stream *stream)
 {
     if (!stream) return;
 
+    /* Stop waiting on an in-flight broadcast */
+    broadcast_wait_cancel(&stream->tx_waiter);
+
     /* Release slot if acquired */
     if (stream->slot_acquired) {
         slot_manager_release(&h2->worker->slots, stream->tier);
@@ -135,21 +180,23 @@ void h2_stream_free(H2Connection *h2, H2Stream *stream)
         h2->worker->h2_streams_active--;
     }
 
-    /* Free allocated strings */
-    free(stream->method);
-    free(stream->path);
-    free(stream->authority);
-    free(stream->scheme);
-
-    /* Free response body source and its owned data */
-    if (stream->body_source) {
-        H2BodySource *bs = (H2BodySource *)stream->body_source;
-        free(bs->data);
-        free(bs);
-        stream->body_source = NULL;
+    /* Free header strings */
+    if (stream->path_payload) {
+        /* Shared with broadcast RPCs that may still be in flight */
+        rpc_payload_unref(stream->path_payload);
+    } else if (stream->path_allocated) {
+        free(stream->path);
+    }
+    if (stream->header_arena.overflows > 0) {
+        h2->worker->h2_header_arena_overflows++;
     }
+    arena_reset(&stream->header_arena);
 
-    free(stream);
+    /* Release the response body; queued DATA slices may still hold it */
+    h2_body_source_unref(stream->body_source);
+    stream->body_source = NULL;
+
+    slab_free(&h2->worker->h2_stream_pool, stream);
 }
 
 /*
@@ -171,6 +218,44 @@ static ssize_t h2_send_callback(nghttp2_session *session,
     return (ssize_t)length;
 }
 
+/*
+ * Send data callback - DATA frames flagged NGHTTP2_DATA_FLAG_NO_COPY.
+ * The 9-byte frame header is copied; the body slice is added by
+ * reference. No padding callback is set, so frames carry no padding.
+ */
+static int h2_send_data_callback(nghttp2_session *session,
+                                 nghttp2_frame *frame, const uint8_t *framehd,
+                                 size_t length, nghttp2_data_source *source,
+                                 void *user_data)
+{
+    Connection *conn = (Connection *)user_data;
+    H2BodySource *bs = (H2BodySource *)source->ptr;
+    struct evbuffer *output = bufferevent_get_output(conn->bev);
+    (void)session;
+    (void)frame;
+
+    if (evbuffer_add(output, framehd, 9) != 0) {
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+    if (length > 0) {
+        bs->refs++;
+        if (evbuffer_add_reference(output, bs->data + bs->pos, length,
+                                   h2_body_slice_release, bs) != 0) {
+            bs->refs--;
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        bs->pos += length;
+    }
+
+    return 0;
+}
+
+void h2_set_send_callbacks(nghttp2_session_callbacks *callbacks)
+{
+    nghttp2_session_callbacks_set_send_callback(callbacks, h2_send_callback);
+    nghttp2_session_callbacks_set_send_data_callback(callbacks, h2_send_data_callback);
+}
+
 /*
  * Downgrade HTTP/2 stream from large/huge tier to normal.
  * Called after request is fully received to release expensive slots ASAP.
@@ -197,6 +282,126 @@ static void h2_downgrade_tier_to_normal(H2Connection *h2, H2Stream *stream)
     }
 }
 
+/*
+ * Send the /tx/{txid} JSON for a completed broadcast.
+ */
+static void h2_send_tx_entry(Connection *conn, H2Stream *stream,
+                             const BroadcastEntry *entry)
+{
+    char body[2048];
+    int len = broadcast_entry_json(entry, body, sizeof(body));
+
+    stream->response_status = 200;
+    stream->response_bytes = len;
+    h2_send_response(conn, stream->stream_id, 200, "application/json",
+                     (const unsigned char *)body, len);
+}
+
+/*
+ * Waiter callback: the broadcast this stream was parked on finished.
+ */
+static void h2_tx_waiter_done(BroadcastWaiter *waiter, const BroadcastEntry *entry)
+{
+    H2Stream *stream = waiter->ctx;
+    h2_send_tx_entry(stream->h2->conn, stream, entry);
+}
+
+/*
+ * Answer /tx/{txid} JSON from the broadcast table, parking the stream
+ * while the broadcast is in flight.
+ */
+static void h2_serve_tx_result(Connection *conn, H2Stream *stream, const char *txid)
+{
+    BroadcastStore *store = &conn->worker->broadcasts;
+    BroadcastEntry *entry = broadcast_lookup(store, txid, TX_HASH_HEX_LEN);
+
+    if (!entry) {
+        static const char not_found[] = "{\"error\":\"unknown txid\"}";
+        store->lookups_miss++;
+        stream->response_status = 404;
+        stream->response_bytes = sizeof(not_found) - 1;
+        h2_send_response(conn, stream->stream_id, 404, "application/json",
+                         (const unsigned char *)not_found, sizeof(not_found) - 1);
+        return;
+    }
+
+    if (entry->pending > 0) {
+        store->lookups_waited++;
+        stream->tx_waiter.on_done = h2_tx_waiter_done;
+        stream->tx_waiter.ctx = stream;
+        broadcast_wait(entry, &stream->tx_waiter);
+        return;
+    }
+
+    store->lookups_hit++;
+    h2_send_tx_entry(conn, stream, entry);
+}
+
+#define H2_NV(name, value) \
+    {(uint8_t *)(name), (uint8_t *)(value), sizeof(name) - 1, strlen(value), \
+     NGHTTP2_NV_FLAG_NONE}
+
+/*
+ * Send a static page in the smallest variant the stream's accept-encoding
+ * allows, or a 304 if the client's copy is current. Sets *status_code to
+ * the status sent and returns the body length, for response tracking.
+ */
+static size_t h2_send_static_file(Connection *conn, H2Stream *stream,
+                                  StaticFile *file, int *status_code)
+{
+    const char *body;
+    size_t body_len;
+    StaticEncoding encoding = static_file_select(file, stream->accept_encodings,
+                                                 &body, &body_len);
+    bool not_modified = static_file_not_modified(
+        file, encoding, stream->has_if_none_match ? stream->if_none_match : NULL,
+        stream->if_modified_since);
+    const char *content_encoding = static_encoding_name(encoding);
+    nghttp2_nv extra[H2_RESPONSE_EXTRA_HEADERS] = {
+        H2_NV("vary", "accept-encoding")
+    };
+    size_t nextra = 1;
+
+    if (file->status_code == 200) {
+        extra[nextra++] = (nghttp2_nv)H2_NV("etag", file->etag[encoding]);
+        extra[nextra++] = (nghttp2_nv)H2_NV("last-modified", file->last_modified_text);
+    }
+    if (content_encoding && !not_modified) {
+        extra[nextra++] = (nghttp2_nv)H2_NV("content-encoding", content_encoding);
+    }
+
+    StaticFiles *files = conn->h2->worker->static_files;
+    static_files_count(files, file, encoding, not_modified);
+    *status_code = not_modified ? 304 : file->status_code;
+    if (not_modified) {
+        body_len = 0;
+    }
+
+    /* Assets use the configured caching; the 404 page is never cached */
+    h2_submit_response(conn, stream->stream_id, *status_code, file->content_type,
+                       file->status_code == 200 ? files->cache_control : NULL,
+                       extra, nextra, file->owner, (const unsigned char *)body, body_len);
+    return body_len;
+}
+
+/*
+ * Wrap the stream's path for broadcast RPCs, which may outlive the stream.
+ * A short path lives in the header arena, so it is moved to its own
+ * block first. Returns NULL on allocation failure.
+ */
+static RPCPayload *h2_stream_share_path(H2Stream *stream)
+{
+    if (!stream->path_allocated) {
+        char *path = strndup(stream->path, stream->path_len);
+        if (!path) {
+            return NULL;
+        }
+        stream->path = path;
+        stream->path_allocated = true;
+    }
+    return rpc_payload_wrap(stream->path, stream->path + 1, stream->path_len - 1);
+}
+
 /*
  * Process a complete HTTP/2 stream request.
  * Unified routing handler called from both HEADERS and DATA END_STREAM paths.
@@ -205,9 +410,10 @@ static void h2_process_stream_request(Connection *conn, H2Stream *stream)
 {
     H2Connection *h2 = conn->h2;
     WorkerProcess *worker = h2->worker;
-    RouteType route = route_request(stream->path, stream->path_len);
+    RouteType route;
+    StaticFile *file = static_files_route(worker->static_files, stream->path,
+                                          stream->path_len, &route);
     update_endpoint_counter(worker, route);
-    StaticFile *file;
     int status_code = 200;
     const char *content_type = "text/plain";
     size_t body_len = 0;
@@ -244,13 +450,23 @@ static void h2_process_stream_request(Connection *conn, H2Stream *stream)
             break;
         }
         case ROUTE_METRICS: {
-            char body[16384];
-            int len = generate_metrics_body(worker, body, sizeof(body));
-            status_code = 200;
-            content_type = "text/plain; version=0.0.4; charset=utf-8";
-            body_len = len;
-            h2_send_response(conn, stream->stream_id, status_code, content_type,
-                             (const unsigned char *)body, body_len);
+            struct evbuffer *body = evbuffer_new();
+            int len = body ? generate_metrics_body(worker, body) : -1;
+            if (len < 0) {
+                status_code = 500;
+                h2_send_response(conn, stream->stream_id, status_code, "text/plain",
+                                 (const unsigned char *)"", 0);
+            } else {
+                status_code = 200;
+                content_type = "text/plain; version=0.0.4; charset=utf-8";
+                body_len = len;
+                /* h2_send_response() copies the body */
+                h2_send_response(conn, stream->stream_id, status_code, content_type,
+                                 evbuffer_pullup(body, -1), body_len);
+            }
+            if (body) {
+                evbuffer_free(body);
+            }
             break;
         }
         case ROUTE_ACME_CHALLENGE: {
@@ -266,49 +482,45 @@ static void h2_process_stream_request(Connection *conn, H2Stream *stream)
             }
             break;
         }
-        case ROUTE_HOME:
-            file = &worker->static_files.index;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
-            break;
         case ROUTE_BROADCAST:
-            file = &worker->static_files.broadcast;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
+            /* Start the broadcast now; the page polls /tx/{txid} for the outcome */
+            if (stream->method && strcmp(stream->method, "GET") == 0) {
+                char txid[TX_HASH_HEX_LEN + 1];
+                if (!stream->path_payload) {
+                    stream->path_payload = h2_stream_share_path(stream);
+                }
+                int rc = broadcast_submit(&worker->broadcasts, stream->path_payload, txid);
+                if (stream->accept_json) {
+                    if (rc < 0) {
+                        static const char invalid[] = "{\"error\":\"invalid transaction\"}";
+                        status_code = 400;
+                        body_len = sizeof(invalid) - 1;
+                        h2_send_response(conn, stream->stream_id, status_code,
+                                         "application/json",
+                                         (const unsigned char *)invalid, body_len);
+                        break;
+                    }
+                    h2_serve_tx_result(conn, stream, txid);
+                    h2_downgrade_tier_to_normal(h2, stream);
+                    return;
+                }
+            }
+            body_len = h2_send_static_file(conn, stream, file, &status_code);
             break;
         case ROUTE_RESULT:
-            file = &worker->static_files.result;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
-            break;
-        case ROUTE_DOCS:
-            file = &worker->static_files.docs;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
-            break;
-        case ROUTE_STATUS:
-            file = &worker->static_files.status;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
-            break;
-        case ROUTE_LOGOS:
-            file = &worker->static_files.logos;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
+            if (stream->accept_json) {
+                /* Response tracking is done by the tx helpers; path ends in the txid */
+                h2_serve_tx_result(conn, stream,
+                                   stream->path + stream->path_len - TX_HASH_HEX_LEN);
+                h2_downgrade_tier_to_normal(h2, stream);
+                return;
+            }
+            body_len = h2_send_static_file(conn, stream, file, &status_code);
             break;
+        case ROUTE_STATIC:
         case ROUTE_ERROR:
         default:
-            status_code = 404;
-            file = &worker->static_files.error;
-            body_len = file->length;
-            h2_send_response(conn, stream->stream_id, status_code, file->content_type,
-                             (const unsigned char *)file->content, file->length);
+            body_len = h2_send_static_file(conn, stream, file, &status_code);
             break;
     }
 
@@ -469,9 +681,15 @@ static int h2_on_header_callback(nghttp2_session *session,
 
     /* Store headers */
     if (namelen == 7 && memcmp(name, ":method", 7) == 0) {
-        stream->method = strndup((const char *)value, valuelen);
+        stream->method = arena_strndup(&stream->header_arena, (const char *)value, valuelen);
     } else if (namelen == 5 && memcmp(name, ":path", 5) == 0) {
-        stream->path = strndup((const char *)value, valuelen);
+        if (stream->path_allocated) {
+            free(stream->path);
+        }
+        stream->path_allocated = valuelen > H2_STREAM_ARENA_PATH_MAX;
+        stream->path = stream->path_allocated
+                     ? strndup((const char *)value, valuelen)
+                     : arena_strndup(&stream->header_arena, (const char *)value, valuelen);
         stream->path_len = valuelen;
 
         /* Hex path validation for long paths (same as HTTP/1.1 validate_path_early) */
@@ -510,11 +728,25 @@ static int h2_on_header_callback(nghttp2_session *session,
                       stream->stream_id, tier_name(required), valuelen);
         }
     } else if (namelen == 10 && memcmp(name, ":authority", 10) == 0) {
-        stream->authority = strndup((const char *)value, valuelen);
+        stream->authority = arena_strndup(&stream->header_arena, (const char *)value, valuelen);
     } else if (namelen == 7 && memcmp(name, ":scheme", 7) == 0) {
-        stream->scheme = strndup((const char *)value, valuelen);
+        stream->scheme = arena_strndup(&stream->header_arena, (const char *)value, valuelen);
     } else if (namelen == 14 && memcmp(name, "content-length", 14) == 0) {
         stream->content_length = (size_t)strtoul((const char *)value, NULL, 10);
+    } else if (namelen == 6 && memcmp(name, "accept", 6) == 0) {
+        if (memmem(value, valuelen, "application/json", 16)) {
+            stream->accept_json = true;
+        }
+    } else if (namelen == 15 && memcmp(name, "accept-encoding", 15) == 0) {
+        stream->accept_encodings = static_accept_encodings((const char *)value, valuelen);
+    } else if (namelen == 13 && memcmp(name, "if-none-match", 13) == 0) {
+        size_t len = valuelen < sizeof(stream->if_none_match)
+                   ? valuelen : sizeof(stream->if_none_match) - 1;
+        memcpy(stream->if_none_match, value, len);
+        stream->if_none_match[len] = '\0';
+        stream->has_if_none_match = true;
+    } else if (namelen == 17 && memcmp(name, "if-modified-since", 17) == 0) {
+        stream->if_modified_since = static_parse_http_date((const char *)value, valuelen);
     }
 
     return 0;
@@ -547,7 +779,7 @@ static int h2_on_data_chunk_recv_callback(nghttp2_session *session,
  */
 int h2_connection_init(Connection *conn)
 {
-    H2Connection *h2 = calloc(1, sizeof(H2Connection));
+    H2Connection *h2 = slab_alloc(&conn->worker->h2_conn_pool);
     if (!h2) {
         log_error("Failed to allocate H2Connection");
         return -1;
@@ -561,11 +793,11 @@ int h2_connection_init(Connection *conn)
     /* Set up nghttp2 callbacks */
     nghttp2_session_callbacks *callbacks;
     if (nghttp2_session_callbacks_new(&callbacks) != 0) {
-        free(h2);
+        slab_free(&conn->worker->h2_conn_pool, h2);
         return -1;
     }
 
-    nghttp2_session_callbacks_set_send_callback(callbacks, h2_send_callback);
+    h2_set_send_callbacks(callbacks);
     nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, h2_on_frame_recv_callback);
     nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, h2_on_stream_close_callback);
     nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, h2_on_begin_headers_callback);
@@ -576,7 +808,7 @@ int h2_connection_init(Connection *conn)
     nghttp2_option *option;
     if (nghttp2_option_new(&option) != 0) {
         nghttp2_session_callbacks_del(callbacks);
-        free(h2);
+        slab_free(&conn->worker->h2_conn_pool, h2);
         return -1;
     }
 
@@ -617,7 +849,7 @@ int h2_connection_init(Connection *conn)
 
     if (rv != 0) {
         log_error("Failed to create nghttp2 session: %s", nghttp2_strerror(rv));
-        free(h2);
+        slab_free(&conn->worker->h2_conn_pool, h2);
         return -1;
     }
 
@@ -634,7 +866,7 @@ int h2_connection_init(Connection *conn)
     if (rv != 0) {
         log_error("Failed to submit SETTINGS: %s", nghttp2_strerror(rv));
         nghttp2_session_del(h2->session);
-        free(h2);
+        slab_free(&conn->worker->h2_conn_pool, h2);
         return -1;
     }
 
@@ -674,24 +906,41 @@ void h2_connection_free(H2Connection *h2)
         nghttp2_session_del(h2->session);
     }
 
-    free(h2);
+    slab_free(&h2->worker->h2_conn_pool, h2);
 }
 
 /*
  * Process incoming data.
  */
-int h2_process_input(Connection *conn, const unsigned char *data, size_t len)
+int h2_process_input(Connection *conn, struct evbuffer *input)
 {
     H2Connection *h2 = conn->h2;
     if (!h2 || !h2->session) {
         return -1;
     }
 
-    ssize_t rv = nghttp2_session_mem_recv(h2->session, data, len);
-    if (rv < 0) {
-        log_error("HTTP/2: nghttp2_session_mem_recv failed: %s",
-                  nghttp2_strerror((int)rv));
-        return -1;
+    /* Feed the first chain at a time; frames split across chains are
+     * buffered inside nghttp2, so nothing is linearized here */
+    size_t budget = H2_INPUT_BUDGET;
+    while (budget > 0) {
+        struct evbuffer_iovec vec;
+        if (evbuffer_peek(input, -1, NULL, &vec, 1) < 1 || vec.iov_len == 0) {
+            break;
+        }
+
+        size_t len = vec.iov_len < budget ? vec.iov_len : budget;
+        ssize_t rv = nghttp2_session_mem_recv(h2->session, vec.iov_base, len);
+        if (rv < 0) {
+            log_error("HTTP/2: nghttp2_session_mem_recv failed: %s",
+                      nghttp2_strerror((int)rv));
+            return -1;
+        }
+        evbuffer_drain(input, (size_t)rv);
+        conn->input_consumed += (size_t)rv;
+        budget -= (size_t)rv;
+        if ((size_t)rv < len) {
+            break;
+        }
     }
 
     /* Send any pending data */
@@ -718,7 +967,11 @@ int h2_send_pending(Connection *conn)
     return 0;
 }
 
-/* Callback for reading response body */
+/*
+ * Callback for sizing the next DATA frame. Nothing is copied here: with
+ * NGHTTP2_DATA_FLAG_NO_COPY nghttp2 hands the frame to
+ * h2_send_data_callback(), which takes the bytes from bs->pos.
+ */
 static ssize_t h2_body_read_callback(nghttp2_session *session,
                                      int32_t stream_id,
                                      uint8_t *buf, size_t length,
@@ -729,28 +982,62 @@ static ssize_t h2_body_read_callback(nghttp2_session *session,
     H2BodySource *bs = (H2BodySource *)source->ptr;
     (void)session;
     (void)stream_id;
+    (void)buf;
     (void)user_data;
 
     size_t remaining = bs->len - bs->pos;
-    size_t to_copy = remaining < length ? remaining : length;
+    size_t to_send = remaining < length ? remaining : length;
 
-    if (to_copy > 0)
-        memcpy(buf, bs->data + bs->pos, to_copy);
-    bs->pos += to_copy;
-
-    if (bs->pos >= bs->len) {
+    *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
+    if (to_send == remaining) {
         *data_flags |= NGHTTP2_DATA_FLAG_EOF;
     }
 
-    return (ssize_t)to_copy;
+    return (ssize_t)to_send;
+}
+
+H2BodySource *h2_body_source_new(StaticFiles *files, const unsigned char *body,
+                                 size_t body_len, nghttp2_data_provider *provider)
+{
+    /* A static page is referenced where it lives, pinning its table;
+     * anything else is copied once, since callers often pass stack
+     * buffers (e.g. char body[8192]) that go out of scope before nghttp2
+     * sends the data. */
+    H2BodySource *bs = malloc(sizeof(H2BodySource) + (files ? 0 : body_len));
+    if (!bs) {
+        return NULL;
+    }
+    bs->refs = 1;
+    bs->len = body_len;
+    bs->pos = 0;
+    if (files) {
+        bs->data = body;
+        bs->files = static_files_ref(files);
+    } else {
+        if (body_len > 0) {
+            memcpy(bs->copy, body, body_len);
+        }
+        bs->data = bs->copy;
+        bs->files = NULL;
+    }
+
+    provider->source.ptr = bs;
+    provider->read_callback = h2_body_read_callback;
+    return bs;
 }
 
 /*
- * Send HTTP/2 response with full headers.
+ * Submit an HTTP/2 response with full headers, plus up to
+ * H2_RESPONSE_EXTRA_HEADERS extra ones. A 304 carries no content-type,
+ * content-length or body. cache_control NULL means "no-store". files is
+ * the static table body points into, or NULL to send a copy of body.
  */
-int h2_send_response(Connection *conn, int32_t stream_id,
-                     int status_code, const char *content_type,
-                     const unsigned char *body, size_t body_len)
+static int h2_submit_response(Connection *conn, int32_t stream_id,
+                              int status_code, const char *content_type,
+                              const char *cache_control,
+                              const nghttp2_nv *extra, size_t nextra,
+                              StaticFiles *files,
+                              const unsigned char *body, size_t body_len)
 {
     H2Connection *h2 = conn->h2;
     if (!h2 || !h2->session) {
@@ -765,16 +1052,8 @@ int h2_send_response(Connection *conn, int32_t stream_id,
     char content_length_str[32];
     snprintf(content_length_str, sizeof(content_length_str), "%zu", body_len);
 
-    /* Determine cache-control based on route */
-    const char *cache_control = "no-store";
-    int cache_max_age = conn->worker->config->cache_max_age;
-    char cache_control_buf[64];
-    /* Static file routes use configurable caching */
-    if (status_code == 200 && cache_max_age > 0 &&
-        strcmp(content_type, "text/html; charset=utf-8") == 0) {
-        snprintf(cache_control_buf, sizeof(cache_control_buf),
-                 "public, max-age=%d", cache_max_age);
-        cache_control = cache_control_buf;
+    if (!cache_control) {
+        cache_control = "no-store";
     }
 
     /* Get per-stream request ID */
@@ -785,63 +1064,64 @@ int h2_send_response(Connection *conn, int32_t stream_id,
     }
 
     /* Headers */
-    nghttp2_nv headers[] = {
+    nghttp2_nv headers[H2_RESPONSE_BASE_HEADERS + H2_RESPONSE_EXTRA_HEADERS] = {
         {(uint8_t *)":status", (uint8_t *)status_str,
          7, strlen(status_str), NGHTTP2_NV_FLAG_NONE},
-        {(uint8_t *)"content-type", (uint8_t *)content_type,
-         12, strlen(content_type), NGHTTP2_NV_FLAG_NONE},
-        {(uint8_t *)"content-length", (uint8_t *)content_length_str,
-         14, strlen(content_length_str), NGHTTP2_NV_FLAG_NONE},
         {(uint8_t *)"x-request-id", (uint8_t *)request_id,
          12, strlen(request_id), NGHTTP2_NV_FLAG_NONE},
         {(uint8_t *)"cache-control", (uint8_t *)cache_control,
-         13, strlen(cache_control), NGHTTP2_NV_FLAG_NONE}
+         13, strlen(cache_control), NGHTTP2_NV_FLAG_NONE},
+        {(uint8_t *)"content-type", (uint8_t *)content_type,
+         12, strlen(content_type), NGHTTP2_NV_FLAG_NONE},
+        {(uint8_t *)"content-length", (uint8_t *)content_length_str,
+         14, strlen(content_length_str), NGHTTP2_NV_FLAG_NONE}
     };
+    size_t nheaders = status_code == 304 ? 3 : H2_RESPONSE_BASE_HEADERS;
 
-    /* Data provider for body - copy body data so it survives async send.
-     * Callers often pass stack-allocated buffers (e.g. char body[8192])
-     * which go out of scope before nghttp2 reads the data. */
-    H2BodySource *body_source = malloc(sizeof(H2BodySource));
-    if (!body_source) {
-        return -1;
+    for (size_t i = 0; i < nextra && i < H2_RESPONSE_EXTRA_HEADERS; i++) {
+        headers[nheaders++] = extra[i];
     }
-    if (body_len > 0) {
-        body_source->data = malloc(body_len);
-        if (!body_source->data) {
-            free(body_source);
+
+    if (status_code == 304) {
+        int rv = nghttp2_submit_response(h2->session, stream_id, headers, nheaders, NULL);
+        if (rv != 0) {
+            log_error("HTTP/2: Failed to submit response: %s", nghttp2_strerror(rv));
             return -1;
         }
-        memcpy(body_source->data, body, body_len);
-    } else {
-        body_source->data = NULL;
+        return h2_send_pending(conn);
     }
-    body_source->len = body_len;
-    body_source->pos = 0;
 
     nghttp2_data_provider data_prd;
-    data_prd.source.ptr = body_source;
-    data_prd.read_callback = h2_body_read_callback;
+    H2BodySource *body_source = h2_body_source_new(files, body, body_len, &data_prd);
+    if (!body_source) {
+        return -1;
+    }
 
     int rv = nghttp2_submit_response(h2->session, stream_id,
-                                      headers, sizeof(headers) / sizeof(headers[0]),
-                                      &data_prd);
+                                      headers, nheaders, &data_prd);
     if (rv != 0) {
         log_error("HTTP/2: Failed to submit response: %s", nghttp2_strerror(rv));
-        free(body_source->data);
-        free(body_source);
+        h2_body_source_unref(body_source);
         return -1;
     }
 
     /* Track body_source in stream for proper cleanup */
     if (stream) {
         /* Free any previous body_source (shouldn't happen, but be safe) */
-        if (stream->body_source) {
-            H2BodySource *old_bs = (H2BodySource *)stream->body_source;
-            free(old_bs->data);
-            free(old_bs);
-        }
+        h2_body_source_unref(stream->body_source);
         stream->body_source = body_source;
     }
 
     return h2_send_pending(conn);
 }
+
+/*
+ * Send HTTP/2 response with full headers.
+ */
+int h2_send_response(Connection *conn, int32_t stream_id,
+                     int status_code, const char *content_type,
+                     const unsigned char *body, size_t body_len)
+{
+    return h2_submit_response(conn, stream_id, status_code, content_type, NULL,
+                              NULL, 0, NULL, body, body_len);
+}
@@ -0,0 +1,370 @@
+/*
+ * HTTP/1.1 request head tokenizer.
+ *
+ * A single forward pass: method and header names through the token
+ * table, target and header values through the delimiter scan, which
+ * dispatches at runtime to the SSE4.2 or AVX2 kernel (http_parser_simd.c)
+ * and finishes the tail here.
+ */
+
+#include "http_parser.h"
+#include "cpu.h"
+
+#include <string.h>
+#include <strings.h>
+
+/* Scan limits: the target ends at SP or a control byte, a value at a
+ * control byte (HT is a control byte too and is stepped over) */
+#define TARGET_LIMIT    0x21
+#define VALUE_LIMIT     0x20
+
+/*
+ * Lookup table for RFC 9110 token characters ("tchar"): ALPHA, DIGIT
+ * and !#$%&'*+-.^_`|~. Index by character value.
+ */
+static const uint8_t token_char[256] = {
+    /* 0x00-0x0F: control characters */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x10-0x1F: control characters */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x20-0x2F: SP ! " # $ % & ' ( ) * + , - . / */
+    0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0,
+    /* 0x30-0x3F: '0'-'9' : ; < = > ? */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+    /* 0x40-0x4F: @ 'A'-'O' */
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    /* 0x50-0x5F: 'P'-'Z' [ \ ] ^ _ */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1,
+    /* 0x60-0x6F: ` 'a'-'o' */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    /* 0x70-0x7F: 'p'-'z' { | } ~ DEL */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0,
+    /* 0x80-0xFF: high bytes (non-ASCII) - not token characters */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const struct {
+    const char *name;
+    size_t len;
+} known_headers[HTTP_HEADER_COUNT] = {
+    [HTTP_HEADER_HOST]              = { "Host", 4 },
+    [HTTP_HEADER_CONTENT_LENGTH]    = { "Content-Length", 14 },
+    [HTTP_HEADER_TRANSFER_ENCODING] = { "Transfer-Encoding", 17 },
+    [HTTP_HEADER_CONNECTION]        = { "Connection", 10 },
+    [HTTP_HEADER_ACCEPT]            = { "Accept", 6 },
+    [HTTP_HEADER_ACCEPT_ENCODING]   = { "Accept-Encoding", 15 },
+    [HTTP_HEADER_IF_NONE_MATCH]     = { "If-None-Match", 13 },
+    [HTTP_HEADER_IF_MODIFIED_SINCE] = { "If-Modified-Since", 17 },
+};
+
+/* ========== Dispatch ========== */
+
+static HttpParserBackend active_backend = HTTP_PARSER_BACKEND_COUNT;  /* Not chosen yet */
+static size_t (*scan_kernel)(const char *data, size_t len, unsigned char limit);
+
+static size_t http_scan_none(const char *data, size_t len, unsigned char limit)
+{
+    (void)data;
+    (void)len;
+    (void)limit;
+    return 0;
+}
+
+int http_parser_backend_supported(HttpParserBackend backend)
+{
+    switch (backend) {
+        case HTTP_PARSER_BACKEND_SCALAR:
+            return 1;
+#if defined(__x86_64__)
+        case HTTP_PARSER_BACKEND_SSE42:
+            return cpu_has(CPU_SSE42);
+        case HTTP_PARSER_BACKEND_AVX2:
+            return cpu_has(CPU_AVX2);
+#endif
+        default:
+            return 0;
+    }
+}
+
+int http_parser_set_backend(HttpParserBackend backend)
+{
+    if (!http_parser_backend_supported(backend)) {
+        return -1;
+    }
+
+    active_backend = backend;
+    scan_kernel = http_scan_none;
+#if defined(__x86_64__)
+    switch (backend) {
+        case HTTP_PARSER_BACKEND_SSE42:
+            scan_kernel = http_scan_sse42;
+            break;
+        case HTTP_PARSER_BACKEND_AVX2:
+            scan_kernel = http_scan_avx2;
+            break;
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
+
+HttpParserBackend http_parser_backend(void)
+{
+    if (active_backend == HTTP_PARSER_BACKEND_COUNT) {
+        if (http_parser_set_backend(HTTP_PARSER_BACKEND_AVX2) < 0 &&
+            http_parser_set_backend(HTTP_PARSER_BACKEND_SSE42) < 0) {
+            http_parser_set_backend(HTTP_PARSER_BACKEND_SCALAR);
+        }
+    }
+    return active_backend;
+}
+
+const char *http_parser_backend_name(HttpParserBackend backend)
+{
+    switch (backend) {
+        case HTTP_PARSER_BACKEND_SCALAR: return "scalar";
+        case HTTP_PARSER_BACKEND_SSE42:  return "sse4.2";
+        case HTTP_PARSER_BACKEND_AVX2:   return "avx2";
+        default:                         return "unknown";
+    }
+}
+
+/* ========== Tokenizer ========== */
+
+/* First byte in [p, end) below limit or DEL, or end */
+static const char *scan_until(const char *p, const char *end, unsigned char limit)
+{
+    p += scan_kernel(p, (size_t)(end - p), limit);
+    while (p < end && (unsigned char)*p >= limit && *p != 0x7F) {
+        p++;
+    }
+    return p;
+}
+
+static const char *scan_token(const char *p, const char *end)
+{
+    while (p < end && token_char[(unsigned char)*p]) {
+        p++;
+    }
+    return p;
+}
+
+/* Step over CRLF or LF. Returns NULL if p is not at a line end. */
+static const char *skip_eol(const char *p, const char *end)
+{
+    if (p < end && *p == '\r') {
+        p++;
+    }
+    return p < end && *p == '\n' ? p + 1 : NULL;
+}
+
+static int lookup_known(const char *name, size_t len)
+{
+    for (int id = 0; id < HTTP_HEADER_COUNT; id++) {
+        if (known_headers[id].len == len &&
+            strncasecmp(name, known_headers[id].name, len) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+static int parse_header_lines(const char *p, const char *end, HttpRequest *req)
+{
+    for (;;) {
+        const char *name, *name_end, *value, *value_end;
+        HttpHeader *h;
+        int id;
+
+        if (p >= end) {
+            return -1;
+        }
+        if (*p == '\r' || *p == '\n') {
+            /* Blank line: end of the head */
+            return skip_eol(p, end) ? 0 : -1;
+        }
+        if (req->num_headers == HTTP_MAX_HEADERS) {
+            return -1;
+        }
+
+        /* Name: a token directly followed by ':' (this also rejects
+         * obs-fold continuation lines, which start with whitespace) */
+        name = p;
+        p = scan_token(p, end);
+        if (p == name || p >= end || *p != ':') {
+            return -1;
+        }
+        name_end = p++;
+
+        /* Value: up to the line end, HT allowed inside */
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        value = p;
+        for (;;) {
+            p = scan_until(p, end, VALUE_LIMIT);
+            if (p < end && *p == '\t') {
+                p++;
+                continue;
+            }
+            break;
+        }
+        value_end = p;
+        p = skip_eol(p, end);
+        if (!p) {
+            return -1;  /* Control byte inside the value, or no line end */
+        }
+        while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+            value_end--;
+        }
+
+        h = &req->headers[req->num_headers];
+        h->name = name;
+        h->name_len = (size_t)(name_end - name);
+        h->value = value;
+        h->value_len = (size_t)(value_end - value);
+
+        id = lookup_known(h->name, h->name_len);
+        if (id == HTTP_HEADER_CONTENT_LENGTH && req->known[id] >= 0) {
+            /* Lengths that differ leave the request's end ambiguous
+             * (smuggling with pipelining); repeats must agree */
+            const HttpHeader *first = &req->headers[req->known[id]];
+            if (first->value_len != h->value_len ||
+                memcmp(first->value, h->value, h->value_len) != 0) {
+                return -1;
+            }
+        }
+        if (id >= 0 && req->known[id] < 0) {
+            req->known[id] = (int8_t)req->num_headers;
+        }
+        req->num_headers++;
+    }
+}
+
+static void request_init(HttpRequest *req)
+{
+    req->method = NULL;
+    req->method_len = 0;
+    req->target = NULL;
+    req->target_len = 0;
+    req->minor_version = 1;
+    req->num_headers = 0;
+    memset(req->known, -1, sizeof(req->known));
+}
+
+/*
+ * The request line after its target: SP HTTP-version, or nothing
+ * (HTTP/0.9 style), then the line end and the header lines.
+ */
+static int parse_version_and_headers(const char *p, const char *end, HttpRequest *req)
+{
+    if (p >= end) {
+        return -1;
+    }
+    if (*p == ' ') {
+        p++;
+        if (end - p < 8 || memcmp(p, "HTTP/1.", 7) != 0 || p[7] < '0' || p[7] > '9') {
+            return -1;
+        }
+        req->minor_version = p[7] - '0';
+        p += 8;
+    } else {
+        req->minor_version = -1;
+    }
+
+    p = skip_eol(p, end);
+    if (!p) {
+        return -1;
+    }
+    return parse_header_lines(p, end, req);
+}
+
+int http_parse_request_tail(const char *buf, size_t len, HttpRequest *req)
+{
+    http_parser_backend();
+    request_init(req);
+    return parse_version_and_headers(buf, buf + len, req);
+}
+
+int http_parse_request(const char *buf, size_t len, HttpRequest *req)
+{
+    const char *p = buf;
+    const char *end = buf + len;
+
+    http_parser_backend();
+    request_init(req);
+
+    /* Method SP */
+    p = scan_token(p, end);
+    if (p == buf || p >= end || *p != ' ') {
+        return -1;
+    }
+    req->method = buf;
+    req->method_len = (size_t)(p - buf);
+    p++;
+
+    /* Target, up to SP or the line end */
+    req->target = p;
+    p = scan_until(p, end, TARGET_LIMIT);
+    req->target_len = (size_t)(p - req->target);
+    if (req->target_len == 0) {
+        return -1;
+    }
+    return parse_version_and_headers(p, end, req);
+}
+
+/* ========== Values ========== */
+
+int http_header_has_token(const char *value, size_t len, const char *token)
+{
+    size_t token_len = strlen(token);
+    const char *p = value;
+    const char *end = value + len;
+
+    while (p < end) {
+        const char *item, *item_end;
+
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) {
+            p++;
+        }
+        item = p;
+        while (p < end && *p != ',') {
+            p++;
+        }
+        item_end = p;
+        while (item_end > item && (item_end[-1] == ' ' || item_end[-1] == '\t')) {
+            item_end--;
+        }
+        if ((size_t)(item_end - item) == token_len &&
+            strncasecmp(item, token, token_len) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int http_parse_content_length(const char *value, size_t len, size_t *out)
+{
+    size_t n = 0;
+
+    if (len == 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        unsigned d = (unsigned char)value[i] - '0';
+        if (d > 9 || n > (SIZE_MAX - d) / 10) {
+            return -1;
+        }
+        n = n * 10 + d;
+    }
+    *out = n;
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * x86 HTTP delimiter scan: SSE4.2 (16 bytes), AVX2 (32 bytes).
+ *
+ * Compiled with per-function target attributes so the rest of the
+ * binary stays baseline x86-64; http_parser.c only calls these after
+ * cpu_has() confirms the instructions exist.
+ *
+ * A byte stops the scan if it is below limit or is DEL; bytes from 0x80
+ * up (obs-text) pass, so the compares are unsigned:
+ *   SSE4.2 - PCMPESTRI in range mode over { 0..limit-1, 0x7F..0x7F },
+ *            which returns the index of the first stop byte directly
+ *   AVX2   - pass = (max(v, limit) == v) & (v != 0x7F), then the first
+ *            zero bit of the movemask
+ */
+
+#include "http_parser.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/* ========== SSE4.2 ========== */
+
+#define SSE42_TARGET __attribute__((target("sse4.2")))
+
+SSE42_TARGET
+size_t http_scan_sse42(const char *data, size_t len, unsigned char limit)
+{
+    const __m128i ranges = _mm_setr_epi8(0, (char)(limit - 1), 0x7F, 0x7F,
+                                         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        int idx = _mm_cmpestri(ranges, 4, v, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                               _SIDD_LEAST_SIGNIFICANT);
+        if (idx != 16) {
+            return i + (size_t)idx;
+        }
+    }
+    return i;
+}
+
+/* ========== AVX2 ========== */
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET
+size_t http_scan_avx2(const char *data, size_t len, unsigned char limit)
+{
+    const __m256i lim = _mm256_set1_epi8((char)limit);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i pass = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, del),
+                                           _mm256_cmpeq_epi8(_mm256_max_epu8(v, lim), v));
+        uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(pass);
+        if (stop) {
+            return i + (size_t)__builtin_ctz(stop);
+        }
+    }
+    return i;
+}
+
+#else /* !__x86_64__ */
+
+/* Keep the translation unit non-empty (ISO C) */
+typedef int http_parser_simd_unused;
+
+#endif /* __x86_64__ */
@@ -82,7 +82,8 @@ static void log_write(LogLevel level, const char *fmt, va_list args)
     /* Get timestamp with microseconds */
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm *tm_info = localtime(&tv.tv_sec);
+    struct tm tm_buf;
+    struct tm *tm_info = localtime_r(&tv.tv_sec, &tm_buf);
     char timestamp[32];
     strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", tm_info);
 
@@ -205,7 +206,8 @@ void log_access(const char *client_ip, const char *method, const char *path,
     /* Get timestamp with microseconds */
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm *tm_info = localtime(&tv.tv_sec);
+    struct tm tm_buf;
+    struct tm *tm_info = localtime_r(&tv.tv_sec, &tm_buf);
 
     if (g_json_mode) {
         /* JSON format */
@@ -1,6 +1,10 @@
 #include "master.h"
 #include "worker.h"
+#include "static_files.h"
 #include "security.h"
+#include "sha256.h"
+#include "hex.h"
+#include "http_parser.h"
 #include "log.h"
 
 #include <stdio.h>
@@ -11,6 +15,7 @@
 #include <errno.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <sys/resource.h>
 
 /* Global master pointer for signal handlers */
@@ -129,10 +134,209 @@ static void setup_master_signals(MasterProcess *master)
     sigaction(SIGPIPE, &sa, NULL);
 }
 
+/*
+ * Load config's static directory into a new image. Unchanged files reuse
+ * the compressed variants of the current image, so only changed files
+ * are compressed again.
+ * Returns the image descriptor, -1 on failure.
+ */
+static int create_static_image(const MasterProcess *master, const Config *config)
+{
+    StaticFiles *previous = NULL;
+    StaticFiles *files;
+    int fd;
+
+    if (master->static_image_fd >= 0) {
+        previous = static_files_map(master->static_image_fd);
+    }
+    files = static_files_open(config->static_dir, config, previous);
+    static_files_unref(previous);
+    if (!files) {
+        return -1;
+    }
+
+    fd = static_image_create(files);
+    static_files_unref(files);
+    return fd;
+}
+
+/*
+ * Make fd the shared image (static_image_fd replaced, generation bumped).
+ */
+static void install_static_image(MasterProcess *master, int fd)
+{
+    if (master->static_image_fd >= 0) {
+        close(master->static_image_fd);
+    }
+    master->static_image_fd = fd;
+    master->static_generation++;
+}
+
+/*
+ * Build and install config's static image in the master (startup and
+ * SIGHUP, before workers are forked from it).
+ * Returns 0 on success, -1 on failure (current image kept).
+ */
+static int build_static_image(MasterProcess *master, const Config *config)
+{
+    int fd = create_static_image(master, config);
+    if (fd < 0) {
+        return -1;
+    }
+    install_static_image(master, fd);
+    return 0;
+}
+
+/*
+ * Drop a static rebuild in progress: its result would be for the old
+ * config (SIGHUP) or nobody is left to take it (shutdown).
+ */
+static void cancel_static_builder(MasterProcess *master)
+{
+    if (master->static_builder > 0) {
+        kill(master->static_builder, SIGKILL);
+        waitpid(master->static_builder, NULL, 0);
+        master->static_builder = 0;
+    }
+    if (master->static_builder_channel >= 0) {
+        close(master->static_builder_channel);
+        master->static_builder_channel = -1;
+    }
+    master->static_rebuild_pending = false;
+}
+
+/*
+ * Static directory changed: rebuild the image in a forked builder, so
+ * compressing a large deploy (gzip -9, brotli q11) never holds up worker
+ * restarts, signals or ticket rotation here. The builder sends the image
+ * back over a datagram socket like the worker channels; changes that
+ * settle while it runs start one more build when it is done.
+ */
+static void start_static_builder(MasterProcess *master)
+{
+    int channel[2];
+    pid_t pid;
+
+    if (master->static_builder > 0 || master->static_builder_channel >= 0) {
+        master->static_rebuild_pending = true;
+        return;
+    }
+    master->static_rebuild_pending = false;
+
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, channel) < 0) {
+        log_warn("Static reload of %s failed: socketpair(): %s",
+                 master->config->static_dir, strerror(errno));
+        return;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        log_warn("Static reload of %s failed: fork(): %s",
+                 master->config->static_dir, strerror(errno));
+        close(channel[0]);
+        close(channel[1]);
+        return;
+    }
+
+    if (pid == 0) {
+        /* Builder: build, hand the image over, exit */
+        close(channel[0]);
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGHUP, SIG_DFL);
+        int fd = create_static_image(master, master->config);
+        int sent = fd >= 0 && static_image_send(channel[1], 0, fd) == 0;
+        _exit(sent ? 0 : 1);
+    }
+
+    close(channel[1]);
+    master->static_builder = pid;
+    master->static_builder_channel = channel[0];
+}
+
+/*
+ * Collect a finished rebuild and hand it to every worker. On failure
+ * (e.g. error.html missing mid-deploy) workers are told so and keep
+ * serving the previous files.
+ */
+static void poll_static_builder(MasterProcess *master)
+{
+    uint32_t unused;
+    int fd = -1;
+    int rc;
+
+    if (master->static_builder_channel < 0) {
+        return;
+    }
+    rc = static_image_recv(master->static_builder_channel, &unused, &fd);
+    if (rc == 0 && master->static_builder > 0) {
+        return;     /* Still building */
+    }
+    close(master->static_builder_channel);
+    master->static_builder_channel = -1;
+    if (master->static_builder > 0) {
+        /* Exits right after sending */
+        waitpid(master->static_builder, NULL, 0);
+        master->static_builder = 0;
+    }
+
+    if (rc > 0 && fd >= 0) {
+        install_static_image(master, fd);
+        log_info("Rebuilt static image from %s (generation %u)",
+                 master->config->static_dir, master->static_generation);
+    } else {
+        fd = -1;
+        log_warn("Static reload of %s failed, workers keep the previous files",
+                 master->config->static_dir);
+    }
+
+    for (int i = 0; i < master->num_workers; i++) {
+        if (master->worker_channels[i] >= 0 &&
+            static_image_send(master->worker_channels[i], master->static_generation, fd) < 0) {
+            log_warn("Failed to send static image to worker %d: %s", i, strerror(errno));
+        }
+    }
+
+    if (master->static_rebuild_pending) {
+        start_static_builder(master);
+    }
+}
+
+/*
+ * Shared ticket keys exist while TLS is on with rotation configured.
+ * Created before forking so every worker generation maps the same keys.
+ * Turned off on reload, the master only unmaps its view: draining
+ * workers still read the shared page, so it must not be wiped.
+ */
+static void update_ticket_keys(MasterProcess *master)
+{
+    bool want = master->config->tls_enabled && master->config->tls_ticket_key_rotation > 0;
+
+    if (want && !master->ticket_keys) {
+        master->ticket_keys = ticket_keys_create();
+        if (!master->ticket_keys) {
+            log_warn("TLS session tickets fall back to per-worker keys");
+        }
+    } else if (!want && master->ticket_keys) {
+        ticket_keys_unmap(master->ticket_keys);
+        master->ticket_keys = NULL;
+    }
+}
+
+static void open_static_watch(MasterProcess *master)
+{
+    static_watch_close(&master->static_watch);
+    if (master->config->static_watch) {
+        static_watch_open(&master->static_watch, master->config->static_dir);
+    }
+}
+
 int master_init(MasterProcess *master, const char *config_path)
 {
     memset(master, 0, sizeof(MasterProcess));
     master->config_path = config_path;
+    master->static_image_fd = -1;
+    master->static_builder_channel = -1;
+    master->static_watch.fd = -1;
 
     /* Load configuration */
     master->config = config_load(config_path);
@@ -176,25 +380,89 @@ int master_init(MasterProcess *master, const char *config_path)
         return -1;
     }
 
+    master->worker_channels = malloc(master->num_workers * sizeof(int));
+    if (!master->worker_channels) {
+        log_error("Failed to allocate worker channel array");
+        free(master->worker_pids);
+        config_free(master->config);
+        return -1;
+    }
+    for (int i = 0; i < master->num_workers; i++) {
+        master->worker_channels[i] = -1;
+    }
+
+    /* Shared before any fork so every worker generation maps the same table */
+    master->tx_cache = txcache_create();
+    if (!master->tx_cache) {
+        log_warn("Cross-worker broadcast dedup disabled");
+    }
+    update_ticket_keys(master);
+
+    /* Static files: loaded and compressed once here, not once per worker */
+    if (build_static_image(master, master->config) < 0) {
+        log_error("Failed to load static files from %s", master->config->static_dir);
+        master_cleanup(master);
+        return -1;
+    }
+    open_static_watch(master);
+
+    log_info("txid hashing: %s backend", sha256_backend_name(sha256_backend()));
+    log_info("hex validation: %s backend", hex_backend_name(hex_backend()));
+    log_info("header parsing: %s backend", http_parser_backend_name(http_parser_backend()));
+
     return 0;
 }
 
-pid_t fork_worker(int worker_id, Config *config)
+pid_t fork_worker(MasterProcess *master, int worker_id)
 {
-    pid_t pid = fork();
+    int channel[2] = { -1, -1 };
+    pid_t pid;
+
+    /* Static image channel; without one the worker just never reloads */
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, channel) < 0) {
+        log_warn("socketpair() failed for worker %d: %s", worker_id, strerror(errno));
+        channel[0] = channel[1] = -1;
+    }
 
+    pid = fork();
     if (pid < 0) {
         log_error("fork() failed for worker %d: %s", worker_id, strerror(errno));
+        if (channel[0] >= 0) {
+            close(channel[0]);
+            close(channel[1]);
+        }
         return -1;
     }
 
     if (pid == 0) {
-        /* Child process - become worker */
-        worker_main(worker_id, config);
+        /* Child process - keep only its own channel end, become worker */
+        for (int i = 0; i < master->num_workers; i++) {
+            if (master->worker_channels[i] >= 0) {
+                close(master->worker_channels[i]);
+            }
+        }
+        if (channel[0] >= 0) {
+            close(channel[0]);
+        }
+        if (master->static_builder_channel >= 0) {
+            close(master->static_builder_channel);
+        }
+        static_watch_close(&master->static_watch);
+        worker_main(worker_id, master->config, master->tx_cache,
+                    master->ticket_keys, master->static_image_fd, channel[1]);
         /* worker_main calls exit(), should never reach here */
         exit(1);
     }
 
+    /* Parent - a replaced or draining worker no longer gets images */
+    if (channel[1] >= 0) {
+        close(channel[1]);
+    }
+    if (master->worker_channels[worker_id] >= 0) {
+        close(master->worker_channels[worker_id]);
+    }
+    master->worker_channels[worker_id] = channel[0];
+
     /* Parent - return child PID */
     return pid;
 }
@@ -207,7 +475,7 @@ static int start_workers(MasterProcess *master)
     log_info("Starting %d worker processes", master->num_workers);
 
     for (int i = 0; i < master->num_workers; i++) {
-        master->worker_pids[i] = fork_worker(i, master->config);
+        master->worker_pids[i] = fork_worker(master, i);
         if (master->worker_pids[i] < 0) {
             log_error("Failed to start worker %d", i);
             /* Continue trying to start other workers */
@@ -254,6 +522,12 @@ static int remove_draining_worker(MasterProcess *master, pid_t pid)
  */
 static void handle_worker_exit(MasterProcess *master, pid_t pid, int status)
 {
+    /* The static builder; its image (or failure) comes over its channel */
+    if (pid == master->static_builder) {
+        master->static_builder = 0;
+        return;
+    }
+
     /* Check if this is a draining worker from reload (expected exit) */
     if (remove_draining_worker(master, pid)) {
         log_info("Draining worker (pid %d) exited cleanly", pid);
@@ -278,7 +552,7 @@ static void handle_worker_exit(MasterProcess *master, pid_t pid, int status)
     /* Restart worker if not shutting down */
     if (!master->shutdown_requested) {
         log_info("Restarting worker %d", worker_id);
-        master->worker_pids[worker_id] = fork_worker(worker_id, master->config);
+        master->worker_pids[worker_id] = fork_worker(master, worker_id);
         if (master->worker_pids[worker_id] > 0) {
             log_info("Restarted worker %d (new pid %d)",
                      worker_id, master->worker_pids[worker_id]);
@@ -359,6 +633,15 @@ void master_reload(MasterProcess *master)
         return;
     }
 
+    /* New workers start from a fresh image of the (possibly new) directory */
+    cancel_static_builder(master);
+    if (build_static_image(master, new_config) < 0) {
+        log_error("Failed to load static files from %s, keeping old configuration",
+                  new_config->static_dir);
+        config_free(new_config);
+        return;
+    }
+
     /* Allocate draining_pids if needed */
     if (!master->draining_pids) {
         master->draining_pids = calloc(master->num_workers, sizeof(pid_t));
@@ -381,6 +664,7 @@ void master_reload(MasterProcess *master)
     /* Update config and restart workers */
     Config *old_config = master->config;
     master->config = new_config;
+    update_ticket_keys(master);
 
     /* Fork new workers (they'll use new config) */
     for (int i = 0; i < master->num_workers; i++) {
@@ -388,8 +672,9 @@ void master_reload(MasterProcess *master)
             /* Old worker still running - will exit after drain */
             pid_t old_pid = master->worker_pids[i];
 
-            /* Start new worker */
-            master->worker_pids[i] = fork_worker(i, new_config);
+            /* Start new worker (same TxCache and ticket keys: dedup
+             * state and TLS resumption survive reload) */
+            master->worker_pids[i] = fork_worker(master, i);
             log_info("Started new worker %d (pid %d), old worker %d draining",
                      i, master->worker_pids[i], old_pid);
         }
@@ -397,6 +682,7 @@ void master_reload(MasterProcess *master)
 
     /* Free old config */
     config_free(old_config);
+    open_static_watch(master);
 
     log_info("Reload complete");
 }
@@ -425,6 +711,18 @@ int master_run(MasterProcess *master)
             master_reload(master);
         }
 
+        /* Static directory changed and settled: rebuild off this loop */
+        if (static_watch_poll(&master->static_watch)) {
+            start_static_builder(master);
+        }
+        poll_static_builder(master);
+
+        /* New session ticket key when the current one is old enough */
+        if (master->ticket_keys) {
+            ticket_keys_rotate_if_due(master->ticket_keys,
+                                      master->config->tls_ticket_key_rotation, time(NULL));
+        }
+
         /* Wait for child events */
         int status;
         pid_t pid = waitpid(-1, &status, WNOHANG);
@@ -441,6 +739,7 @@ int master_run(MasterProcess *master)
 
     /* Graceful shutdown */
     log_info("Shutdown requested, draining workers");
+    cancel_static_builder(master);
     master_shutdown_workers(master);
     wait_for_workers(master, 30);  /* 30 second timeout */
 
@@ -460,8 +759,37 @@ void master_cleanup(MasterProcess *master)
         master->draining_pids = NULL;
     }
 
+    if (master->worker_channels) {
+        for (int i = 0; i < master->num_workers; i++) {
+            if (master->worker_channels[i] >= 0) {
+                close(master->worker_channels[i]);
+            }
+        }
+        free(master->worker_channels);
+        master->worker_channels = NULL;
+    }
+
+    if (master->static_image_fd >= 0) {
+        close(master->static_image_fd);
+        master->static_image_fd = -1;
+    }
+    static_watch_close(&master->static_watch);
+
     if (master->config) {
         config_free(master->config);
         master->config = NULL;
     }
+
+    txcache_destroy(master->tx_cache);
+    master->tx_cache = NULL;
+
+    cancel_static_builder(master);
+
+    /* Workers are gone unless some drained past the shutdown wait */
+    if (master->num_draining == 0) {
+        ticket_keys_destroy(master->ticket_keys);
+    } else {
+        ticket_keys_unmap(master->ticket_keys);
+    }
+    master->ticket_keys = NULL;
 }
@@ -1,5 +1,6 @@
 #include "router.h"
 #include "hex.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* Minimum raw transaction hex length (82 bytes = 164 chars) */
@@ -8,47 +9,203 @@
 /* Transaction ID length (32 bytes = 64 chars) */
 #define TXID_HEX_LENGTH 64
 
-RouteType route_request(const char *path, size_t path_len)
+/* Perfect hash search: seeds tried per table size, and how far the
+ * table may grow (in slots per route) before falling back to probing */
+#define ROUTE_SEED_TRIES        64
+#define ROUTE_MAX_SLOTS_PER     64
+#define ROUTE_MIN_SLOTS         16
+
+static const struct {
+    const char *path;
+    RouteType route;
+} fixed_routes[] = {
+    { "/health",  ROUTE_HEALTH },
+    { "/ready",   ROUTE_READY },
+    { "/version", ROUTE_VERSION },
+    { "/alive",   ROUTE_ALIVE },
+    { "/metrics", ROUTE_METRICS },
+};
+
+/* ========== Route Table ========== */
+
+static uint32_t route_hash(const char *path, size_t len, uint32_t seed)
 {
-    /* Skip leading slash */
-    if (path_len == 0 || path[0] != '/') {
-        return ROUTE_ERROR;
+    uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)path[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+int route_table_init(RouteTable *table)
+{
+    memset(table, 0, sizeof(*table));
+
+    for (size_t i = 0; i < sizeof(fixed_routes) / sizeof(fixed_routes[0]); i++) {
+        if (route_table_add(table, fixed_routes[i].path, strlen(fixed_routes[i].path),
+                            fixed_routes[i].route, NULL) < 0) {
+            route_table_free(table);
+            return -1;
+        }
     }
+    return 0;
+}
 
-    const char *content = path + 1;
-    size_t content_len = path_len - 1;
+int route_table_add(RouteTable *table, const char *path, size_t path_len,
+                    RouteType route, const void *data)
+{
+    for (size_t i = 0; i < table->count; i++) {
+        if (table->entries[i].path_len == path_len &&
+            memcmp(table->entries[i].path, path, path_len) == 0) {
+            return 1;
+        }
+    }
 
-    /* Empty path after slash = home page */
-    if (content_len == 0) {
-        return ROUTE_HOME;
+    if (table->count == table->capacity) {
+        size_t capacity = table->capacity ? table->capacity * 2 : 16;
+        RouteEntry *entries = realloc(table->entries, capacity * sizeof(RouteEntry));
+        if (!entries) return -1;
+        table->entries = entries;
+        table->capacity = capacity;
     }
 
-    /* Check for observability endpoints first */
-    if (content_len == 6 && strncmp(content, "health", 6) == 0) {
-        return ROUTE_HEALTH;
+    RouteEntry *entry = &table->entries[table->count++];
+    entry->path = path;
+    entry->path_len = path_len;
+    entry->route = route;
+    entry->data = data;
+    if (path_len > table->max_path_len) {
+        table->max_path_len = path_len;
+    }
+    return 0;
+}
+
+/*
+ * Place every entry with the given seed. With probing off, fails on the
+ * first collision; otherwise records the longest probe sequence.
+ */
+static int route_table_place(RouteTable *table, uint32_t *slots, uint32_t mask,
+                             uint32_t seed, int probe, size_t *max_probe)
+{
+    memset(slots, 0, ((size_t)mask + 1) * sizeof(uint32_t));
+    *max_probe = 0;
+
+    for (size_t i = 0; i < table->count; i++) {
+        const RouteEntry *entry = &table->entries[i];
+        uint32_t slot = route_hash(entry->path, entry->path_len, seed) & mask;
+        size_t distance = 0;
+
+        while (slots[slot] != 0) {
+            if (!probe) return -1;
+            slot = (slot + 1) & mask;
+            distance++;
+        }
+        slots[slot] = (uint32_t)i + 1;
+        if (distance > *max_probe) {
+            *max_probe = distance;
+        }
     }
-    if (content_len == 5 && strncmp(content, "ready", 5) == 0) {
-        return ROUTE_READY;
+    return 0;
+}
+
+int route_table_build(RouteTable *table)
+{
+    size_t min_slots = ROUTE_MIN_SLOTS;
+    size_t max_probe;
+
+    while (min_slots < table->count * 2) {
+        min_slots *= 2;
     }
-    if (content_len == 7 && strncmp(content, "version", 7) == 0) {
-        return ROUTE_VERSION;
+
+    for (size_t size = min_slots; size <= min_slots * ROUTE_MAX_SLOTS_PER; size *= 2) {
+        uint32_t *slots = malloc(size * sizeof(uint32_t));
+        if (!slots) return -1;
+
+        for (uint32_t seed = 0; seed < ROUTE_SEED_TRIES; seed++) {
+            if (route_table_place(table, slots, (uint32_t)(size - 1), seed, 0, &max_probe) == 0) {
+                free(table->slots);
+                table->slots = slots;
+                table->mask = (uint32_t)(size - 1);
+                table->seed = seed;
+                table->max_probe = 0;
+                return 0;
+            }
+        }
+        free(slots);
     }
-    if (content_len == 5 && strncmp(content, "alive", 5) == 0) {
-        return ROUTE_ALIVE;
+
+    /* No perfect seed: fall back to linear probing at the smallest size */
+    uint32_t *slots = malloc(min_slots * sizeof(uint32_t));
+    if (!slots) return -1;
+    route_table_place(table, slots, (uint32_t)(min_slots - 1), 0, 1, &max_probe);
+    free(table->slots);
+    table->slots = slots;
+    table->mask = (uint32_t)(min_slots - 1);
+    table->seed = 0;
+    table->max_probe = max_probe;
+    return 0;
+}
+
+void route_table_free(RouteTable *table)
+{
+    free(table->entries);
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+static const RouteEntry *route_table_lookup(const RouteTable *table, const char *path,
+                                            size_t path_len)
+{
+    if (!table->slots || path_len > table->max_path_len) {
+        return NULL;
     }
-    if (content_len == 7 && strncmp(content, "metrics", 7) == 0) {
-        return ROUTE_METRICS;
+
+    uint32_t slot = route_hash(path, path_len, table->seed) & table->mask;
+    for (size_t probe = 0; probe <= table->max_probe; probe++) {
+        uint32_t index = table->slots[slot];
+        if (index == 0) return NULL;
+
+        const RouteEntry *entry = &table->entries[index - 1];
+        if (entry->path_len == path_len && memcmp(entry->path, path, path_len) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) & table->mask;
     }
+    return NULL;
+}
 
-    /* Check for static page routes */
-    if (content_len == 4 && strncmp(content, "docs", 4) == 0) {
-        return ROUTE_DOCS;
+/* ========== Routing ========== */
+
+RouteType route_request(const RouteTable *table, const char *path, size_t path_len,
+                        const void **data)
+{
+    *data = NULL;
+
+    /* Exact paths: fixed endpoints and static assets */
+    if (table) {
+        const RouteEntry *entry = route_table_lookup(table, path, path_len);
+        if (entry) {
+            *data = entry->data;
+            return entry->route;
+        }
     }
-    if (content_len == 6 && strncmp(content, "status", 6) == 0) {
-        return ROUTE_STATUS;
+
+    /* Skip leading slash */
+    if (path_len == 0 || path[0] != '/') {
+        return ROUTE_ERROR;
     }
-    if (content_len == 5 && strncmp(content, "logos", 5) == 0) {
-        return ROUTE_LOGOS;
+
+    const char *content = path + 1;
+    size_t content_len = path_len - 1;
+
+    /* Bare slash without an index page */
+    if (content_len == 0) {
+        return ROUTE_ERROR;
     }
 
     /* Check for ACME HTTP-01 challenge path */
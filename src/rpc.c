@@ -6,11 +6,13 @@
  */
 
 #include "rpc.h"
+#include "rpc_parse.h"
 #include "log.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
@@ -135,6 +137,15 @@ int rpc_init(RPCClient *client, const RPCConfig *config, BitcoinChain chain)
         snprintf(client->wallet, sizeof(client->wallet), "%s", config->wallet);
     }
 
+    /* Async connection pool sizing */
+    client->pool.max_size = config->pool_max > 0 ? config->pool_max : RPC_POOL_DEFAULT_MAX;
+    client->pool.min_size = config->pool_min > 0 ? config->pool_min : 0;
+    if (client->pool.min_size > client->pool.max_size) {
+        client->pool.min_size = client->pool.max_size;
+    }
+    client->pool.idle_timeout_sec = config->pool_idle_timeout_sec > 0 ?
+        config->pool_idle_timeout_sec : RPC_POOL_DEFAULT_IDLE_TIMEOUT;
+
     /* Determine auth method */
     if (config->cookie_file[0]) {
         /* Direct cookie file path */
@@ -266,17 +277,15 @@ static int rpc_connect(RPCClient *client)
 }
 
 /*
- * Send HTTP request and receive response.
- * Returns response body (caller must free) or NULL on error.
+ * Send HTTP request and parse the response as it is received.
+ * Returns RPC_OK once resp holds a complete response, RPC_ERR_* otherwise.
  */
-static char *rpc_http_request(RPCClient *client,
-                              const char *body, size_t body_len,
-                              int *http_status, int *rpc_error)
+static int rpc_http_request(RPCClient *client, const char *body, size_t body_len,
+                            RPCResponse *resp)
 {
     int fd = rpc_connect(client);
     if (fd < 0) {
-        *rpc_error = RPC_ERR_CONNECT;
-        return NULL;
+        return RPC_ERR_CONNECT;
     }
 
     /* Build HTTP request */
@@ -301,207 +310,201 @@ static char *rpc_http_request(RPCClient *client,
         send(fd, body, body_len, 0) != (ssize_t)body_len) {
         log_error("RPC: Failed to send request");
         close(fd);
-        *rpc_error = RPC_ERR_CONNECT;
-        return NULL;
-    }
-
-    /* Receive response - start with small buffer, grow if needed
-     * Most RPC responses are <64KB, so this avoids 4MB allocation for typical requests */
-    size_t buffer_size = RPC_INITIAL_BUFFER_LEN;
-    char *response = malloc(buffer_size);
-    if (!response) {
-        close(fd);
-        *rpc_error = RPC_ERR_MEMORY;
-        return NULL;
+        return RPC_ERR_CONNECT;
     }
 
-    size_t total = 0;
+    /* Parse as it arrives: memory use doesn't depend on response size */
+    char buf[16384];
     ssize_t n;
-    while ((n = recv(fd, response + total, buffer_size - total - 1, 0)) > 0) {
-        total += n;
-        /* Grow buffer if needed */
-        if (total >= buffer_size - 1 && buffer_size < RPC_MAX_RESPONSE_LEN) {
-            size_t new_size = buffer_size * 2;
-            if (new_size > RPC_MAX_RESPONSE_LEN) {
-                new_size = RPC_MAX_RESPONSE_LEN;
-            }
-            char *new_buf = realloc(response, new_size);
-            if (!new_buf) {
-                /* Use what we have if realloc fails */
-                break;
-            }
-            response = new_buf;
-            buffer_size = new_size;
+    while (!rpc_response_done(resp) && (n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        if (rpc_response_feed(resp, buf, (size_t)n) < 0) {
+            close(fd);
+            return RPC_ERR_PARSE;
         }
-        if (total >= RPC_MAX_RESPONSE_LEN - 1) break;
     }
-    response[total] = '\0';
-
     close(fd);
 
-    if (total == 0) {
-        free(response);
-        *rpc_error = RPC_ERR_CONNECT;
-        return NULL;
-    }
-
-    /* Parse HTTP status */
-    *http_status = 0;
-    if (strncmp(response, "HTTP/", 5) == 0) {
-        char *status_start = strchr(response, ' ');
-        if (status_start) {
-            *http_status = atoi(status_start + 1);
-        }
+    if (resp->bytes == 0) {
+        return RPC_ERR_CONNECT;
     }
-
-    /* Find body (after \r\n\r\n) */
-    char *body_start = strstr(response, "\r\n\r\n");
-    if (!body_start) {
-        free(response);
-        *rpc_error = RPC_ERR_PARSE;
-        return NULL;
+    if (!rpc_response_done(resp) && rpc_response_eof(resp) < 0) {
+        return RPC_ERR_PARSE;
     }
-    body_start += 4;
-
-    /* Move body to start of buffer */
-    size_t body_offset = body_start - response;
-    memmove(response, body_start, total - body_offset + 1);
 
     client->request_count++;
 
-    if (*http_status == 401 || *http_status == 403) {
-        *rpc_error = RPC_ERR_AUTH;
-        free(response);
-        return NULL;
+    if (resp->status == 401 || resp->status == 403) {
+        return RPC_ERR_AUTH;
     }
-
-    *rpc_error = RPC_OK;
-    return response;
+    return RPC_OK;
 }
 
 /* ========== JSON-RPC Helpers ========== */
 
+/*
+ * Count a node error by its JSON-RPC code (e.g. -26 rejected, -25
+ * missing inputs, -27 already in chain).
+ */
+static void rpc_count_node_error(RPCClient *client, const RPCJsonScanner *json)
+{
+    if (!json->has_error_code) {
+        client->node_errors_other++;
+        return;
+    }
+    for (int i = 0; i < client->node_error_codes; i++) {
+        if (client->node_errors[i].code == json->error_code) {
+            client->node_errors[i].count++;
+            return;
+        }
+    }
+    if (client->node_error_codes < RPC_NODE_ERROR_CODES) {
+        RPCErrorCount *e = &client->node_errors[client->node_error_codes++];
+        e->code = json->error_code;
+        e->count = 1;
+        return;
+    }
+    client->node_errors_other++;
+}
+
 /*
  * Build JSON-RPC request.
  */
+static uint64_t jsonrpc_request_id = 0;
+
 static char *build_jsonrpc_request(const char *method, const char *params)
 {
-    static uint64_t request_id = 0;
     size_t buf_size = strlen(params) + strlen(method) + 128;
     char *request = malloc(buf_size);
     if (!request) return NULL;
 
     snprintf(request, buf_size,
         "{\"jsonrpc\":\"1.0\",\"id\":%lu,\"method\":\"%s\",\"params\":%s}",
-        (unsigned long)(++request_id), method, params);
+        (unsigned long)(++jsonrpc_request_id), method, params);
 
     return request;
 }
 
+/* ========== Shared Payloads ========== */
+
+RPCPayload *rpc_payload_wrap(void *block, const char *hex, size_t len)
+{
+    RPCPayload *payload = malloc(sizeof(RPCPayload));
+    if (!payload) return NULL;
+
+    payload->hex = hex;
+    payload->len = len;
+    payload->block = block;
+    payload->owner = NULL;
+    payload->refs = 1;
+    return payload;
+}
+
+RPCPayload *rpc_payload_wrap_evbuffer(struct evbuffer *owner, const char *hex, size_t len)
+{
+    RPCPayload *payload = rpc_payload_wrap(NULL, hex, len);
+    if (payload) {
+        payload->owner = owner;
+    }
+    return payload;
+}
+
+RPCPayload *rpc_payload_ref(RPCPayload *payload)
+{
+    payload->refs++;
+    return payload;
+}
+
+void rpc_payload_unref(RPCPayload *payload)
+{
+    if (!payload || --payload->refs > 0) return;
+    if (payload->owner) {
+        evbuffer_free(payload->owner);
+    }
+    free(payload->block);
+    free(payload);
+}
+
+/* evbuffer_add_reference() cleanup: the chain no longer needs the hex */
+static void rpc_payload_chain_cleanup(const void *data, size_t len, void *extra)
+{
+    (void)data;
+    (void)len;
+    rpc_payload_unref(extra);
+}
+
 /*
- * Extract result or error from JSON-RPC response.
- * Very simple JSON parsing - just finds "result" or "error" fields.
+ * JSON-RPC body as an evbuffer (health probes and other small calls).
  */
-static int parse_jsonrpc_response(const char *response, char *result,
-                                  size_t result_sz, int *is_error)
-{
-    *is_error = 0;
-
-    /* Check for error first */
-    const char *error_pos = strstr(response, "\"error\":");
-    if (error_pos) {
-        /* Check if error is null */
-        const char *val_start = error_pos + 8;
-        while (*val_start == ' ' || *val_start == '\t') val_start++;
-
-        if (strncmp(val_start, "null", 4) != 0) {
-            /* Has error - extract message */
-            const char *msg_pos = strstr(val_start, "\"message\":");
-            if (msg_pos) {
-                msg_pos += 10;
-                while (*msg_pos == ' ' || *msg_pos == '"') msg_pos++;
-                const char *msg_end = strchr(msg_pos, '"');
-                if (msg_end) {
-                    size_t len = msg_end - msg_pos;
-                    if (len >= result_sz) len = result_sz - 1;
-                    strncpy(result, msg_pos, len);
-                    result[len] = '\0';
-                    *is_error = 1;
-                    return RPC_ERR_NODE;
-                }
-            }
-            /* Fallback - copy entire error object */
-            strncpy(result, val_start, result_sz - 1);
-            result[result_sz - 1] = '\0';
-            *is_error = 1;
-            return RPC_ERR_NODE;
-        }
-    }
+static struct evbuffer *build_jsonrpc_body(const char *method, const char *params)
+{
+    struct evbuffer *body = evbuffer_new();
+    if (!body) return NULL;
 
-    /* Extract result */
-    const char *result_pos = strstr(response, "\"result\":");
-    if (!result_pos) {
-        strncpy(result, "No result in response", result_sz - 1);
-        return RPC_ERR_PARSE;
+    if (evbuffer_add_printf(body,
+            "{\"jsonrpc\":\"1.0\",\"id\":%lu,\"method\":\"%s\",\"params\":%s}",
+            (unsigned long)(++jsonrpc_request_id), method, params) < 0) {
+        evbuffer_free(body);
+        return NULL;
     }
+    return body;
+}
 
-    result_pos += 9;
-    while (*result_pos == ' ' || *result_pos == '\t') result_pos++;
+static int rpc_body_add_hex(struct evbuffer *body, RPCPayload *hex,
+                            const void *data, size_t len)
+{
+    rpc_payload_ref(hex);
+    if (evbuffer_add_reference(body, data, len, rpc_payload_chain_cleanup, hex) < 0) {
+        rpc_payload_unref(hex);
+        return -1;
+    }
+    return 0;
+}
 
-    /* Handle string result (txid, etc.) */
-    if (*result_pos == '"') {
-        result_pos++;
-        const char *end = strchr(result_pos, '"');
-        if (end) {
-            size_t len = end - result_pos;
-            if (len >= result_sz) len = result_sz - 1;
-            strncpy(result, result_pos, len);
-            result[len] = '\0';
-            return RPC_OK;
-        }
+/*
+ * sendrawtransaction body: head and tail are small copies, the hex is
+ * referenced in place. The chain holds a payload reference until the
+ * body (and any output buffer referencing it) is freed.
+ */
+struct evbuffer *rpc_build_sendraw_body(RPCPayload *hex)
+{
+    static const char tail[] = "\"]}";
+    struct evbuffer *body = evbuffer_new();
+    if (!body) return NULL;
+
+    if (evbuffer_add_printf(body,
+            "{\"jsonrpc\":\"1.0\",\"id\":%lu,\"method\":\"sendrawtransaction\",\"params\":[\"",
+            (unsigned long)(++jsonrpc_request_id)) < 0) {
+        evbuffer_free(body);
+        return NULL;
     }
 
-    /* Handle object/array result */
-    if (*result_pos == '{' || *result_pos == '[') {
-        /* Find matching brace/bracket */
-        int depth = 1;
-        char open = *result_pos;
-        char close_char = (open == '{') ? '}' : ']';
-        const char *p = result_pos + 1;
-        int in_string = 0;
-
-        while (*p && depth > 0) {
-            if (*p == '"' && *(p-1) != '\\') {
-                in_string = !in_string;
-            } else if (!in_string) {
-                if (*p == open) depth++;
-                else if (*p == close_char) depth--;
+    if (hex->hex) {
+        if (rpc_body_add_hex(body, hex, hex->hex, hex->len) < 0) {
+            evbuffer_free(body);
+            return NULL;
+        }
+    } else {
+        /* Segment by segment: evbuffer_add_buffer_reference() would make
+         * multicast chains, which the HTTP write cannot reference again */
+        struct evbuffer_ptr pos;
+        struct evbuffer_iovec vec;
+        evbuffer_ptr_set(hex->owner, &pos, 0, EVBUFFER_PTR_SET);
+        while (evbuffer_peek(hex->owner, -1, &pos, &vec, 1) > 0) {
+            if (rpc_body_add_hex(body, hex, vec.iov_base, vec.iov_len) < 0 ||
+                evbuffer_ptr_set(hex->owner, &pos, vec.iov_len, EVBUFFER_PTR_ADD) < 0) {
+                evbuffer_free(body);
+                return NULL;
             }
-            p++;
         }
-
-        size_t len = p - result_pos;
-        if (len >= result_sz) len = result_sz - 1;
-        strncpy(result, result_pos, len);
-        result[len] = '\0';
-        return RPC_OK;
     }
 
-    /* Handle null */
-    if (strncmp(result_pos, "null", 4) == 0) {
-        strncpy(result, "null", result_sz - 1);
-        return RPC_OK;
+    /* Not evbuffer_add(): a new chain after a reference chain is sized
+     * from it, i.e. twice the hex for three bytes */
+    if (evbuffer_add_reference(body, tail, sizeof(tail) - 1, NULL, NULL) < 0) {
+        evbuffer_free(body);
+        return NULL;
     }
-
-    /* Handle number/boolean */
-    const char *end = result_pos;
-    while (*end && *end != ',' && *end != '}') end++;
-    size_t len = end - result_pos;
-    if (len >= result_sz) len = result_sz - 1;
-    strncpy(result, result_pos, len);
-    result[len] = '\0';
-
-    return RPC_OK;
+    return body;
 }
 
 /* ========== High-level RPC Methods ========== */
@@ -518,12 +521,12 @@ static int rpc_call(RPCClient *client, const char *method, const char *params,
         return RPC_ERR_MEMORY;
     }
 
-    int http_status, rpc_error;
-    char *response = rpc_http_request(client, request, strlen(request),
-                                      &http_status, &rpc_error);
+    RPCResponse resp;
+    rpc_response_init(&resp, result, result_sz);
+    int rpc_error = rpc_http_request(client, request, strlen(request), &resp);
     free(request);
 
-    if (!response) {
+    if (rpc_error != RPC_OK) {
         client->error_count++;
 
         /* Try refreshing cookie on auth failure */
@@ -533,14 +536,14 @@ static int rpc_call(RPCClient *client, const char *method, const char *params,
                 /* Retry with new cookie */
                 request = build_jsonrpc_request(method, params);
                 if (request) {
-                    response = rpc_http_request(client, request, strlen(request),
-                                              &http_status, &rpc_error);
+                    rpc_response_init(&resp, result, result_sz);
+                    rpc_error = rpc_http_request(client, request, strlen(request), &resp);
                     free(request);
                 }
             }
         }
 
-        if (!response) {
+        if (rpc_error != RPC_OK) {
             switch (rpc_error) {
                 case RPC_ERR_CONNECT:
                     strncpy(result, "Failed to connect to node", result_sz - 1);
@@ -551,22 +554,33 @@ static int rpc_call(RPCClient *client, const char *method, const char *params,
                 case RPC_ERR_TIMEOUT:
                     strncpy(result, "Request timed out", result_sz - 1);
                     break;
+                case RPC_ERR_PARSE:
+                    strncpy(result, "Malformed HTTP response", result_sz - 1);
+                    break;
                 default:
                     strncpy(result, "RPC request failed", result_sz - 1);
             }
+            result[result_sz - 1] = '\0';
             client->available = 0;
             return rpc_error;
         }
     }
 
-    int is_error;
-    int ret = parse_jsonrpc_response(response, result, result_sz, &is_error);
-    free(response);
+    /* The result was scanned straight into result; errors come back here */
+    const char *text;
+    size_t text_len;
+    int ret = rpc_json_outcome(&resp.json, &text, &text_len);
+    if (text != result) {
+        if (text_len >= result_sz) text_len = result_sz - 1;
+        memmove(result, text, text_len);
+        result[text_len] = '\0';
+    }
 
-    if (is_error) {
+    if (ret == RPC_ERR_NODE) {
         client->error_count++;
-        log_debug("RPC %s error: %s", method, result);
-    } else {
+        rpc_count_node_error(client, &resp.json);
+        log_debug("RPC %s error %ld: %s", method, resp.json.error_code, result);
+    } else if (ret == RPC_OK) {
         client->available = 1;
     }
 
@@ -773,17 +787,19 @@ void rpc_manager_log_status(RPCManager *mgr)
 /* Default async timeout in seconds */
 #define RPC_ASYNC_TIMEOUT_SEC 30
 
-/* Initial response buffer size */
-#define RPC_ASYNC_INITIAL_BUF 4096
-
 /* Forward declarations for async callbacks */
-static void rpc_async_read_cb(struct bufferevent *bev, void *ctx);
-static void rpc_async_event_cb(struct bufferevent *bev, short events, void *ctx);
+static void rpc_pool_read_cb(struct bufferevent *bev, void *ctx);
+static void rpc_pool_event_cb(struct bufferevent *bev, short events, void *ctx);
+static void rpc_pool_timer_cb(evutil_socket_t fd, short events, void *ctx);
 static void rpc_async_timeout_cb(evutil_socket_t fd, short events, void *ctx);
 static void rpc_async_process_response(RPCRequest *req);
 static void rpc_request_complete(RPCRequest *req, int status,
                                   const char *result, size_t result_len);
-static int rpc_async_connect(RPCRequest *req);
+static void rpc_pool_service_waiters(RPCClient *client);
+static void rpc_batch_unlink(RPCRequest *req);
+static void rpc_batch_complete_members(RPCRequest *batch, int status,
+                                       const char *result, size_t result_len);
+static void rpc_batch_timer_cb(evutil_socket_t fd, short events, void *ctx);
 
 /*
  * Pre-resolve hostname for a client into resolved_addr.
@@ -856,6 +872,14 @@ int rpc_manager_init_async(RPCManager *mgr,
         }
     }
 
+    /* Warm the connection pools now, then reap/health-check periodically */
+    rpc_pool_timer_cb(-1, 0, mgr);
+    mgr->pool_timer = event_new(base, -1, EV_PERSIST, rpc_pool_timer_cb, mgr);
+    if (mgr->pool_timer) {
+        struct timeval tv = { .tv_sec = RPC_POOL_MAINTENANCE_SEC, .tv_usec = 0 };
+        evtimer_add(mgr->pool_timer, &tv);
+    }
+
     log_info("RPC: Async manager initialized (event_base=%p)", (void *)base);
     return ret;
 }
@@ -890,325 +914,1059 @@ static void rpc_request_list_remove(RPCManager *mgr, RPCRequest *req)
     req->prev = NULL;
 }
 
+/* ========== Connection Pool ========== */
+
 /*
- * Free all resources associated with an RPCRequest.
+ * Append request to the pool's wait queue.
  */
-static void rpc_request_free(RPCRequest *req)
+static void rpc_pool_wait_push(RPCPool *pool, RPCRequest *req)
 {
-    if (req->bev) {
-        bufferevent_free(req->bev);
-        req->bev = NULL;
-    }
-    if (req->timeout_ev) {
-        event_free(req->timeout_ev);
-        req->timeout_ev = NULL;
+    req->wait_next = NULL;
+    req->queued = 1;
+    if (pool->wait_tail) {
+        pool->wait_tail->wait_next = req;
+    } else {
+        pool->wait_head = req;
     }
-    free(req->request_body);
-    free(req->response_buf);
-    free(req);
+    pool->wait_tail = req;
+    pool->waiting++;
 }
 
 /*
- * Complete an async request: fire callback, remove from list, free.
+ * Pop the oldest waiting request, or NULL if none.
  */
-static void rpc_request_complete(RPCRequest *req, int status,
-                                  const char *result, size_t result_len)
+static RPCRequest *rpc_pool_wait_pop(RPCPool *pool)
 {
-    /* Remove from active list */
-    if (req->mgr) {
-        rpc_request_list_remove(req->mgr, req);
-    }
+    RPCRequest *req = pool->wait_head;
+    if (!req) return NULL;
 
-    /* Fire callback if still set (cancelled requests have NULL callback) */
-    if (req->callback) {
-        req->callback(status, result, result_len, req->callback_data);
+    pool->wait_head = req->wait_next;
+    if (!pool->wait_head) {
+        pool->wait_tail = NULL;
     }
-
-    rpc_request_free(req);
+    req->wait_next = NULL;
+    req->queued = 0;
+    pool->waiting--;
+    return req;
 }
 
 /*
- * Build HTTP request bytes for an async RPC call.
- * Returns a malloc'd string (caller takes ownership).
+ * Remove a specific request from the wait queue (timeout/cancel).
  */
-static char *rpc_build_http_request(RPCClient *client, const char *body,
-                                     size_t body_len, size_t *out_len)
+static void rpc_pool_wait_remove(RPCPool *pool, RPCRequest *req)
 {
-    const char *path = client->wallet[0] ? "/wallet/" : "/";
-    char header[2048];
-
-    int header_len = snprintf(header, sizeof(header),
-        "POST %s%s HTTP/1.1\r\n"
-        "Host: %s:%d\r\n"
-        "Authorization: %s\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: %zu\r\n"
-        "Connection: close\r\n"
-        "\r\n",
-        path, client->wallet,
-        client->host, client->port,
-        client->auth_header,
-        body_len);
+    RPCRequest *prev = NULL;
+    RPCRequest *cur = pool->wait_head;
 
-    size_t total_len = (size_t)header_len + body_len;
-    char *buf = malloc(total_len);
-    if (!buf) return NULL;
+    while (cur && cur != req) {
+        prev = cur;
+        cur = cur->wait_next;
+    }
+    if (!cur) return;
 
-    memcpy(buf, header, header_len);
-    memcpy(buf + header_len, body, body_len);
-    *out_len = total_len;
-    return buf;
+    if (prev) {
+        prev->wait_next = req->wait_next;
+    } else {
+        pool->wait_head = req->wait_next;
+    }
+    if (pool->wait_tail == req) {
+        pool->wait_tail = prev;
+    }
+    req->wait_next = NULL;
+    req->queued = 0;
+    pool->waiting--;
 }
 
 /*
- * Initiate async connection to RPC server.
+ * Open a new pooled connection. The connect completes asynchronously;
+ * an attached request is sent from the CONNECTED event.
  */
-static int rpc_async_connect(RPCRequest *req)
+static RPCPoolConn *rpc_pool_conn_open(RPCClient *client, struct event_base *base)
 {
-    RPCClient *client = req->client;
+    RPCPool *pool = &client->pool;
 
     if (client->resolved_addr_len == 0) {
         log_error("RPC async: No resolved address for %s:%d",
                   client->host, client->port);
-        return -1;
+        return NULL;
     }
 
-    /* Create bufferevent */
-    req->bev = bufferevent_socket_new(req->base, -1, BEV_OPT_CLOSE_ON_FREE);
-    if (!req->bev) {
+    RPCPoolConn *pc = calloc(1, sizeof(RPCPoolConn));
+    if (!pc) return NULL;
+
+    pc->client = client;
+    pc->base = base;
+    pc->bev = bufferevent_socket_new(base, -1, BEV_OPT_CLOSE_ON_FREE);
+    if (!pc->bev) {
         log_error("RPC async: Failed to create bufferevent");
-        return -1;
+        free(pc);
+        return NULL;
     }
 
-    /* Set callbacks */
-    bufferevent_setcb(req->bev, rpc_async_read_cb, NULL,
-                      rpc_async_event_cb, req);
+    bufferevent_setcb(pc->bev, rpc_pool_read_cb, NULL, rpc_pool_event_cb, pc);
 
-    /* Set per-operation timeouts on the bufferevent */
+    /* Bound the connect itself; idle connections clear this later */
     struct timeval tv = { .tv_sec = client->timeout_sec, .tv_usec = 0 };
-    bufferevent_set_timeouts(req->bev, &tv, &tv);
-
-    /* Start overall timeout timer */
-    req->timeout_ev = evtimer_new(req->base, rpc_async_timeout_cb, req);
-    if (req->timeout_ev) {
-        struct timeval overall_tv = { .tv_sec = client->timeout_sec, .tv_usec = 0 };
-        evtimer_add(req->timeout_ev, &overall_tv);
-    }
+    bufferevent_set_timeouts(pc->bev, &tv, &tv);
 
-    /* Initiate async connect */
-    if (bufferevent_socket_connect(req->bev,
+    if (bufferevent_socket_connect(pc->bev,
             (struct sockaddr *)&client->resolved_addr,
             client->resolved_addr_len) < 0) {
         log_error("RPC async: bufferevent_socket_connect failed");
-        bufferevent_free(req->bev);
-        req->bev = NULL;
-        if (req->timeout_ev) {
-            event_free(req->timeout_ev);
-            req->timeout_ev = NULL;
-        }
-        return -1;
+        bufferevent_free(pc->bev);
+        free(pc);
+        return NULL;
     }
 
-    return 0;
+    pc->last_used = time(NULL);
+
+    pc->prev = NULL;
+    pc->next = pool->conns;
+    if (pool->conns) {
+        pool->conns->prev = pc;
+    }
+    pool->conns = pc;
+    pool->total++;
+
+    return pc;
 }
 
 /*
- * Event callback: connected, EOF, error, timeout.
+ * Close a pooled connection. Any attached request loses its connection
+ * (the caller decides whether to retry or complete it).
  */
-static void rpc_async_event_cb(struct bufferevent *bev, short events, void *ctx)
+static void rpc_pool_conn_close(RPCPoolConn *pc)
 {
-    RPCRequest *req = ctx;
-    (void)bev;
-
-    if (events & BEV_EVENT_CONNECTED) {
-        /* Connection established — send the HTTP request */
-        size_t http_len;
-        char *http_req = rpc_build_http_request(req->client,
-                                                 req->request_body,
-                                                 req->request_body_len,
-                                                 &http_len);
-        if (!http_req) {
-            rpc_request_complete(req, RPC_ERR_MEMORY, "Memory allocation failed", 24);
-            return;
-        }
+    RPCPool *pool = &pc->client->pool;
 
-        bufferevent_write(req->bev, http_req, http_len);
-        free(http_req);
-
-        /* Enable reading for the response */
-        bufferevent_enable(req->bev, EV_READ);
-        return;
+    if (pc->req) {
+        pc->req->conn = NULL;
+        pc->req = NULL;
+        pool->busy--;
     }
 
-    if (events & BEV_EVENT_EOF) {
-        /* Server closed connection — response is complete */
-        rpc_async_process_response(req);
-        return;
+    if (pc->prev) {
+        pc->prev->next = pc->next;
+    } else {
+        pool->conns = pc->next;
     }
-
-    if (events & BEV_EVENT_TIMEOUT) {
-        log_debug("RPC async: timeout for %s:%d",
-                  req->client->host, req->client->port);
-        rpc_request_complete(req, RPC_ERR_TIMEOUT, "Request timed out", 17);
-        return;
+    if (pc->next) {
+        pc->next->prev = pc->prev;
     }
+    pool->total--;
 
-    if (events & BEV_EVENT_ERROR) {
-        int err = EVUTIL_SOCKET_ERROR();
-        log_debug("RPC async: connection error for %s:%d: %s",
-                  req->client->host, req->client->port,
-                  evutil_socket_error_to_string(err));
-        rpc_request_complete(req, RPC_ERR_CONNECT,
-                              "Failed to connect to node", 25);
-        return;
-    }
+    bufferevent_free(pc->bev);
+    free(pc);
 }
 
 /*
- * Read callback: accumulate response data.
+ * Find a connection with no request in flight.
+ * Prefers established connections over ones still connecting.
  */
-static void rpc_async_read_cb(struct bufferevent *bev, void *ctx)
+static RPCPoolConn *rpc_pool_find_idle(RPCPool *pool)
 {
-    RPCRequest *req = ctx;
-    struct evbuffer *input = bufferevent_get_input(bev);
-    size_t avail = evbuffer_get_length(input);
-
-    if (avail == 0) return;
+    RPCPoolConn *connecting = NULL;
 
-    /* Grow buffer if needed */
-    size_t needed = req->response_len + avail + 1;
-    if (needed > RPC_MAX_RESPONSE_LEN) {
-        log_warn("RPC async: response exceeds %d bytes, truncating",
-                 RPC_MAX_RESPONSE_LEN);
-        avail = RPC_MAX_RESPONSE_LEN - req->response_len - 1;
-        if (avail == 0) return;
+    for (RPCPoolConn *pc = pool->conns; pc; pc = pc->next) {
+        if (pc->req) continue;
+        if (pc->connected) return pc;
+        if (!connecting) connecting = pc;
     }
+    return connecting;
+}
 
-    if (needed > req->response_cap) {
-        size_t new_cap = req->response_cap ? req->response_cap * 2 : RPC_ASYNC_INITIAL_BUF;
-        while (new_cap < needed) new_cap *= 2;
-        if (new_cap > RPC_MAX_RESPONSE_LEN) new_cap = RPC_MAX_RESPONSE_LEN;
+/*
+ * Write the HTTP request for the attached request onto the connection.
+ */
+int rpc_write_http_request(struct evbuffer *output, const RPCClient *client,
+                           struct evbuffer *body)
+{
+    static const char format[] =
+        "POST %s%s HTTP/1.1\r\n"
+        "Host: %s:%d\r\n"
+        "Authorization: %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+    const char *path = client->wallet[0] ? "/wallet/" : "/";
+    size_t body_len = evbuffer_get_length(body);
+    struct evbuffer_iovec vec;
 
-        char *new_buf = realloc(req->response_buf, new_cap);
-        if (!new_buf) {
-            rpc_request_complete(req, RPC_ERR_MEMORY,
-                                  "Memory allocation failed", 24);
-            return;
+    /* Headers are bounded by the host/auth/wallet limits: one segment */
+    if (evbuffer_reserve_space(output, RPC_HEADER_RESERVE, &vec, 1) < 1) {
+        return -1;
+    }
+    int n = snprintf(vec.iov_base, vec.iov_len, format,
+                     path, client->wallet, client->host, client->port,
+                     client->auth_header, body_len);
+    if (n < 0 || (size_t)n >= vec.iov_len) {
+        if (evbuffer_add_printf(output, format,
+                                path, client->wallet, client->host, client->port,
+                                client->auth_header, body_len) < 0) {
+            return -1;
+        }
+    } else {
+        vec.iov_len = (size_t)n;
+        if (evbuffer_commit_space(output, &vec, 1) < 0) {
+            return -1;
         }
-        req->response_buf = new_buf;
-        req->response_cap = new_cap;
     }
 
-    /* Drain data from evbuffer into our response buffer */
-    evbuffer_remove(input, req->response_buf + req->response_len, avail);
-    req->response_len += avail;
-    req->response_buf[req->response_len] = '\0';
+    /* Shares body's chains: the hex is never copied into output */
+    return evbuffer_add_buffer_reference(output, body);
+}
+
+static void rpc_pool_conn_send(RPCPoolConn *pc)
+{
+    RPCRequest *req = pc->req;
+    RPCClient *client = pc->client;
+    struct evbuffer *output = bufferevent_get_output(pc->bev);
+
+    if (rpc_write_http_request(output, client, req->request_body) < 0) {
+        /* Nothing usable was queued; the request's timeout reports it */
+        log_error("RPC: failed to queue request to %s:%d", client->host, client->port);
+        return;
+    }
+
+    /* Enable reading for the response */
+    bufferevent_enable(pc->bev, EV_READ);
 }
 
 /*
- * Overall timeout callback.
+ * Bind a request to a connection and send it once connected.
  */
-static void rpc_async_timeout_cb(evutil_socket_t fd, short events, void *ctx)
+static void rpc_pool_attach(RPCPoolConn *pc, RPCRequest *req)
 {
-    RPCRequest *req = ctx;
-    (void)fd;
-    (void)events;
+    RPCClient *client = pc->client;
 
-    log_debug("RPC async: overall timeout for %s:%d",
-              req->client->host, req->client->port);
-    rpc_request_complete(req, RPC_ERR_TIMEOUT, "Request timed out", 17);
+    pc->req = req;
+    req->conn = pc;
+    client->pool.busy++;
+
+    /* Per-operation timeouts apply only while a request is in flight */
+    struct timeval tv = { .tv_sec = client->timeout_sec, .tv_usec = 0 };
+    bufferevent_set_timeouts(pc->bev, &tv, &tv);
+
+    if (pc->connected) {
+        rpc_pool_conn_send(pc);
+    }
 }
 
 /*
- * Process a complete HTTP response from the RPC server.
- * Handles HTTP status parsing, auth retry, and JSON-RPC result extraction.
+ * Detach a request from its connection. A connection whose response was
+ * fully consumed (Content-Length framed, no "Connection: close") goes back
+ * to the pool; anything else is closed. Waiters are serviced either way.
  */
-static void rpc_async_process_response(RPCRequest *req)
+static void rpc_pool_release(RPCRequest *req)
 {
-    if (!req->response_buf || req->response_len == 0) {
-        rpc_request_complete(req, RPC_ERR_CONNECT,
-                              "Empty response from node", 24);
-        return;
+    RPCPoolConn *pc = req->conn;
+    if (!pc) return;
+
+    RPCClient *client = pc->client;
+    struct evbuffer *input = bufferevent_get_input(pc->bev);
+
+    int reusable = pc->connected &&
+                   !req->response.server_close &&
+                   rpc_response_done(&req->response) &&
+                   evbuffer_get_length(input) == 0;
+
+    pc->req = NULL;
+    req->conn = NULL;
+    client->pool.busy--;
+
+    if (reusable) {
+        pc->reused = 1;
+        pc->last_used = time(NULL);
+        /* No timeouts while idle; keep reading to notice a server close */
+        bufferevent_set_timeouts(pc->bev, NULL, NULL);
+        bufferevent_enable(pc->bev, EV_READ);
+    } else {
+        rpc_pool_conn_close(pc);
     }
 
-    /* Parse HTTP status line */
-    int http_status = 0;
-    if (strncmp(req->response_buf, "HTTP/", 5) == 0) {
-        char *status_start = strchr(req->response_buf, ' ');
-        if (status_start) {
-            http_status = atoi(status_start + 1);
+    rpc_pool_service_waiters(client);
+}
+
+/*
+ * Hand idle (or newly opened) connections to queued requests.
+ */
+static void rpc_pool_service_waiters(RPCClient *client)
+{
+    RPCPool *pool = &client->pool;
+
+    while (pool->wait_head) {
+        RPCPoolConn *pc = rpc_pool_find_idle(pool);
+        if (!pc) {
+            if (pool->total >= pool->max_size) return;
+            pc = rpc_pool_conn_open(client, pool->wait_head->base);
+            if (!pc) {
+                RPCRequest *req = rpc_pool_wait_pop(pool);
+                rpc_request_complete(req, RPC_ERR_CONNECT,
+                                      "Failed to connect to node", 25);
+                continue;
+            }
         }
+        rpc_pool_attach(pc, rpc_pool_wait_pop(pool));
     }
+}
 
-    /* Handle auth failure with cookie retry */
-    if ((http_status == 401 || http_status == 403) && !req->auth_retried) {
-        if (req->client->cookie_path[0]) {
-            log_info("RPC async: auth failed, refreshing cookie...");
-            req->auth_retried = 1;
-
-            if (rpc_refresh_cookie(req->client) == 0) {
-                /* Reset response state and reconnect */
-                free(req->response_buf);
-                req->response_buf = NULL;
-                req->response_len = 0;
-                req->response_cap = 0;
-
-                if (req->bev) {
-                    bufferevent_free(req->bev);
-                    req->bev = NULL;
-                }
-                if (req->timeout_ev) {
-                    event_free(req->timeout_ev);
-                    req->timeout_ev = NULL;
-                }
+/*
+ * Route a request to a pooled connection: reuse an idle one (hit),
+ * open a new one while below max_size (miss), or queue (wait).
+ * Returns 0 on success, -1 if a needed connection could not be opened.
+ */
+static int rpc_pool_dispatch(RPCRequest *req)
+{
+    RPCClient *client = req->client;
+    RPCPool *pool = &client->pool;
 
-                if (rpc_async_connect(req) == 0) {
-                    return;  /* Retry in progress */
-                }
-            }
-        }
-        req->client->error_count++;
-        rpc_request_complete(req, RPC_ERR_AUTH,
-                              "Authentication failed", 21);
-        return;
+    RPCPoolConn *pc = rpc_pool_find_idle(pool);
+    if (pc) {
+        pool->hits++;
+        rpc_pool_attach(pc, req);
+        return 0;
     }
 
-    if (http_status == 401 || http_status == 403) {
-        req->client->error_count++;
-        rpc_request_complete(req, RPC_ERR_AUTH,
-                              "Authentication failed", 21);
-        return;
+    if (pool->total < pool->max_size) {
+        pc = rpc_pool_conn_open(client, req->base);
+        if (!pc) return -1;
+        pool->misses++;
+        rpc_pool_attach(pc, req);
+        return 0;
     }
 
-    /* Find body after \r\n\r\n */
-    char *body_start = strstr(req->response_buf, "\r\n\r\n");
-    if (!body_start) {
-        rpc_request_complete(req, RPC_ERR_PARSE,
+    pool->waits++;
+    rpc_pool_wait_push(pool, req);
+    return 0;
+}
+
+/*
+ * Free all resources associated with an RPCRequest.
+ */
+static void rpc_request_free(RPCRequest *req)
+{
+    if (req->queued) {
+        rpc_pool_wait_remove(&req->client->pool, req);
+    }
+    rpc_batch_unlink(req);
+    if (req->is_batch) {
+        /* Members still waiting on this batch are completed or cancelled on their own */
+        for (int i = 0; i < req->member_count; i++) {
+            if (req->members[i]) {
+                req->members[i]->batch = NULL;
+            }
+        }
+        free(req->members);
+    }
+    if (req->conn) {
+        /* Response still in flight: the connection can't be reused */
+        rpc_pool_conn_close(req->conn);
+    }
+    if (req->timeout_ev) {
+        event_free(req->timeout_ev);
+        req->timeout_ev = NULL;
+    }
+    if (req->request_body) {
+        evbuffer_free(req->request_body);
+    }
+    free(req);
+}
+
+/*
+ * Complete an async request: fire callback, remove from list, free.
+ */
+static void rpc_request_complete(RPCRequest *req, int status,
+                                  const char *result, size_t result_len)
+{
+    /* Remove from active list */
+    if (req->mgr) {
+        rpc_request_list_remove(req->mgr, req);
+    }
+
+    /* Give the connection back before waiters are serviced */
+    if (req->queued) {
+        rpc_pool_wait_remove(&req->client->pool, req);
+    }
+    rpc_batch_unlink(req);
+    rpc_pool_release(req);
+
+    /* Broadcast outcome stats (health probes and batches are not broadcasts) */
+    if (req->mgr && !req->is_probe && !req->is_batch) {
+        if (status == RPC_OK) {
+            req->mgr->successful_broadcasts++;
+        } else {
+            req->mgr->failed_broadcasts++;
+        }
+    }
+
+    /* A batch completes every broadcast it carried */
+    if (req->is_batch) {
+        rpc_batch_complete_members(req, status, result, result_len);
+    }
+
+    /* Fire callback if still set (cancelled requests have NULL callback) */
+    if (req->callback) {
+        req->callback(status, result, result_len, req->callback_data);
+    }
+
+    rpc_request_free(req);
+}
+
+/*
+ * Allocate a request, start its overall timeout and add it to the
+ * active list. Takes ownership of body.
+ */
+static RPCRequest *rpc_request_new(RPCManager *mgr, RPCClient *client,
+                                    struct evbuffer *body, RPCResultCallback callback,
+                                    void *user_data)
+{
+    RPCRequest *req = calloc(1, sizeof(RPCRequest));
+    if (!req) {
+        evbuffer_free(body);
+        return NULL;
+    }
+
+    req->client = client;
+    req->mgr = mgr;
+    req->base = mgr->base;
+    req->request_body = body;
+    req->id = jsonrpc_request_id;       /* Taken by the body built just before */
+    rpc_response_init(&req->response, req->result, sizeof(req->result));
+    req->callback = callback;
+    req->callback_data = user_data;
+
+    /* Overall timeout also covers time spent waiting for a connection */
+    req->timeout_ev = evtimer_new(req->base, rpc_async_timeout_cb, req);
+    if (req->timeout_ev) {
+        struct timeval overall_tv = { .tv_sec = client->timeout_sec, .tv_usec = 0 };
+        evtimer_add(req->timeout_ev, &overall_tv);
+    }
+
+    rpc_request_list_add(mgr, req);
+    return req;
+}
+
+static void rpc_batch_reply_cb(void *ctx, const RPCJsonScanner *json);
+
+/*
+ * Reset response state before a request is (re-)sent.
+ */
+static void rpc_request_reset_response(RPCRequest *req)
+{
+    rpc_response_init(&req->response, req->result, sizeof(req->result));
+    if (req->is_batch) {
+        rpc_json_expect_batch(&req->response.json, rpc_batch_reply_cb, req);
+    }
+}
+
+/*
+ * Event callback: connected, EOF, error, timeout.
+ */
+static void rpc_pool_event_cb(struct bufferevent *bev, short events, void *ctx)
+{
+    RPCPoolConn *pc = ctx;
+    RPCRequest *req = pc->req;
+    RPCClient *client = pc->client;
+    (void)bev;
+
+    if (events & BEV_EVENT_CONNECTED) {
+        pc->connected = 1;
+        pc->last_used = time(NULL);
+        if (req) {
+            /* Connection established — send the HTTP request */
+            rpc_pool_conn_send(pc);
+        } else {
+            /* Warm connection: idle until a request needs it */
+            bufferevent_set_timeouts(pc->bev, NULL, NULL);
+            bufferevent_enable(pc->bev, EV_READ);
+            rpc_pool_service_waiters(client);
+        }
+        return;
+    }
+
+    if (!req) {
+        /* Idle connection closed (node's rpcservertimeout) or failed */
+        log_debug("RPC pool: idle connection to %s:%d closed",
+                  client->host, client->port);
+        rpc_pool_conn_close(pc);
+        rpc_pool_service_waiters(client);
+        return;
+    }
+
+    /*
+     * A reused connection that dies before any response byte was most
+     * likely closed by the node while idle. Retry once on a fresh one.
+     */
+    if ((events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) && pc->reused &&
+        req->response.bytes == 0 && !req->stale_retried) {
+        req->stale_retried = 1;
+        rpc_pool_conn_close(pc);
+        pc = rpc_pool_conn_open(client, req->base);
+        if (pc) {
+            rpc_pool_attach(pc, req);
+            return;
+        }
+        rpc_request_complete(req, RPC_ERR_CONNECT,
+                              "Failed to connect to node", 25);
+        return;
+    }
+
+    /* The connection is finished either way */
+    req->response.server_close = 1;
+
+    if (events & BEV_EVENT_EOF) {
+        /* Server closed connection — unframed response is complete */
+        rpc_response_eof(&req->response);
+        rpc_async_process_response(req);
+        return;
+    }
+
+    if (events & BEV_EVENT_TIMEOUT) {
+        log_debug("RPC async: timeout for %s:%d",
+                  client->host, client->port);
+        rpc_request_complete(req, RPC_ERR_TIMEOUT, "Request timed out", 17);
+        return;
+    }
+
+    if (events & BEV_EVENT_ERROR) {
+        int err = EVUTIL_SOCKET_ERROR();
+        log_debug("RPC async: connection error for %s:%d: %s",
+                  client->host, client->port,
+                  evutil_socket_error_to_string(err));
+        rpc_request_complete(req, RPC_ERR_CONNECT,
+                              "Failed to connect to node", 25);
+        return;
+    }
+}
+
+/*
+ * Read callback: feed response bytes to the parser as they arrive.
+ */
+static void rpc_pool_read_cb(struct bufferevent *bev, void *ctx)
+{
+    RPCPoolConn *pc = ctx;
+    RPCRequest *req = pc->req;
+    struct evbuffer *input = bufferevent_get_input(bev);
+
+    if (!req) {
+        /* Unsolicited bytes on an idle connection: framing is lost */
+        RPCClient *client = pc->client;
+        rpc_pool_conn_close(pc);
+        rpc_pool_service_waiters(client);
+        return;
+    }
+
+    /* Parse each segment in place; stop at the end of the response */
+    while (!rpc_response_done(&req->response) && evbuffer_get_length(input) > 0) {
+        struct evbuffer_iovec vec;
+        if (evbuffer_peek(input, -1, NULL, &vec, 1) < 1) break;
+
+        ssize_t used = rpc_response_feed(&req->response, vec.iov_base, vec.iov_len);
+        if (used < 0) {
+            log_warn("RPC async: malformed HTTP response from %s:%d",
+                     req->client->host, req->client->port);
+            req->response.server_close = 1;
+            rpc_request_complete(req, RPC_ERR_PARSE, "Malformed HTTP response", 23);
+            return;
+        }
+        evbuffer_drain(input, (size_t)used);
+    }
+
+    if (rpc_response_done(&req->response)) {
+        rpc_async_process_response(req);
+    }
+}
+
+/*
+ * Overall timeout callback.
+ */
+static void rpc_async_timeout_cb(evutil_socket_t fd, short events, void *ctx)
+{
+    RPCRequest *req = ctx;
+    (void)fd;
+    (void)events;
+
+    log_debug("RPC async: overall timeout for %s:%d",
+              req->client->host, req->client->port);
+    req->response.server_close = 1;
+    rpc_request_complete(req, RPC_ERR_TIMEOUT, "Request timed out", 17);
+}
+
+/*
+ * Process a complete HTTP response from the RPC server.
+ * Handles HTTP status parsing, auth retry, and JSON-RPC result extraction.
+ */
+static void rpc_async_process_response(RPCRequest *req)
+{
+    RPCResponse *resp = &req->response;
+
+    if (resp->bytes == 0) {
+        rpc_request_complete(req, RPC_ERR_CONNECT,
+                              "Empty response from node", 24);
+        return;
+    }
+    if (!rpc_response_done(resp)) {
+        rpc_request_complete(req, RPC_ERR_PARSE,
                               "Malformed HTTP response", 23);
         return;
     }
-    body_start += 4;
 
-    /* Parse JSON-RPC response using existing logic */
-    char result[4096];
-    int is_error;
-    int ret = parse_jsonrpc_response(body_start, result, sizeof(result), &is_error);
+    int http_status = resp->status;
+
+    /* Handle auth failure with cookie retry */
+    if ((http_status == 401 || http_status == 403) && !req->auth_retried) {
+        if (req->client->cookie_path[0]) {
+            log_info("RPC async: auth failed, refreshing cookie...");
+            req->auth_retried = 1;
+
+            if (rpc_refresh_cookie(req->client) == 0) {
+                /* Return the connection, reset response state and resend */
+                rpc_pool_release(req);
+                rpc_request_reset_response(req);
+
+                if (rpc_pool_dispatch(req) == 0) {
+                    return;  /* Retry in progress */
+                }
+            }
+        }
+        req->client->error_count++;
+        rpc_request_complete(req, RPC_ERR_AUTH,
+                              "Authentication failed", 21);
+        return;
+    }
+
+    if (http_status == 401 || http_status == 403) {
+        req->client->error_count++;
+        rpc_request_complete(req, RPC_ERR_AUTH,
+                              "Authentication failed", 21);
+        return;
+    }
+
+    /* Batch replies were handed to their members as the array streamed past */
+    if (req->is_batch && resp->json.array) {
+        if (resp->json.invalid || !resp->json.complete) {
+            req->client->error_count++;
+            rpc_request_complete(req, RPC_ERR_PARSE,
+                                  "Malformed JSON-RPC response", 27);
+        } else {
+            rpc_request_complete(req, RPC_OK, NULL, 0);
+        }
+        return;
+    }
+
+    /* Result and error were extracted while the body streamed past */
+    const char *text;
+    size_t text_len;
+    int ret = rpc_json_outcome(&resp->json, &text, &text_len);
+    if (resp->json.result_truncated) {
+        log_debug("RPC async: result truncated to %zu bytes", text_len);
+    }
 
     req->client->request_count++;
 
-    if (is_error) {
+    if (ret == RPC_OK) {
+        req->client->available = 1;
+    } else {
         req->client->error_count++;
-        rpc_request_complete(req, ret, result, strlen(result));
+        if (ret == RPC_ERR_NODE) {
+            rpc_count_node_error(req->client, &resp->json);
+        }
+    }
+    rpc_request_complete(req, ret, text, text_len);
+}
+
+/*
+ * Health probe completion: a failed probe marks the node down.
+ */
+static void rpc_pool_probe_cb(int status, const char *result,
+                               size_t result_len, void *user_data)
+{
+    RPCClient *client = user_data;
+    (void)result_len;
+
+    if (status != RPC_OK) {
+        client->pool.health_failures++;
+        client->available = 0;
+        log_warn("RPC pool: %s health check failed: %s",
+                 network_chain_to_string(client->chain), result);
+    }
+}
+
+/*
+ * Send a cheap "uptime" call on an idle connection. Keeps it inside the
+ * node's rpcservertimeout and verifies the node still answers.
+ */
+static void rpc_pool_probe(RPCManager *mgr, RPCPoolConn *pc)
+{
+    struct evbuffer *body = build_jsonrpc_body("uptime", "[]");
+    if (!body) return;
+
+    RPCRequest *req = rpc_request_new(mgr, pc->client, body,
+                                      rpc_pool_probe_cb, pc->client);
+    if (!req) return;
+
+    req->is_probe = 1;
+    pc->client->pool.health_checks++;
+    rpc_pool_attach(pc, req);
+}
+
+/*
+ * Reap connections idle past idle_timeout (down to min_size), probe the
+ * ones kept, and open connections until min_size are available.
+ */
+static void rpc_pool_maintain(RPCManager *mgr, RPCClient *client)
+{
+    RPCPool *pool = &client->pool;
+    time_t now = time(NULL);
+
+    RPCPoolConn *pc = pool->conns;
+    while (pc) {
+        RPCPoolConn *next = pc->next;
+        if (!pc->req && pc->connected &&
+            now - pc->last_used >= pool->idle_timeout_sec) {
+            if (pool->total > pool->min_size) {
+                pool->reaped++;
+                rpc_pool_conn_close(pc);
+            } else {
+                rpc_pool_probe(mgr, pc);
+            }
+        }
+        pc = next;
+    }
+
+    while (pool->total < pool->min_size) {
+        if (!rpc_pool_conn_open(client, mgr->base)) break;
+    }
+}
+
+/*
+ * Periodic pool maintenance for every configured chain.
+ */
+static void rpc_pool_timer_cb(evutil_socket_t fd, short events, void *ctx)
+{
+    RPCManager *mgr = ctx;
+    RPCClient *clients[] = { &mgr->mainnet, &mgr->testnet,
+                             &mgr->signet, &mgr->regtest };
+    (void)fd;
+    (void)events;
+
+    for (int i = 0; i < 4; i++) {
+        if (clients[i]->host[0] && clients[i]->resolved_addr_len > 0) {
+            rpc_pool_maintain(mgr, clients[i]);
+        }
+    }
+}
+
+/* ========== Broadcast Coalescing ========== */
+
+/* Upper bounds of the batch size and coalescing delay histogram buckets */
+static const int rpc_batch_size_bounds[RPC_BATCH_SIZE_BUCKETS - 1] = {
+    1, 2, 4, 8, 16, 32, 64
+};
+static const double rpc_batch_delay_bounds[RPC_BATCH_DELAY_BUCKETS - 1] = {
+    0.0005, 0.001, 0.002, 0.005, 0.01, 0.05
+};
+
+void rpc_manager_set_batching(RPCManager *mgr, int window_ms, int max_size)
+{
+    RPCClient *clients[] = { &mgr->mainnet, &mgr->testnet,
+                             &mgr->signet, &mgr->regtest };
+
+    if (window_ms < 0) window_ms = 0;
+    if (window_ms > RPC_BATCH_MAX_WINDOW_MS) window_ms = RPC_BATCH_MAX_WINDOW_MS;
+    if (max_size > RPC_BATCH_MAX_SIZE) max_size = RPC_BATCH_MAX_SIZE;
+    if (max_size < 2) window_ms = 0;
+
+    for (int i = 0; i < 4; i++) {
+        RPCBatcher *batcher = &clients[i]->batcher;
+
+        batcher->window_ms = window_ms;
+        batcher->max_size = max_size;
+        if (window_ms == 0 || !mgr->base || !clients[i]->host[0] || batcher->timer) {
+            continue;
+        }
+        batcher->timer = evtimer_new(mgr->base, rpc_batch_timer_cb, clients[i]);
+        if (!batcher->timer) {
+            log_warn("RPC: cannot create batch timer for %s, sending broadcasts singly",
+                     network_chain_to_string(clients[i]->chain));
+        }
+    }
+
+    if (window_ms > 0) {
+        log_info("RPC: coalescing broadcasts for %d ms, up to %d per batch",
+                 window_ms, max_size);
+    }
+}
+
+/*
+ * Take a request out of the coalescing queue or the batch carrying it.
+ */
+static void rpc_batch_unlink(RPCRequest *req)
+{
+    if (req->batch_queued) {
+        RPCBatcher *batcher = &req->client->batcher;
+        RPCRequest **link = &batcher->head;
+        RPCRequest *prev = NULL;
+
+        while (*link && *link != req) {
+            prev = *link;
+            link = &(*link)->batch_next;
+        }
+        if (*link) {
+            *link = req->batch_next;
+            if (batcher->tail == req) {
+                batcher->tail = prev;
+            }
+            batcher->queued--;
+        }
+        req->batch_next = NULL;
+        req->batch_queued = 0;
+    }
+
+    if (req->batch) {
+        RPCRequest *batch = req->batch;
+        for (int i = 0; i < batch->member_count; i++) {
+            if (batch->members[i] == req) {
+                batch->members[i] = NULL;
+                break;
+            }
+        }
+        req->batch = NULL;
+    }
+}
+
+/*
+ * Queue a broadcast for the next batch. The window starts with the first
+ * one; a full batch is sent from the next loop iteration, so the caller
+ * still gets its request back.
+ */
+static void rpc_batch_add(RPCRequest *req)
+{
+    RPCBatcher *batcher = &req->client->batcher;
+
+    clock_gettime(CLOCK_MONOTONIC, &req->batch_enqueued);
+    req->batch_queued = 1;
+    req->batch_next = NULL;
+    if (batcher->tail) {
+        batcher->tail->batch_next = req;
     } else {
-        req->client->available = 1;
-        rpc_request_complete(req, RPC_OK, result, strlen(result));
+        batcher->head = req;
+    }
+    batcher->tail = req;
+    batcher->queued++;
+
+    if (batcher->queued >= batcher->max_size) {
+        event_active(batcher->timer, EV_TIMEOUT, 1);
+    } else if (batcher->queued == 1) {
+        struct timeval tv = {
+            .tv_sec = batcher->window_ms / 1000,
+            .tv_usec = (batcher->window_ms % 1000) * 1000
+        };
+        evtimer_add(batcher->timer, &tv);
     }
 }
 
-RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
-                                         const char *hex_tx,
-                                         RPCResultCallback callback,
-                                         void *user_data)
+/*
+ * Dequeue a broadcast for sending and record how long it waited.
+ */
+static RPCRequest *rpc_batch_pop(RPCBatcher *batcher, const struct timespec *now)
+{
+    RPCRequest *req = batcher->head;
+
+    batcher->head = req->batch_next;
+    if (!batcher->head) {
+        batcher->tail = NULL;
+    }
+    batcher->queued--;
+    req->batch_next = NULL;
+    req->batch_queued = 0;
+
+    double waited = (now->tv_sec - req->batch_enqueued.tv_sec) +
+                    (now->tv_nsec - req->batch_enqueued.tv_nsec) / 1e9;
+    int b = 0;
+    while (b < RPC_BATCH_DELAY_BUCKETS - 1 && waited > rpc_batch_delay_bounds[b]) {
+        b++;
+    }
+    batcher->delay_buckets[b]++;
+    batcher->delay_count++;
+    batcher->delay_sum_seconds += waited;
+    return req;
+}
+
+static void rpc_batch_count_size(RPCBatcher *batcher, int n)
+{
+    int b = 0;
+    while (b < RPC_BATCH_SIZE_BUCKETS - 1 && n > rpc_batch_size_bounds[b]) {
+        b++;
+    }
+    batcher->size_buckets[b]++;
+    batcher->size_sum += (uint64_t)n;
+    batcher->sent++;
+}
+
+/*
+ * Send n dequeued broadcasts as one JSON-RPC array. The member bodies
+ * are moved into it (chains relinked, the hex still by reference).
+ */
+static void rpc_batch_send(RPCClient *client, RPCRequest **members, int n)
+{
+    RPCManager *mgr = members[0]->mgr;
+    struct evbuffer *body = evbuffer_new();
+    int ok = body != NULL;
+
+    /* Separators by reference: an evbuffer_add() after a reference chain
+     * would allocate a chain sized from it */
+    if (ok) {
+        ok = evbuffer_add_reference(body, "[", 1, NULL, NULL) == 0;
+    }
+    for (int i = 0; ok && i < n; i++) {
+        if (i > 0) {
+            ok = evbuffer_add_reference(body, ",", 1, NULL, NULL) == 0;
+        }
+        if (ok) {
+            ok = evbuffer_add_buffer(body, members[i]->request_body) == 0;
+        }
+    }
+    if (ok) {
+        ok = evbuffer_add_reference(body, "]", 1, NULL, NULL) == 0;
+    }
+
+    RPCRequest *batch = NULL;
+    RPCRequest **slots = ok ? malloc(n * sizeof(RPCRequest *)) : NULL;
+    if (slots) {
+        batch = rpc_request_new(mgr, client, body, NULL, NULL);
+        body = NULL;
+    }
+    if (!batch) {
+        if (body) {
+            evbuffer_free(body);
+        }
+        free(slots);
+        for (int i = 0; i < n; i++) {
+            rpc_request_complete(members[i], RPC_ERR_MEMORY,
+                                  "Memory allocation failed", 24);
+        }
+        return;
+    }
+
+    batch->is_batch = 1;
+    batch->members = slots;
+    batch->member_count = n;
+    for (int i = 0; i < n; i++) {
+        slots[i] = members[i];
+        members[i]->batch = batch;
+    }
+    rpc_request_reset_response(batch);
+
+    if (rpc_pool_dispatch(batch) < 0) {
+        rpc_request_complete(batch, RPC_ERR_CONNECT,
+                              "Failed to connect to node", 25);
+    }
+}
+
+/*
+ * Window over (or batch full): send everything queued, max_size at a
+ * time. A lone broadcast goes out as a plain request.
+ */
+static void rpc_batch_timer_cb(evutil_socket_t fd, short events, void *ctx)
+{
+    RPCClient *client = ctx;
+    RPCBatcher *batcher = &client->batcher;
+    RPCRequest *members[RPC_BATCH_MAX_SIZE];
+    struct timespec now;
+    (void)fd;
+    (void)events;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    while (batcher->head) {
+        int n = 0;
+        while (batcher->head && n < batcher->max_size) {
+            members[n++] = rpc_batch_pop(batcher, &now);
+        }
+        rpc_batch_count_size(batcher, n);
+
+        if (n > 1) {
+            rpc_batch_send(client, members, n);
+        } else if (rpc_pool_dispatch(members[0]) < 0) {
+            rpc_request_complete(members[0], RPC_ERR_CONNECT,
+                                  "Failed to connect to node", 25);
+        }
+    }
+}
+
+/*
+ * One reply of a batch response: keep it with the member it answers
+ * (matched by id) until the whole response has been read.
+ */
+static void rpc_batch_reply_cb(void *ctx, const RPCJsonScanner *json)
+{
+    RPCRequest *batch = ctx;
+    RPCClient *client = batch->client;
+
+    if (!json->has_id) return;
+
+    for (int i = 0; i < batch->member_count; i++) {
+        RPCRequest *member = batch->members[i];
+        if (!member || member->batch_answered || member->id != json->id) continue;
+
+        const char *text;
+        size_t text_len;
+        int ret = rpc_json_outcome(json, &text, &text_len);
+        if (text_len >= sizeof(member->result)) {
+            text_len = sizeof(member->result) - 1;
+        }
+        memcpy(member->result, text, text_len);
+        member->result[text_len] = '\0';
+        member->batch_result_len = text_len;
+        member->batch_status = ret;
+        member->batch_answered = 1;
+
+        client->request_count++;
+        if (ret == RPC_OK) {
+            client->available = 1;
+        } else {
+            client->error_count++;
+            if (ret == RPC_ERR_NODE) {
+                rpc_count_node_error(client, json);
+            }
+        }
+        return;
+    }
+}
+
+/*
+ * Complete the members of a finished batch: with their own reply where
+ * the node gave one, otherwise with the batch's outcome.
+ */
+static void rpc_batch_complete_members(RPCRequest *batch, int status,
+                                       const char *result, size_t result_len)
+{
+    static const char missing[] = "No reply in batch response";
+
+    for (int i = 0; i < batch->member_count; i++) {
+        RPCRequest *member = batch->members[i];
+        if (!member) continue;
+
+        batch->members[i] = NULL;
+        member->batch = NULL;
+        if (member->batch_answered) {
+            rpc_request_complete(member, member->batch_status,
+                                  member->result, member->batch_result_len);
+        } else if (status == RPC_OK) {
+            rpc_request_complete(member, RPC_ERR_PARSE, missing, sizeof(missing) - 1);
+        } else {
+            rpc_request_complete(member, status, result, result_len);
+        }
+    }
+}
+
+/*
+ * Common front half of the async broadcast entry points: resolve the
+ * client for chain. Reports failure through callback and returns NULL.
+ */
+static RPCClient *rpc_broadcast_client(RPCManager *mgr, BitcoinChain chain,
+                                       RPCResultCallback callback, void *user_data)
 {
     if (!mgr->base) {
         log_error("RPC async: no event_base (async not initialized)");
@@ -1229,20 +1987,17 @@ RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
         }
         return NULL;
     }
+    return client;
+}
 
-    /* Build JSON-RPC request body */
-    size_t params_len = strlen(hex_tx) + 8;
-    char *params = malloc(params_len);
-    if (!params) {
-        if (callback) {
-            callback(RPC_ERR_MEMORY, "Memory allocation failed", 24, user_data);
-        }
-        return NULL;
-    }
-    snprintf(params, params_len, "[\"%s\"]", hex_tx);
-
-    char *body = build_jsonrpc_request("sendrawtransaction", params);
-    free(params);
+/*
+ * Common back half: wrap body (ownership taken) in a request and hand it
+ * to the connection pool.
+ */
+static RPCRequest *rpc_broadcast_dispatch(RPCManager *mgr, RPCClient *client,
+                                          struct evbuffer *body,
+                                          RPCResultCallback callback, void *user_data)
+{
     if (!body) {
         if (callback) {
             callback(RPC_ERR_MEMORY, "Memory allocation failed", 24, user_data);
@@ -1250,30 +2005,25 @@ RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
         return NULL;
     }
 
-    /* Create request */
-    RPCRequest *req = calloc(1, sizeof(RPCRequest));
+    /* Create request (adds to active list) */
+    RPCRequest *req = rpc_request_new(mgr, client, body, callback, user_data);
     if (!req) {
-        free(body);
         if (callback) {
             callback(RPC_ERR_MEMORY, "Memory allocation failed", 24, user_data);
         }
         return NULL;
     }
 
-    req->client = client;
-    req->mgr = mgr;
-    req->base = mgr->base;
-    req->request_body = body;
-    req->request_body_len = strlen(body);
-    req->callback = callback;
-    req->callback_data = user_data;
-
-    /* Add to active list */
-    rpc_request_list_add(mgr, req);
     mgr->total_broadcasts++;
 
-    /* Initiate async connect */
-    if (rpc_async_connect(req) < 0) {
+    /* Coalesce with other broadcasts for this chain */
+    if (client->batcher.window_ms > 0 && client->batcher.timer) {
+        rpc_batch_add(req);
+        return req;
+    }
+
+    /* Hand to the connection pool */
+    if (rpc_pool_dispatch(req) < 0) {
         rpc_request_list_remove(mgr, req);
         mgr->failed_broadcasts++;
         if (callback) {
@@ -1286,10 +2036,26 @@ RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
     return req;
 }
 
+RPCRequest *rpc_manager_broadcast_async(RPCManager *mgr, BitcoinChain chain,
+                                         RPCPayload *hex,
+                                         RPCResultCallback callback,
+                                         void *user_data)
+{
+    RPCClient *client = rpc_broadcast_client(mgr, chain, callback, user_data);
+    if (!client) {
+        return NULL;
+    }
+
+    return rpc_broadcast_dispatch(mgr, client, rpc_build_sendraw_body(hex),
+                                  callback, user_data);
+}
+
 void rpc_request_cancel(RPCRequest *req)
 {
     if (!req) return;
 
+    RPCClient *client = req->client;
+
     /* Prevent callback from firing */
     req->callback = NULL;
     req->callback_data = NULL;
@@ -1300,12 +2066,44 @@ void rpc_request_cancel(RPCRequest *req)
     }
 
     rpc_request_free(req);
+
+    /* A closed in-flight connection may free capacity for waiters */
+    rpc_pool_service_waiters(client);
 }
 
 void rpc_manager_cancel_all(RPCManager *mgr)
 {
+    RPCClient *clients[] = { &mgr->mainnet, &mgr->testnet,
+                             &mgr->signet, &mgr->regtest };
+
+    if (mgr->pool_timer) {
+        event_free(mgr->pool_timer);
+        mgr->pool_timer = NULL;
+    }
+
+    /* No more batches: waiting broadcasts are cancelled with the rest */
+    for (int i = 0; i < 4; i++) {
+        RPCBatcher *batcher = &clients[i]->batcher;
+        if (batcher->timer) {
+            event_free(batcher->timer);
+            batcher->timer = NULL;
+        }
+    }
+
+    /* Empty wait queues first so cancelling doesn't open new connections */
+    for (int i = 0; i < 4; i++) {
+        while (rpc_pool_wait_pop(&clients[i]->pool)) {
+        }
+    }
+
     while (mgr->active_requests) {
         RPCRequest *req = mgr->active_requests;
         rpc_request_cancel(req);
     }
+
+    for (int i = 0; i < 4; i++) {
+        while (clients[i]->pool.conns) {
+            rpc_pool_conn_close(clients[i]->pool.conns);
+        }
+    }
 }
@@ -0,0 +1,687 @@
+/*
+ * Incremental JSON-RPC response parser.
+ *
+ * Two layers, both byte-driven and resumable at any split point:
+ *   HTTP  - status line, the three headers that matter for framing, then
+ *           the body as Content-Length bytes, chunks or until EOF.
+ *   JSON  - a scanner that tracks only nesting depth, string/escape state
+ *           and the keys at depth 1 ("result", "error", "id") and inside
+ *           the error object ("code", "message"). Values of those keys are
+ *           copied out; everything else is skipped. In a batch reply the
+ *           same keys are matched one level deeper, per array element.
+ */
+
+#include "rpc_parse.h"
+#include "rpc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* ========== JSON scanner ========== */
+
+void rpc_json_init(RPCJsonScanner *json, char *result, size_t result_cap)
+{
+    memset(json, 0, sizeof(*json));
+    json->result = result;
+    json->result_cap = result_cap;
+    result[0] = '\0';
+}
+
+void rpc_json_expect_batch(RPCJsonScanner *json, RPCJsonElementCallback on_element,
+                           void *ctx)
+{
+    json->batch = 1;
+    json->on_element = on_element;
+    json->element_ctx = ctx;
+}
+
+/* Clear the reply fields before the next element of a batch */
+static void json_reset_reply(RPCJsonScanner *json)
+{
+    json->result_len = 0;
+    json->result[0] = '\0';
+    json->has_result = 0;
+    json->result_truncated = 0;
+    json->has_error = 0;
+    json->has_error_code = 0;
+    json->error_code = 0;
+    json->error_message_len = 0;
+    json->error_message[0] = '\0';
+    json->has_id = 0;
+    json->id = 0;
+    json->error_depth = 0;
+}
+
+/* Capturing the value as raw JSON text (objects, arrays) */
+static inline int json_raw_active(const RPCJsonScanner *json)
+{
+    return json->field != RPC_FIELD_NONE && json->field_raw && !json->field_scalar;
+}
+
+static void json_emit(RPCJsonScanner *json, char c)
+{
+    switch (json->field) {
+        case RPC_FIELD_RESULT:
+            if (json->result_len + 1 < json->result_cap) {
+                json->result[json->result_len++] = c;
+                json->result[json->result_len] = '\0';
+            } else {
+                json->result_truncated = 1;
+            }
+            break;
+        case RPC_FIELD_ERROR_CODE:
+        case RPC_FIELD_ID:
+            if (json->number_len + 1 < sizeof(json->number)) {
+                json->number[json->number_len++] = c;
+            }
+            break;
+        case RPC_FIELD_ERROR:
+            if (json->field_scalar) {
+                if (json->number_len + 1 < sizeof(json->number)) {
+                    json->number[json->number_len++] = c;
+                }
+                break;
+            }
+            /* fall through */
+        case RPC_FIELD_ERROR_MESSAGE:
+            if (json->error_message_len + 1 < sizeof(json->error_message)) {
+                json->error_message[json->error_message_len++] = c;
+                json->error_message[json->error_message_len] = '\0';
+            }
+            break;
+        case RPC_FIELD_NONE:
+            break;
+    }
+}
+
+static void json_start_field(RPCJsonScanner *json, int raw, int scalar)
+{
+    json->field = json->pending;
+    json->pending = RPC_FIELD_NONE;
+    json->field_raw = raw;
+    json->field_scalar = scalar;
+    json->field_depth = json->depth + 1;
+
+    /* A repeated key replaces the earlier value */
+    switch (json->field) {
+        case RPC_FIELD_RESULT:
+            json->has_result = 1;
+            json->result_len = 0;
+            json->result_truncated = 0;
+            json->result[0] = '\0';
+            break;
+        case RPC_FIELD_ERROR:
+        case RPC_FIELD_ERROR_MESSAGE:
+            json->error_message_len = 0;
+            json->error_message[0] = '\0';
+            json->number_len = 0;
+            break;
+        case RPC_FIELD_ERROR_CODE:
+        case RPC_FIELD_ID:
+            json->number_len = 0;
+            break;
+        case RPC_FIELD_NONE:
+            break;
+    }
+}
+
+static void json_finish_field(RPCJsonScanner *json)
+{
+    json->number[json->number_len] = '\0';
+
+    switch (json->field) {
+        case RPC_FIELD_ERROR_CODE: {
+            char *end;
+            long code = strtol(json->number, &end, 10);
+            if (end != json->number) {
+                json->error_code = code;
+                json->has_error_code = 1;
+            }
+            break;
+        }
+        case RPC_FIELD_ID: {
+            char *end;
+            unsigned long long id = strtoull(json->number, &end, 10);
+            json->has_id = end != json->number && *end == '\0';
+            json->id = json->has_id ? (uint64_t)id : 0;
+            break;
+        }
+        case RPC_FIELD_ERROR:
+            /* "error": null is the success case */
+            if (json->field_scalar && strcmp(json->number, "null") == 0) {
+                json->has_error = 0;
+            } else {
+                json->has_error = 1;
+                if (json->field_scalar) {
+                    memcpy(json->error_message, json->number, json->number_len + 1);
+                    json->error_message_len = json->number_len;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    json->field = RPC_FIELD_NONE;
+    json->field_raw = 0;
+    json->field_scalar = 0;
+}
+
+/* One decoded character of string content */
+static void json_string_char(RPCJsonScanner *json, char c)
+{
+    if (json->string_is_key) {
+        if (json->key_len < RPC_PARSE_KEY_LEN) {
+            json->key[json->key_len] = c;
+        }
+        json->key_len++;
+    } else if (json->field != RPC_FIELD_NONE && !json->field_raw) {
+        json_emit(json, c);
+    }
+}
+
+static void json_string_codepoint(RPCJsonScanner *json, unsigned cp)
+{
+    if (cp < 0x80) {
+        json_string_char(json, (char)cp);
+    } else if (cp < 0x800) {
+        json_string_char(json, (char)(0xC0 | (cp >> 6)));
+        json_string_char(json, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        json_string_char(json, (char)(0xE0 | (cp >> 12)));
+        json_string_char(json, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        json_string_char(json, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void json_string_byte(RPCJsonScanner *json, char c)
+{
+    if (json_raw_active(json)) {
+        json_emit(json, c);
+    }
+
+    if (json->unicode_left) {
+        int v = hex_nibble(c);
+        if (v < 0) {
+            json->unicode_left = 0;     /* Malformed: drop the escape */
+            return;
+        }
+        json->unicode_value = json->unicode_value * 16 + (unsigned)v;
+        if (--json->unicode_left == 0) {
+            json_string_codepoint(json, json->unicode_value);
+        }
+        return;
+    }
+
+    if (json->escape) {
+        json->escape = 0;
+        switch (c) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'u':
+                json->unicode_left = 4;
+                json->unicode_value = 0;
+                return;
+            default: break;             /* \" \\ \/ */
+        }
+        json_string_char(json, c);
+        return;
+    }
+
+    if (c == '\\') {
+        json->escape = 1;
+    } else if (c == '"') {
+        json->in_string = 0;
+        if (!json->string_is_key && json->field != RPC_FIELD_NONE && !json->field_raw) {
+            json_finish_field(json);
+        }
+    } else {
+        json_string_char(json, c);
+    }
+}
+
+static int json_key_is(const RPCJsonScanner *json, const char *name)
+{
+    size_t n = strlen(name);
+    return json->key_len == n && memcmp(json->key, name, n) == 0;
+}
+
+/* ':' after a key: decide where its value goes */
+static void json_key_done(RPCJsonScanner *json)
+{
+    json->pending = RPC_FIELD_NONE;
+    if (json->field != RPC_FIELD_NONE) {
+        return;                         /* Inside a captured value */
+    }
+    if (json->depth == json->base + 1) {
+        if (json_key_is(json, "result")) {
+            json->pending = RPC_FIELD_RESULT;
+        } else if (json_key_is(json, "error")) {
+            json->pending = RPC_FIELD_ERROR;
+        } else if (json_key_is(json, "id")) {
+            json->pending = RPC_FIELD_ID;
+        }
+    } else if (json->depth == json->base + 2 && json->error_depth == json->base + 2) {
+        if (json_key_is(json, "code")) {
+            json->pending = RPC_FIELD_ERROR_CODE;
+        } else if (json_key_is(json, "message")) {
+            json->pending = RPC_FIELD_ERROR_MESSAGE;
+        }
+    }
+}
+
+static void json_open(RPCJsonScanner *json, char c)
+{
+    if (json->depth == 0) {
+        if (c == '[' && json->batch) {
+            json->array = 1;
+            json->base = 1;
+        } else if (c != '{') {
+            json->invalid = 1;
+            return;
+        }
+    } else if (json->array && json->depth == 1 && c != '{') {
+        json->invalid = 1;              /* Batch elements are reply objects */
+        return;
+    }
+
+    if (json->field == RPC_FIELD_NONE && json->pending != RPC_FIELD_NONE) {
+        if (json->pending == RPC_FIELD_ERROR && c == '{') {
+            /* Error object: look for code/message inside it */
+            json->has_error = 1;
+            json->error_depth = json->depth + 1;
+            json->error_message_len = 0;
+            json->has_error_code = 0;
+            json->pending = RPC_FIELD_NONE;
+        } else if (json->pending == RPC_FIELD_ERROR_CODE ||
+                   json->pending == RPC_FIELD_ID) {
+            json->pending = RPC_FIELD_NONE;
+        } else {
+            json_start_field(json, 1, 0);
+        }
+    }
+
+    if (json_raw_active(json)) {
+        json_emit(json, c);
+    }
+    json->depth++;
+    if (json->depth <= 3) {
+        json->is_object[json->depth] = (c == '{');
+    }
+    json->want_key = (c == '{');
+}
+
+static void json_close(RPCJsonScanner *json, char c)
+{
+    if (json->depth == 0) {
+        json->invalid = 1;
+        return;
+    }
+
+    if (json_raw_active(json)) {
+        json_emit(json, c);
+    }
+    json->depth--;
+    json->pending = RPC_FIELD_NONE;
+    json->want_key = 0;
+
+    if (json->field != RPC_FIELD_NONE && json->depth < json->field_depth) {
+        json_finish_field(json);
+    }
+    if (json->error_depth && json->depth < json->error_depth) {
+        json->error_depth = 0;
+    }
+    if (json->array && json->depth == 1) {
+        /* One reply of the batch is complete */
+        json->elements++;
+        if (json->on_element) {
+            json->element_done = 1;
+            json->on_element(json->element_ctx, json);
+            json->element_done = 0;
+        }
+        json_reset_reply(json);
+    }
+    if (json->depth == 0) {
+        json->complete = 1;
+    }
+}
+
+void rpc_json_feed(RPCJsonScanner *json, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && !json->complete && !json->invalid; i++) {
+        char c = data[i];
+
+        if (json->in_string) {
+            json_string_byte(json, c);
+            continue;
+        }
+
+        if (json->field_scalar) {
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n' &&
+                c != ',' && c != '}' && c != ']') {
+                json_emit(json, c);
+                continue;
+            }
+            json_finish_field(json);
+        }
+
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                if (json_raw_active(json)) {
+                    json_emit(json, c);
+                }
+                break;
+
+            case '"':
+                if (json->depth == 0 || (json->array && json->depth == 1)) {
+                    json->invalid = 1;
+                    break;
+                }
+                if (json_raw_active(json)) {
+                    json_emit(json, c);
+                }
+                json->in_string = 1;
+                json->escape = 0;
+                json->unicode_left = 0;
+                json->string_is_key = json->want_key;
+                if (json->string_is_key) {
+                    json->key_len = 0;
+                } else if (json->field == RPC_FIELD_NONE && json->pending != RPC_FIELD_NONE) {
+                    json_start_field(json, 0, 0);
+                }
+                break;
+
+            case '{':
+            case '[':
+                json_open(json, c);
+                break;
+
+            case '}':
+            case ']':
+                json_close(json, c);
+                break;
+
+            case ':':
+                if (json_raw_active(json)) {
+                    json_emit(json, c);
+                }
+                if (json->string_is_key) {
+                    json->string_is_key = 0;
+                    json_key_done(json);
+                }
+                json->want_key = 0;
+                break;
+
+            case ',':
+                if (json_raw_active(json)) {
+                    json_emit(json, c);
+                }
+                json->pending = RPC_FIELD_NONE;
+                json->want_key = json->depth <= 3 ? json->is_object[json->depth] : 0;
+                break;
+
+            default:
+                /* Number, true, false, null */
+                if (json->depth == 0 || (json->array && json->depth == 1)) {
+                    json->invalid = 1;
+                } else if (json_raw_active(json)) {
+                    json_emit(json, c);
+                } else if (json->field == RPC_FIELD_NONE && json->pending != RPC_FIELD_NONE) {
+                    json_start_field(json, 1, 1);
+                    json_emit(json, c);
+                }
+                break;
+        }
+    }
+}
+
+int rpc_json_outcome(const RPCJsonScanner *json, const char **text, size_t *text_len)
+{
+    static const char malformed[] = "Malformed JSON-RPC response";
+    static const char no_result[] = "No result in response";
+    static const char node_error[] = "Node returned an error";
+
+    if (json->invalid || !(json->complete || json->element_done)) {
+        *text = malformed;
+        *text_len = sizeof(malformed) - 1;
+        return RPC_ERR_PARSE;
+    }
+    if (json->has_error) {
+        if (json->error_message_len > 0) {
+            *text = json->error_message;
+            *text_len = json->error_message_len;
+        } else {
+            *text = node_error;
+            *text_len = sizeof(node_error) - 1;
+        }
+        return RPC_ERR_NODE;
+    }
+    if (!json->has_result) {
+        *text = no_result;
+        *text_len = sizeof(no_result) - 1;
+        return RPC_ERR_PARSE;
+    }
+    *text = json->result;
+    *text_len = json->result_len;
+    return RPC_OK;
+}
+
+/* ========== HTTP framing ========== */
+
+void rpc_response_init(RPCResponse *resp, char *result, size_t result_cap)
+{
+    resp->state = RPC_HTTP_STATUS_LINE;
+    resp->status = 0;
+    resp->server_close = 0;
+    resp->chunked = 0;
+    resp->content_length = -1;
+    resp->remaining = 0;
+    resp->bytes = 0;
+    resp->line_len = 0;
+    rpc_json_init(&resp->json, result, result_cap);
+}
+
+static int header_is(const char *line, const char *name, const char **value)
+{
+    size_t n = strlen(name);
+    if (strncasecmp(line, name, n) != 0) {
+        return 0;
+    }
+    line += n;
+    while (*line == ' ' || *line == '\t') line++;
+    *value = line;
+    return 1;
+}
+
+/* Headers are complete: pick the body framing */
+static void http_headers_done(RPCResponse *resp)
+{
+    if (resp->status >= 100 && resp->status < 200) {
+        /* Interim response: the real one follows */
+        resp->state = RPC_HTTP_STATUS_LINE;
+        resp->chunked = 0;
+        resp->content_length = -1;
+        return;
+    }
+
+    if (resp->chunked) {
+        resp->state = RPC_HTTP_CHUNK_SIZE;
+    } else if (resp->content_length >= 0) {
+        resp->remaining = (uint64_t)resp->content_length;
+        resp->state = resp->remaining ? RPC_HTTP_BODY : RPC_HTTP_DONE;
+    } else {
+        resp->state = RPC_HTTP_UNTIL_CLOSE;
+        resp->server_close = 1;
+    }
+}
+
+/* One complete line (CRLF stripped, NUL-terminated) */
+static int http_line(RPCResponse *resp)
+{
+    const char *line = resp->line;
+    const char *value;
+
+    switch (resp->state) {
+        case RPC_HTTP_STATUS_LINE:
+            if (resp->line_len == 0) {
+                return 0;               /* Tolerate a stray CRLF */
+            }
+            if (resp->line_len < 12 || strncmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ') {
+                return -1;
+            }
+            if (line[7] == '0') {
+                resp->server_close = 1;
+            }
+            resp->status = atoi(line + 9);
+            if (resp->status < 100 || resp->status > 599) {
+                return -1;
+            }
+            resp->state = RPC_HTTP_HEADERS;
+            return 0;
+
+        case RPC_HTTP_HEADERS:
+            if (resp->line_len == 0) {
+                http_headers_done(resp);
+            } else if (header_is(line, "Content-Length:", &value)) {
+                char *end;
+                long long n = strtoll(value, &end, 10);
+                if (end == value || n < 0) {
+                    return -1;
+                }
+                resp->content_length = (long)n;
+            } else if (header_is(line, "Transfer-Encoding:", &value)) {
+                if (strcasestr(value, "chunked")) {
+                    resp->chunked = 1;
+                }
+            } else if (header_is(line, "Connection:", &value)) {
+                if (strncasecmp(value, "close", 5) == 0) {
+                    resp->server_close = 1;
+                }
+            }
+            return 0;
+
+        case RPC_HTTP_CHUNK_SIZE: {
+            uint64_t size = 0;
+            size_t i = 0;
+            int v;
+            for (; i < resp->line_len && (v = hex_nibble(line[i])) >= 0; i++) {
+                if (size >> 56) {
+                    return -1;          /* Absurd chunk size */
+                }
+                size = size * 16 + (uint64_t)v;
+            }
+            if (i == 0) {
+                return -1;
+            }
+            resp->remaining = size;
+            resp->state = size ? RPC_HTTP_CHUNK_DATA : RPC_HTTP_TRAILERS;
+            return 0;
+        }
+
+        case RPC_HTTP_CHUNK_END:
+            if (resp->line_len != 0) {
+                return -1;
+            }
+            resp->state = RPC_HTTP_CHUNK_SIZE;
+            return 0;
+
+        case RPC_HTTP_TRAILERS:
+            if (resp->line_len == 0) {
+                resp->state = RPC_HTTP_DONE;
+            }
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+ssize_t rpc_response_feed(RPCResponse *resp, const char *data, size_t len)
+{
+    size_t i = 0;
+
+    while (i < len && resp->state != RPC_HTTP_DONE) {
+        switch (resp->state) {
+            case RPC_HTTP_STATUS_LINE:
+            case RPC_HTTP_HEADERS:
+            case RPC_HTTP_CHUNK_SIZE:
+            case RPC_HTTP_CHUNK_END:
+            case RPC_HTTP_TRAILERS: {
+                const char *nl = memchr(data + i, '\n', len - i);
+                size_t take = nl ? (size_t)(nl - (data + i)) : len - i;
+                size_t room = sizeof(resp->line) - 1 - resp->line_len;
+                size_t copy = take < room ? take : room;
+
+                memcpy(resp->line + resp->line_len, data + i, copy);
+                resp->line_len += copy;
+                i += take;
+                if (!nl) {
+                    break;              /* Line continues in the next segment */
+                }
+                i++;
+
+                if (resp->line_len > 0 && resp->line[resp->line_len - 1] == '\r') {
+                    resp->line_len--;
+                }
+                resp->line[resp->line_len] = '\0';
+                if (http_line(resp) < 0) {
+                    resp->state = RPC_HTTP_ERROR;
+                    return -1;
+                }
+                resp->line_len = 0;
+                break;
+            }
+
+            case RPC_HTTP_BODY:
+            case RPC_HTTP_CHUNK_DATA: {
+                size_t n = len - i;
+                if (n > resp->remaining) {
+                    n = (size_t)resp->remaining;
+                }
+                rpc_json_feed(&resp->json, data + i, n);
+                i += n;
+                resp->remaining -= n;
+                if (resp->remaining == 0) {
+                    resp->state = resp->state == RPC_HTTP_BODY
+                        ? RPC_HTTP_DONE : RPC_HTTP_CHUNK_END;
+                }
+                break;
+            }
+
+            case RPC_HTTP_UNTIL_CLOSE:
+                rpc_json_feed(&resp->json, data + i, len - i);
+                i = len;
+                break;
+
+            default:
+                return -1;
+        }
+    }
+
+    resp->bytes += i;
+    return (ssize_t)i;
+}
+
+int rpc_response_eof(RPCResponse *resp)
+{
+    if (resp->state == RPC_HTTP_UNTIL_CLOSE) {
+        resp->state = RPC_HTTP_DONE;
+    }
+    resp->server_close = 1;
+    return resp->state == RPC_HTTP_DONE ? 0 : -1;
+}
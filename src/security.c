@@ -21,6 +21,7 @@
 #include <errno.h>
 
 #ifdef __linux__
+#include <unistd.h>
 #include <sys/prctl.h>
 #include <sys/syscall.h>
 #include <linux/filter.h>
@@ -269,6 +270,14 @@ static int apply_seccomp_filter(void)
         log_warn("prctl(PR_SET_NO_NEW_PRIVS) failed: %s", strerror(errno));
     }
 
+#if defined(__NR_seccomp) && defined(SECCOMP_FILTER_FLAG_TSYNC)
+    /* Filter every thread of the worker (TLS handshake threads), not just this one */
+    if (syscall(__NR_seccomp, SECCOMP_SET_MODE_FILTER, SECCOMP_FILTER_FLAG_TSYNC, &prog) == 0) {
+        return 0;
+    }
+    log_debug("seccomp TSYNC failed (%s), filtering this thread only", strerror(errno));
+#endif
+
     if (prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) < 0) {
         log_warn("seccomp filter failed: %s", strerror(errno));
         return -1;
@@ -0,0 +1,351 @@
+/*
+ * SHA-256 / double-SHA256 with runtime backend dispatch.
+ *
+ * This file holds the portable pieces: the scalar compression function,
+ * padding, the streaming context and the batch driver that feeds the
+ * 8-way AVX2 kernel. The x86 kernels live in sha256_x86.c.
+ */
+
+#include "sha256.h"
+#include "cpu.h"
+
+#include <string.h>
+
+const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t sha256_h0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t ror32(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void sha256_blocks_scalar(uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    uint32_t w[64];
+
+    while (nblocks--) {
+        for (int t = 0; t < 16; t++) {
+            w[t] = load_be32(data + 4 * t);
+        }
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = ror32(w[t - 15], 7) ^ ror32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = ror32(w[t - 2], 17) ^ ror32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int t = 0; t < 64; t++) {
+            uint32_t t1 = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) +
+                          ((e & f) ^ (~e & g)) + sha256_k[t] + w[t];
+            uint32_t t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) +
+                          ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += SHA256_BLOCK_LEN;
+    }
+}
+
+/* ========== Dispatch ========== */
+
+static SHA256Backend active_backend = SHA256_BACKEND_COUNT;  /* Not chosen yet */
+static void (*blocks_fn)(uint32_t state[8], const uint8_t *data, size_t nblocks);
+
+int sha256_backend_supported(SHA256Backend backend)
+{
+    switch (backend) {
+        case SHA256_BACKEND_SCALAR:
+            return 1;
+#if defined(__x86_64__)
+        case SHA256_BACKEND_AVX2:
+            return cpu_has(CPU_AVX2);
+        case SHA256_BACKEND_SHANI:
+            return cpu_has(CPU_SHA | CPU_SSSE3 | CPU_SSE41);
+#endif
+        default:
+            return 0;
+    }
+}
+
+int sha256_set_backend(SHA256Backend backend)
+{
+    if (!sha256_backend_supported(backend)) {
+        return -1;
+    }
+
+    active_backend = backend;
+    blocks_fn = sha256_blocks_scalar;
+#if defined(__x86_64__)
+    if (backend == SHA256_BACKEND_SHANI) {
+        blocks_fn = sha256_blocks_shani;
+    }
+#endif
+    return 0;
+}
+
+SHA256Backend sha256_backend(void)
+{
+    if (active_backend == SHA256_BACKEND_COUNT) {
+        if (sha256_set_backend(SHA256_BACKEND_SHANI) < 0 &&
+            sha256_set_backend(SHA256_BACKEND_AVX2) < 0) {
+            sha256_set_backend(SHA256_BACKEND_SCALAR);
+        }
+    }
+    return active_backend;
+}
+
+const char *sha256_backend_name(SHA256Backend backend)
+{
+    switch (backend) {
+        case SHA256_BACKEND_SCALAR: return "scalar";
+        case SHA256_BACKEND_AVX2:   return "avx2";
+        case SHA256_BACKEND_SHANI:  return "shani";
+        default:                    return "unknown";
+    }
+}
+
+static inline void sha256_blocks(uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    sha256_backend();
+    blocks_fn(state, data, nblocks);
+}
+
+/* ========== Streaming API ========== */
+
+void sha256_init(SHA256Ctx *ctx)
+{
+    memcpy(ctx->state, sha256_h0, sizeof(sha256_h0));
+    ctx->bytes = 0;
+    ctx->buf_len = 0;
+}
+
+void sha256_update(SHA256Ctx *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    ctx->bytes += len;
+
+    if (ctx->buf_len > 0) {
+        size_t take = SHA256_BLOCK_LEN - ctx->buf_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buf + ctx->buf_len, p, take);
+        ctx->buf_len += take;
+        p += take;
+        len -= take;
+        if (ctx->buf_len < SHA256_BLOCK_LEN) {
+            return;
+        }
+        sha256_blocks(ctx->state, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+
+    /* Whole blocks straight from the caller's buffer */
+    size_t nblocks = len / SHA256_BLOCK_LEN;
+    if (nblocks > 0) {
+        sha256_blocks(ctx->state, p, nblocks);
+        p += nblocks * SHA256_BLOCK_LEN;
+        len -= nblocks * SHA256_BLOCK_LEN;
+    }
+
+    memcpy(ctx->buf, p, len);
+    ctx->buf_len = len;
+}
+
+/*
+ * Write the padding for a message of total_bytes whose last partial
+ * block (tail_len bytes) is already in block, which must have room for
+ * two blocks unless tail_len < 56. Returns the block count (1 or 2).
+ */
+static size_t sha256_pad(uint8_t *block, size_t tail_len,
+                         uint64_t total_bytes)
+{
+    size_t nblocks = tail_len + 9 > SHA256_BLOCK_LEN ? 2 : 1;
+    uint64_t bits = total_bytes * 8;
+
+    block[tail_len] = 0x80;
+    memset(block + tail_len + 1, 0, nblocks * SHA256_BLOCK_LEN - tail_len - 9);
+    for (int i = 0; i < 8; i++) {
+        block[nblocks * SHA256_BLOCK_LEN - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    return nblocks;
+}
+
+void sha256_final(SHA256Ctx *ctx, uint8_t out[SHA256_DIGEST_LEN])
+{
+    uint8_t block[2 * SHA256_BLOCK_LEN];
+
+    memcpy(block, ctx->buf, ctx->buf_len);
+    size_t nblocks = sha256_pad(block, ctx->buf_len, ctx->bytes);
+    sha256_blocks(ctx->state, block, nblocks);
+
+    for (int i = 0; i < 8; i++) {
+        store_be32(out + 4 * i, ctx->state[i]);
+    }
+}
+
+/*
+ * Second pass of a double hash: one padded block over a 32-byte digest.
+ */
+static void sha256_digest_block(uint8_t block[SHA256_BLOCK_LEN],
+                                const uint8_t digest[SHA256_DIGEST_LEN])
+{
+    memcpy(block, digest, SHA256_DIGEST_LEN);
+    sha256_pad(block, SHA256_DIGEST_LEN, SHA256_DIGEST_LEN);
+}
+
+void sha256d(const void *data, size_t len, uint8_t out[SHA256_DIGEST_LEN])
+{
+    SHA256Ctx ctx;
+    uint8_t first[SHA256_DIGEST_LEN];
+    uint8_t block[SHA256_BLOCK_LEN];
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, first);
+
+    sha256_digest_block(block, first);
+    memcpy(ctx.state, sha256_h0, sizeof(sha256_h0));
+    sha256_blocks(ctx.state, block, 1);
+    for (int i = 0; i < 8; i++) {
+        store_be32(out + 4 * i, ctx.state[i]);
+    }
+}
+
+/* ========== Batch API ========== */
+
+#if defined(__x86_64__)
+/*
+ * Run up to eight messages through the 8-way kernel in lockstep.
+ * Each lane walks its own block list (body blocks, then padded tail);
+ * lanes that finish early keep hashing a dummy block and their result
+ * is captured at the step they finished.
+ */
+static void sha256d_avx2_group(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                               uint8_t (*out)[SHA256_DIGEST_LEN])
+{
+    static const uint8_t dummy[SHA256_BLOCK_LEN];
+    uint8_t tails[8][2 * SHA256_BLOCK_LEN];
+    size_t full[8], total[8], max_blocks = 0;
+    uint32_t state[8][8];
+    uint32_t result[8][8];
+    const uint8_t *blocks[8];
+
+    for (size_t lane = 0; lane < 8; lane++) {
+        for (int w = 0; w < 8; w++) {
+            state[w][lane] = sha256_h0[w];
+        }
+        if (lane >= n) {
+            full[lane] = total[lane] = 0;
+            continue;
+        }
+        full[lane] = lens[lane] / SHA256_BLOCK_LEN;
+        size_t tail_len = lens[lane] % SHA256_BLOCK_LEN;
+        memcpy(tails[lane], msgs[lane] + full[lane] * SHA256_BLOCK_LEN, tail_len);
+        total[lane] = full[lane] + sha256_pad(tails[lane], tail_len, lens[lane]);
+        if (total[lane] > max_blocks) {
+            max_blocks = total[lane];
+        }
+    }
+
+    for (size_t b = 0; b < max_blocks; b++) {
+        for (size_t lane = 0; lane < 8; lane++) {
+            if (b >= total[lane]) {
+                blocks[lane] = dummy;
+            } else if (b < full[lane]) {
+                blocks[lane] = msgs[lane] + b * SHA256_BLOCK_LEN;
+            } else {
+                blocks[lane] = tails[lane] + (b - full[lane]) * SHA256_BLOCK_LEN;
+            }
+        }
+        sha256_block_avx2_8way(state, blocks);
+        for (size_t lane = 0; lane < n; lane++) {
+            if (b + 1 == total[lane]) {
+                for (int w = 0; w < 8; w++) {
+                    result[lane][w] = state[w][lane];
+                }
+            }
+        }
+    }
+
+    /* Second pass: every lane is exactly one block */
+    for (size_t lane = 0; lane < 8; lane++) {
+        for (int w = 0; w < 8; w++) {
+            state[w][lane] = sha256_h0[w];
+        }
+        if (lane < n) {
+            uint8_t digest[SHA256_DIGEST_LEN];
+            for (int w = 0; w < 8; w++) {
+                store_be32(digest + 4 * w, result[lane][w]);
+            }
+            sha256_digest_block(tails[lane], digest);
+            blocks[lane] = tails[lane];
+        } else {
+            blocks[lane] = dummy;
+        }
+    }
+    sha256_block_avx2_8way(state, blocks);
+
+    for (size_t lane = 0; lane < n; lane++) {
+        for (int w = 0; w < 8; w++) {
+            store_be32(out[lane] + 4 * w, state[w][lane]);
+        }
+    }
+}
+#endif
+
+void sha256d_batch(const uint8_t *const *msgs, const size_t *lens, size_t n,
+                   uint8_t (*out)[SHA256_DIGEST_LEN])
+{
+#if defined(__x86_64__)
+    if (sha256_backend() == SHA256_BACKEND_AVX2) {
+        for (size_t i = 0; i < n; i += 8) {
+            size_t group = n - i < 8 ? n - i : 8;
+            sha256d_avx2_group(msgs + i, lens + i, group, out + i);
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        sha256d(msgs[i], lens[i], out[i]);
+    }
+}
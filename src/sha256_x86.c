@@ -0,0 +1,178 @@
+/*
+ * x86 SHA-256 kernels: SHA-NI (single stream) and AVX2 (8-way).
+ *
+ * Compiled with per-function target attributes so the rest of the
+ * binary stays baseline x86-64; sha256.c only calls these after
+ * cpu_has() confirms the instructions exist.
+ */
+
+#include "sha256.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/* ========== SHA-NI ========== */
+
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+/*
+ * Four rounds: msg holds W[t..t+3] + K[t..t+3]. sha256rnds2 does two
+ * rounds from the low half, so the high half is shuffled down for the
+ * second call.
+ */
+#define SHANI_QUAD(s0, s1, msg) do { \
+    (s1) = _mm_sha256rnds2_epu32((s1), (s0), (msg)); \
+    (s0) = _mm_sha256rnds2_epu32((s0), (s1), _mm_shuffle_epi32((msg), 0x0E)); \
+} while (0)
+
+/* W for the next four rounds: m2 += sigma terms of (m0, m1), m2 = msg2 */
+#define SHANI_SCHEDULE(m0, m1, m2) \
+    (m2) = _mm_sha256msg2_epu32(_mm_add_epi32((m2), _mm_alignr_epi8((m1), (m0), 4)), (m1))
+
+SHANI_TARGET
+void sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+                                       4, 5, 6, 7, 0, 1, 2, 3);
+    const __m128i *k = (const __m128i *)sha256_k;
+
+    /* a..h -> ABEF / CDGH lane layout the instructions expect */
+    __m128i abcd = _mm_loadu_si128((const __m128i *)state);
+    __m128i efgh = _mm_loadu_si128((const __m128i *)(state + 4));
+    __m128i t1 = _mm_shuffle_epi32(abcd, 0xB1);
+    __m128i t2 = _mm_shuffle_epi32(efgh, 0x1B);
+    __m128i s0 = _mm_alignr_epi8(t1, t2, 8);
+    __m128i s1 = _mm_blend_epi16(t2, t1, 0xF0);
+
+    while (nblocks--) {
+        __m128i save0 = s0, save1 = s1;
+        __m128i m0, m1, m2, m3;
+
+        m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 0)), bswap);
+        SHANI_QUAD(s0, s1, _mm_add_epi32(m0, _mm_loadu_si128(k + 0)));
+        m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), bswap);
+        SHANI_QUAD(s0, s1, _mm_add_epi32(m1, _mm_loadu_si128(k + 1)));
+        m0 = _mm_sha256msg1_epu32(m0, m1);
+        m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), bswap);
+        SHANI_QUAD(s0, s1, _mm_add_epi32(m2, _mm_loadu_si128(k + 2)));
+        m1 = _mm_sha256msg1_epu32(m1, m2);
+        m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), bswap);
+        SHANI_QUAD(s0, s1, _mm_add_epi32(m3, _mm_loadu_si128(k + 3)));
+
+        /* Rounds 16..63: each step derives the next four schedule words */
+        for (int i = 4; i < 16; i += 4) {
+            SHANI_SCHEDULE(m2, m3, m0);
+            m2 = _mm_sha256msg1_epu32(m2, m3);
+            SHANI_QUAD(s0, s1, _mm_add_epi32(m0, _mm_loadu_si128(k + i)));
+            SHANI_SCHEDULE(m3, m0, m1);
+            m3 = _mm_sha256msg1_epu32(m3, m0);
+            SHANI_QUAD(s0, s1, _mm_add_epi32(m1, _mm_loadu_si128(k + i + 1)));
+            SHANI_SCHEDULE(m0, m1, m2);
+            if (i < 12) {
+                m0 = _mm_sha256msg1_epu32(m0, m1);
+            }
+            SHANI_QUAD(s0, s1, _mm_add_epi32(m2, _mm_loadu_si128(k + i + 2)));
+            SHANI_SCHEDULE(m1, m2, m3);
+            if (i < 12) {
+                m1 = _mm_sha256msg1_epu32(m1, m2);
+            }
+            SHANI_QUAD(s0, s1, _mm_add_epi32(m3, _mm_loadu_si128(k + i + 3)));
+        }
+
+        s0 = _mm_add_epi32(s0, save0);
+        s1 = _mm_add_epi32(s1, save1);
+        data += SHA256_BLOCK_LEN;
+    }
+
+    /* ABEF / CDGH -> a..h */
+    t1 = _mm_shuffle_epi32(s0, 0x1B);
+    t2 = _mm_shuffle_epi32(s1, 0xB1);
+    abcd = _mm_blend_epi16(t1, t2, 0xF0);
+    efgh = _mm_alignr_epi8(t2, t1, 8);
+    _mm_storeu_si128((__m128i *)state, abcd);
+    _mm_storeu_si128((__m128i *)(state + 4), efgh);
+}
+
+/* ========== AVX2 8-way ========== */
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+#define V_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define V_ADD(a, b) _mm256_add_epi32((a), (b))
+#define V_XOR(a, b) _mm256_xor_si256((a), (b))
+#define V_AND(a, b) _mm256_and_si256((a), (b))
+
+AVX2_TARGET
+static inline __m256i avx2_load_word(const uint8_t *const blocks[8], int t,
+                                     __m256i bswap)
+{
+    /* Word t of every lane, byte-swapped to big-endian values */
+    __m256i v = _mm256_setr_epi32(
+        *(const int32_t *)(const void *)(blocks[0] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[1] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[2] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[3] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[4] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[5] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[6] + 4 * t),
+        *(const int32_t *)(const void *)(blocks[7] + 4 * t));
+    return _mm256_shuffle_epi8(v, bswap);
+}
+
+AVX2_TARGET
+void sha256_block_avx2_8way(uint32_t state[8][8], const uint8_t *const blocks[8])
+{
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i w[16];
+    __m256i s[8];
+
+    for (int i = 0; i < 8; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *)state[i]);
+    }
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+    __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+
+    for (int t = 0; t < 64; t++) {
+        __m256i wt;
+        if (t < 16) {
+            wt = avx2_load_word(blocks, t, bswap);
+        } else {
+            __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+            __m256i s0 = V_XOR(V_XOR(V_ROR(w15, 7), V_ROR(w15, 18)), _mm256_srli_epi32(w15, 3));
+            __m256i s1 = V_XOR(V_XOR(V_ROR(w2, 17), V_ROR(w2, 19)), _mm256_srli_epi32(w2, 10));
+            wt = V_ADD(V_ADD(w[t & 15], s0), V_ADD(w[(t - 7) & 15], s1));
+        }
+        w[t & 15] = wt;
+
+        __m256i S1 = V_XOR(V_XOR(V_ROR(e, 6), V_ROR(e, 11)), V_ROR(e, 25));
+        __m256i ch = V_XOR(V_AND(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = V_ADD(V_ADD(V_ADD(h, S1), V_ADD(ch, wt)),
+                           _mm256_set1_epi32((int)sha256_k[t]));
+        __m256i S0 = V_XOR(V_XOR(V_ROR(a, 2), V_ROR(a, 13)), V_ROR(a, 22));
+        __m256i maj = V_XOR(V_XOR(V_AND(a, b), V_AND(a, c)), V_AND(b, c));
+        __m256i t2 = V_ADD(S0, maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = V_ADD(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = V_ADD(t1, t2);
+    }
+
+    s[0] = V_ADD(s[0], a); s[1] = V_ADD(s[1], b);
+    s[2] = V_ADD(s[2], c); s[3] = V_ADD(s[3], d);
+    s[4] = V_ADD(s[4], e); s[5] = V_ADD(s[5], f);
+    s[6] = V_ADD(s[6], g); s[7] = V_ADD(s[7], h);
+
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)state[i], s[i]);
+    }
+}
+
+#endif /* __x86_64__ */
@@ -1,4 +1,5 @@
 #include "static_files.h"
+#include "sha256.h"
 #include "log.h"
 
 #include <stdio.h>
@@ -8,23 +9,465 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 
-/* Maximum file size (1MB should be plenty for HTML) */
-#define MAX_FILE_SIZE (1024 * 1024)
+#include <event2/buffer.h>
+#include <zlib.h>
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+/* Maximum file size (room for JS bundles and wasm) */
+#define MAX_FILE_SIZE (8 * 1024 * 1024)
+
+/*
+ * Compression is done once per load, so use the slowest, densest settings.
+ * Brotli's densest level is too slow for multi-megabyte bundles.
+ */
+#define GZIP_LEVEL      9
+#define GZIP_WINDOW     (15 + 16)   /* 32KB window, gzip wrapper */
+#define GZIP_MEMLEVEL   9
+#ifdef HAVE_BROTLI
+#define BROTLI_QUALITY  11
+#define BROTLI_QUALITY_LARGE    6
+#define BROTLI_LARGE_SIZE       (1024 * 1024)
+#endif
+
+static const char *encoding_names[STATIC_ENCODING_COUNT] = {
+    NULL, "gzip", "br"
+};
+
+/*
+ * Content types by extension. Formats that are already compressed are
+ * not worth precompressing.
+ */
+static const struct {
+    const char *ext;
+    const char *type;
+    bool compress;
+} mime_types[] = {
+    { "html",        "text/html; charset=utf-8",        true },
+    { "htm",         "text/html; charset=utf-8",        true },
+    { "css",         "text/css; charset=utf-8",         true },
+    { "js",          "text/javascript; charset=utf-8",  true },
+    { "mjs",         "text/javascript; charset=utf-8",  true },
+    { "json",        "application/json",                true },
+    { "map",         "application/json",                true },
+    { "webmanifest", "application/manifest+json",       true },
+    { "txt",         "text/plain; charset=utf-8",       true },
+    { "xml",         "application/xml",                 true },
+    { "svg",         "image/svg+xml",                   true },
+    { "ico",         "image/x-icon",                    true },
+    { "wasm",        "application/wasm",                true },
+    { "ttf",         "font/ttf",                        true },
+    { "otf",         "font/otf",                        true },
+    { "woff",        "font/woff",                       false },
+    { "woff2",       "font/woff2",                      false },
+    { "png",         "image/png",                       false },
+    { "jpg",         "image/jpeg",                      false },
+    { "jpeg",        "image/jpeg",                      false },
+    { "gif",         "image/gif",                       false },
+    { "webp",        "image/webp",                      false },
+    { "avif",        "image/avif",                      false },
+};
+
+#define DEFAULT_CONTENT_TYPE    "application/octet-stream"
+
+/* Pages served by role; they get no URL of their own */
+#define PAGE_INDEX      "index.html"
+#define PAGE_BROADCAST  "broadcast.html"
+#define PAGE_RESULT     "result.html"
+#define PAGE_ERROR      "error.html"
+
+static const char *content_type_for(const char *name, bool *compress)
+{
+    const char *dot = strrchr(name, '.');
+
+    if (dot) {
+        for (size_t i = 0; i < sizeof(mime_types) / sizeof(mime_types[0]); i++) {
+            if (strcasecmp(dot + 1, mime_types[i].ext) == 0) {
+                *compress = mime_types[i].compress;
+                return mime_types[i].type;
+            }
+        }
+    }
+    *compress = false;
+    return DEFAULT_CONTENT_TYPE;
+}
+
+/* ========== Compressed Variants ========== */
+
+static int compress_gzip(const char *data, size_t len, char **out, size_t *out_len)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+
+    if (deflateInit2(&zs, GZIP_LEVEL, Z_DEFLATED, GZIP_WINDOW, GZIP_MEMLEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        return -1;
+    }
+
+    size_t cap = deflateBound(&zs, (uLong)len);
+    char *buf = malloc(cap);
+    if (!buf) {
+        deflateEnd(&zs);
+        return -1;
+    }
+
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    zs.next_out = (Bytef *)buf;
+    zs.avail_out = (uInt)cap;
+
+    int rc = deflate(&zs, Z_FINISH);
+    size_t produced = zs.total_out;
+    deflateEnd(&zs);
+
+    if (rc != Z_STREAM_END) {
+        free(buf);
+        return -1;
+    }
+
+    *out = buf;
+    *out_len = produced;
+    return 0;
+}
+
+#ifdef HAVE_BROTLI
+static int compress_brotli(const char *data, size_t len, char **out, size_t *out_len)
+{
+    size_t cap = BrotliEncoderMaxCompressedSize(len);
+    char *buf = malloc(cap);
+    if (!buf) return -1;
+
+    size_t produced = cap;
+    int quality = len > BROTLI_LARGE_SIZE ? BROTLI_QUALITY_LARGE : BROTLI_QUALITY;
+    if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC,
+                               len, (const uint8_t *)data, &produced, (uint8_t *)buf)) {
+        free(buf);
+        return -1;
+    }
+
+    *out = buf;
+    *out_len = produced;
+    return 0;
+}
+#endif
+
+/*
+ * Copy the variants of an identical file from the table being replaced,
+ * so a reload only compresses what changed. Returns 0 if one was found.
+ */
+static int reuse_variants(StaticFile *file, const StaticFiles *previous)
+{
+    for (size_t i = 0; previous && i < previous->count; i++) {
+        const StaticFile *old = &previous->assets[i];
+
+        if (old->length != file->length ||
+            memcmp(old->content, file->content, file->length) != 0) {
+            continue;
+        }
+        for (int e = STATIC_ENCODING_GZIP; e < STATIC_ENCODING_COUNT; e++) {
+            if (!old->encoded[e]) continue;
+            file->encoded[e] = malloc(old->encoded_length[e]);
+            if (!file->encoded[e]) continue;
+            memcpy(file->encoded[e], old->encoded[e], old->encoded_length[e]);
+            file->encoded_length[e] = old->encoded_length[e];
+        }
+        return 0;
+    }
+    return -1;
+}
+
+/*
+ * Build the compressed variants of a loaded file. A variant that fails
+ * or is no smaller than the raw bytes is dropped; the page is still
+ * served uncompressed, so this never fails the load.
+ */
+static void build_variants(StaticFile *file, const char *path, const StaticFiles *previous)
+{
+    if (reuse_variants(file, previous) == 0) {
+        log_debug("Unchanged %s: reusing its compressed variants", path);
+        return;
+    }
+
+    for (int e = STATIC_ENCODING_GZIP; e < STATIC_ENCODING_COUNT; e++) {
+        char *out = NULL;
+        size_t out_len = 0;
+        int rc = -1;
+
+        if (e == STATIC_ENCODING_GZIP) {
+            rc = compress_gzip(file->content, file->length, &out, &out_len);
+        }
+#ifdef HAVE_BROTLI
+        if (e == STATIC_ENCODING_BROTLI) {
+            rc = compress_brotli(file->content, file->length, &out, &out_len);
+        }
+#endif
+        if (rc < 0) continue;
+
+        if (out_len >= file->length) {
+            free(out);
+            continue;
+        }
+
+        file->encoded[e] = out;
+        file->encoded_length[e] = out_len;
+        log_debug("Compressed %s: %s %zu -> %zu bytes", path, encoding_names[e],
+                  file->length, out_len);
+    }
+}
+
+/* ========== Validators ========== */
+
+static const char *etag_suffixes[STATIC_ENCODING_COUNT] = {
+    "", "-gzip", "-br"
+};
+
+/*
+ * Strong ETags: the first 64 bits of SHA-256 over the raw bytes, with
+ * the coding appended so every variant has its own tag.
+ */
+static void build_validators(StaticFile *file, time_t mtime)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint8_t digest[SHA256_DIGEST_LEN];
+    char hash[17];
+    SHA256Ctx ctx;
+    struct tm tm;
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, file->content, file->length);
+    sha256_final(&ctx, digest);
+    for (int i = 0; i < 8; i++) {
+        hash[i * 2] = hex[digest[i] >> 4];
+        hash[i * 2 + 1] = hex[digest[i] & 0xf];
+    }
+    hash[16] = '\0';
+
+    for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+        snprintf(file->etag[e], sizeof(file->etag[e]), "\"%s%s\"", hash, etag_suffixes[e]);
+    }
+
+    file->last_modified = mtime;
+    gmtime_r(&mtime, &tm);
+    strftime(file->last_modified_text, sizeof(file->last_modified_text),
+             "%a, %d %b %Y %H:%M:%S GMT", &tm);
+}
+
+time_t static_parse_http_date(const char *value, size_t len)
+{
+    char date[64];
+    struct tm tm;
+
+    while (len > 0 && (*value == ' ' || *value == '\t')) {
+        value++;
+        len--;
+    }
+    if (len == 0 || len >= sizeof(date)) return -1;
+    memcpy(date, value, len);
+    date[len] = '\0';
+
+    memset(&tm, 0, sizeof(tm));
+    const char *end = strptime(date, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if (!end) return -1;
+    while (*end == ' ' || *end == '\t') end++;
+    if (*end != '\0') return -1;
+
+    return timegm(&tm);
+}
+
+/*
+ * Weak comparison of each entity-tag in an If-None-Match list against
+ * etag ("W/" prefixes are ignored, "*" matches anything).
+ */
+static bool etag_list_matches(const char *list, const char *etag)
+{
+    size_t etag_len = strlen(etag);
+    const char *p = list;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p == '\0') break;
+        if (*p == '*') return true;
+        if (p[0] == 'W' && p[1] == '/') p += 2;
+
+        const char *tag = p;
+        if (*p == '"') {
+            p++;
+            while (*p && *p != '"') p++;
+            if (*p == '"') p++;
+        }
+        if ((size_t)(p - tag) == etag_len && memcmp(tag, etag, etag_len) == 0) {
+            return true;
+        }
+        while (*p && *p != ',') p++;
+    }
+    return false;
+}
+
+bool static_file_not_modified(const StaticFile *file, StaticEncoding encoding,
+                              const char *if_none_match, time_t if_modified_since)
+{
+    if (file->status_code != 200) return false;
+
+    if (if_none_match) {
+        return etag_list_matches(if_none_match, file->etag[encoding]);
+    }
+    return if_modified_since >= 0 && file->last_modified <= if_modified_since;
+}
+
+/* ========== Prebuilt Response Heads ========== */
+
+/*
+ * Format one head into a heap copy. not_modified gives the 304 form,
+ * which carries the validators and caching headers but no Content-*.
+ */
+static char *format_head(const StaticFile *file, int encoding, int keep_alive,
+                         int not_modified, const char *cache_control, size_t *head_len)
+{
+    char head[768];
+    char encoding_line[64] = "";
+    char validators[160] = "";
+    size_t body_len = file->length;
+    int len;
+
+    if (encoding != STATIC_ENCODING_IDENTITY) {
+        body_len = file->encoded_length[encoding];
+        snprintf(encoding_line, sizeof(encoding_line),
+                 "Content-Encoding: %s\r\n", encoding_names[encoding]);
+    }
+    if (file->status_code == 200) {
+        snprintf(validators, sizeof(validators), "ETag: %s\r\nLast-Modified: %s\r\n",
+                 file->etag[encoding], file->last_modified_text);
+    }
+
+    if (not_modified) {
+        len = snprintf(head, sizeof(head),
+            "HTTP/1.1 304 Not Modified\r\n"
+            "Vary: Accept-Encoding\r\n"
+            "%s"
+            "Cache-Control: %s\r\n"
+            "Connection: %s\r\n"
+            "X-Request-ID: ",
+            validators, cache_control, keep_alive ? "keep-alive" : "close");
+    } else {
+        len = snprintf(head, sizeof(head),
+            "HTTP/1.1 %d %s\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Length: %zu\r\n"
+            "Vary: Accept-Encoding\r\n"
+            "%s"
+            "%s"
+            "Cache-Control: %s\r\n"
+            "Connection: %s\r\n"
+            "X-Request-ID: ",
+            file->status_code, file->status_text, file->content_type, body_len,
+            encoding_line, validators, cache_control, keep_alive ? "keep-alive" : "close");
+    }
+    if (len < 0 || (size_t)len >= sizeof(head)) return NULL;
+
+    char *copy = malloc((size_t)len);
+    if (!copy) return NULL;
+    memcpy(copy, head, (size_t)len);
+    *head_len = (size_t)len;
+    return copy;
+}
 
 /*
- * Load a single file into memory.
+ * Format every HTTP/1.1 head the file can be served with. Everything but
+ * the request ID is fixed once the file and config are loaded.
+ */
+static int build_heads(StaticFile *file, const char *cache_control)
+{
+    for (int keep_alive = 0; keep_alive <= 1; keep_alive++) {
+        for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+            if (e != STATIC_ENCODING_IDENTITY && !file->encoded[e]) continue;
+
+            file->head[keep_alive][e] = format_head(file, e, keep_alive, 0, cache_control,
+                                                    &file->head_length[keep_alive][e]);
+            if (!file->head[keep_alive][e]) return -1;
+
+            if (file->status_code != 200) continue;
+            file->not_modified_head[keep_alive][e] =
+                format_head(file, e, keep_alive, 1, cache_control,
+                            &file->not_modified_head_length[keep_alive][e]);
+            if (!file->not_modified_head[keep_alive][e]) return -1;
+        }
+    }
+    return 0;
+}
+
+/* evbuffer cleanup: a queued head or body has been sent */
+static void release_reference(const void *data, size_t len, void *extra)
+{
+    (void)data;
+    (void)len;
+    static_files_unref(extra);
+}
+
+int static_file_write_response(struct evbuffer *output, const StaticFile *file,
+                               StaticEncoding encoding, bool keep_alive,
+                               bool not_modified, const char *request_id)
+{
+    const char *head = file->head[keep_alive][encoding];
+    size_t head_len = file->head_length[keep_alive][encoding];
+    const char *body = file->content;
+    size_t body_len = file->length;
+    char tail[64];
+
+    if (not_modified) {
+        head = file->not_modified_head[keep_alive][encoding];
+        head_len = file->not_modified_head_length[keep_alive][encoding];
+        body_len = 0;
+    } else if (encoding != STATIC_ENCODING_IDENTITY) {
+        body = file->encoded[encoding];
+        body_len = file->encoded_length[encoding];
+    }
+
+    /* The request ID and the blank line are the only per-response bytes */
+    size_t id_len = strnlen(request_id, sizeof(tail) - 4);
+    memcpy(tail, request_id, id_len);
+    memcpy(tail + id_len, "\r\n\r\n", 4);
+
+    if (evbuffer_add_reference(output, head, head_len, release_reference,
+                               static_files_ref(file->owner)) < 0) {
+        static_files_unref(file->owner);
+        return -1;
+    }
+    if (evbuffer_add(output, tail, id_len + 4) < 0) {
+        return -1;
+    }
+    if (body_len > 0 &&
+        evbuffer_add_reference(output, body, body_len, release_reference,
+                               static_files_ref(file->owner)) < 0) {
+        static_files_unref(file->owner);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Load a single file into memory, with its compressed variants and
+ * response heads.
  * Returns 0 on success, -1 on error.
  */
-static int load_file(StaticFile *file, const char *path, const char *content_type)
+static int load_file(StaticFile *file, const char *path, int status_code,
+                     const char *status_text, const char *cache_control,
+                     const StaticFiles *previous)
 {
     struct stat st;
     int fd = -1;
     char *content = NULL;
+    bool compress;
 
-    file->content = NULL;
-    file->length = 0;
-    file->content_type = content_type;
+    memset(file, 0, sizeof(*file));
+    file->content_type = content_type_for(path, &compress);
+    file->status_code = status_code;
+    file->status_text = status_text;
 
     /* Get file size */
     if (stat(path, &st) < 0) {
@@ -75,7 +518,19 @@ static int load_file(StaticFile *file, const char *path, const char *content_typ
     file->content = content;
     file->length = (size_t)total;
 
-    log_info("Loaded %s (%zu bytes)", path, file->length);
+    if (compress) {
+        build_variants(file, path, previous);
+    }
+    build_validators(file, st.st_mtime);
+
+    if (build_heads(file, cache_control) < 0) {
+        log_error("Failed to allocate response headers for %s", path);
+        return -1;
+    }
+
+    log_info("Loaded %s (%zu bytes, gzip %zu, br %zu)", path, file->length,
+             file->encoded_length[STATIC_ENCODING_GZIP],
+             file->encoded_length[STATIC_ENCODING_BROTLI]);
     return 0;
 }
 
@@ -89,75 +544,834 @@ static void free_file(StaticFile *file)
         file->content = NULL;
     }
     file->length = 0;
+    free(file->url);
+    file->url = NULL;
+
+    for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+        free(file->encoded[e]);
+        file->encoded[e] = NULL;
+        file->encoded_length[e] = 0;
+
+        for (int keep_alive = 0; keep_alive <= 1; keep_alive++) {
+            free(file->head[keep_alive][e]);
+            file->head[keep_alive][e] = NULL;
+            file->head_length[keep_alive][e] = 0;
+            free(file->not_modified_head[keep_alive][e]);
+            file->not_modified_head[keep_alive][e] = NULL;
+            file->not_modified_head_length[keep_alive][e] = 0;
+        }
+    }
 }
 
-int static_files_load(StaticFiles *files, const char *dir, const Config *config)
+/* ========== Asset Table ========== */
+
+/*
+ * URL for a file at rel (relative to the static directory), or NULL for
+ * pages that are only served by role.
+ */
+static char *url_for(const char *rel)
 {
-    char path[512];
+    size_t len = strlen(rel);
+    char *url;
+
+    if (strcmp(rel, PAGE_BROADCAST) == 0 || strcmp(rel, PAGE_RESULT) == 0 ||
+        strcmp(rel, PAGE_ERROR) == 0) {
+        return NULL;
+    }
+    if (strcmp(rel, PAGE_INDEX) == 0) {
+        return strdup("/");
+    }
 
-    (void)config; /* No longer used for banner injection */
+    /* Top-level pages are addressed without ".html" (/docs) */
+    if (!strchr(rel, '/') && len > 5 && strcmp(rel + len - 5, ".html") == 0) {
+        len -= 5;
+    }
 
-    memset(files, 0, sizeof(StaticFiles));
+    url = malloc(len + 2);
+    if (!url) return NULL;
+    url[0] = '/';
+    memcpy(url + 1, rel, len);
+    url[len + 1] = '\0';
+    return url;
+}
+
+/*
+ * Directory scan state. Role pages are remembered by index because the
+ * asset array moves while it grows.
+ */
+typedef struct {
+    const StaticFiles *previous; /* Table being replaced, or NULL */
+    size_t capacity;
+    long page[4];               /* index, broadcast, result, error; -1 = absent */
+} ScanState;
+
+static const char *const page_names[4] = {
+    PAGE_INDEX, PAGE_BROADCAST, PAGE_RESULT, PAGE_ERROR
+};
+
+/*
+ * Load one file into the asset array, growing it as needed.
+ */
+static int add_asset(StaticFiles *files, ScanState *scan, const char *path,
+                     const char *rel)
+{
+    size_t *capacity = &scan->capacity;
+
+    if (files->count == STATIC_MAX_ASSETS) {
+        log_warn("Static asset limit (%d) reached, skipping %s", STATIC_MAX_ASSETS, path);
+        return 0;
+    }
+    if (files->count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 16;
+        StaticFile *assets = realloc(files->assets, grown * sizeof(StaticFile));
+        if (!assets) return -1;
+        files->assets = assets;
+        *capacity = grown;
+    }
+
+    StaticFile *file = &files->assets[files->count];
+    bool is_error = strcmp(rel, PAGE_ERROR) == 0;
+    if (load_file(file, path, is_error ? 404 : 200, is_error ? "Not Found" : "OK",
+                  files->cache_control, scan->previous) < 0) {
+        free_file(file);
+        return -1;
+    }
+    files->count++;
+
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(rel, page_names[i]) == 0) {
+            scan->page[i] = (long)files->count - 1;
+        }
+    }
+
+    bool role_only = strcmp(rel, PAGE_BROADCAST) == 0 || strcmp(rel, PAGE_RESULT) == 0 ||
+                     is_error;
+    if (!role_only) {
+        file->url = url_for(rel);
+        if (!file->url) return -1;
+        file->url_len = strlen(file->url);
+    }
+    return 0;
+}
+
+/*
+ * Load every regular file under dir/rel, recursing into subdirectories.
+ */
+static int scan_dir(StaticFiles *files, ScanState *scan, const char *dir,
+                    const char *rel, int depth)
+{
+    char path[1024];
+    DIR *d;
+    struct dirent *ent;
+    int rc = 0;
+
+    snprintf(path, sizeof(path), "%s%s%s", dir, rel[0] ? "/" : "", rel);
+    d = opendir(path);
+    if (!d) {
+        log_error("Failed to open static directory %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    while (rc == 0 && (ent = readdir(d)) != NULL) {
+        char child_rel[512];
+        char child_path[1024];
+        struct stat st;
+
+        if (ent->d_name[0] == '.') continue;
+
+        if (snprintf(child_rel, sizeof(child_rel), "%s%s%s", rel, rel[0] ? "/" : "",
+                     ent->d_name) >= (int)sizeof(child_rel)) {
+            log_warn("Static path too long, skipping %s/%s", path, ent->d_name);
+            continue;
+        }
+        snprintf(child_path, sizeof(child_path), "%s/%s", dir, child_rel);
+        if (stat(child_path, &st) < 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            if (depth < STATIC_MAX_DEPTH) {
+                rc = scan_dir(files, scan, dir, child_rel, depth + 1);
+            }
+        } else if (S_ISREG(st.st_mode)) {
+            if (st.st_size > MAX_FILE_SIZE) {
+                log_warn("Static file %s too large (%ld bytes, max %d), skipping",
+                         child_path, (long)st.st_size, MAX_FILE_SIZE);
+                continue;
+            }
+            rc = add_asset(files, scan, child_path, child_rel);
+        }
+    }
+
+    closedir(d);
+    return rc;
+}
+
+/*
+ * Free every asset and the route table.
+ */
+static void free_files(StaticFiles *files)
+{
+    /* Mapped files point into the image: only the index is ours */
+    for (size_t i = 0; !files->image && i < files->count; i++) {
+        free_file(&files->assets[i]);
+    }
+    free(files->assets);
+    route_table_free(&files->routes);
+    if (files->image) {
+        munmap(files->image, files->image_size);
+        files->image = NULL;
+    }
+    files->assets = NULL;
+    files->count = 0;
+    files->index = NULL;
+    files->broadcast = NULL;
+    files->result = NULL;
+    files->error = NULL;
+}
 
-    /* Load index.html */
-    snprintf(path, sizeof(path), "%s/index.html", dir);
-    if (load_file(&files->index, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+/*
+ * Point the role pages at their assets (page[] holds asset indexes, -1
+ * if absent) and build the route table. origin names the source in logs.
+ * Returns 0 on success, -1 on error (files is left for the caller to free).
+ */
+static int index_files(StaticFiles *files, const long page[4], const char *origin)
+{
+    StaticFile **pages[4] = { &files->index, &files->broadcast, &files->result, &files->error };
+
+    for (int i = 0; i < 4; i++) {
+        *pages[i] = page[i] >= 0 && (size_t)page[i] < files->count
+            ? &files->assets[page[i]] : NULL;
+    }
+    if (!files->broadcast || !files->result || !files->error) {
+        log_error("Static directory %s must contain %s, %s and %s", origin,
+                  PAGE_BROADCAST, PAGE_RESULT, PAGE_ERROR);
         return -1;
     }
 
-    /* Load broadcast.html */
-    snprintf(path, sizeof(path), "%s/broadcast.html", dir);
-    if (load_file(&files->broadcast, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+    if (route_table_init(&files->routes) < 0) {
         return -1;
     }
+    for (size_t i = 0; i < files->count; i++) {
+        StaticFile *file = &files->assets[i];
+        file->owner = files;
+        if (!file->url) continue;
 
-    /* Load result.html */
-    snprintf(path, sizeof(path), "%s/result.html", dir);
-    if (load_file(&files->result, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+        int rc = route_table_add(&files->routes, file->url, file->url_len,
+                                 ROUTE_STATIC, file);
+        if (rc < 0) {
+            return -1;
+        }
+        if (rc > 0) {
+            log_warn("Static asset %s shadowed by an existing route", file->url);
+        }
+    }
+    if (route_table_build(&files->routes) < 0) {
         return -1;
     }
 
-    /* Load error.html */
-    snprintf(path, sizeof(path), "%s/error.html", dir);
-    if (load_file(&files->error, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+    log_info("Loaded %zu static assets from %s (%zu routes, %s lookup)",
+             files->count, origin, files->routes.count,
+             files->routes.max_probe == 0 ? "perfect hash" : "probed hash");
+    return 0;
+}
+
+static int load_files(StaticFiles *files, const char *dir, const Config *config,
+                      const StaticFiles *previous)
+{
+    ScanState scan = { previous, 0, { -1, -1, -1, -1 } };
+
+    memset(files, 0, sizeof(StaticFiles));
+
+    if (config->cache_max_age > 0) {
+        snprintf(files->cache_control, sizeof(files->cache_control),
+                 "public, max-age=%d", config->cache_max_age);
+    } else {
+        snprintf(files->cache_control, sizeof(files->cache_control), "no-store");
+    }
+
+    if (scan_dir(files, &scan, dir, "", 0) < 0) {
+        free_files(files);
+        return -1;
+    }
+
+    /* The array no longer moves: take the role pages and build routes */
+    if (index_files(files, scan.page, dir) < 0) {
+        free_files(files);
+        return -1;
+    }
+    return 0;
+}
+
+StaticFiles *static_files_open(const char *dir, const Config *config,
+                               const StaticFiles *previous)
+{
+    StaticFiles *files = malloc(sizeof(StaticFiles));
+
+    if (!files) {
+        log_error("Failed to allocate static file table");
+        return NULL;
+    }
+    if (load_files(files, dir, config, previous) < 0) {
+        free(files);
+        return NULL;
+    }
+    files->refs = 1;
+    return files;
+}
+
+StaticFiles *static_files_ref(StaticFiles *files)
+{
+    files->refs++;
+    return files;
+}
+
+void static_files_unref(StaticFiles *files)
+{
+    if (!files || --files->refs > 0) {
+        return;
+    }
+    free_files(files);
+    free(files);
+}
+
+void static_files_inherit_stats(StaticFiles *files, const StaticFiles *old)
+{
+    for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+        files->responses[e] += old->responses[e];
+        files->bytes_sent[e] += old->bytes_sent[e];
+    }
+    files->bytes_saved += old->bytes_saved;
+    files->not_modified += old->not_modified;
+    files->not_modified_bytes += old->not_modified_bytes;
+
+    for (size_t i = 0; i < old->count; i++) {
+        const StaticFile *prev = &old->assets[i];
+        StaticFile *file;
+
+        if (!prev->url || prev->requests == 0) continue;
+        file = static_files_find(files, prev->url);
+        if (file) {
+            file->requests += prev->requests;
+        }
+    }
+}
+
+StaticFile *static_files_page(StaticFiles *files, RouteType route)
+{
+    switch (route) {
+        case ROUTE_BROADCAST: return files->broadcast;
+        case ROUTE_RESULT:    return files->result;
+        case ROUTE_ERROR:     return files->error;
+        default:              return NULL;
+    }
+}
+
+StaticFile *static_files_route(StaticFiles *files, const char *path, size_t path_len,
+                               RouteType *route)
+{
+    const void *data;
+
+    *route = route_request(&files->routes, path, path_len, &data);
+    if (*route == ROUTE_STATIC) {
+        return (StaticFile *)data;
+    }
+    return static_files_page(files, *route);
+}
+
+StaticFile *static_files_find(StaticFiles *files, const char *url)
+{
+    const void *data;
+
+    if (route_request(&files->routes, url, strlen(url), &data) != ROUTE_STATIC) {
+        return NULL;
+    }
+    return (StaticFile *)data;
+}
+
+/* ========== Shared Image ========== */
+
+#define IMAGE_MAGIC     "RRSTATIC"
+#define IMAGE_VERSION   1
+#define IMAGE_ALIGN     64      /* Blobs start on a cache line */
+
+typedef struct {
+    uint64_t offset;            /* 0 = absent (offset 0 is the header) */
+    uint64_t length;            /* Strings: excluding the stored NUL */
+} ImageSpan;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t size;
+    int64_t page[4];            /* index, broadcast, result, error; -1 = absent */
+    char cache_control[64];
+} ImageHeader;
+
+typedef struct {
+    ImageSpan url;
+    ImageSpan content_type;
+    ImageSpan status_text;
+    ImageSpan content;
+    ImageSpan encoded[STATIC_ENCODING_COUNT];
+    ImageSpan head[2][STATIC_ENCODING_COUNT];
+    ImageSpan not_modified_head[2][STATIC_ENCODING_COUNT];
+    int64_t last_modified;
+    int32_t status_code;
+    int32_t reserved;
+    char etag[STATIC_ENCODING_COUNT][STATIC_ETAG_LEN];
+    char last_modified_text[32];
+} ImageEntry;
+
+typedef struct {
+    char *base;                 /* NULL while sizing */
+    size_t pos;
+} ImageWriter;
+
+/* Sent on a worker channel, with the image fd attached when ok */
+typedef struct {
+    uint32_t generation;
+    int32_t ok;
+} ImageNotice;
+
+static size_t align_up(size_t n, size_t align)
+{
+    return (n + align - 1) & ~(align - 1);
+}
+
+/* Place a blob (followed by a NUL if terminate) in the data area */
+static ImageSpan image_put(ImageWriter *w, const void *data, size_t len, bool terminate)
+{
+    ImageSpan span = { 0, 0 };
+
+    if (!data) return span;
+    span.offset = align_up(w->pos, IMAGE_ALIGN);
+    span.length = len;
+    if (w->base) {
+        memcpy(w->base + span.offset, data, len);
+        if (terminate) w->base[span.offset + len] = '\0';
+    }
+    w->pos = span.offset + len + (terminate ? 1 : 0);
+    return span;
+}
+
+static int64_t page_index(const StaticFiles *files, const StaticFile *page)
+{
+    return page ? (int64_t)(page - files->assets) : -1;
+}
+
+/*
+ * Lay files out: header, entries, then the data area from the first page
+ * boundary. With w->base NULL only the size (w->pos) is computed.
+ */
+static void image_layout(const StaticFiles *files, ImageWriter *w)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    ImageEntry *entries = w->base ? (ImageEntry *)(w->base + sizeof(ImageHeader)) : NULL;
+
+    w->pos = align_up(sizeof(ImageHeader) + files->count * sizeof(ImageEntry), page_size);
+
+    for (size_t i = 0; i < files->count; i++) {
+        const StaticFile *file = &files->assets[i];
+        ImageEntry entry;
+
+        memset(&entry, 0, sizeof(entry));
+        entry.url = image_put(w, file->url, file->url_len, true);
+        entry.content_type = image_put(w, file->content_type, strlen(file->content_type), true);
+        entry.status_text = image_put(w, file->status_text, strlen(file->status_text), true);
+        entry.content = image_put(w, file->content, file->length, true);
+        for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+            entry.encoded[e] = image_put(w, file->encoded[e], file->encoded_length[e], false);
+            for (int k = 0; k < 2; k++) {
+                entry.head[k][e] = image_put(w, file->head[k][e], file->head_length[k][e], false);
+                entry.not_modified_head[k][e] =
+                    image_put(w, file->not_modified_head[k][e],
+                              file->not_modified_head_length[k][e], false);
+            }
+        }
+        entry.last_modified = file->last_modified;
+        entry.status_code = file->status_code;
+        memcpy(entry.etag, file->etag, sizeof(entry.etag));
+        memcpy(entry.last_modified_text, file->last_modified_text,
+               sizeof(entry.last_modified_text));
+        if (entries) {
+            entries[i] = entry;
+        }
+    }
+    w->pos = align_up(w->pos, page_size);
+
+    if (w->base) {
+        ImageHeader *header = (ImageHeader *)w->base;
+        memcpy(header->magic, IMAGE_MAGIC, sizeof(header->magic));
+        header->version = IMAGE_VERSION;
+        header->count = (uint32_t)files->count;
+        header->size = w->pos;
+        header->page[0] = page_index(files, files->index);
+        header->page[1] = page_index(files, files->broadcast);
+        header->page[2] = page_index(files, files->result);
+        header->page[3] = page_index(files, files->error);
+        memcpy(header->cache_control, files->cache_control, sizeof(header->cache_control));
+    }
+}
+
+/* A memfd where available, otherwise an unlinked temporary file */
+static int image_open_fd(void)
+{
+    int fd;
+
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+    fd = memfd_create("rawrelay-static", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd >= 0) {
+        return fd;
+    }
+    log_debug("memfd_create failed (%s), using a temporary file", strerror(errno));
+#endif
+
+    FILE *tmp = tmpfile();
+    if (!tmp) {
+        log_error("Failed to create static image file: %s", strerror(errno));
         return -1;
     }
+    fd = dup(fileno(tmp));
+    fclose(tmp);
+    return fd;
+}
 
-    /* Load docs.html */
-    snprintf(path, sizeof(path), "%s/docs.html", dir);
-    if (load_file(&files->docs, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+int static_image_create(const StaticFiles *files)
+{
+    ImageWriter w = { NULL, 0 };
+    size_t size;
+    int fd;
+
+    image_layout(files, &w);
+    size = w.pos;
+
+    fd = image_open_fd();
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) < 0) {
+        log_error("Failed to size static image (%zu bytes): %s", size, strerror(errno));
+        close(fd);
         return -1;
     }
 
-    /* Load status.html */
-    snprintf(path, sizeof(path), "%s/status.html", dir);
-    if (load_file(&files->status, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+    w.base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (w.base == MAP_FAILED) {
+        log_error("Failed to map static image: %s", strerror(errno));
+        close(fd);
         return -1;
     }
+    image_layout(files, &w);
+    munmap(w.base, size);
+
+#ifdef F_ADD_SEALS
+    /* Read-only from here on (memfd only; a temporary file cannot be sealed) */
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+
+    log_info("Built static image: %zu assets, %zu KB", files->count, size / 1024);
+    return fd;
+}
+
+static bool span_valid(ImageSpan span, size_t size, bool terminated)
+{
+    size_t end = span.offset + span.length + (terminated ? 1 : 0);
+    return span.offset == 0 ||
+           (span.offset < size && span.length < size && end <= size);
+}
+
+static char *span_ptr(char *base, ImageSpan span)
+{
+    return span.offset ? base + span.offset : NULL;
+}
+
+/* Point file into the image. Returns -1 if a span is out of bounds. */
+static int map_entry(StaticFile *file, const ImageEntry *entry, char *base, size_t size)
+{
+    bool ok = span_valid(entry->url, size, true) &&
+              span_valid(entry->content_type, size, true) && entry->content_type.offset &&
+              span_valid(entry->status_text, size, true) && entry->status_text.offset &&
+              span_valid(entry->content, size, true) && entry->content.offset;
+
+    for (int e = 0; ok && e < STATIC_ENCODING_COUNT; e++) {
+        ok = span_valid(entry->encoded[e], size, false);
+        for (int k = 0; ok && k < 2; k++) {
+            ok = span_valid(entry->head[k][e], size, false) &&
+                 span_valid(entry->not_modified_head[k][e], size, false);
+        }
+    }
+    if (!ok) return -1;
+
+    file->url = span_ptr(base, entry->url);
+    file->url_len = entry->url.length;
+    file->content_type = span_ptr(base, entry->content_type);
+    file->status_text = span_ptr(base, entry->status_text);
+    file->content = span_ptr(base, entry->content);
+    file->length = entry->content.length;
+    for (int e = 0; e < STATIC_ENCODING_COUNT; e++) {
+        file->encoded[e] = span_ptr(base, entry->encoded[e]);
+        file->encoded_length[e] = entry->encoded[e].length;
+        for (int k = 0; k < 2; k++) {
+            file->head[k][e] = span_ptr(base, entry->head[k][e]);
+            file->head_length[k][e] = entry->head[k][e].length;
+            file->not_modified_head[k][e] = span_ptr(base, entry->not_modified_head[k][e]);
+            file->not_modified_head_length[k][e] = entry->not_modified_head[k][e].length;
+        }
+    }
+    file->last_modified = (time_t)entry->last_modified;
+    file->status_code = entry->status_code;
+    memcpy(file->etag, entry->etag, sizeof(file->etag));
+    memcpy(file->last_modified_text, entry->last_modified_text,
+           sizeof(file->last_modified_text));
+    file->last_modified_text[sizeof(file->last_modified_text) - 1] = '\0';
+    return 0;
+}
+
+StaticFiles *static_files_map(int fd)
+{
+    struct stat st;
+    StaticFiles *files;
+    const ImageHeader *header;
+    const ImageEntry *entries;
+    long page[4];
+    char *base;
+    size_t size;
+
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ImageHeader)) {
+        log_error("Static image is missing or truncated");
+        return NULL;
+    }
+    size = (size_t)st.st_size;
+
+    base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        log_error("Failed to map static image: %s", strerror(errno));
+        return NULL;
+    }
+
+    header = (const ImageHeader *)base;
+    entries = (const ImageEntry *)(base + sizeof(ImageHeader));
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != IMAGE_VERSION || header->size != size ||
+        header->count > STATIC_MAX_ASSETS ||
+        sizeof(ImageHeader) + header->count * sizeof(ImageEntry) > size) {
+        log_error("Static image is invalid");
+        munmap(base, size);
+        return NULL;
+    }
+
+    files = calloc(1, sizeof(StaticFiles));
+    if (!files || !(files->assets = calloc(header->count + 1, sizeof(StaticFile)))) {
+        log_error("Failed to allocate static file index");
+        free(files);
+        munmap(base, size);
+        return NULL;
+    }
+    files->image = base;
+    files->image_size = size;
+    memcpy(files->cache_control, header->cache_control, sizeof(files->cache_control));
+    files->cache_control[sizeof(files->cache_control) - 1] = '\0';
+
+    for (uint32_t i = 0; i < header->count; i++) {
+        if (map_entry(&files->assets[i], &entries[i], base, size) < 0) {
+            log_error("Static image entry %u is out of bounds", i);
+            free_files(files);
+            free(files);
+            return NULL;
+        }
+        files->count++;
+    }
+    for (int i = 0; i < 4; i++) {
+        page[i] = (long)header->page[i];
+    }
+
+    if (index_files(files, page, "shared image") < 0) {
+        free_files(files);
+        free(files);
+        return NULL;
+    }
+    files->refs = 1;
+    return files;
+}
 
-    /* Load logos.html */
-    snprintf(path, sizeof(path), "%s/logos.html", dir);
-    if (load_file(&files->logos, path, "text/html; charset=utf-8") < 0) {
-        static_files_free(files);
+int static_image_send(int channel, uint32_t generation, int fd)
+{
+    ImageNotice notice = { generation, fd >= 0 };
+    struct iovec iov = { &notice, sizeof(notice) };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (fd >= 0) {
+        struct cmsghdr *cmsg;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    return sendmsg(channel, &msg, MSG_DONTWAIT) == (ssize_t)sizeof(notice) ? 0 : -1;
+}
+
+int static_image_recv(int channel, uint32_t *generation, int *fd)
+{
+    ImageNotice notice;
+    struct iovec iov = { &notice, sizeof(notice) };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg;
+    ssize_t n;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    *fd = -1;
+    n = recvmsg(channel, &msg, MSG_DONTWAIT);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    }
+    if (n == 0) {
         return -1;
     }
 
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    if (n != (ssize_t)sizeof(notice) || !notice.ok) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    *generation = notice.generation;
+    return 1;
+}
+
+/* ========== Content Negotiation ========== */
+
+/*
+ * True if an Accept-Encoding parameter list (after the coding) sets q=0.
+ */
+static int quality_is_zero(const char *p, const char *end)
+{
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ';')) p++;
+        if (end - p >= 2 && (p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+            p += 2;
+            if (p == end || *p != '0') return 0;
+            for (p++; p < end && *p != ';'; p++) {
+                if (*p != '.' && *p != '0' && *p != ' ' && *p != '\t') return 0;
+            }
+            return 1;
+        }
+        while (p < end && *p != ';') p++;
+    }
     return 0;
 }
 
-void static_files_free(StaticFiles *files)
+unsigned static_accept_encodings(const char *value, size_t len)
+{
+    const char *p = value;
+    const char *end = value + len;
+    unsigned accepted = 0;
+    unsigned listed = 0;
+    int wildcard = 0;
+
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) p++;
+        const char *token = p;
+        while (p < end && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+        size_t token_len = (size_t)(p - token);
+        const char *params = p;
+        while (p < end && *p != ',') p++;
+
+        if (token_len == 0) continue;
+        int refused = quality_is_zero(params, p);
+        unsigned bit = 0;
+
+        if ((token_len == 4 && strncasecmp(token, "gzip", 4) == 0) ||
+            (token_len == 6 && strncasecmp(token, "x-gzip", 6) == 0)) {
+            bit = STATIC_ACCEPT_GZIP;
+        } else if (token_len == 2 && strncasecmp(token, "br", 2) == 0) {
+            bit = STATIC_ACCEPT_BROTLI;
+        } else if (token_len == 1 && *token == '*') {
+            wildcard = refused ? -1 : 1;
+            continue;
+        } else {
+            continue;
+        }
+
+        listed |= bit;
+        if (refused) {
+            accepted &= ~bit;
+        } else {
+            accepted |= bit;
+        }
+    }
+
+    if (wildcard > 0) {
+        accepted |= (STATIC_ACCEPT_GZIP | STATIC_ACCEPT_BROTLI) & ~listed;
+    }
+    return accepted;
+}
+
+StaticEncoding static_file_select(const StaticFile *file, unsigned accepted,
+                                  const char **body, size_t *len)
+{
+    StaticEncoding chosen = STATIC_ENCODING_IDENTITY;
+    size_t best = file->length;
+
+    for (int e = STATIC_ENCODING_GZIP; e < STATIC_ENCODING_COUNT; e++) {
+        if ((accepted & (1u << e)) && file->encoded[e] && file->encoded_length[e] < best) {
+            chosen = (StaticEncoding)e;
+            best = file->encoded_length[e];
+        }
+    }
+
+    if (chosen == STATIC_ENCODING_IDENTITY) {
+        *body = file->content;
+        *len = file->length;
+    } else {
+        *body = file->encoded[chosen];
+        *len = file->encoded_length[chosen];
+    }
+    return chosen;
+}
+
+void static_files_count(StaticFiles *files, StaticFile *file,
+                        StaticEncoding encoding, bool not_modified)
+{
+    size_t len = encoding == STATIC_ENCODING_IDENTITY ? file->length
+                                                      : file->encoded_length[encoding];
+
+    file->requests++;
+
+    if (not_modified) {
+        files->not_modified++;
+        files->not_modified_bytes += len;
+        return;
+    }
+    files->responses[encoding]++;
+    files->bytes_sent[encoding] += len;
+    files->bytes_saved += file->length - len;
+}
+
+const char *static_encoding_name(StaticEncoding encoding)
 {
-    free_file(&files->index);
-    free_file(&files->broadcast);
-    free_file(&files->result);
-    free_file(&files->error);
-    free_file(&files->docs);
-    free_file(&files->status);
-    free_file(&files->logos);
+    return encoding < STATIC_ENCODING_COUNT ? encoding_names[encoding] : NULL;
 }
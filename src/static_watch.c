@@ -0,0 +1,132 @@
+#include "static_watch.h"
+#include "static_files.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | \
+                    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+/*
+ * Watch path and its subdirectories. Directories already watched keep
+ * their watch (inotify_add_watch() returns the existing one).
+ */
+static void add_watches(StaticWatch *watch, const char *path, int depth)
+{
+    DIR *d;
+    struct dirent *ent;
+
+    if (inotify_add_watch(watch->fd, path, WATCH_MASK | IN_ONLYDIR) < 0) {
+        log_warn("Cannot watch %s: %s", path, strerror(errno));
+        return;
+    }
+    if (depth >= STATIC_MAX_DEPTH || !(d = opendir(path))) {
+        return;
+    }
+
+    while ((ent = readdir(d)) != NULL) {
+        char child[1024];
+        struct stat st;
+
+        if (ent->d_name[0] == '.') continue;
+        if (snprintf(child, sizeof(child), "%s/%s", path, ent->d_name) >= (int)sizeof(child)) {
+            continue;
+        }
+        if (stat(child, &st) == 0 && S_ISDIR(st.st_mode)) {
+            add_watches(watch, child, depth + 1);
+        }
+    }
+    closedir(d);
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+int static_watch_open(StaticWatch *watch, const char *dir)
+{
+    memset(watch, 0, sizeof(*watch));
+    snprintf(watch->dir, sizeof(watch->dir), "%s", dir);
+
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0) {
+        log_warn("inotify unavailable (%s), static files will not hot reload",
+                 strerror(errno));
+        return -1;
+    }
+
+    add_watches(watch, watch->dir, 0);
+    log_debug("Watching %s for static file changes", watch->dir);
+    return 0;
+}
+
+bool static_watch_poll(StaticWatch *watch)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+
+    if (watch->fd < 0) {
+        return false;
+    }
+
+    /* Only the fact that something changed matters: drain and debounce */
+    while ((n = read(watch->fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            if (!(ev->mask & IN_IGNORED) && !(ev->len > 0 && ev->name[0] == '.')) {
+                watch->pending = true;
+                watch->changed_ms = now_ms();
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+
+    if (!watch->pending || now_ms() - watch->changed_ms < STATIC_WATCH_SETTLE_MS) {
+        return false;
+    }
+
+    /* Quiet long enough. Pick up new subdirectories, or the directory replaced */
+    watch->pending = false;
+    add_watches(watch, watch->dir, 0);
+    return true;
+}
+
+#else /* !__linux__ */
+
+int static_watch_open(StaticWatch *watch, const char *dir)
+{
+    (void)dir;
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+    log_info("Static file hot reload needs inotify (Linux); use SIGHUP to reload");
+    return -1;
+}
+
+bool static_watch_poll(StaticWatch *watch)
+{
+    (void)watch;
+    return false;
+}
+
+#endif /* __linux__ */
+
+void static_watch_close(StaticWatch *watch)
+{
+    if (watch->fd >= 0) {
+        close(watch->fd);
+        watch->fd = -1;
+    }
+    watch->pending = false;
+}
@@ -0,0 +1,127 @@
+/*
+ * Shared TLS session ticket keys (see ticket_keys.h).
+ *
+ * A single writer (the master) and many readers (workers), so the
+ * txcache seqlock is enough without a CAS: the master bumps seq to odd,
+ * rewrites the set, and publishes seq + 1. A reader copies the set and
+ * keeps it only if seq was even and unchanged across the copy.
+ */
+
+#include "ticket_keys.h"
+#include "log.h"
+
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+
+#define TICKET_KEYS_SNAPSHOT_TRIES  8
+
+struct TicketKeys {
+    uint64_t seq;
+    TicketKeySet set;
+};
+
+static int ticket_key_generate(TicketKey *key, time_t now)
+{
+    if (RAND_bytes(key->name, sizeof(key->name)) != 1 ||
+        RAND_bytes(key->aes_key, sizeof(key->aes_key)) != 1 ||
+        RAND_bytes(key->hmac_key, sizeof(key->hmac_key)) != 1) {
+        OPENSSL_cleanse(key, sizeof(*key));
+        return -1;
+    }
+    key->created = now;
+    return 0;
+}
+
+TicketKeys *ticket_keys_create(void)
+{
+    void *mem = mmap(NULL, sizeof(TicketKeys), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        log_error("TicketKeys: mmap of %zu bytes failed: %s",
+                  sizeof(TicketKeys), strerror(errno));
+        return NULL;
+    }
+#ifdef MADV_DONTDUMP
+    /* Keep the keys out of core dumps */
+    madvise(mem, sizeof(TicketKeys), MADV_DONTDUMP);
+#endif
+
+    TicketKeys *keys = mem;
+    if (ticket_key_generate(&keys->set.keys[0], time(NULL)) < 0) {
+        log_error("TicketKeys: RAND_bytes failed");
+        munmap(mem, sizeof(TicketKeys));
+        return NULL;
+    }
+    keys->set.count = 1;
+
+    log_info("TicketKeys: shared session ticket keys ready (%d kept)", TICKET_KEYS_KEPT);
+    return keys;
+}
+
+void ticket_keys_unmap(TicketKeys *keys)
+{
+    if (keys) {
+        munmap(keys, sizeof(TicketKeys));
+    }
+}
+
+void ticket_keys_destroy(TicketKeys *keys)
+{
+    if (keys) {
+        OPENSSL_cleanse(keys, sizeof(*keys));
+        munmap(keys, sizeof(TicketKeys));
+    }
+}
+
+int ticket_keys_rotate_if_due(TicketKeys *keys, int interval_sec, time_t now)
+{
+    TicketKey fresh;
+
+    if (interval_sec <= 0 || now - keys->set.keys[0].created < interval_sec) {
+        return 0;
+    }
+    if (ticket_key_generate(&fresh, now) < 0) {
+        log_error("TicketKeys: RAND_bytes failed, keeping current key");
+        return -1;
+    }
+
+    uint64_t seq = keys->seq;
+    __atomic_store_n(&keys->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* Newest first: the oldest key falls off the end */
+    memmove(&keys->set.keys[1], &keys->set.keys[0],
+            sizeof(TicketKey) * (TICKET_KEYS_KEPT - 1));
+    keys->set.keys[0] = fresh;
+    if (keys->set.count < TICKET_KEYS_KEPT) {
+        keys->set.count++;
+    }
+    keys->set.generation++;
+
+    __atomic_store_n(&keys->seq, seq + 2, __ATOMIC_RELEASE);
+    OPENSSL_cleanse(&fresh, sizeof(fresh));
+
+    log_info("TicketKeys: rotated session ticket key (generation %u)",
+             keys->set.generation);
+    return 1;
+}
+
+int ticket_keys_snapshot(const TicketKeys *keys, TicketKeySet *out)
+{
+    for (int i = 0; i < TICKET_KEYS_SNAPSHOT_TRIES; i++) {
+        uint64_t seq = __atomic_load_n(&keys->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+
+        memcpy(out, &keys->set, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&keys->seq, __ATOMIC_RELAXED) == seq) {
+            return 0;
+        }
+    }
+    return -1;
+}
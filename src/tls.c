@@ -1,9 +1,15 @@
 #include "tls.h"
+#include "ticket_keys.h"
 #include "log.h"
 
 #include <string.h>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
 /* ALPN protocol identifiers */
 static const unsigned char alpn_h2[] = { 2, 'h', '2' };
@@ -63,13 +69,122 @@ static int tls_alpn_select_cb(SSL *ssl,
     return SSL_TLSEXT_ERR_NOACK;
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+/*
+ * Session ticket key callback: tickets are sealed with the master's
+ * shared keys so any worker can open them (see ticket_keys.h).
+ * Encrypt: always under the newest key. Decrypt: 1 for the newest key,
+ * 2 (accept and reissue) for an older kept key, 0 (full handshake) for
+ * a key that has rotated out or was never ours.
+ */
+static int tls_ticket_key_cb(SSL *ssl, unsigned char key_name[16],
+                             unsigned char iv[EVP_MAX_IV_LENGTH],
+                             EVP_CIPHER_CTX *cctx, EVP_MAC_CTX *hctx, int enc)
+{
+    TLSContext *tls = SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    TicketKeySet set;
+    const TicketKey *key = NULL;
+    int ret = 1;
+
+    if (!tls || !tls->ticket_keys || ticket_keys_snapshot(tls->ticket_keys, &set) < 0) {
+        return 0;
+    }
+
+    if (enc) {
+        /* No key (never expected): issue no ticket rather than seal under zeros */
+        if (set.count == 0) {
+            ret = 0;
+            goto out;
+        }
+        key = &set.keys[0];
+        memcpy(key_name, key->name, TICKET_KEY_NAME_LEN);
+        if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1) {
+            ret = -1;
+            goto out;
+        }
+    } else {
+        for (uint32_t i = 0; i < set.count; i++) {
+            if (memcmp(key_name, set.keys[i].name, TICKET_KEY_NAME_LEN) == 0) {
+                key = &set.keys[i];
+                ret = i == 0 ? 1 : 2;
+                break;
+            }
+        }
+        if (!key) {
+            __atomic_fetch_add(&tls->ticket_unknown_key, 1, __ATOMIC_RELAXED);  /* Handshake threads */
+            ret = 0;
+            goto out;
+        }
+    }
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY,
+                                          (void *)key->hmac_key, TICKET_KEY_SECRET_LEN),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (EVP_CipherInit_ex(cctx, EVP_aes_256_cbc(), NULL, key->aes_key, iv, enc) != 1 ||
+        EVP_MAC_CTX_set_params(hctx, params) != 1) {
+        ret = -1;
+    }
+
+out:
+    OPENSSL_cleanse(&set, sizeof(set));
+    return ret;
+}
+#endif
+
+/*
+ * Shared session ticket keys, when the master provides them; otherwise
+ * OpenSSL's own per-SSL_CTX keys (resumption only on the same worker).
+ */
+static void tls_setup_ticket_keys(SSL_CTX *ctx, TLSContext *tls)
+{
+    if (!tls->ticket_keys) {
+        return;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    SSL_CTX_set_app_data(ctx, tls);
+    SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, tls_ticket_key_cb);
+#else
+    /* The EVP_MAC ticket callback needs OpenSSL 3.0 */
+    tls->ticket_keys = NULL;
+#endif
+}
+
+/*
+ * Kernel TLS: OpenSSL switches record encryption into the kernel after
+ * the handshake when the cipher and kernel allow it (AES-GCM, plus
+ * ChaCha20-Poly1305 on newer kernels, and the tls module), and quietly
+ * keeps encrypting in userspace otherwise. Counted per connection.
+ */
+static void tls_setup_ktls(SSL_CTX *ctx, TLSContext *tls)
+{
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    if (tls->ktls) {
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+    }
+#else
+    (void)ctx;
+    (void)tls;
+#endif
+}
+
 /*
  * Initialize TLS context.
  */
-int tls_context_init(TLSContext *tls, const Config *config)
+int tls_context_init(TLSContext *tls, const Config *config, struct TicketKeys *ticket_keys)
 {
     memset(tls, 0, sizeof(*tls));
     tls->http2_enabled = config->http2_enabled;
+    tls->ticket_keys = ticket_keys;
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    tls->ktls = config->tls_ktls;
+#else
+    if (config->tls_ktls) {
+        log_warn("kTLS requested but OpenSSL was built without it, encrypting in userspace");
+    }
+#endif
 
     /* Initialize OpenSSL */
     SSL_library_init();
@@ -141,6 +256,8 @@ int tls_context_init(TLSContext *tls, const Config *config)
     /* Set session caching for better performance */
     SSL_CTX_set_session_cache_mode(tls->ctx, SSL_SESS_CACHE_SERVER);
     SSL_CTX_set_session_id_context(tls->ctx, (const unsigned char *)"rawrelay", 8);
+    tls_setup_ticket_keys(tls->ctx, tls);
+    tls_setup_ktls(tls->ctx, tls);
 
     /* TLS security hardening - defense-in-depth flags.
      * SSL_CTX_set_min_proto_version(TLS1_2_VERSION) already disables
@@ -184,8 +301,10 @@ int tls_context_init(TLSContext *tls, const Config *config)
         return -1;
     }
 
-    log_info("TLS context initialized (HTTP/2: %s)",
-             tls->http2_enabled ? "enabled" : "disabled");
+    log_info("TLS context initialized (HTTP/2: %s, session tickets: %s, kTLS: %s)",
+             tls->http2_enabled ? "enabled" : "disabled",
+             tls->ticket_keys ? "shared" : "per-worker",
+             tls->ktls ? "enabled" : "disabled");
 
     return 0;
 }
@@ -247,6 +366,20 @@ bool tls_is_http2(SSL *ssl)
     return proto && strcmp(proto, "h2") == 0;
 }
 
+/*
+ * Check for kernel record encryption on the write side.
+ */
+bool tls_ktls_send_active(SSL *ssl)
+{
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    BIO *wbio = SSL_get_wbio(ssl);
+    return wbio && BIO_get_ktls_send(wbio);
+#else
+    (void)ssl;
+    return false;
+#endif
+}
+
 /*
  * Get certificate expiry timestamp.
  */
@@ -329,6 +462,8 @@ int tls_context_reload(TLSContext *tls, const Config *config)
     /* Set session caching */
     SSL_CTX_set_session_cache_mode(new_ctx, SSL_SESS_CACHE_SERVER);
     SSL_CTX_set_session_id_context(new_ctx, (const unsigned char *)"rawrelay", 8);
+    tls_setup_ticket_keys(new_ctx, tls);
+    tls_setup_ktls(new_ctx, tls);
 
     /* TLS security hardening - same flags as tls_context_init() */
     SSL_CTX_set_options(new_ctx,
@@ -0,0 +1,418 @@
+/*
+ * TLS handshake threads (see tls_offload.h).
+ *
+ * Each thread owns an inbox (filled by the event loop under the thread's
+ * lock) and the handshakes it is driving. Its loop: take the inbox, step
+ * every handshake that is new or whose fd became ready, retire finished
+ * and timed-out ones to the pool's done list, then poll() the rest plus
+ * its wake pipe. The event loop takes the done list when the done pipe
+ * becomes readable; the pipe is only written when the list goes from
+ * empty to non-empty, and the loop drains the pipe before taking the
+ * list, so no handshake is left behind.
+ */
+
+#include "tls_offload.h"
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+typedef struct TLSOffloadThread {
+    TLSOffload *pool;
+    pthread_t thread;
+    bool started;
+    int wake_pipe[2];
+
+    /* Shared with the event loop, under lock */
+    pthread_mutex_t lock;
+    TLSHandshake *inbox_head;
+    TLSHandshake *inbox_tail;
+    int queued;                         /* Inbox plus active */
+    bool stop;
+
+    /* Thread only */
+    TLSHandshake **active;
+    struct pollfd *pfds;
+    int num_active;
+} TLSOffloadThread;
+
+static double elapsed_sec(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+static void pipe_signal(int fd)
+{
+    ssize_t n;
+    do {
+        n = write(fd, "", 1);
+    } while (n < 0 && errno == EINTR);
+    /* EAGAIN: a wakeup is already pending, which is all we need */
+}
+
+static void pipe_drain(int fd)
+{
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+static int pipe_open(int fds[2])
+{
+    if (pipe(fds) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+}
+
+/* ========== Handshake threads ========== */
+
+/*
+ * Advance a handshake. Returns 1 when it is over (hs->ok says how),
+ * 0 when it waits for hs->want on its fd.
+ */
+static int handshake_step(TLSHandshake *hs)
+{
+    int r = SSL_do_handshake(hs->ssl);
+    if (r == 1) {
+        hs->ok = true;
+        return 1;
+    }
+
+    switch (SSL_get_error(hs->ssl, r)) {
+    case SSL_ERROR_WANT_READ:
+        hs->want = POLLIN;
+        return 0;
+    case SSL_ERROR_WANT_WRITE:
+        hs->want = POLLOUT;
+        return 0;
+    case SSL_ERROR_SSL:
+        hs->tls_error = true;
+        break;
+    default:
+        break;  /* Peer closed or socket error */
+    }
+    /* The error queue is per thread: don't leave it to the next handshake */
+    ERR_clear_error();
+    return 1;
+}
+
+static void handshake_finish(TLSOffloadThread *t, TLSHandshake *hs)
+{
+    TLSOffload *pool = t->pool;
+    struct timespec now;
+    bool was_empty;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    hs->duration_sec = elapsed_sec(&hs->started, &now);
+    hs->next = NULL;
+
+    pthread_mutex_lock(&t->lock);
+    t->queued--;
+    pthread_mutex_unlock(&t->lock);
+
+    pthread_mutex_lock(&pool->done_lock);
+    was_empty = pool->done_head == NULL;
+    if (pool->done_tail) {
+        pool->done_tail->next = hs;
+    } else {
+        pool->done_head = hs;
+    }
+    pool->done_tail = hs;
+    pthread_mutex_unlock(&pool->done_lock);
+
+    if (was_empty) {
+        pipe_signal(pool->done_pipe[1]);
+    }
+}
+
+static bool deadline_passed(const TLSHandshake *hs, const struct timespec *now)
+{
+    return now->tv_sec > hs->deadline.tv_sec ||
+           (now->tv_sec == hs->deadline.tv_sec && now->tv_nsec >= hs->deadline.tv_nsec);
+}
+
+static void *handshake_thread_main(void *arg)
+{
+    TLSOffloadThread *t = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&t->lock);
+        TLSHandshake *incoming = t->inbox_head;
+        bool stop = t->stop;
+        t->inbox_head = t->inbox_tail = NULL;
+        pthread_mutex_unlock(&t->lock);
+
+        /* New handshakes step right away (want == 0) */
+        while (incoming) {
+            TLSHandshake *next = incoming->next;
+            incoming->next = NULL;
+            t->active[t->num_active++] = incoming;
+            incoming = next;
+        }
+
+        if (stop) {
+            for (int i = 0; i < t->num_active; i++) {
+                handshake_finish(t, t->active[i]);
+            }
+            t->num_active = 0;
+            break;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        int i = 0;
+        while (i < t->num_active) {
+            TLSHandshake *hs = t->active[i];
+            int over;
+
+            if (hs->want == 0) {
+                over = handshake_step(hs);
+            } else {
+                over = deadline_passed(hs, &now);
+            }
+            if (over) {
+                handshake_finish(t, hs);
+                t->active[i] = t->active[--t->num_active];
+            } else {
+                i++;
+            }
+        }
+
+        /* Wait for the wake pipe, a ready fd, or the nearest deadline */
+        int timeout_ms = -1;
+        t->pfds[0].fd = t->wake_pipe[0];
+        t->pfds[0].events = POLLIN;
+        for (i = 0; i < t->num_active; i++) {
+            TLSHandshake *hs = t->active[i];
+            t->pfds[i + 1].fd = hs->fd;
+            t->pfds[i + 1].events = hs->want;
+            t->pfds[i + 1].revents = 0;
+
+            double left = elapsed_sec(&now, &hs->deadline);
+            int left_ms = left <= 0 ? 0 : (int)(left * 1000) + 1;
+            if (timeout_ms < 0 || left_ms < timeout_ms) {
+                timeout_ms = left_ms;
+            }
+        }
+
+        if (poll(t->pfds, t->num_active + 1, timeout_ms) < 0 && errno != EINTR) {
+            continue;   /* Deadlines still bound every handshake */
+        }
+        if (t->pfds[0].revents) {
+            pipe_drain(t->wake_pipe[0]);
+        }
+        for (i = 0; i < t->num_active; i++) {
+            if (t->pfds[i + 1].revents) {
+                t->active[i]->want = 0;     /* Ready (or failed): step it */
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* ========== Event loop side ========== */
+
+static void done_cb(evutil_socket_t fd, short events, void *arg)
+{
+    TLSOffload *pool = arg;
+    TLSHandshake *list;
+    (void)fd;
+    (void)events;
+
+    pipe_drain(pool->done_pipe[0]);
+
+    pthread_mutex_lock(&pool->done_lock);
+    list = pool->done_head;
+    pool->done_head = pool->done_tail = NULL;
+    pthread_mutex_unlock(&pool->done_lock);
+
+    while (list) {
+        TLSHandshake *next = list->next;
+        pool->in_flight--;
+        pool->done_fn(list, pool->done_arg);
+        slab_free(&pool->handshakes, list);
+        list = next;
+    }
+}
+
+int tls_offload_init(TLSOffload *pool, struct event_base *base, int num_threads,
+                     int queue_max, int timeout_sec, TLSOffloadDoneFn done_fn, void *arg)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->done_pipe[0] = pool->done_pipe[1] = -1;
+
+    if (num_threads > TLS_OFFLOAD_MAX_THREADS) {
+        log_warn("handshake_threads %d capped at %d", num_threads, TLS_OFFLOAD_MAX_THREADS);
+        num_threads = TLS_OFFLOAD_MAX_THREADS;
+    }
+    pool->queue_max = queue_max > 0 ? queue_max : TLS_OFFLOAD_DEFAULT_QUEUE;
+    pool->timeout_sec = timeout_sec > 0 ? timeout_sec : 10;
+    pool->done_fn = done_fn;
+    pool->done_arg = arg;
+
+    pthread_mutex_init(&pool->done_lock, NULL);
+    if (slab_pool_init(&pool->handshakes, "tls_handshake", sizeof(TLSHandshake)) < 0 ||
+        pipe_open(pool->done_pipe) < 0) {
+        log_error("TLS offload: setup failed: %s", strerror(errno));
+        tls_offload_shutdown(pool);
+        return -1;
+    }
+
+    pool->done_event = event_new(base, pool->done_pipe[0], EV_READ | EV_PERSIST, done_cb, pool);
+    pool->threads = calloc(num_threads, sizeof(TLSOffloadThread));
+    if (!pool->done_event || !pool->threads || event_add(pool->done_event, NULL) < 0) {
+        log_error("TLS offload: setup failed");
+        tls_offload_shutdown(pool);
+        return -1;
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        TLSOffloadThread *t = &pool->threads[i];
+        t->pool = pool;
+        t->wake_pipe[0] = t->wake_pipe[1] = -1;
+        pthread_mutex_init(&t->lock, NULL);
+        pool->num_threads++;
+
+        t->active = calloc(pool->queue_max, sizeof(*t->active));
+        t->pfds = calloc(pool->queue_max + 1, sizeof(*t->pfds));
+        if (!t->active || !t->pfds || pipe_open(t->wake_pipe) < 0) {
+            log_error("TLS offload: thread %d setup failed", i);
+            tls_offload_shutdown(pool);
+            return -1;
+        }
+
+        int rc = pthread_create(&t->thread, NULL, handshake_thread_main, t);
+        if (rc != 0) {
+            log_error("TLS offload: pthread_create failed: %s", strerror(rc));
+            tls_offload_shutdown(pool);
+            return -1;
+        }
+        t->started = true;
+    }
+
+    log_info("TLS handshakes offloaded to %d threads (%d in flight each, %ds timeout)",
+             pool->num_threads, pool->queue_max, pool->timeout_sec);
+    return 0;
+}
+
+int tls_offload_submit(TLSOffload *pool, int fd, SSL *ssl,
+                       const struct sockaddr *addr, int socklen)
+{
+    TLSHandshake *hs = slab_alloc(&pool->handshakes);
+    if (!hs) {
+        return -1;
+    }
+    if (SSL_set_fd(ssl, fd) != 1) {
+        slab_free(&pool->handshakes, hs);
+        return -1;
+    }
+    SSL_set_accept_state(ssl);
+
+    hs->fd = fd;
+    hs->ssl = ssl;
+    if (socklen > 0 && (size_t)socklen <= sizeof(hs->addr)) {
+        memcpy(&hs->addr, addr, socklen);
+        hs->socklen = socklen;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &hs->started);
+    hs->deadline = hs->started;
+    hs->deadline.tv_sec += pool->timeout_sec;
+
+    /* Round-robin, skipping full threads */
+    for (int tries = 0; tries < pool->num_threads; tries++) {
+        TLSOffloadThread *t = &pool->threads[pool->next_thread++ % pool->num_threads];
+        bool wake = false;
+
+        pthread_mutex_lock(&t->lock);
+        if (t->queued < pool->queue_max) {
+            t->queued++;
+            wake = t->inbox_head == NULL;
+            if (t->inbox_tail) {
+                t->inbox_tail->next = hs;
+            } else {
+                t->inbox_head = hs;
+            }
+            t->inbox_tail = hs;
+            pthread_mutex_unlock(&t->lock);
+
+            if (wake) {
+                pipe_signal(t->wake_pipe[1]);
+            }
+            pool->in_flight++;
+            return 0;
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+
+    slab_free(&pool->handshakes, hs);
+    return -1;
+}
+
+void tls_offload_shutdown(TLSOffload *pool)
+{
+    for (int i = 0; i < pool->num_threads; i++) {
+        TLSOffloadThread *t = &pool->threads[i];
+        if (t->started) {
+            pthread_mutex_lock(&t->lock);
+            t->stop = true;
+            pthread_mutex_unlock(&t->lock);
+            pipe_signal(t->wake_pipe[1]);
+            pthread_join(t->thread, NULL);
+            t->started = false;
+        }
+    }
+
+    /* Everything still held comes back as failed */
+    if (pool->done_fn) {
+        pthread_mutex_lock(&pool->done_lock);
+        for (TLSHandshake *hs = pool->done_head; hs; hs = hs->next) {
+            hs->ok = false;
+        }
+        pthread_mutex_unlock(&pool->done_lock);
+        if (pool->done_pipe[0] >= 0) {
+            done_cb(-1, 0, pool);
+        }
+    }
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        TLSOffloadThread *t = &pool->threads[i];
+        for (int j = 0; j < 2; j++) {
+            if (t->wake_pipe[j] >= 0) {
+                close(t->wake_pipe[j]);
+            }
+        }
+        free(t->active);
+        free(t->pfds);
+        pthread_mutex_destroy(&t->lock);
+    }
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->num_threads = 0;
+
+    if (pool->done_event) {
+        event_free(pool->done_event);
+        pool->done_event = NULL;
+    }
+    for (int j = 0; j < 2; j++) {
+        if (pool->done_pipe[j] >= 0) {
+            close(pool->done_pipe[j]);
+            pool->done_pipe[j] = -1;
+        }
+    }
+    pthread_mutex_destroy(&pool->done_lock);
+    slab_pool_destroy(&pool->handshakes);
+    pool->done_fn = NULL;
+}
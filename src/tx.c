@@ -0,0 +1,199 @@
+/*
+ * Bitcoin transaction helpers - txid/wtxid computation.
+ *
+ * Walks the serialized transaction once to find where the inputs/outputs
+ * end and whether a witness section is present. Legacy transactions are
+ * hashed in place (txid == wtxid). For segwit the witness-stripped
+ * serialization is assembled and both ids go through one sha256d_batch()
+ * call, which the AVX2 backend hashes side by side.
+ */
+
+#include "tx.h"
+#include "hex.h"
+#include "sha256.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Stripped serializations up to this size are built on the stack */
+#define TX_STRIP_STACK_MAX 4096
+
+/* Segwit marker/flag bytes following the version field */
+#define TX_SEGWIT_MARKER 0x00
+#define TX_SEGWIT_FLAG   0x01
+
+/* Bounded reader over the raw transaction */
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+} TxReader;
+
+static int tx_skip(TxReader *r, size_t n)
+{
+    if (n > r->len - r->pos) {
+        return -1;
+    }
+    r->pos += n;
+    return 0;
+}
+
+/*
+ * Read a CompactSize varint.
+ */
+static int tx_read_varint(TxReader *r, uint64_t *out)
+{
+    if (r->pos >= r->len) {
+        return -1;
+    }
+
+    uint8_t first = r->data[r->pos++];
+    size_t width;
+    if (first < 0xFD) {
+        *out = first;
+        return 0;
+    } else if (first == 0xFD) {
+        width = 2;
+    } else if (first == 0xFE) {
+        width = 4;
+    } else {
+        width = 8;
+    }
+
+    if (width > r->len - r->pos) {
+        return -1;
+    }
+
+    uint64_t v = 0;
+    for (size_t i = 0; i < width; i++) {
+        v |= (uint64_t)r->data[r->pos + i] << (8 * i);
+    }
+    r->pos += width;
+    *out = v;
+    return 0;
+}
+
+/*
+ * Skip a length-prefixed byte string (scripts, witness items).
+ */
+static int tx_skip_bytes(TxReader *r)
+{
+    uint64_t n;
+    if (tx_read_varint(r, &n) < 0 || n > r->len - r->pos) {
+        return -1;
+    }
+    r->pos += (size_t)n;
+    return 0;
+}
+
+int tx_compute_ids(const uint8_t *raw, size_t len, uint8_t txid[TX_HASH_LEN],
+                   uint8_t wtxid[TX_HASH_LEN])
+{
+    TxReader r = { raw, len, 0 };
+    uint64_t n_in, n_out;
+    int segwit = 0;
+
+    if (tx_skip(&r, 4) < 0) {
+        return -1;
+    }
+
+    /* Segwit: marker 0x00 (which would otherwise be a zero input count) */
+    if (len - r.pos >= 2 && raw[r.pos] == TX_SEGWIT_MARKER &&
+        raw[r.pos + 1] == TX_SEGWIT_FLAG) {
+        segwit = 1;
+        r.pos += 2;
+    }
+    size_t body_start = r.pos;
+
+    /* Inputs: prevout (36) + scriptSig + sequence (4) */
+    if (tx_read_varint(&r, &n_in) < 0 || n_in == 0) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < n_in; i++) {
+        if (tx_skip(&r, 36) < 0 || tx_skip_bytes(&r) < 0 || tx_skip(&r, 4) < 0) {
+            return -1;
+        }
+    }
+
+    /* Outputs: value (8) + scriptPubKey */
+    if (tx_read_varint(&r, &n_out) < 0) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < n_out; i++) {
+        if (tx_skip(&r, 8) < 0 || tx_skip_bytes(&r) < 0) {
+            return -1;
+        }
+    }
+    size_t body_end = r.pos;
+
+    /* Witness: one stack per input */
+    if (segwit) {
+        for (uint64_t i = 0; i < n_in; i++) {
+            uint64_t n_items;
+            if (tx_read_varint(&r, &n_items) < 0) {
+                return -1;
+            }
+            for (uint64_t j = 0; j < n_items; j++) {
+                if (tx_skip_bytes(&r) < 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    /* Locktime must be the final 4 bytes */
+    if (len - r.pos != 4) {
+        return -1;
+    }
+
+    if (!segwit) {
+        sha256d(raw, len, txid);
+        if (wtxid) {
+            memcpy(wtxid, txid, TX_HASH_LEN);
+        }
+        return 0;
+    }
+
+    /* txid covers version || body || locktime; wtxid covers everything */
+    size_t body_len = body_end - body_start;
+    size_t strip_len = 4 + body_len + 4;
+    uint8_t stack_buf[TX_STRIP_STACK_MAX];
+    uint8_t *stripped = strip_len <= sizeof(stack_buf) ? stack_buf : malloc(strip_len);
+    if (!stripped) {
+        return -1;
+    }
+    memcpy(stripped, raw, 4);
+    memcpy(stripped + 4, raw + body_start, body_len);
+    memcpy(stripped + 4 + body_len, raw + len - 4, 4);
+
+    if (wtxid) {
+        const uint8_t *msgs[2] = { stripped, raw };
+        size_t lens[2] = { strip_len, len };
+        uint8_t ids[2][SHA256_DIGEST_LEN];
+        sha256d_batch(msgs, lens, 2, ids);
+        memcpy(txid, ids[0], TX_HASH_LEN);
+        memcpy(wtxid, ids[1], TX_HASH_LEN);
+    } else {
+        sha256d(stripped, strip_len, txid);
+    }
+
+    if (stripped != stack_buf) {
+        free(stripped);
+    }
+    return 0;
+}
+
+int tx_compute_txid(const uint8_t *raw, size_t len, uint8_t txid[TX_HASH_LEN])
+{
+    return tx_compute_ids(raw, len, txid, NULL);
+}
+
+void tx_txid_to_hex(const uint8_t txid[TX_HASH_LEN], char *out)
+{
+    uint8_t reversed[TX_HASH_LEN];
+
+    for (int i = 0; i < TX_HASH_LEN; i++) {
+        reversed[i] = txid[TX_HASH_LEN - 1 - i];
+    }
+    hex_encode(reversed, TX_HASH_LEN, out);
+}
@@ -0,0 +1,146 @@
+/*
+ * Cross-worker broadcast dedup cache (see txcache.h).
+ *
+ * Slot protocol (a per-slot seqlock with CAS-claimed writers):
+ *   seq == 0     never written
+ *   seq odd      a writer owns the slot
+ *   seq even     stable record
+ * A writer CASes seq from even to odd, copies the record in, then
+ * publishes seq + 2. A reader copies the record and accepts it only if
+ * seq was even and unchanged across the copy. Nobody ever waits.
+ *
+ * A worker killed mid-write leaves its slot odd; it is skipped from then
+ * on, which costs one slot of capacity, not correctness.
+ */
+
+#include "txcache.h"
+#include "log.h"
+
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+
+typedef struct {
+    uint64_t seq;
+    TxCacheRecord rec;
+} TxCacheSlot;
+
+struct TxCache {
+    TxCacheSlot slots[TXCACHE_SLOTS];
+};
+
+/*
+ * txids are uniformly distributed; the first 4 bytes are the hash.
+ */
+static uint32_t txcache_hash(const uint8_t txid[32])
+{
+    return (uint32_t)txid[0] | ((uint32_t)txid[1] << 8) |
+           ((uint32_t)txid[2] << 16) | ((uint32_t)txid[3] << 24);
+}
+
+static int txcache_expired(const TxCacheRecord *rec, time_t now)
+{
+    int ttl = rec->accepted > 0 ? TXCACHE_ACCEPTED_TTL_SEC : TXCACHE_REJECTED_TTL_SEC;
+    return now - rec->stored_at >= ttl;
+}
+
+TxCache *txcache_create(void)
+{
+    /* Anonymous shared pages are zeroed: every slot starts at seq 0 */
+    void *mem = mmap(NULL, sizeof(TxCache), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        log_error("TxCache: mmap of %zu bytes failed: %s",
+                  sizeof(TxCache), strerror(errno));
+        return NULL;
+    }
+
+    log_info("TxCache: %d shared slots (%zu KB)", TXCACHE_SLOTS, sizeof(TxCache) / 1024);
+    return mem;
+}
+
+void txcache_destroy(TxCache *cache)
+{
+    if (cache) {
+        munmap(cache, sizeof(TxCache));
+    }
+}
+
+int txcache_lookup(TxCache *cache, const uint8_t txid[32], TxCacheRecord *out)
+{
+    uint32_t hash = txcache_hash(txid);
+
+    for (int i = 0; i < TXCACHE_PROBE_LIMIT; i++) {
+        TxCacheSlot *slot = &cache->slots[(hash + i) & (TXCACHE_SLOTS - 1)];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == 0) {
+            return 0;   /* Writers never skip an unused slot: end of chain */
+        }
+        if ((seq & 1) || memcmp(slot->rec.txid, txid, 32) != 0) {
+            continue;
+        }
+
+        memcpy(out, &slot->rec, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq ||
+            memcmp(out->txid, txid, 32) != 0) {
+            return 0;   /* Rewritten while copying */
+        }
+        return !txcache_expired(out, time(NULL));
+    }
+
+    return 0;
+}
+
+int txcache_store(TxCache *cache, const TxCacheRecord *rec)
+{
+    uint32_t hash = txcache_hash(rec->txid);
+    time_t now = time(NULL);
+    TxCacheSlot *victim = NULL;
+    uint64_t victim_seq = 0;
+    int64_t victim_age = INT64_MAX;
+    int victim_live = 0;
+
+    /* Prefer: same txid, then unused, then expired, then oldest */
+    for (int i = 0; i < TXCACHE_PROBE_LIMIT; i++) {
+        TxCacheSlot *slot = &cache->slots[(hash + i) & (TXCACHE_SLOTS - 1)];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+        if (seq & 1) {
+            continue;
+        }
+        if (seq == 0 || memcmp(slot->rec.txid, rec->txid, 32) == 0) {
+            victim = slot;
+            victim_seq = seq;
+            victim_live = 0;
+            break;
+        }
+
+        /* Unsynchronized peek: only used to rank candidates */
+        int expired = txcache_expired(&slot->rec, now);
+        int64_t age = expired ? INT64_MIN : slot->rec.stored_at;
+        if (age < victim_age) {
+            victim = slot;
+            victim_seq = seq;
+            victim_age = age;
+            victim_live = !expired;
+        }
+    }
+
+    if (!victim) {
+        return -1;
+    }
+
+    if (!__atomic_compare_exchange_n(&victim->seq, &victim_seq, victim_seq + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return -1;  /* Another writer got there first; drop rather than wait */
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(&victim->rec, rec, sizeof(*rec));
+
+    __atomic_store_n(&victim->seq, victim_seq + 2, __ATOMIC_RELEASE);
+    return victim_live;
+}
@@ -1,8 +1,11 @@
 #include "worker.h"
 #include "connection.h"
+#include "http2.h"
 #include "tcp_opts.h"
 #include "static_files.h"
 #include "tls.h"
+#include "tls_offload.h"
+#include "endpoints.h"
 #include "security.h"
 #include "log.h"
 
@@ -39,7 +42,10 @@ static void tls_accept_cb(struct evconnlistener *listener, evutil_socket_t fd,
 static void accept_error_cb(struct evconnlistener *listener, void *ctx);
 static void signal_cb(evutil_socket_t sig, short events, void *ctx);
 static void signal_reload_cb(evutil_socket_t sig, short events, void *ctx);
+static void static_channel_cb(evutil_socket_t fd, short events, void *ctx);
 static void cleanup_timer_cb(evutil_socket_t fd, short events, void *ctx);
+static void loop_probe_cb(evutil_socket_t fd, short events, void *ctx);
+static void tls_handshake_done_cb(TLSHandshake *hs, void *arg);
 static void send_403_response(int fd);
 static void send_503_response(int fd);
 static void send_429_response(int fd);
@@ -197,6 +203,48 @@ static void signal_reload_cb(evutil_socket_t sig, short events, void *ctx)
     }
 }
 
+/*
+ * The master rebuilt the static image: map it and swap it in.
+ * Requests from now on use the new files; responses already queued hold
+ * a reference to the old table, which is unmapped when the last one is
+ * sent. A notice without an image means the rebuild failed (e.g.
+ * error.html missing mid-deploy) and the old files stay.
+ */
+static void static_channel_cb(evutil_socket_t fd, short events, void *ctx)
+{
+    WorkerProcess *worker = ctx;
+    uint32_t generation;
+    int image_fd;
+    int rc;
+    (void)events;
+
+    while ((rc = static_image_recv(fd, &generation, &image_fd)) > 0) {
+        StaticFiles *files = NULL;
+
+        if (image_fd >= 0) {
+            files = static_files_map(image_fd);
+            close(image_fd);
+        }
+        if (!files) {
+            worker->static_reload_failures++;
+            log_warn("Static reload failed, still serving the previous files");
+            continue;
+        }
+
+        static_files_inherit_stats(files, worker->static_files);
+        static_files_unref(worker->static_files);
+        worker->static_files = files;
+        worker->static_generation = generation;
+        worker->static_reloads++;
+        log_info("Switched to static image generation %u (%zu assets)",
+                 generation, files->count);
+    }
+
+    if (rc < 0) {
+        event_del(worker->static_channel_event);
+    }
+}
+
 /*
  * Check if we should exit (draining and no active connections).
  * Exported for use by connection.c
@@ -283,7 +331,7 @@ static void send_403_response(int fd)
 
 /*
  * Periodic cleanup timer callback.
- * Cleans up expired rate limiter entries.
+ * Cleans up expired rate limiter entries and broadcast results.
  */
 static void cleanup_timer_cb(evutil_socket_t fd, short events, void *ctx)
 {
@@ -292,6 +340,26 @@ static void cleanup_timer_cb(evutil_socket_t fd, short events, void *ctx)
     (void)events;
 
     rate_limiter_cleanup(&worker->rate_limiter);
+    broadcast_store_expire(&worker->broadcasts);
+}
+
+/*
+ * Event loop probe: fires every LOOP_PROBE_INTERVAL_MS; anything beyond
+ * that since the last run is time the loop spent busy elsewhere.
+ */
+static void loop_probe_cb(evutil_socket_t fd, short events, void *ctx)
+{
+    WorkerProcess *worker = ctx;
+    struct timespec now;
+    (void)fd;
+    (void)events;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double lag = (now.tv_sec - worker->loop_probe_last.tv_sec) +
+                 (now.tv_nsec - worker->loop_probe_last.tv_nsec) / 1e9 -
+                 LOOP_PROBE_INTERVAL_MS / 1000.0;
+    update_loop_lag_histogram(worker, lag > 0 ? lag : 0);
+    worker->loop_probe_last = now;
 }
 
 /*
@@ -380,6 +448,72 @@ static void accept_cb(struct evconnlistener *listener, evutil_socket_t fd,
     /* Connection is now managed by bufferevent callbacks */
 }
 
+/*
+ * Wrap an accepted TLS socket in an SSL bufferevent and a connection:
+ * BUFFEREVENT_SSL_ACCEPTING handshakes on the event loop,
+ * BUFFEREVENT_SSL_OPEN takes over a handshake thread's finished one.
+ * The slot and active count are already held; released on failure.
+ */
+static void tls_connection_start(WorkerProcess *worker, evutil_socket_t fd, SSL *ssl,
+                                 struct sockaddr *addr, int socklen,
+                                 enum bufferevent_ssl_state state)
+{
+    /* Create SSL bufferevent */
+    struct bufferevent *bev = bufferevent_openssl_socket_new(
+        worker->base, fd, ssl,
+        state,
+        BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS);
+
+    if (!bev) {
+        log_error("Failed to create SSL bufferevent");
+        SSL_free(ssl);
+        close(fd);
+        worker->active_connections--;
+        slot_manager_release_normal(&worker->slots);
+        return;
+    }
+
+    /* Create connection using shared init (fixes slot leak - sets slot_held=true) */
+    Connection *conn = connection_new_with_bev(worker, bev, addr, socklen);
+    if (!conn) {
+        log_error("Failed to allocate TLS connection");
+        bufferevent_free(bev);  /* This frees SSL and closes fd */
+        worker->active_connections--;
+        slot_manager_release_normal(&worker->slots);
+        return;
+    }
+
+    conn->ssl = ssl;
+    conn->tls_handshake_done = false;
+
+    log_debug("TLS connection from %s:%d", log_format_ip(conn->client_ip), conn->client_port);
+}
+
+/*
+ * A handshake thread is done with a connection's handshake.
+ */
+static void tls_handshake_done_cb(TLSHandshake *hs, void *arg)
+{
+    WorkerProcess *worker = arg;
+
+    if (!hs->ok) {
+        if (hs->tls_error) {
+            worker->tls_handshake_errors++;
+            worker->errors_tls++;
+        }
+        SSL_free(hs->ssl);
+        close(hs->fd);
+        worker->active_connections--;
+        slot_manager_release_normal(&worker->slots);
+        worker_check_drain(worker);
+        return;
+    }
+
+    update_tls_handshake_histogram(worker, hs->duration_sec);
+    tls_connection_start(worker, hs->fd, hs->ssl, (struct sockaddr *)&hs->addr,
+                         hs->socklen, BUFFEREVENT_SSL_OPEN);
+}
+
 /*
  * TLS accept callback - called for each new TLS connection.
  * Creates an SSL-wrapped bufferevent for async TLS I/O.
@@ -446,35 +580,16 @@ static void tls_accept_cb(struct evconnlistener *listener, evutil_socket_t fd,
         return;
     }
 
-    /* Create SSL bufferevent */
-    struct bufferevent *bev = bufferevent_openssl_socket_new(
-        worker->base, fd, ssl,
-        BUFFEREVENT_SSL_ACCEPTING,
-        BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS);
-
-    if (!bev) {
-        log_error("Failed to create SSL bufferevent");
-        SSL_free(ssl);
-        close(fd);
-        worker->active_connections--;
-        slot_manager_release_normal(&worker->slots);
-        return;
-    }
-
-    /* Create connection using shared init (fixes slot leak - sets slot_held=true) */
-    Connection *conn = connection_new_with_bev(worker, bev, addr, socklen);
-    if (!conn) {
-        log_error("Failed to allocate TLS connection");
-        bufferevent_free(bev);  /* This frees SSL and closes fd */
-        worker->active_connections--;
-        slot_manager_release_normal(&worker->slots);
-        return;
+    /* Handshake on a handshake thread, unless every one is full */
+    if (worker->tls_offload.num_threads > 0) {
+        if (tls_offload_submit(&worker->tls_offload, fd, ssl, addr, socklen) == 0) {
+            worker->tls_handshakes_offloaded++;
+            return;
+        }
+        worker->tls_offload_overflows++;
     }
 
-    conn->ssl = ssl;
-    conn->tls_handshake_done = false;
-
-    log_debug("TLS connection from %s:%d", log_format_ip(conn->client_ip), conn->client_port);
+    tls_connection_start(worker, fd, ssl, addr, socklen, BUFFEREVENT_SSL_ACCEPTING);
 }
 
 /*
@@ -518,6 +633,11 @@ static void worker_cleanup(WorkerProcess *worker)
         worker->cleanup_event = NULL;
     }
 
+    if (worker->loop_probe_event) {
+        event_free(worker->loop_probe_event);
+        worker->loop_probe_event = NULL;
+    }
+
     if (worker->listener) {
         evconnlistener_free(worker->listener);
         worker->listener = NULL;
@@ -528,9 +648,27 @@ static void worker_cleanup(WorkerProcess *worker)
         worker->tls_listener = NULL;
     }
 
+    /* Join the handshake threads; handshakes they still hold are closed */
+    if (worker->tls_offload.num_threads > 0) {
+        tls_offload_shutdown(&worker->tls_offload);
+    }
+
     /* Cancel in-flight async RPC requests before destroying event loop */
     rpc_manager_cancel_all(&worker->rpc);
 
+    if (worker->static_channel_event) {
+        event_free(worker->static_channel_event);
+        worker->static_channel_event = NULL;
+    }
+    if (worker->static_channel >= 0) {
+        close(worker->static_channel);
+        worker->static_channel = -1;
+    }
+
+    /* Broadcast entries are safe to free once no RPC callback can fire */
+    broadcast_store_free(&worker->broadcasts);
+    buffer_pool_destroy(&worker->tx_buffers);
+
     if (worker->base) {
         event_base_free(worker->base);
         worker->base = NULL;
@@ -539,8 +677,14 @@ static void worker_cleanup(WorkerProcess *worker)
     /* Free TLS context */
     tls_context_free(&worker->tls);
 
-    /* Free static files */
-    static_files_free(&worker->static_files);
+    /* Connections still open at exit go with their slabs */
+    slab_pool_destroy(&worker->h2_stream_pool);
+    slab_pool_destroy(&worker->h2_conn_pool);
+    slab_pool_destroy(&worker->conn_pool);
+
+    /* Drop the worker's reference to the static files */
+    static_files_unref(worker->static_files);
+    worker->static_files = NULL;
 
     /* Free rate limiter */
     rate_limiter_free(&worker->rate_limiter);
@@ -554,7 +698,8 @@ static void worker_cleanup(WorkerProcess *worker)
 /*
  * Worker main entry point.
  */
-void worker_main(int worker_id, Config *config)
+void worker_main(int worker_id, Config *config, TxCache *tx_cache,
+                 TicketKeys *ticket_keys, int static_image_fd, int static_channel)
 {
     WorkerProcess worker = {0};
     char identity[32];
@@ -568,6 +713,7 @@ void worker_main(int worker_id, Config *config)
 
     worker.worker_id = worker_id;
     worker.config = config;
+    worker.static_channel = static_channel;
     worker.cpu_core = worker_id % get_num_cpus();
 
     /* Record start time for uptime metric */
@@ -613,8 +759,15 @@ void worker_main(int worker_id, Config *config)
         }
     }
 
-    /* Load static files from configured directory */
-    if (static_files_load(&worker.static_files, config->static_dir, config) < 0) {
+    /* Map the master's static image; load a private copy if that fails */
+    if (static_image_fd >= 0) {
+        worker.static_files = static_files_map(static_image_fd);
+        close(static_image_fd);
+    }
+    if (!worker.static_files) {
+        worker.static_files = static_files_open(config->static_dir, config, NULL);
+    }
+    if (!worker.static_files) {
         log_error("Failed to load static files from %s", config->static_dir);
         exit(1);
     }
@@ -623,7 +776,7 @@ void worker_main(int worker_id, Config *config)
     worker.base = event_base_new();
     if (!worker.base) {
         log_error("Failed to create event base");
-        static_files_free(&worker.static_files);
+        static_files_unref(worker.static_files);
         exit(1);
     }
 
@@ -641,6 +794,28 @@ void worker_main(int worker_id, Config *config)
             log_info("Mixed mode: testing all enabled RPC connections");
         }
         rpc_manager_log_status(&worker.rpc);
+
+        /* Optional coalescing of bursty broadcasts into batches */
+        rpc_manager_set_batching(&worker.rpc, config->rpc_batch_window_ms,
+                                 config->rpc_batch_max);
+    }
+
+    /* Broadcast pipeline: results served from memory on /tx/{txid} */
+    if (broadcast_store_init(&worker.broadcasts, &worker.rpc, config->chain,
+                             tx_cache) < 0) {
+        log_warn("Broadcast result table unavailable - broadcasting disabled");
+    }
+
+    /* Huge-tier transactions are decoded into pooled buffers */
+    buffer_set_max_size(config->max_buffer_size);
+    buffer_pool_init(&worker.tx_buffers);
+
+    /* Connections, HTTP/2 sessions and streams come from slabs */
+    if (slab_pool_init(&worker.conn_pool, "connection", sizeof(Connection)) < 0 ||
+        slab_pool_init(&worker.h2_conn_pool, "h2_connection", sizeof(H2Connection)) < 0 ||
+        slab_pool_init(&worker.h2_stream_pool, "h2_stream", sizeof(H2Stream)) < 0) {
+        log_error("Failed to initialize object pools");
+        exit(1);
     }
 
     /* Create SO_REUSEPORT socket */
@@ -670,7 +845,7 @@ void worker_main(int worker_id, Config *config)
 
     /* Initialize TLS if enabled */
     if (config->tls_enabled) {
-        if (tls_context_init(&worker.tls, config) < 0) {
+        if (tls_context_init(&worker.tls, config, ticket_keys) < 0) {
             log_error("Failed to initialize TLS context");
             exit(1);
         }
@@ -700,6 +875,14 @@ void worker_main(int worker_id, Config *config)
 
         evconnlistener_set_error_cb(worker.tls_listener, accept_error_cb);
         log_info("TLS listener started on port %d", config->tls_port);
+
+        /* Handshake threads (before seccomp, which covers them too) */
+        if (config->tls_handshake_threads > 0 &&
+            tls_offload_init(&worker.tls_offload, worker.base,
+                             config->tls_handshake_threads, config->tls_handshake_queue,
+                             config->read_timeout_sec, tls_handshake_done_cb, &worker) < 0) {
+            log_warn("TLS handshake threads unavailable, handshaking on the event loop");
+        }
     }
 
     /* Set up signal handling */
@@ -714,6 +897,25 @@ void worker_main(int worker_id, Config *config)
         event_add(worker.cleanup_event, &cleanup_interval);
     }
 
+    /* Event loop lag probe for rawrelay_event_loop_lag_seconds */
+    struct timeval probe_interval = {0, LOOP_PROBE_INTERVAL_MS * 1000};
+    worker.loop_probe_event = event_new(worker.base, -1, EV_PERSIST,
+                                        loop_probe_cb, &worker);
+    if (worker.loop_probe_event) {
+        clock_gettime(CLOCK_MONOTONIC, &worker.loop_probe_last);
+        event_add(worker.loop_probe_event, &probe_interval);
+    }
+
+    /* Hot reload: the master sends a new static image when the directory changes */
+    if (worker.static_channel >= 0) {
+        worker.static_channel_event = event_new(worker.base, worker.static_channel,
+                                                EV_READ | EV_PERSIST,
+                                                static_channel_cb, &worker);
+        if (worker.static_channel_event) {
+            event_add(worker.static_channel_event, NULL);
+        }
+    }
+
     log_info("Started on port %d (SO_REUSEPORT)", config->listen_port);
 
     /* Apply security restrictions (seccomp) if enabled */
@@ -0,0 +1,167 @@
+/*
+ * /metrics rendering with every optional series present: four chains
+ * with a full node error code table each, TLS and kTLS on, broadcast
+ * coalescing on, and counters at their largest. The body must keep
+ * every section through the last one (the slab pools).
+ *
+ * Usage: make test  (or ./build/test_metrics, from the repository root)
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <event2/buffer.h>
+
+#include "../include/endpoints.h"
+#include "../include/worker.h"
+#include "../include/connection.h"
+#include "../include/http2.h"
+#include "../include/static_files.h"
+#include "../include/log.h"
+
+#define BIG UINT64_MAX
+
+static void fill_client(RPCClient *client)
+{
+    strcpy(client->host, "node.example.com");
+    client->available = 1;
+    client->request_count = BIG;
+    client->error_count = BIG;
+    for (int c = 0; c < RPC_NODE_ERROR_CODES; c++) {
+        client->node_errors[c].code = -32000 - c;
+        client->node_errors[c].count = BIG;
+    }
+    client->node_error_codes = RPC_NODE_ERROR_CODES;
+    client->node_errors_other = BIG;
+
+    client->pool.hits = BIG;
+    client->pool.misses = BIG;
+    client->pool.waits = BIG;
+    client->pool.reaped = BIG;
+    client->pool.health_failures = BIG;
+
+    client->batcher.window_ms = RPC_BATCH_MAX_WINDOW_MS;
+    client->batcher.sent = BIG;
+    client->batcher.size_sum = BIG;
+    client->batcher.delay_count = BIG;
+    client->batcher.delay_sum_seconds = 1e12;
+    for (int b = 0; b < RPC_BATCH_SIZE_BUCKETS; b++) {
+        client->batcher.size_buckets[b] = BIG / RPC_BATCH_SIZE_BUCKETS;
+    }
+    for (int b = 0; b < RPC_BATCH_DELAY_BUCKETS; b++) {
+        client->batcher.delay_buckets[b] = BIG / RPC_BATCH_DELAY_BUCKETS;
+    }
+}
+
+static WorkerProcess *maximal_worker(Config *config)
+{
+    WorkerProcess *worker = calloc(1, sizeof(WorkerProcess));
+    assert(worker);
+
+    config->tls_enabled = 1;
+    worker->config = config;
+    worker->worker_id = 255;
+    worker->tls.ktls = true;
+    worker->static_files = static_files_open("./static", config, NULL);
+    assert(worker->static_files && "run from the repository root");
+
+    slot_manager_init(&worker->slots, 1000000, 1000000, 1000000);
+    int rc = rate_limiter_init(&worker->rate_limiter, 10, 20);
+    rc |= slab_pool_init(&worker->conn_pool, "connection", sizeof(Connection));
+    rc |= slab_pool_init(&worker->h2_conn_pool, "h2_connection", sizeof(H2Connection));
+    rc |= slab_pool_init(&worker->h2_stream_pool, "h2_stream", sizeof(H2Stream));
+    assert(rc == 0);
+    worker->conn_pool.allocs = BIG;
+    worker->h2_stream_pool.slab_allocs = BIG;
+
+    worker->requests_processed = BIG;
+    worker->connections_accepted = BIG;
+    worker->response_bytes_total = BIG;
+    worker->tx_streamed = BIG;
+    worker->broadcasts.submitted = BIG;
+
+    fill_client(&worker->rpc.mainnet);
+    fill_client(&worker->rpc.testnet);
+    fill_client(&worker->rpc.signet);
+    fill_client(&worker->rpc.regtest);
+    return worker;
+}
+
+static void free_worker(WorkerProcess *worker)
+{
+    slab_pool_destroy(&worker->conn_pool);
+    slab_pool_destroy(&worker->h2_conn_pool);
+    slab_pool_destroy(&worker->h2_stream_pool);
+    rate_limiter_free(&worker->rate_limiter);
+    static_files_unref(worker->static_files);
+    free(worker);
+}
+
+static void test_maximal_body_is_complete(void) {
+    Config *config = config_default();
+    WorkerProcess *worker = maximal_worker(config);
+    struct evbuffer *out = evbuffer_new();
+    assert(config && out);
+
+    int len = generate_metrics_body(worker, out);
+    assert(len > 0);
+    assert((size_t)len == evbuffer_get_length(out));
+
+    /* Well past the 32 KB the body used to be cut at */
+    assert(len > 32 * 1024);
+
+    const char *body = (const char *)evbuffer_pullup(out, -1);
+    char *text = malloc((size_t)len + 1);
+    assert(text);
+    memcpy(text, body, (size_t)len);
+    text[len] = '\0';
+
+    /* Per-chain series for the last chain and its last error code */
+    assert(strstr(text, "rawrelay_rpc_node_errors_total{worker=\"255\",chain=\"regtest\",code=\"-32015\"}"));
+    assert(strstr(text, "rawrelay_rpc_batch_delay_seconds_count{worker=\"255\",chain=\"regtest\"}"));
+
+    /* Sections after the per-chain ones */
+    assert(strstr(text, "rawrelay_dedup_evictions_total{worker=\"255\"}"));
+    assert(strstr(text, "rawrelay_tx_buffer_requests_total{worker=\"255\""));
+
+    /* The last section, complete */
+    const char *last = "rawrelay_pool_slab_allocations_total{worker=\"255\",pool=\"h2_stream\"} 18446744073709551615\n";
+    size_t last_len = strlen(last);
+    assert((size_t)len >= last_len);
+    assert(strcmp(text + len - last_len, last) == 0);
+
+    free(text);
+    evbuffer_free(out);
+    free_worker(worker);
+    config_free(config);
+    printf("  [PASS] test_maximal_body_is_complete (%d bytes)\n", len);
+}
+
+static void test_appends_to_existing_output(void) {
+    Config *config = config_default();
+    WorkerProcess *worker = maximal_worker(config);
+    struct evbuffer *out = evbuffer_new();
+    assert(config && out);
+
+    evbuffer_add(out, "HEAD", 4);
+    int len = generate_metrics_body(worker, out);
+    assert(len > 0);
+    assert(evbuffer_get_length(out) == (size_t)len + 4);
+
+    evbuffer_free(out);
+    free_worker(worker);
+    config_free(config);
+    printf("  [PASS] test_appends_to_existing_output\n");
+}
+
+int main(void) {
+    printf("Running metrics tests...\n");
+    log_init(LOG_WARN);
+    test_maximal_body_is_complete();
+    test_appends_to_existing_output();
+    printf("All tests passed!\n");
+    return 0;
+}